@@ -20,6 +20,7 @@
 #include "framework/mlt_version.h"
 #include "mlt++/Mlt.h"
 #include "renderjob.h"
+#include "segmentedrenderjob.h"
 #include <QApplication>
 #include <QDebug>
 #include <QDir>
@@ -30,6 +31,14 @@
 #include <QUrl>
 #include <cstdio>
 
+static void consumer_frame_show(mlt_consumer, int *renderedFrames, mlt_frame)
+{
+    // Reported every few frames, this is parsed by the segmented render job
+    if (++(*renderedFrames) % 10 == 0) {
+        fprintf(stderr, "FRAMES:%d \n", *renderedFrames);
+    }
+}
+
 int main(int argc, char **argv)
 {
     QApplication app(argc, argv);
@@ -54,10 +63,34 @@ int main(int argc, char **argv)
             pid = args.at(0).section(QLatin1Char(':'), 1).toInt();
             args.removeFirst();
         }
+        // Do we want a segmented render
+        if (args.count() > 2 && args.at(0) == QLatin1String("-segments")) {
+            args.removeFirst();
+            // first frame of each segment, followed by a 'c' if the segment is in the preview cache
+            QList<int> boundaries;
+            QList<int> cachedStarts;
+            for (const QString &frame : args.takeFirst().split(QLatin1Char(','), QString::SkipEmptyParts)) {
+                boundaries << frame.section(QLatin1Char('c'), 0, 0).toInt();
+                if (frame.endsWith(QLatin1Char('c'))) {
+                    cachedStarts << boundaries.last();
+                }
+            }
+            // number of segments rendered at the same time
+            int workers = args.takeFirst().toInt();
+            // ffmpeg, used to join the segments
+            QString ffmpeg = args.takeFirst();
+            auto *sJob = new SegmentedRenderJob(render, playlist, target, pid, boundaries, workers, ffmpeg);
+            // smart render: preview cache folder, chunk extension and preview encoding parameters
+            if (args.count() > 3 && args.at(0) == QLatin1String("-cached")) {
+                sJob->setCachedSegments(cachedStarts, args.at(1), args.at(2), args.at(3));
+            }
+            sJob->start();
+            return app.exec();
+        }
         // Do we want a split render
         if (args.count() > 0 && args.at(0) == QLatin1String("-split")) {
             args.removeFirst();
-            // chunks to render
+            // chunks to render, either a first frame or a first-last frame range
             QStringList chunks = args.at(0).split(QLatin1Char(','), QString::SkipEmptyParts);
             args.removeFirst();
             // chunk size in frames
@@ -69,6 +102,8 @@ int main(int argc, char **argv)
             // avformat consumer params
             QStringList consumerParams = args.at(0).split(QLatin1Char(' '), QString::SkipEmptyParts);
             args.removeFirst();
+            // report the rendered frames, for segmented renders
+            bool reportFrames = !args.isEmpty() && args.at(0) == QLatin1String("-progress");
             QDir baseFolder(target);
             Mlt::Factory::init();
             Mlt::Profile profile;
@@ -80,15 +115,17 @@ int main(int argc, char **argv)
             profile.set_explicit(1);
             const char *localename = prod.get_lcnumeric();
             QLocale::setDefault(QLocale(localename));
-            for (const QString &frame : chunks) {
-                fprintf(stderr, "START:%d \n", frame.toInt());
+            for (const QString &chunk : chunks) {
+                int frame = chunk.section(QLatin1Char('-'), 0, 0).toInt();
+                int last = chunk.contains(QLatin1Char('-')) ? chunk.section(QLatin1Char('-'), 1, 1).toInt() : frame + chunkSize;
+                fprintf(stderr, "START:%d \n", frame);
                 QString fileName = QStringLiteral("%1.%2").arg(frame).arg(extension);
                 if (baseFolder.exists(fileName)) {
                     // Don't overwrite an existing file
-                    fprintf(stderr, "DONE:%d \n", frame.toInt());
+                    fprintf(stderr, "DONE:%d \n", frame);
                     continue;
                 }
-                QScopedPointer<Mlt::Producer> playlst(prod.cut(frame.toInt(), frame.toInt() + chunkSize));
+                QScopedPointer<Mlt::Producer> playlst(prod.cut(frame, last));
                 QScopedPointer<Mlt::Consumer> cons(
                     new Mlt::Consumer(profile, QString("avformat:%1").arg(baseFolder.absoluteFilePath(fileName)).toUtf8().constData()));
                 for (const QString &param : consumerParams) {
@@ -102,10 +139,19 @@ int main(int argc, char **argv)
                 cons->set("terminate_on_pause", 1);
                 cons->connect(*playlst);
                 playlst.reset();
+                int renderedFrames = 0;
+                QScopedPointer<Mlt::Event> frameEvent;
+                if (reportFrames) {
+                    frameEvent.reset(cons->listen("consumer-frame-show", &renderedFrames, (mlt_listener)consumer_frame_show));
+                }
                 cons->run();
                 cons->stop();
                 cons->purge();
-                fprintf(stderr, "DONE:%d \n", frame.toInt());
+                if (reportFrames) {
+                    // The final count is checked before joining the segment
+                    fprintf(stderr, "FRAMES:%d \n", renderedFrames);
+                }
+                fprintf(stderr, "DONE:%d \n", frame);
             }
             // Mlt::Factory::close();
             fprintf(stderr, "+ + + RENDERING FINSHED + + + \n");
@@ -131,8 +131,7 @@ void RenderJob::receivedStderr()
         }
         int frame = result.section(QLatin1Char(','), 1).section(QLatin1Char(' '), -1).toInt();
         if ((m_kdenliveinterface != nullptr) && m_kdenliveinterface->isValid()) {
-            m_dbusargs[1] = m_progress;
-            m_kdenliveinterface->callWithArgumentList(QDBus::NoBlock, QStringLiteral("setRenderingProgress"), m_dbusargs);
+            m_kdenliveinterface->callWithArgumentList(QDBus::NoBlock, QStringLiteral("setRenderingProgress"), {m_dest, m_progress, frame});
         }
         if (m_jobUiserver) {
             m_jobUiserver->call(QStringLiteral("setPercent"), (uint)m_progress);
@@ -239,7 +238,7 @@ void RenderJob::initKdenliveDbusInterface()
         m_dbusargs.append(m_dest);
         m_dbusargs.append((int)0);
         if (!m_args.contains(QStringLiteral("pass=2"))) {
-            m_kdenliveinterface->callWithArgumentList(QDBus::NoBlock, QStringLiteral("setRenderingProgress"), m_dbusargs);
+            m_kdenliveinterface->callWithArgumentList(QDBus::NoBlock, QStringLiteral("setRenderingProgress"), {m_dest, 0, -1});
         }
         connect(m_kdenliveinterface, SIGNAL(abortRenderJob(QString)), this, SLOT(slotAbort(QString)));
     }
@@ -34,20 +34,22 @@ class RenderJob : public QObject
 
 public:
     RenderJob(const QString &render, const QString &scenelist, const QString &target, int pid = -1, int in = -1, int out = -1);
-    ~RenderJob();
+    ~RenderJob() override;
     void setLocale(const QString &locale);
 
 public slots:
-    void start();
+    virtual void start();
+
+protected slots:
+    virtual void slotAbort();
 
 private slots:
     void slotIsOver(QProcess::ExitStatus status, bool isWritable = true);
     void receivedStderr();
-    void slotAbort();
     void slotAbort(const QString &url);
     void slotCheckProcess(QProcess::ProcessState state);
 
-private:
+protected:
     QString m_scenelist;
     QString m_dest;
     int m_progress;
@@ -0,0 +1,376 @@
+/***************************************************************************
+ *   Copyright (C) 2019 by Kdenlive contributors                           *
+ *   This file is part of kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+#include "segmentedrenderjob.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDomDocument>
+#include <QFileInfo>
+#include <QTextStream>
+#include <algorithm>
+
+SegmentedRenderJob::SegmentedRenderJob(const QString &render, const QString &scenelist, const QString &target, int pid, const QList<int> &boundaries,
+                                       int workers, const QString &ffmpeg)
+    : RenderJob(render, scenelist, target, pid)
+    , m_workers(qMax(1, workers))
+    , m_ffmpeg(ffmpeg)
+    , m_extension(QFileInfo(target).suffix())
+{
+    for (int start : boundaries) {
+        if (m_segments.empty() || start > m_segments.back().start) {
+            m_segments.emplace_back();
+            m_segments.back().start = start;
+        }
+    }
+}
+
+void SegmentedRenderJob::setCachedSegments(const QList<int> &cachedStarts, const QString &folder, const QString &extension, const QString &videoParams)
+{
+    m_cachedStarts = cachedStarts;
+    m_cacheFolder = QDir(folder);
+    m_cacheExtension = extension;
+    m_videoParams = videoParams;
+}
+
+bool SegmentedRenderJob::readConsumer(int &out)
+{
+    QFile file(m_scenelist);
+    QDomDocument doc;
+    if (!file.open(QIODevice::ReadOnly) || !doc.setContent(&file)) {
+        return false;
+    }
+    const QDomElement consumer = doc.elementsByTagName(QStringLiteral("consumer")).item(0).toElement();
+    if (consumer.isNull()) {
+        return false;
+    }
+    out = consumer.attribute(QStringLiteral("out"), QStringLiteral("-1")).toInt();
+    m_hasAudio = consumer.attribute(QStringLiteral("an")) != QLatin1String("1");
+    // The workers get the same encoding parameters, the target and range are given by the split mode
+    const QStringList ignored{QStringLiteral("mlt_service"), QStringLiteral("target"), QStringLiteral("in"), QStringLiteral("out")};
+    QStringList params;
+    const QDomNamedNodeMap attributes = consumer.attributes();
+    for (int i = 0; i < attributes.count(); ++i) {
+        const QDomAttr attribute = attributes.item(i).toAttr();
+        if (!ignored.contains(attribute.name())) {
+            params << QStringLiteral("%1=%2").arg(attribute.name(), attribute.value());
+        }
+    }
+    m_consumerParams = params.join(QLatin1Char(' '));
+    return true;
+}
+
+void SegmentedRenderJob::start()
+{
+    if (m_pid > -1) {
+        initKdenliveDbusInterface();
+    }
+    int out = -1;
+    if (m_segments.empty() || !readConsumer(out) || out < m_segments.back().start) {
+        finish(-2, tr("Cannot read the segments of %1").arg(m_scenelist));
+        return;
+    }
+    if (m_ffmpeg.isEmpty()) {
+        finish(-2, tr("FFmpeg is required to join the rendered segments"));
+        return;
+    }
+    for (size_t i = 0; i < m_segments.size(); ++i) {
+        m_segments[i].end = i + 1 < m_segments.size() ? m_segments[i + 1].start - 1 : out;
+        m_totalFrames += m_segments[i].end - m_segments[i].start + 1;
+    }
+    // Segments are written next to the destination, so that joining them does not copy across filesystems
+    m_folder.reset(new QTemporaryDir(QFileInfo(m_dest).absolutePath() + QStringLiteral("/.kdenlive-segments-XXXXXX")));
+    if (!m_folder->isValid()) {
+        m_folder.reset(new QTemporaryDir());
+    }
+    if (!m_folder->isValid()) {
+        finish(-2, tr("Cannot create a folder for the segments of %1").arg(m_dest));
+        return;
+    }
+    if (m_cacheExtension.isEmpty() || !prepareCachedSegments(out)) {
+        // Audio is not split: joining audio segments with a stream copy leaves gaps at their boundaries
+        for (Segment &segment : m_segments) {
+            segment.folder = m_folder->path();
+            segment.extension = m_extension;
+            segment.params = m_hasAudio ? m_consumerParams + QStringLiteral(" an=1") : m_consumerParams;
+        }
+        if (!addAudioSegment(out)) {
+            finish(-2, tr("Cannot create a folder for the segments of %1").arg(m_dest));
+            return;
+        }
+    }
+    m_logstream << "Segmented render of " << m_dest << ": " << m_segments.size() << " segments, " << m_workers << " workers" << endl;
+    reportProgress();
+    startWorkers();
+    if (allSegmentsDone()) {
+        // All the segments were found in the preview cache
+        concatenate();
+    }
+}
+
+bool SegmentedRenderJob::prepareCachedSegments(int out)
+{
+    std::vector<bool> cached;
+    for (const Segment &segment : m_segments) {
+        cached.push_back(m_cachedStarts.contains(segment.start) &&
+                         m_cacheFolder.exists(QStringLiteral("%1.%2").arg(segment.start).arg(m_cacheExtension)));
+    }
+    if (std::find(cached.begin(), cached.end(), true) == cached.end()) {
+        m_logstream << "No preview chunk found in " << m_cacheFolder.absolutePath() << ", rendering all segments" << endl;
+        return false;
+    }
+    int cachedFrames = 0;
+    for (size_t i = 0; i < m_segments.size(); ++i) {
+        Segment &segment = m_segments[i];
+        segment.cached = cached[i];
+        if (segment.cached) {
+            segment.folder = m_cacheFolder.absolutePath();
+            segment.extension = m_cacheExtension;
+            segment.frames = segment.end - segment.start + 1;
+            cachedFrames += segment.frames;
+        } else {
+            // The fresh segments must be encoded like the preview chunks they are joined with
+            segment.folder = m_folder->path();
+            segment.extension = m_cacheExtension;
+            segment.params = m_videoParams;
+        }
+    }
+    m_logstream << "Smart render: " << cachedFrames << " frames copied from " << m_cacheFolder.absolutePath() << endl;
+    // The preview chunks have no audio
+    return addAudioSegment(out);
+}
+
+bool SegmentedRenderJob::addAudioSegment(int out)
+{
+    if (!m_hasAudio) {
+        return true;
+    }
+    // It has the same first frame as the first video segment, so it is written in a subfolder
+    QDir audioFolder(m_folder->path());
+    if (!audioFolder.mkpath(QStringLiteral("audio")) || !audioFolder.cd(QStringLiteral("audio"))) {
+        return false;
+    }
+    Segment audio;
+    audio.start = m_segments.front().start;
+    audio.end = out;
+    audio.audio = true;
+    audio.folder = audioFolder.absolutePath();
+    audio.extension = m_extension;
+    audio.params = m_consumerParams + QStringLiteral(" vn=1");
+    m_totalFrames += audio.end - audio.start + 1;
+    // It is the longest segment, so it starts first
+    m_segments.insert(m_segments.begin(), std::move(audio));
+    return true;
+}
+
+QString SegmentedRenderJob::segmentFile(const Segment &segment) const
+{
+    return QDir(segment.folder).absoluteFilePath(QStringLiteral("%1.%2").arg(segment.start).arg(segment.extension));
+}
+
+void SegmentedRenderJob::startWorkers()
+{
+    int running = 0;
+    for (const Segment &segment : m_segments) {
+        if (segment.process && segment.process->state() != QProcess::NotRunning) {
+            running++;
+        }
+    }
+    while (running < m_workers && m_nextSegment < (int)m_segments.size()) {
+        Segment &segment = m_segments[(size_t)m_nextSegment++];
+        if (segment.cached) {
+            continue;
+        }
+        const QStringList args{m_prog,
+                               m_scenelist,
+                               segment.folder,
+                               QStringLiteral("-split"),
+                               QStringLiteral("%1-%2").arg(segment.start).arg(segment.end),
+                               QStringLiteral("0"),
+                               segment.extension,
+                               segment.params,
+                               QStringLiteral("-progress")};
+        segment.process.reset(new QProcess);
+        segment.process->setReadChannel(QProcess::StandardError);
+        QProcess *process = segment.process.get();
+        connect(process, &QProcess::readyReadStandardError, this, [this, &segment]() { segmentOutput(segment); });
+        connect(process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this,
+                [this, &segment](int exitCode, QProcess::ExitStatus status) { segmentFinished(segment, exitCode, status); });
+        m_logstream << "Starting segment " << segment.start << "-" << segment.end << endl;
+        process->start(QCoreApplication::applicationFilePath(), args);
+        running++;
+    }
+}
+
+void SegmentedRenderJob::segmentOutput(Segment &segment)
+{
+    const QStringList lines = QString::fromLocal8Bit(segment.process->readAllStandardError()).split(QLatin1Char('\n'), QString::SkipEmptyParts);
+    bool progress = false;
+    for (const QString &line : lines) {
+        const QString result = line.simplified();
+        if (result.startsWith(QLatin1String("FRAMES:"))) {
+            segment.rendered = result.section(QLatin1Char(':'), 1).toInt();
+            segment.frames = qMin(segment.rendered, segment.end - segment.start + 1);
+            progress = true;
+        } else if (!result.startsWith(QLatin1String("START:")) && !result.startsWith(QLatin1String("DONE:")) && !result.isEmpty()) {
+            segment.errors.append(result + QStringLiteral("<br>"));
+        }
+    }
+    if (progress) {
+        reportProgress();
+    }
+}
+
+void SegmentedRenderJob::reportProgress()
+{
+    int frames = 0;
+    for (const Segment &segment : m_segments) {
+        frames += segment.frames;
+    }
+    // The last percent is left for the concatenation
+    int progress = qMin(99, (int)(100. * frames / qMax(1, m_totalFrames)));
+    if (progress <= m_progress) {
+        return;
+    }
+    m_progress = progress;
+    if ((m_kdenliveinterface != nullptr) && m_kdenliveinterface->isValid()) {
+        m_kdenliveinterface->callWithArgumentList(QDBus::NoBlock, QStringLiteral("setRenderingProgress"), {m_dest, m_progress, frames});
+    }
+}
+
+void SegmentedRenderJob::segmentFinished(Segment &segment, int exitCode, QProcess::ExitStatus status)
+{
+    if (m_failed) {
+        return;
+    }
+    // Read the final frame count, it may not have been processed yet
+    segmentOutput(segment);
+    const QString fileName = segmentFile(segment);
+    const int length = segment.end - segment.start + 1;
+    if (status == QProcess::CrashExit || exitCode != 0 || !QFileInfo::exists(fileName) || segment.rendered != length) {
+        m_failed = true;
+        if (segment.rendered != length) {
+            // A short segment would shift all the following ones when joined
+            segment.errors.append(tr("Segment %1-%2 has %3 frames instead of %4").arg(segment.start).arg(segment.end).arg(segment.rendered).arg(length));
+        }
+        m_logstream << "Segment " << segment.start << "-" << segment.end << " failed: " << segment.errors << endl;
+        stopWorkers();
+        finish(-2, segment.errors);
+        return;
+    }
+    segment.frames = segment.end - segment.start + 1;
+    reportProgress();
+    startWorkers();
+    if (allSegmentsDone()) {
+        concatenate();
+    }
+}
+
+bool SegmentedRenderJob::allSegmentsDone() const
+{
+    for (const Segment &segment : m_segments) {
+        if (!segment.cached && (!segment.process || segment.process->state() != QProcess::NotRunning)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SegmentedRenderJob::concatenate()
+{
+    const QString listFile = m_folder->filePath(QStringLiteral("segments.txt"));
+    QFile list(listFile);
+    if (!list.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        finish(-2, tr("Cannot write to file %1").arg(listFile));
+        return;
+    }
+    QTextStream stream(&list);
+    QString audioFile;
+    for (const Segment &segment : m_segments) {
+        QString path = segmentFile(segment);
+        if (segment.audio) {
+            audioFile = path;
+            continue;
+        }
+        stream << "file '" << path.replace(QLatin1Char('\''), QStringLiteral("'\\''")) << "'\n";
+    }
+    list.close();
+    // Streams are copied: the segments use the same encoding parameters
+    QStringList args{QStringLiteral("-y"),    QStringLiteral("-v"), QStringLiteral("error"), QStringLiteral("-f"), QStringLiteral("concat"),
+                     QStringLiteral("-safe"), QStringLiteral("0"),  QStringLiteral("-i"),    listFile};
+    if (audioFile.isEmpty()) {
+        args << QStringLiteral("-map") << QStringLiteral("0");
+    } else {
+        args << QStringLiteral("-i") << audioFile << QStringLiteral("-map") << QStringLiteral("0:v") << QStringLiteral("-map") << QStringLiteral("1:a");
+    }
+    args << QStringLiteral("-c") << QStringLiteral("copy") << m_dest;
+    m_logstream << "Joining segments: " << m_ffmpeg << ' ' << args.join(QLatin1Char(' ')) << endl;
+    m_concatProcess.reset(new QProcess);
+    connect(m_concatProcess.get(), static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this,
+            &SegmentedRenderJob::concatenationFinished);
+    m_concatProcess->start(m_ffmpeg, args);
+}
+
+void SegmentedRenderJob::concatenationFinished(int exitCode, QProcess::ExitStatus status)
+{
+    if (status == QProcess::CrashExit || exitCode != 0) {
+        finish(-2, QString::fromLocal8Bit(m_concatProcess->readAllStandardError()));
+        return;
+    }
+    finish(-1);
+}
+
+void SegmentedRenderJob::stopWorkers()
+{
+    for (Segment &segment : m_segments) {
+        if (segment.process) {
+            segment.process->disconnect(this);
+            segment.process->kill();
+            segment.process->waitForFinished(3000);
+        }
+    }
+    if (m_concatProcess) {
+        m_concatProcess->disconnect(this);
+        m_concatProcess->kill();
+        m_concatProcess->waitForFinished(3000);
+    }
+}
+
+void SegmentedRenderJob::slotAbort()
+{
+    qWarning() << "Job aborted by user...";
+    m_failed = true;
+    stopWorkers();
+    QFile(m_dest).remove();
+    finish(-3);
+}
+
+void SegmentedRenderJob::finish(int status, const QString &error)
+{
+    if (m_kdenliveinterface) {
+        m_kdenliveinterface->callWithArgumentList(QDBus::NoBlock, QStringLiteral("setRenderingFinished"), {m_dest, status, error});
+    }
+    if (status == -1) {
+        m_logstream << "Rendering of " << m_dest << " finished" << endl;
+    } else if (status == -3) {
+        m_logstream << "Job aborted by user" << endl;
+    } else {
+        m_logstream << "Rendering of " << m_dest << " failed: " << error << endl;
+    }
+    m_logstream.flush();
+    if (m_erase) {
+        QFile(m_scenelist).remove();
+    }
+    m_folder.reset();
+    if (status == -1) {
+        m_logfile.remove();
+    }
+    // This may be called before the event loop is started
+    QMetaObject::invokeMethod(qApp, "quit", Qt::QueuedConnection);
+}
@@ -0,0 +1,121 @@
+/***************************************************************************
+ *   Copyright (C) 2019 by Kdenlive contributors                           *
+ *   This file is part of kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#ifndef SEGMENTEDRENDERJOB_H
+#define SEGMENTEDRENDERJOB_H
+
+#include "renderjob.h"
+#include <QDir>
+#include <QMap>
+#include <QTemporaryDir>
+#include <memory>
+#include <vector>
+
+/**
+  Renders a playlist as several segments in parallel, then joins them without re-encoding.
+
+  Each segment is rendered by a worker kdenlive_render process in split mode,
+  at most \c workers of them running at the same time. The segments are written
+  in a temporary folder next to the destination, using its container, and
+  concatenated with the ffmpeg concat demuxer once they are all done.
+  If the destination has audio, the video segments are rendered without it and
+  the audio is rendered in one piece, then muxed with the joined video: joined
+  audio segments would drift from the video. A segment is only joined if its
+  worker reports all its frames rendered.
+  Progress is the sum of the frames rendered by all the workers, aborting the job
+  kills all of them.
+
+  In smart render mode, some segments are timeline preview chunks that are copied
+  from the preview cache instead of being rendered. The other video segments are
+  rendered with the preview encoding parameters.
+  */
+class SegmentedRenderJob : public RenderJob
+{
+    Q_OBJECT
+
+public:
+    /** @param boundaries the first frame of each segment, in increasing order
+        @param workers the maximum number of segments rendered at the same time
+        @param ffmpeg the path to the ffmpeg executable used to join the segments */
+    SegmentedRenderJob(const QString &render, const QString &scenelist, const QString &target, int pid, const QList<int> &boundaries, int workers,
+                       const QString &ffmpeg);
+
+    /** @brief Enables the smart render mode
+        @param cachedStarts the first frame of the segments that are available in the preview cache
+        @param folder the preview cache folder, where a chunk is named after its first frame
+        @param extension the extension of the preview chunks
+        @param videoParams the preview encoding parameters, used for the segments that are not cached */
+    void setCachedSegments(const QList<int> &cachedStarts, const QString &folder, const QString &extension, const QString &videoParams);
+
+public slots:
+    void start() override;
+
+protected slots:
+    void slotAbort() override;
+
+private:
+    struct Segment
+    {
+        int start;
+        int end;
+        /** The segment is copied from the preview cache */
+        bool cached{false};
+        /** The segment is the audio of the whole range, in smart render mode */
+        bool audio{false};
+        QString folder;
+        QString extension;
+        QString params;
+        /** Frames rendered so far, for the progress */
+        int frames{0};
+        /** Last frame count reported by the worker */
+        int rendered{-1};
+        std::unique_ptr<QProcess> process;
+        QString errors;
+    };
+    std::vector<Segment> m_segments;
+    int m_workers;
+    QString m_ffmpeg;
+    std::unique_ptr<QTemporaryDir> m_folder;
+    QString m_extension;
+    QString m_consumerParams;
+    QList<int> m_cachedStarts;
+    QDir m_cacheFolder;
+    QString m_cacheExtension;
+    QString m_videoParams;
+    int m_nextSegment{0};
+    int m_totalFrames{0};
+    bool m_hasAudio{true};
+    bool m_failed{false};
+    std::unique_ptr<QProcess> m_concatProcess;
+
+    /** @brief Reads the frame range and the parameters of the consumer of the playlist */
+    bool readConsumer(int &out);
+    /** @brief Sets up the segments in smart render mode, returns false if no cached chunk is left */
+    bool prepareCachedSegments(int out);
+    /** @brief Adds the segment rendering the audio of the whole range, if the destination has audio */
+    bool addAudioSegment(int out);
+    /** @brief Returns the file of a segment */
+    QString segmentFile(const Segment &segment) const;
+    /** @brief Starts workers until their maximum count is reached or all segments are started */
+    void startWorkers();
+    void segmentOutput(Segment &segment);
+    void segmentFinished(Segment &segment, int exitCode, QProcess::ExitStatus status);
+    void reportProgress();
+    bool allSegmentsDone() const;
+    /** @brief Joins the segments into the destination file */
+    void concatenate();
+    void concatenationFinished(int exitCode, QProcess::ExitStatus status);
+    /** @brief Reports the job result to Kdenlive and quits */
+    void finish(int status, const QString &error = QString());
+    /** @brief Kills the running workers */
+    void stopWorkers();
+};
+
+#endif
@@ -30,6 +30,8 @@
 #include <mutex>
 #include <unordered_map>
 
+class MetadataCache;
+
 /** @brief This class is the base class for assets (transitions or effets) repositories
  */
 
@@ -77,6 +79,16 @@ protected:
     void init();
     virtual Mlt::Properties *retrieveListFromMlt() const = 0;
 
+    /* @brief Fills the assets from the cache written by a previous init
+       @return false if the cache is missing or was built from other sources
+    */
+    bool loadCache(const MetadataCache &cache, const QByteArray &signature);
+    /* @brief Stores the parsed assets in the cache */
+    void saveCache(const MetadataCache &cache, const QByteArray &signature) const;
+
+    /* @brief Returns the name of the file caching the parsed assets */
+    virtual QString cacheName() const = 0;
+
     /* @brief Parse some info from a mlt structure
        @param res Datastructure to fill
        @return true on success
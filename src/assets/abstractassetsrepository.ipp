@@ -19,14 +19,18 @@
  *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
  ***************************************************************************/
 
+#include "utils/metadatacache.hpp"
 #include "xml/xml.hpp"
+#include <QDataStream>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QStandardPaths>
 #include <QString>
 #include <QTextStream>
 
 #include <locale>
+#include <vector>
 #ifdef Q_OS_MAC
 #include <xlocale.h>
 #endif
@@ -35,6 +39,8 @@ template <typename AssetType> AbstractAssetsRepository<AssetType>::AbstractAsset
 
 template <typename AssetType> void AbstractAssetsRepository<AssetType>::init()
 {
+    QElapsedTimer timer;
+    timer.start();
 // Warning: Mlt::Factory::init() resets the locale to the default system value, make sure we keep correct locale
 #ifndef Q_OS_MAC
     setlocale(LC_NUMERIC, nullptr);
@@ -51,6 +57,26 @@ template <typename AssetType> void AbstractAssetsRepository<AssetType>::init()
     // Retrieve the list of MLT's available assets.
     QScopedPointer<Mlt::Properties> assets(retrieveListFromMlt());
     int max = assets->count();
+
+    // Set the directories to look into for effects.
+    QStringList asset_dirs = assetDirs();
+
+    // Parsing the metadata of all MLT services is slow, so the result is cached until MLT, its services or the custom assets change
+    QStringList services;
+    for (int i = 0; i < max; ++i) {
+        services << assets->get_name(i);
+    }
+    QStringList sourceDirs = asset_dirs;
+    if (mlt_environment("MLT_REPOSITORY") != nullptr) {
+        sourceDirs << QString::fromUtf8(mlt_environment("MLT_REPOSITORY"));
+    }
+    const MetadataCache cache(MetadataCache::location(cacheName()));
+    const QByteArray signature = MetadataCache::signature(sourceDirs, services);
+    if (loadCache(cache, signature)) {
+        qDebug() << "// Loaded" << m_assets.size() << "assets from cache in" << timer.elapsed() << "ms";
+        return;
+    }
+
     QString sox = QStringLiteral("sox.");
     for (int i = 0; i < max; ++i) {
         Info info;
@@ -74,9 +100,6 @@ template <typename AssetType> void AbstractAssetsRepository<AssetType>::init()
 
     // We now parse custom effect xml
 
-    // Set the directories to look into for effects.
-    QStringList asset_dirs = assetDirs();
-
     /* Parsing of custom xml works as follows: we parse all custom files.
        Each of them contains a tag, which is the corresponding mlt asset, and an id that is the name of the asset. Note that several custom files can correspond
        to the same tag, and in that case they must have different ids. We do the parsing in a map from ids to parse info, and then we add them to the asset
@@ -109,6 +132,72 @@ template <typename AssetType> void AbstractAssetsRepository<AssetType>::init()
             qDebug() << "Error: conflicting asset name " << custom.first;
         }*/
     }
+    saveCache(cache, signature);
+    qDebug() << "// Parsed" << m_assets.size() << "assets in" << timer.elapsed() << "ms";
+}
+
+template <typename AssetType> bool AbstractAssetsRepository<AssetType>::loadCache(const MetadataCache &cache, const QByteArray &signature)
+{
+    QByteArray payload;
+    if (!cache.read(signature, payload)) {
+        return false;
+    }
+    QDataStream stream(payload);
+    quint32 count = 0;
+    stream >> count;
+    std::vector<Info> infos(count);
+    QStringList keys;
+    for (Info &info : infos) {
+        qint32 version = 0;
+        qint32 type = 0;
+        QString key;
+        stream >> key >> info.id >> info.mltId >> info.name >> info.description >> info.author >> info.version_str >> version >> type;
+        info.version = version;
+        info.type = static_cast<AssetType>(type);
+        keys.push_back(key);
+    }
+    // The descriptions of all assets are stored in a single document, which is much faster to parse than many small ones
+    QString xml;
+    stream >> xml;
+    QDomDocument doc;
+    if (stream.status() != QDataStream::Ok || !doc.setContent(xml)) {
+        qDebug() << "// Invalid asset cache, parsing assets again";
+        return false;
+    }
+    QDomNodeList nodes = doc.documentElement().childNodes();
+    if (nodes.count() != (int)count) {
+        return false;
+    }
+    m_assets.clear();
+    m_assets.reserve(count);
+    for (quint32 i = 0; i < count; ++i) {
+        Info &info = infos[i];
+        QDomElement element = nodes.item((int)i).toElement();
+        // Assets without description are stored as an empty placeholder
+        if (element.tagName() != QLatin1String("none")) {
+            info.xml = element;
+        }
+        m_assets[keys.at((int)i)] = info;
+    }
+    return true;
+}
+
+template <typename AssetType> void AbstractAssetsRepository<AssetType>::saveCache(const MetadataCache &cache, const QByteArray &signature) const
+{
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    QDomDocument doc;
+    QDomElement root = doc.createElement(QStringLiteral("assets"));
+    doc.appendChild(root);
+    stream << (quint32)m_assets.size();
+    for (const auto &asset : m_assets) {
+        const Info &info = asset.second;
+        stream << asset.first << info.id << info.mltId << info.name << info.description << info.author << info.version_str << (qint32)info.version
+               << (qint32)info.type;
+        root.appendChild(info.xml.isNull() ? doc.createElement(QStringLiteral("none")) : doc.importNode(info.xml, true));
+    }
+    stream << doc.toString(-1);
+    cache.write(signature, payload);
 }
 
 template <typename AssetType> void AbstractAssetsRepository<AssetType>::parseAssetList(const QString &filePath, QSet<QString> &destination)
@@ -0,0 +1,128 @@
+/***************************************************************************
+ *   Copyright (C) 2019 by Kdenlive contributors                           *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "keyframecurve.hpp"
+#include <algorithm>
+
+void KeyframeCurve::build(const std::vector<int> &frames, const std::vector<mlt_keyframe_type> &types, const std::vector<double> &values, int dimension)
+{
+    clear();
+    m_dimension = std::max(1, dimension);
+    const size_t count = std::min({frames.size(), types.size(), values.size() / (size_t)m_dimension});
+    m_frames.assign(frames.begin(), frames.begin() + (long)count);
+    m_scales.assign(count, 0.);
+    m_coefficients.assign(count * (size_t)m_dimension * 4, 0.);
+    auto value = [&values, count, this](size_t key, int component) { return values[std::min(key, count - 1) * (size_t)m_dimension + (size_t)component]; };
+    for (size_t i = 0; i < count; ++i) {
+        double *coefficients = m_coefficients.data() + i * (size_t)m_dimension * 4;
+        const bool last = i + 1 == count;
+        if (!last) {
+            m_scales[i] = 1. / std::max(1, m_frames[i + 1] - m_frames[i]);
+        }
+        for (int c = 0; c < m_dimension; ++c) {
+            double *k = coefficients + c * 4;
+            const double y1 = value(i, c);
+            k[3] = y1;
+            if (last || types[i] == mlt_keyframe_discrete) {
+                continue;
+            }
+            const double y2 = value(i + 1, c);
+            if (types[i] == mlt_keyframe_smooth) {
+                // Same spline as MLT, the first and last keyframes being their own neighbour
+                const double y0 = value(i > 0 ? i - 1 : i, c);
+                const double y3 = value(i + 2, c);
+                k[0] = -0.5 * y0 + 1.5 * y1 - 1.5 * y2 + 0.5 * y3;
+                k[1] = y0 - 2.5 * y1 + 2 * y2 - 0.5 * y3;
+                k[2] = -0.5 * y0 + 0.5 * y2;
+            } else {
+                k[2] = y2 - y1;
+            }
+        }
+    }
+}
+
+void KeyframeCurve::clear()
+{
+    m_frames.clear();
+    m_scales.clear();
+    m_coefficients.clear();
+}
+
+bool KeyframeCurve::isEmpty() const
+{
+    return m_frames.empty();
+}
+
+int KeyframeCurve::dimension() const
+{
+    return m_dimension;
+}
+
+int KeyframeCurve::segmentAt(int frame) const
+{
+    auto next = std::upper_bound(m_frames.begin(), m_frames.end(), frame);
+    return next == m_frames.begin() ? 0 : (int)(next - m_frames.begin()) - 1;
+}
+
+double KeyframeCurve::segmentValue(int segment, int component, int frame) const
+{
+    const double *k = m_coefficients.data() + ((size_t)segment * (size_t)m_dimension + (size_t)component) * 4;
+    // Before the first keyframe, the position is clamped to it
+    const double t = std::max(0, frame - m_frames[(size_t)segment]) * m_scales[(size_t)segment];
+    return ((k[0] * t + k[1]) * t + k[2]) * t + k[3];
+}
+
+void KeyframeCurve::evaluate(int frame, double *out) const
+{
+    if (m_frames.empty()) {
+        std::fill(out, out + m_dimension, 0.);
+        return;
+    }
+    const int segment = segmentAt(frame);
+    for (int c = 0; c < m_dimension; ++c) {
+        out[c] = segmentValue(segment, c, frame);
+    }
+}
+
+double KeyframeCurve::evaluate(int frame, int component) const
+{
+    if (m_frames.empty() || component < 0 || component >= m_dimension) {
+        return 0.;
+    }
+    return segmentValue(segmentAt(frame), component, frame);
+}
+
+void KeyframeCurve::evaluateRange(int first, int count, int component, double *out) const
+{
+    if (m_frames.empty() || component < 0 || component >= m_dimension) {
+        std::fill(out, out + std::max(0, count), 0.);
+        return;
+    }
+    int segment = segmentAt(first);
+    const int last = (int)m_frames.size() - 1;
+    for (int i = 0; i < count; ++i) {
+        const int frame = first + i;
+        while (segment < last && frame >= m_frames[(size_t)segment + 1]) {
+            segment++;
+        }
+        out[i] = segmentValue(segment, component, frame);
+    }
+}
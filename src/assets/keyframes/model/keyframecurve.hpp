@@ -0,0 +1,73 @@
+/***************************************************************************
+ *   Copyright (C) 2019 by Kdenlive contributors                           *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef KEYFRAMECURVE_H
+#define KEYFRAMECURVE_H
+
+#include <framework/mlt_types.h>
+#include <vector>
+
+/* @brief This class is a pre-parsed version of a keyframe animation, used to interpolate its values.
+   Each segment between two keyframes is stored as the coefficients of a cubic polynomial for each component of the value,
+   which covers the three MLT interpolation types: discrete (constant), linear and smooth (the Catmull-Rom spline used by MLT,
+   with the neighbouring keyframes as control points). Evaluating a frame is thus a binary search followed by a polynomial,
+   and does not allocate.
+   Frames before the first keyframe or after the last one take the value of that keyframe, as in MLT.
+ */
+class KeyframeCurve
+{
+
+public:
+    /* @brief Rebuilds the curve
+       @param frames is the position of the keyframes, in increasing order
+       @param types is the interpolation type of each keyframe, used until the next one
+       @param values is the value of the keyframes, dimension consecutive components for each of them
+       @param dimension is the number of components of a value (1 for a double, 5 for a rectangle with its opacity)
+     */
+    void build(const std::vector<int> &frames, const std::vector<mlt_keyframe_type> &types, const std::vector<double> &values, int dimension);
+    void clear();
+
+    bool isEmpty() const;
+    int dimension() const;
+
+    /* @brief Writes the dimension components of the value at the given frame to out */
+    void evaluate(int frame, double *out) const;
+    /* @brief Returns one component of the value at the given frame */
+    double evaluate(int frame, int component = 0) const;
+    /* @brief Writes one component of the values of count consecutive frames, starting at first, to out.
+       This walks the segments once, so that drawing a curve does not search each frame */
+    void evaluateRange(int first, int count, int component, double *out) const;
+
+protected:
+    /* @brief Returns the index of the last keyframe before or at the given frame, 0 if there is none */
+    int segmentAt(int frame) const;
+    /* @brief Returns the value of a component in a segment */
+    double segmentValue(int segment, int component, int frame) const;
+
+    std::vector<int> m_frames;
+    /* Inverse of the length of each segment, 0 for the last keyframe */
+    std::vector<double> m_scales;
+    /* 4 coefficients per component and segment, from the cubic to the constant one */
+    std::vector<double> m_coefficients;
+    int m_dimension{1};
+};
+
+#endif
@@ -419,6 +419,7 @@ Fun KeyframeModel::updateKeyframe_lambda(GenTime pos, KeyframeType type, const Q
         int row = static_cast<int>(std::distance(m_keyframeList.begin(), m_keyframeList.find(pos)));
         m_keyframeList[pos].first = type;
         m_keyframeList[pos].second = value;
+        invalidateCurve();
         if (notify) emit dataChanged(index(row), index(row), {ValueRole, NormalizedValueRole, TypeRole});
         return true;
     };
@@ -439,6 +440,7 @@ Fun KeyframeModel::addKeyframe_lambda(GenTime pos, KeyframeType type, const QVar
         if (notify) beginInsertRows(QModelIndex(), insertionRow, insertionRow);
         m_keyframeList[pos].first = type;
         m_keyframeList[pos].second = value;
+        invalidateCurve();
         if (notify) endInsertRows();
         return true;
     };
@@ -455,6 +457,7 @@ Fun KeyframeModel::deleteKeyframe_lambda(GenTime pos, bool notify)
         int row = static_cast<int>(std::distance(m_keyframeList.begin(), m_keyframeList.find(pos)));
         if (notify) beginRemoveRows(QModelIndex(), row, row);
         m_keyframeList.erase(pos);
+        invalidateCurve();
         if (notify) endRemoveRows();
         qDebug() << "after" << getAnimProperty();
         return true;
@@ -967,62 +970,24 @@ QVariant KeyframeModel::getInterpolatedValue(const GenTime &pos) const
     }
     auto prev = next;
     --prev;
-    // We now have surrounding keyframes, we use mlt to compute the value
-    Mlt::Properties prop;
-    bool useOpacity = true;
-    if (auto ptr = m_model.lock()) {
-        ptr->passProperties(prop);
-        if (m_paramType == ParamType::AnimatedRect) {
-            useOpacity = ptr->data(m_index, AssetParameterModel::OpacityRole).toBool();
-        }
-    }
-    QLocale locale;
     int p = pos.frames(pCore->getCurrentFps());
+    // Smooth segments depend on the neighbouring keyframes, the curve uses them all like MLT does
     if (m_paramType == ParamType::KeyframeParam) {
-        prop.anim_set("keyframe", prev->second.second.toDouble(), prev->first.frames(pCore->getCurrentFps()), next->first.frames(pCore->getCurrentFps()),
-                      convertToMltType(prev->second.first));
-        prop.anim_set("keyframe", next->second.second.toDouble(), next->first.frames(pCore->getCurrentFps()), next->first.frames(pCore->getCurrentFps()),
-                      convertToMltType(next->second.first));
-        return QVariant(prop.anim_get_double("keyframe", p));
+        QMutexLocker locker(&m_curveMutex);
+        updateCurve();
+        return QVariant(m_curve.evaluate(p));
     } else if (m_paramType == ParamType::AnimatedRect) {
-        QStringList vals = prev->second.second.toString().split(QLatin1Char(' '));
-        if (vals.count() >= 4) {
-            mlt_rect rect;
-            rect.x = vals.at(0).toInt();
-            rect.y = vals.at(1).toInt();
-            rect.w = vals.at(2).toInt();
-            rect.h = vals.at(3).toInt();
-            if (useOpacity) {
-                if (vals.count()) {
-                    rect.o = locale.toDouble(vals.at(4));
-                } else {
-                    rect.o = 1;
-                }
-            }
-            prop.anim_set("keyframe", rect, prev->first.frames(pCore->getCurrentFps()), next->first.frames(pCore->getCurrentFps()),
-                          convertToMltType(prev->second.first));
+        double rect[5];
+        bool useOpacity;
+        {
+            QMutexLocker locker(&m_curveMutex);
+            updateCurve();
+            m_curve.evaluate(p, rect);
+            useOpacity = m_curveOpacity;
         }
-        vals = next->second.second.toString().split(QLatin1Char(' '));
-        if (vals.count() >= 4) {
-            mlt_rect rect;
-            rect.x = vals.at(0).toInt();
-            rect.y = vals.at(1).toInt();
-            rect.w = vals.at(2).toInt();
-            rect.h = vals.at(3).toInt();
-            if (useOpacity) {
-                if (vals.count() > 4) {
-                    rect.o = locale.toDouble(vals.at(4));
-                } else {
-                    rect.o = 1;
-                }
-            }
-            prop.anim_set("keyframe", rect, next->first.frames(pCore->getCurrentFps()), next->first.frames(pCore->getCurrentFps()),
-                          convertToMltType(next->second.first));
-        }
-        mlt_rect rect = prop.anim_get_rect("keyframe", p);
-        QString res = QStringLiteral("%1 %2 %3 %4").arg((int)rect.x).arg((int)rect.y).arg((int)rect.w).arg((int)rect.h);
+        QString res = QStringLiteral("%1 %2 %3 %4").arg((int)rect[0]).arg((int)rect[1]).arg((int)rect[2]).arg((int)rect[3]);
         if (useOpacity) {
-            res.append(QStringLiteral(" %1").arg(locale.toString(rect.o)));
+            res.append(QStringLiteral(" %1").arg(QLocale().toString(rect[4])));
         }
         return QVariant(res);
     } else if (m_paramType == ParamType::Roto_spline) {
@@ -1057,6 +1022,66 @@ QVariant KeyframeModel::getInterpolatedValue(const GenTime &pos) const
     return QVariant();
 }
 
+void KeyframeModel::getInterpolatedValues(int first, int count, std::vector<double> &values, int component) const
+{
+    values.resize((size_t)qMax(0, count));
+    QMutexLocker locker(&m_curveMutex);
+    if (!updateCurve()) {
+        std::fill(values.begin(), values.end(), 0.);
+        return;
+    }
+    m_curve.evaluateRange(first, count, component, values.data());
+}
+
+void KeyframeModel::invalidateCurve()
+{
+    QMutexLocker locker(&m_curveMutex);
+    m_curveValid = false;
+}
+
+bool KeyframeModel::updateCurve() const
+{
+    if (m_paramType != ParamType::KeyframeParam && m_paramType != ParamType::AnimatedRect) {
+        return false;
+    }
+    double fps = pCore->getCurrentFps();
+    if (m_curveValid && qFuzzyCompare(fps, m_curveFps)) {
+        return true;
+    }
+    const bool isRect = m_paramType == ParamType::AnimatedRect;
+    m_curveOpacity = true;
+    if (isRect) {
+        if (auto ptr = m_model.lock()) {
+            m_curveOpacity = ptr->data(m_index, AssetParameterModel::OpacityRole).toBool();
+        }
+    }
+    QLocale locale;
+    std::vector<int> frames;
+    std::vector<mlt_keyframe_type> types;
+    std::vector<double> values;
+    frames.reserve(m_keyframeList.size());
+    types.reserve(m_keyframeList.size());
+    values.reserve(m_keyframeList.size() * (isRect ? 5 : 1));
+    for (const auto &keyframe : m_keyframeList) {
+        frames.push_back(keyframe.first.frames(fps));
+        types.push_back(convertToMltType(keyframe.second.first));
+        if (!isRect) {
+            values.push_back(keyframe.second.second.toDouble());
+            continue;
+        }
+        // Rectangles are stored as "x y w h [opacity]", the opacity using the locale
+        const QStringList vals = keyframe.second.second.toString().split(QLatin1Char(' '), QString::SkipEmptyParts);
+        for (int i = 0; i < 4; ++i) {
+            values.push_back(i < vals.count() ? vals.at(i).toDouble() : 0.);
+        }
+        values.push_back(vals.count() > 4 ? locale.toDouble(vals.at(4)) : 1.);
+    }
+    m_curve.build(frames, types, values, isRect ? 5 : 1);
+    m_curveFps = fps;
+    m_curveValid = true;
+    return true;
+}
+
 void KeyframeModel::sendModification()
 {
     if (auto ptr = m_model.lock()) {
@@ -25,13 +25,16 @@
 #include "assets/model/assetparametermodel.hpp"
 #include "definitions.h"
 #include "gentime.h"
+#include "keyframecurve.hpp"
 #include "undohelper.hpp"
 
 #include <QAbstractListModel>
+#include <QMutex>
 #include <QReadWriteLock>
 
 #include <map>
 #include <memory>
+#include <vector>
 
 class AssetParameterModel;
 class DocUndoStack;
@@ -156,6 +159,10 @@ public:
     /* @brief Return the interpolated value at given pos */
     QVariant getInterpolatedValue(int pos) const;
     QVariant getInterpolatedValue(const GenTime &pos) const;
+    /* @brief Fills values with the interpolated values of count consecutive frames, starting at first, for curve drawing.
+       For rectangles, component selects the coordinate (0 to 4 for x, y, width, height and opacity)
+     */
+    void getInterpolatedValues(int first, int count, std::vector<double> &values, int component = 0) const;
     QVariant updateInterpolated(const QVariant &interpValue, double val);
     /* @brief Return the real value from a normalized one */
     QVariant getNormalizedValue(double newVal) const;
@@ -199,6 +206,13 @@ protected:
     void parseAnimProperty(const QString &prop);
     void parseRotoProperty(const QString &prop);
 
+    /* @brief Rebuilds the interpolation curve if the keyframes or the frame rate changed. Returns false if the parameter has no curve.
+       m_curveMutex must be locked
+     */
+    bool updateCurve() const;
+    /* @brief Marks the interpolation curve as outdated, after the keyframes changed */
+    void invalidateCurve();
+
 private:
     std::weak_ptr<AssetParameterModel> m_model;
     std::weak_ptr<DocUndoStack> m_undoStack;
@@ -209,6 +223,13 @@ private:
 
     std::map<GenTime, std::pair<KeyframeType, QVariant>> m_keyframeList;
 
+    /* Pre-parsed version of the keyframes, used to interpolate the values of double and rectangle parameters */
+    mutable KeyframeCurve m_curve;
+    mutable QMutex m_curveMutex;
+    mutable bool m_curveValid{false};
+    mutable double m_curveFps{0};
+    mutable bool m_curveOpacity{true};
+
 signals:
     void modelChanged();
 
@@ -513,7 +513,9 @@ void SmallJobLabel::slotSetJobCount(int jobCount)
     if (jobCount > 0) {
         // prepare animation
         setText(i18np("%1 job", "%1 jobs", jobCount));
-        setToolTip(i18np("%1 pending job", "%1 pending jobs", jobCount));
+        JobScheduler::Metrics metrics = pCore->jobManager()->queueMetrics();
+        setToolTip(i18np("%1 pending job", "%1 pending jobs", jobCount) + QLatin1Char('\n') +
+                   i18n("%1 waiting for a thread, average wait: %2 s", metrics.queued, QString::number(metrics.averageWait() / 1000.0, 'f', 1)));
 
         if (style()->styleHint(QStyle::SH_Widget_Animate, nullptr, this) != 0) {
             setFixedWidth(sizeHint().width());
@@ -1239,6 +1241,7 @@ void Bin::selectProxyModel(const QModelIndex &id)
                 m_locateAction->setEnabled(true);
                 m_duplicateAction->setEnabled(true);
                 std::shared_ptr<ProjectClip> clip = std::static_pointer_cast<ProjectClip>(currentItem);
+                pCore->jobManager()->prioritizeClip(clip->clipId());
                 ClipType::ProducerType type = clip->clipType();
                 m_openAction->setEnabled(type == ClipType::Image || type == ClipType::Audio || type == ClipType::Text || type == ClipType::TextTemplate);
                 showClipProperties(clip, false);
@@ -2909,8 +2912,8 @@ QStringList Bin::getProxyHashList()
 void Bin::slotSendAudioThumb(const QString &id)
 {
     std::shared_ptr<ProjectClip> clip = m_itemModel->getClipByBinID(id);
-    if ((clip != nullptr) && clip->audioThumbCreated()) {
-        m_monitor->prepareAudioThumb(clip->audioChannels(), clip->audioFrameCache);
+    if ((clip != nullptr) && (clip->audioThumbCreated() || clip->audioThumbPartial())) {
+        m_monitor->prepareAudioThumb(clip->audioChannels(), clip->audioFrameLevels());
     } else {
         m_monitor->prepareAudioThumb(0);
     }
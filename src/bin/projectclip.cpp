@@ -32,6 +32,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "jobs/loadjob.hpp"
 #include "jobs/thumbjob.hpp"
 #include "kdenlivesettings.h"
+#include "lib/audio/audioPeaks.h"
 #include "lib/audio/audioStreamInfo.h"
 #include "mltcontroller/clipcontroller.h"
 #include "mltcontroller/clippropertiescontroller.h"
@@ -44,8 +45,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "projectsubclip.h"
 #include "timecode.h"
 #include "timeline2/model/snapmodel.hpp"
+#include "utils/filehashcache.hpp"
 
+#include "utils/proxystore.hpp"
 #include "utils/thumbnailcache.hpp"
+#include "utils/thumbnailprefetcher.hpp"
 #include "xml/xml.hpp"
 #include <QPainter>
 #include <jobs/proxyclipjob.h>
@@ -161,7 +165,6 @@ ProjectClip::~ProjectClip()
     m_requestedThumbs.clear();
     m_thumbMutex.unlock();
     m_thumbThread.waitForFinished();
-    audioFrameCache.clear();
 }
 
 void ProjectClip::connectEffectStack()
@@ -192,20 +195,37 @@ QString ProjectClip::getXmlProperty(const QDomElement &producer, const QString &
     return value;
 }
 
-void ProjectClip::updateAudioThumbnail(QList<double> audioLevels)
+void ProjectClip::updateAudioThumbnail(std::shared_ptr<AudioPeaks> audioPeaks, bool complete)
 {
-    audioFrameCache = audioLevels;
-    m_audioThumbCreated = true;
+    m_audioPeaks = std::move(audioPeaks);
+    m_audioThumbCreated = complete && m_audioPeaks != nullptr;
+    m_audioThumbPartial = !complete && m_audioPeaks != nullptr;
     if (auto ptr = m_model.lock()) {
         emit std::static_pointer_cast<ProjectItemModel>(ptr)->refreshAudioThumbs(m_binId);
     }
 }
 
+std::shared_ptr<AudioPeaks> ProjectClip::audioPeaks() const
+{
+    return m_audioPeaks;
+}
+
+QList<double> ProjectClip::audioFrameLevels() const
+{
+    // Not kept in memory: the peaks are read from the mapped peak file when the levels are needed
+    return m_audioPeaks ? m_audioPeaks->frameLevels() : QList<double>();
+}
+
 bool ProjectClip::audioThumbCreated() const
 {
     return (m_audioThumbCreated);
 }
 
+bool ProjectClip::audioThumbPartial() const
+{
+    return m_audioThumbPartial;
+}
+
 ClipType::ProducerType ProjectClip::clipType() const
 {
     return m_clipType;
@@ -307,6 +327,7 @@ void ProjectClip::reloadProducer(bool refreshOnly, bool audioStreamChanged)
         // In that case, we only want a new thumbnail.
         // We thus set up a thumb job. We must make sure that there is no pending LOADJOB
         // Clear cache first
+        ThumbnailPrefetcher::get()->releaseClip(clipId());
         ThumbnailCache::get()->invalidateThumbsForClip(clipId());
         pCore->jobManager()->discardJobs(clipId(), AbstractClipJob::THUMBJOB);
         m_thumbsProducer.reset();
@@ -324,6 +345,7 @@ void ProjectClip::reloadProducer(bool refreshOnly, bool audioStreamChanged)
         if (!xml.isNull()) {
             pCore->jobManager()->discardJobs(clipId(), AbstractClipJob::THUMBJOB);
             m_thumbsProducer.reset();
+            ThumbnailPrefetcher::get()->releaseClip(clipId());
             ThumbnailCache::get()->invalidateThumbsForClip(clipId());
             int loadJob = pCore->jobManager()->startJob<LoadJob>({clipId()}, loadjobId, QString(), xml);
             pCore->jobManager()->startJob<ThumbJob>({clipId()}, loadJob, QString(), 150, -1, true, true);
@@ -397,6 +419,7 @@ bool ProjectClip::setProducer(std::shared_ptr<Mlt::Producer> producer, bool repl
     QMutexLocker locker(&m_producerMutex);
     updateProducer(producer);
     m_thumbsProducer.reset();
+    ThumbnailPrefetcher::get()->releaseClip(clipId());
     connectEffectStack();
 
     // Update info
@@ -493,42 +516,51 @@ std::shared_ptr<Mlt::Producer> ProjectClip::thumbProducer()
     if (m_thumbsProducer) {
         return m_thumbsProducer;
     }
+    QMutexLocker lock(&m_thumbMutex);
+    if (!m_thumbsProducer) {
+        m_thumbsProducer = createThumbProducer();
+    }
+    return m_thumbsProducer;
+}
+
+std::shared_ptr<Mlt::Producer> ProjectClip::createThumbProducer()
+{
     if (clipType() == ClipType::Unknown) {
         return nullptr;
     }
-    QMutexLocker lock(&m_thumbMutex);
     std::shared_ptr<Mlt::Producer> prod = originalProducer();
     if (!prod->is_valid()) {
         return nullptr;
     }
+    std::shared_ptr<Mlt::Producer> thumbsProducer;
     if (KdenliveSettings::gpu_accel()) {
         // TODO: when the original producer changes, we must reload this thumb producer
-        m_thumbsProducer = softClone(ClipController::getPassPropertiesList());
+        thumbsProducer = softClone(ClipController::getPassPropertiesList());
         Mlt::Filter converter(*prod->profile(), "avcolor_space");
-        m_thumbsProducer->attach(converter);
+        thumbsProducer->attach(converter);
     } else {
         QString mltService = m_masterProducer->get("mlt_service");
         const QString mltResource = m_masterProducer->get("resource");
         if (mltService == QLatin1String("avformat")) {
             mltService = QStringLiteral("avformat-novalidate");
         }
-        m_thumbsProducer.reset(new Mlt::Producer(*pCore->thumbProfile(), mltService.toUtf8().constData(), mltResource.toUtf8().constData()));
-        if (m_thumbsProducer->is_valid()) {
+        thumbsProducer.reset(new Mlt::Producer(*pCore->thumbProfile(), mltService.toUtf8().constData(), mltResource.toUtf8().constData()));
+        if (thumbsProducer->is_valid()) {
             Mlt::Properties original(m_masterProducer->get_properties());
-            Mlt::Properties cloneProps(m_thumbsProducer->get_properties());
+            Mlt::Properties cloneProps(thumbsProducer->get_properties());
             cloneProps.pass_list(original, ClipController::getPassPropertiesList());
             Mlt::Filter scaler(*pCore->thumbProfile(), "swscale");
             Mlt::Filter padder(*pCore->thumbProfile(), "resize");
             Mlt::Filter converter(*pCore->thumbProfile(), "avcolor_space");
-            m_thumbsProducer->set("audio_index", -1);
+            thumbsProducer->set("audio_index", -1);
             // Required to make get_playtime() return > 1
-            m_thumbsProducer->set("out", m_thumbsProducer->get_length() -1);
-            m_thumbsProducer->attach(scaler);
-            m_thumbsProducer->attach(padder);
-            m_thumbsProducer->attach(converter);
+            thumbsProducer->set("out", thumbsProducer->get_length() -1);
+            thumbsProducer->attach(scaler);
+            thumbsProducer->attach(padder);
+            thumbsProducer->attach(converter);
         }
     }
-    return m_thumbsProducer;
+    return thumbsProducer;
 }
 
 void ProjectClip::createDisabledMasterProducer()
@@ -866,51 +898,38 @@ const QString ProjectClip::hash()
 const QString ProjectClip::getFileHash()
 {
     QByteArray fileData;
-    QByteArray fileHash;
+    QString result;
     switch (m_clipType) {
     case ClipType::SlideShow:
         fileData = clipUrl().toUtf8();
-        fileHash = QCryptographicHash::hash(fileData, QCryptographicHash::Md5);
         break;
     case ClipType::Text:
     case ClipType::TextTemplate:
         fileData = getProducerProperty(QStringLiteral("xmldata")).toUtf8();
-        fileHash = QCryptographicHash::hash(fileData, QCryptographicHash::Md5);
         break;
     case ClipType::QText:
         fileData = getProducerProperty(QStringLiteral("text")).toUtf8();
-        fileHash = QCryptographicHash::hash(fileData, QCryptographicHash::Md5);
         break;
     case ClipType::Color:
         fileData = getProducerProperty(QStringLiteral("resource")).toUtf8();
-        fileHash = QCryptographicHash::hash(fileData, QCryptographicHash::Md5);
         break;
-    default:
-        QFile file(clipUrl());
-        if (file.open(QIODevice::ReadOnly)) { // write size and hash only if resource points to a file
-            /*
-             * 1 MB = 1 second per 450 files (or faster)
-             * 10 MB = 9 seconds per 450 files (or faster)
-             */
-            if (file.size() > 2000000) {
-                fileData = file.read(1000000);
-                if (file.seek(file.size() - 1000000)) {
-                    fileData.append(file.readAll());
-                }
-            } else {
-                fileData = file.readAll();
-            }
-            file.close();
-            ClipController::setProducerProperty(QStringLiteral("kdenlive:file_size"), QString::number(file.size()));
-            fileHash = QCryptographicHash::hash(fileData, QCryptographicHash::Md5);
+    default: {
+        // write size and hash only if resource points to a file. The hash is only read from the file if it changed since it was last hashed
+        qint64 size = 0;
+        result = FileHashCache::get()->hash(clipUrl(), &size);
+        if (!result.isEmpty()) {
+            ClipController::setProducerProperty(QStringLiteral("kdenlive:file_size"), QString::number(size));
         }
         break;
     }
-    if (fileHash.isEmpty()) {
+    }
+    if (!fileData.isNull()) {
+        result = QString::fromLatin1(QCryptographicHash::hash(fileData, QCryptographicHash::Md5).toHex());
+    }
+    if (result.isEmpty()) {
         qDebug() << "// WARNING EMPTY CLIP HASH: ";
         return QString();
     }
-    QString result = fileHash.toHex();
     ClipController::setProducerProperty(QStringLiteral("kdenlive:file_hash"), result);
     return result;
 }
@@ -1079,6 +1098,11 @@ void ProjectClip::deleteProxy()
     bool ok;
     QDir dir = pCore->currentDoc()->getCacheDir(CacheProxy, &ok);
     if (ok && proxy.length() > 2) {
+        // Keep the proxy unless we know that no other project uses it
+        std::unique_ptr<ProxyStore> store = pCore->currentDoc()->proxyStore();
+        if (store && store->removeReference(proxy, pCore->currentDoc()->getDocumentProperty(QStringLiteral("documentid"))) != 0) {
+            return;
+        }
         proxy = QFileInfo(proxy).fileName();
         if (dir.exists(proxy)) {
             dir.remove(proxy);
@@ -1164,9 +1188,10 @@ void ProjectClip::discardAudioThumb()
     if (!audioThumbPath.isEmpty()) {
         QFile::remove(audioThumbPath);
     }
-    audioFrameCache.clear();
+    m_audioPeaks.reset();
     qCDebug(KDENLIVE_LOG) << "////////////////////  DISCARD AUIIO THUMBNS";
     m_audioThumbCreated = false;
+    m_audioThumbPartial = false;
     refreshAudioInfo();
     pCore->jobManager()->discardJobs(clipId(), AbstractClipJob::AUDIOTHUMBJOB);
 }
@@ -1191,7 +1216,7 @@ const QString ProjectClip::getAudioThumbPath()
         audioPath.append(QLatin1Char('_') + QString::number(audioInfo()->audio_index()));
     }
     int roundedFps = (int)pCore->getCurrentFps();
-    audioPath.append(QStringLiteral("_%1_audio.png").arg(roundedFps));
+    audioPath.append(QStringLiteral("_%1_audio.peaks").arg(roundedFps));
     return audioPath;
 }
 
@@ -33,6 +33,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QUrl>
 #include <memory>
 
+class AudioPeaks;
 class AudioStreamInfo;
 class ClipPropertiesController;
 class MarkerListModel;
@@ -152,6 +153,8 @@ public:
 
     /** @brief Returns this clip's producer. */
     std::shared_ptr<Mlt::Producer> thumbProducer();
+    /** @brief Creates a new producer for thumbnails, at the resolution of the thumbnail profile. */
+    std::shared_ptr<Mlt::Producer> createThumbProducer();
 
     /** @brief Recursively disable/enable bin effects. */
     void setBinEffectsEnabled(bool enabled) override;
@@ -170,10 +173,14 @@ public:
     /** @brief Returns true if we are using a proxy for this clip. */
     bool hasProxy() const;
 
-    /** Cache for every audio Frame with 10 Bytes */
-    /** format is frame -> channel ->bytes */
-    QList<double> audioFrameCache;
+    /** @brief Returns the audio peaks of the clip, nullptr if they were not computed yet */
+    std::shared_ptr<AudioPeaks> audioPeaks() const;
+    /** @brief Returns per frame audio levels derived from the peaks, format is frame -> channel -> level (0-256).
+        They are computed on each call, for the clip shown in the clip monitor */
+    QList<double> audioFrameLevels() const;
     bool audioThumbCreated() const;
+    /** @brief Returns true if the peaks are still being computed, the frames not computed yet being silent */
+    bool audioThumbPartial() const;
 
     void setWaitingStatus(const QString &id);
     /** @brief Returns true if the clip matched a condition, for example vcodec=mpeg1video. */
@@ -241,8 +248,9 @@ protected:
 
 public slots:
     /* @brief Store the audio thumbnails once computed. Note that the parameter is a value and not a reference, fill free to use it as a sink (use std::move to
-     * avoid copy). */
-    void updateAudioThumbnail(QList<double> audioLevels);
+     * avoid copy).
+     * @param complete is false for the partial thumbnails displayed while they are computed */
+    void updateAudioThumbnail(std::shared_ptr<AudioPeaks> audioPeaks, bool complete = true);
     /** @brief Delete the proxy file */
     void deleteProxy();
 
@@ -259,6 +267,8 @@ private:
     QMutex m_thumbMutex;
     QFuture<void> m_thumbThread;
     QList<int> m_requestedThumbs;
+    std::shared_ptr<AudioPeaks> m_audioPeaks;
+    bool m_audioThumbPartial{false};
     const QString geometryWithOffset(const QString &data, int offset);
 
     // This is a helper function that creates the disabled producer. This is a clone of the original one, with audio and video disabled
@@ -41,13 +41,24 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "xml/xml.hpp"
 
 #include <KLocalizedString>
+#include <QDir>
 #include <QIcon>
 #include <QMimeData>
 #include <mlt++/Mlt.h>
+#include <algorithm>
 #include <queue>
 #include <qvarlengtharray.h>
 #include <utility>
 
+namespace {
+// Key used to index clips by url, matching QFileInfo's comparison: the canonical path, or the cleaned path for files that do not resolve
+QString urlKey(const QFileInfo &info)
+{
+    const QString canonical = info.canonicalFilePath();
+    return canonical.isEmpty() ? QDir::cleanPath(info.absoluteFilePath()) : canonical;
+}
+} // namespace
+
 ProjectItemModel::ProjectItemModel(QObject *parent)
     : AbstractTreeModel(parent)
     , m_lock(QReadWriteLock::Recursive)
@@ -340,28 +351,21 @@ std::shared_ptr<ProjectClip> ProjectItemModel::getClipByBinID(const QString &bin
     if (binId.contains(QLatin1Char('_'))) {
         return getClipByBinID(binId.section(QLatin1Char('_'), 0, 0));
     }
-    for (const auto &clip : m_allItems) {
-        auto c = std::static_pointer_cast<AbstractProjectItem>(clip.second.lock());
-        if (c->itemType() == AbstractProjectItem::ClipItem && c->clipId() == binId) {
-            return std::static_pointer_cast<ProjectClip>(c);
-        }
+    auto c = getItemByBinId(binId);
+    if (c && c->itemType() == AbstractProjectItem::ClipItem) {
+        return std::static_pointer_cast<ProjectClip>(c);
     }
     return nullptr;
 }
 
-const QList<double> ProjectItemModel::getAudioLevelsByBinID(const QString &binId)
+std::shared_ptr<AudioPeaks> ProjectItemModel::getAudioPeaksByBinID(const QString &binId)
 {
     READ_LOCK();
-    if (binId.contains(QLatin1Char('_'))) {
-        return getAudioLevelsByBinID(binId.section(QLatin1Char('_'), 0, 0));
-    }
-    for (const auto &clip : m_allItems) {
-        auto c = std::static_pointer_cast<AbstractProjectItem>(clip.second.lock());
-        if (c->itemType() == AbstractProjectItem::ClipItem && c->clipId() == binId) {
-            return std::static_pointer_cast<ProjectClip>(c)->audioFrameCache;
-        }
+    std::shared_ptr<ProjectClip> clip = getClipByBinID(binId);
+    if (clip) {
+        return clip->audioPeaks();
     }
-    return QList<double>();
+    return nullptr;
 }
 
 bool ProjectItemModel::hasClip(const QString &binId)
@@ -373,11 +377,9 @@ bool ProjectItemModel::hasClip(const QString &binId)
 std::shared_ptr<ProjectFolder> ProjectItemModel::getFolderByBinId(const QString &binId)
 {
     READ_LOCK();
-    for (const auto &clip : m_allItems) {
-        auto c = std::static_pointer_cast<AbstractProjectItem>(clip.second.lock());
-        if (c->itemType() == AbstractProjectItem::FolderItem && c->clipId() == binId) {
-            return std::static_pointer_cast<ProjectFolder>(c);
-        }
+    auto c = getItemByBinId(binId);
+    if (c && c->itemType() == AbstractProjectItem::FolderItem) {
+        return std::static_pointer_cast<ProjectFolder>(c);
     }
     return nullptr;
 }
@@ -385,25 +387,22 @@ std::shared_ptr<ProjectFolder> ProjectItemModel::getFolderByBinId(const QString
 const QString ProjectItemModel::getFolderIdByName(const QString &folderName)
 {
     READ_LOCK();
-    for (const auto &clip : m_allItems) {
-        auto c = std::static_pointer_cast<AbstractProjectItem>(clip.second.lock());
-        if (c->itemType() == AbstractProjectItem::FolderItem && c->name() == folderName) {
-            return c->clipId();
-        }
+    auto it = m_folderNameIndex.find(folderName);
+    if (it == m_folderNameIndex.end() || it->second.empty()) {
+        return QString();
     }
-    return QString();
+    // With duplicate names, return the oldest folder so that the result does not depend on the set order
+    return *std::min_element(it->second.begin(), it->second.end(), [](const QString &a, const QString &b) { return a.toInt() < b.toInt(); });
 }
 
 std::shared_ptr<AbstractProjectItem> ProjectItemModel::getItemByBinId(const QString &binId)
 {
     READ_LOCK();
-    for (const auto &clip : m_allItems) {
-        auto c = std::static_pointer_cast<AbstractProjectItem>(clip.second.lock());
-        if (c->clipId() == binId) {
-            return c;
-        }
+    auto it = m_binIdIndex.find(binId);
+    if (it == m_binIdIndex.end()) {
+        return nullptr;
     }
-    return nullptr;
+    return std::static_pointer_cast<AbstractProjectItem>(m_allItems.at(it->second).lock());
 }
 
 void ProjectItemModel::setBinEffectsEnabled(bool enabled)
@@ -523,7 +522,11 @@ void ProjectItemModel::registerItem(const std::shared_ptr<TreeItem> &item)
     auto clip = std::static_pointer_cast<AbstractProjectItem>(item);
     m_binPlaylist->manageBinItemInsertion(clip);
     AbstractTreeModel::registerItem(item);
-    if (clip->itemType() == AbstractProjectItem::ClipItem) {
+    Q_ASSERT(m_binIdIndex.count(clip->clipId()) == 0);
+    m_binIdIndex[clip->clipId()] = item->getId();
+    if (clip->itemType() == AbstractProjectItem::FolderItem) {
+        m_folderNameIndex[clip->name()].insert(clip->clipId());
+    } else if (clip->itemType() == AbstractProjectItem::ClipItem) {
         auto clipItem = std::static_pointer_cast<ProjectClip>(clip);
         updateWatcher(clipItem);
     }
@@ -535,9 +538,19 @@ void ProjectItemModel::deregisterItem(int id, TreeItem *item)
     m_binPlaylist->manageBinItemDeletion(clip);
     // TODO : here, we should suspend jobs belonging to the item we delete. They can be restarted if the item is reinserted by undo
     AbstractTreeModel::deregisterItem(id, item);
-    if (clip->itemType() == AbstractProjectItem::ClipItem) {
+    m_binIdIndex.erase(clip->clipId());
+    if (clip->itemType() == AbstractProjectItem::FolderItem) {
+        auto it = m_folderNameIndex.find(clip->name());
+        if (it != m_folderNameIndex.end()) {
+            it->second.erase(clip->clipId());
+            if (it->second.empty()) {
+                m_folderNameIndex.erase(it);
+            }
+        }
+    } else if (clip->itemType() == AbstractProjectItem::ClipItem) {
         auto clipItem = static_cast<ProjectClip *>(clip);
         m_fileWatcher->removeFile(clipItem->clipId());
+        unindexClipUrl(clipItem->clipId());
     }
 }
 
@@ -701,6 +714,14 @@ Fun ProjectItemModel::requestRenameFolder_lambda(const std::shared_ptr<AbstractP
         if (!currentFolder) {
             return false;
         }
+        auto it = m_folderNameIndex.find(currentFolder->name());
+        if (it != m_folderNameIndex.end()) {
+            it->second.erase(currentFolder->clipId());
+            if (it->second.empty()) {
+                m_folderNameIndex.erase(it);
+            }
+        }
+        m_folderNameIndex[newName].insert(currentFolder->clipId());
         currentFolder->setName(newName);
         m_binPlaylist->manageBinFolderRename(currentFolder);
         auto index = getIndexFromItem(currentFolder);
@@ -779,12 +800,10 @@ QStringList ProjectItemModel::getClipByUrl(const QFileInfo &url) const
 {
     READ_LOCK();
     QStringList result;
-    for (const auto &clip : m_allItems) {
-        auto c = std::static_pointer_cast<AbstractProjectItem>(clip.second.lock());
-        if (c->itemType() == AbstractProjectItem::ClipItem) {
-            if (QFileInfo(std::static_pointer_cast<ProjectClip>(c)->clipUrl()) == url) {
-                result << c->clipId();
-            }
+    auto it = m_urlIndex.find(urlKey(url));
+    if (it != m_urlIndex.end()) {
+        for (const QString &binId : it->second) {
+            result << binId;
         }
     }
     return result;
@@ -859,13 +878,7 @@ bool ProjectItemModel::loadFolders(Mlt::Properties &folders)
 bool ProjectItemModel::isIdFree(const QString &id) const
 {
     READ_LOCK();
-    for (const auto &clip : m_allItems) {
-        auto c = std::static_pointer_cast<AbstractProjectItem>(clip.second.lock());
-        if (c->clipId() == id) {
-            return false;
-        }
-    }
-    return true;
+    return m_binIdIndex.count(id) == 0;
 }
 
 void ProjectItemModel::loadBinPlaylist(Mlt::Tractor *documentTractor, Mlt::Tractor *modelTractor, std::unordered_map<QString, QString> &binIdCorresp)
@@ -970,6 +983,7 @@ void ProjectItemModel::setClipInvalid(const QString &binId)
 void ProjectItemModel::updateWatcher(const std::shared_ptr<ProjectClip> &clipItem)
 {
     QWriteLocker locker(&m_lock);
+    indexClipUrl(clipItem->clipId(), clipItem->clipUrl());
     if (clipItem->clipType() == ClipType::AV || clipItem->clipType() == ClipType::Audio || clipItem->clipType() == ClipType::Image ||
         clipItem->clipType() == ClipType::Video || clipItem->clipType() == ClipType::Playlist || clipItem->clipType() == ClipType::TextTemplate) {
         m_fileWatcher->removeFile(clipItem->clipId());
@@ -977,6 +991,35 @@ void ProjectItemModel::updateWatcher(const std::shared_ptr<ProjectClip> &clipIte
     }
 }
 
+void ProjectItemModel::indexClipUrl(const QString &binId, const QString &url)
+{
+    QWriteLocker locker(&m_lock);
+    unindexClipUrl(binId);
+    if (url.isEmpty()) {
+        return;
+    }
+    QString key = urlKey(QFileInfo(url));
+    m_urlIndex[key].insert(binId);
+    m_indexedUrls[binId] = key;
+}
+
+void ProjectItemModel::unindexClipUrl(const QString &binId)
+{
+    QWriteLocker locker(&m_lock);
+    auto previous = m_indexedUrls.find(binId);
+    if (previous == m_indexedUrls.end()) {
+        return;
+    }
+    auto it = m_urlIndex.find(previous->second);
+    if (it != m_urlIndex.end()) {
+        it->second.erase(binId);
+        if (it->second.empty()) {
+            m_urlIndex.erase(it);
+        }
+    }
+    m_indexedUrls.erase(previous);
+}
+
 void ProjectItemModel::setDragType(PlaylistState::ClipState type)
 {
     QWriteLocker locker(&m_lock);
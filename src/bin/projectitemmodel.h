@@ -32,8 +32,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QIcon>
 #include <QReadWriteLock>
 #include <QSize>
+#include <unordered_map>
+#include <unordered_set>
 
 class AbstractProjectItem;
+class AudioPeaks;
 class BinPlaylist;
 class FileWatcher;
 class MarkerListModel;
@@ -66,8 +69,8 @@ public:
 
     /** @brief Returns a clip from the hierarchy, given its id */
     std::shared_ptr<ProjectClip> getClipByBinID(const QString &binId);
-    /** @brief Returns audio levels for a clip from its id */
-    const QList <double>getAudioLevelsByBinID(const QString &binId);
+    /** @brief Returns audio peaks for a clip from its id, nullptr if they are not available */
+    std::shared_ptr<AudioPeaks> getAudioPeaksByBinID(const QString &binId);
 
     /** @brief Returns a list of clips using the given url */
     QStringList getClipByUrl(const QFileInfo &url) const;
@@ -219,6 +222,10 @@ protected:
     /* @brief Function to be called when the url of a clip changes */
     void updateWatcher(const std::shared_ptr<ProjectClip> &item);
 
+    /* @brief Helpers to maintain the url -> bin ids index */
+    void indexClipUrl(const QString &binId, const QString &url);
+    void unindexClipUrl(const QString &binId);
+
 public slots:
     /** @brief An item in the list was modified, notify */
     void onItemUpdated(const std::shared_ptr<AbstractProjectItem> &item, int role);
@@ -242,6 +249,13 @@ private:
 
     std::unique_ptr<FileWatcher> m_fileWatcher;
 
+    /* The following indexes are maintained by registerItem/deregisterItem (and the folder rename lambda), so that
+       lookups by bin id, url or folder name do not need to scan m_allItems */
+    std::unordered_map<QString, int> m_binIdIndex;                             // bin id -> tree item id
+    std::unordered_map<QString, std::unordered_set<QString>> m_urlIndex;        // normalized clip url -> bin ids
+    std::unordered_map<QString, QString> m_indexedUrls;                        // bin id -> url under which the clip is currently indexed
+    std::unordered_map<QString, std::unordered_set<QString>> m_folderNameIndex; // folder name -> folder bin ids
+
     int m_nextId;
     QIcon m_blankThumb;
     PlaylistState::ClipState m_dragType;
@@ -48,6 +48,7 @@ Core::Core()
     : m_thumbProfile(nullptr)
     , m_capture(new MediaCapture(this))
 {
+    m_startupTimer.start();
 }
 
 void Core::prepareShutdown()
@@ -87,6 +88,8 @@ void Core::build(bool isAppImage, const QString &MltPath)
     qRegisterMetaType<QDomElement>("QDomElement");
     qRegisterMetaType<requestClipInfo>("requestClipInfo");
     
+    QElapsedTimer phase;
+    phase.start();
     if (isAppImage) {
         QString appPath = qApp->applicationDirPath();
         KdenliveSettings::setFfmpegpath(QDir::cleanPath(appPath + QStringLiteral("/ffmpeg")));
@@ -98,9 +101,11 @@ void Core::build(bool isAppImage, const QString &MltPath)
         // Open connection with Mlt
         MltConnection::construct(MltPath);
     }
+    m_self->addTiming(QStringLiteral("MLT connection"), phase.restart());
 
     // load the profile from disk
     ProfileRepository::get()->refresh();
+    m_self->addTiming(QStringLiteral("Profiles"), phase.restart());
     // load default profile
     m_self->m_profile = KdenliveSettings::default_profile();
     if (m_self->m_profile.isEmpty()) {
@@ -124,7 +129,10 @@ void Core::initGUI(const QUrl &Url)
     m_profile = KdenliveSettings::default_profile();
     m_currentProfile = m_profile;
     profileChanged();
+    QElapsedTimer phase;
+    phase.start();
     m_mainWindow = new MainWindow();
+    addTiming(QStringLiteral("Main window"), phase.restart());
     connect(this, &Core::showConfigDialog, m_mainWindow, &MainWindow::slotPreferences);
 
     // load default profile and ask user to select one if not found.
@@ -187,7 +195,10 @@ void Core::initGUI(const QUrl &Url)
     // TODO
     connect(m_producerQueue, SIGNAL(removeInvalidProxy(QString,bool)), m_binWidget, SLOT(slotRemoveInvalidProxy(QString,bool)));*/
 
+    addTiming(QStringLiteral("Project manager and bin"), phase.restart());
+
     m_mainWindow->init();
+    addTiming(QStringLiteral("Main window setup"), phase.restart());
     projectManager()->init(Url, QString());
     if (qApp->isSessionRestored()) {
         // NOTE: we are restoring only one window, because Kdenlive only uses one MainWindow
@@ -195,6 +206,18 @@ void Core::initGUI(const QUrl &Url)
     }
     QMetaObject::invokeMethod(pCore->projectManager(), "slotLoadOnOpen", Qt::QueuedConnection);
     m_mainWindow->show();
+    addTiming(QStringLiteral("Startup"), m_startupTimer.elapsed());
+}
+
+void Core::addTiming(const QString &phase, qint64 ms)
+{
+    qDebug() << "// Phase" << phase << "took" << ms << "ms";
+    m_timings.push_back({phase, ms});
+}
+
+QVector<QPair<QString, qint64>> Core::timings() const
+{
+    return m_timings;
 }
 
 std::unique_ptr<Core> &Core::self()
@@ -528,6 +551,11 @@ void Core::pushUndo(const Fun &undo, const Fun &redo, const QString &text)
     undoStack()->push(new FunctionalUndoCommand(undo, redo, text));
 }
 
+void Core::pushUndo(UndoTransaction &&transaction, const QString &text)
+{
+    undoStack()->push(new FunctionalUndoCommand(std::move(transaction), text));
+}
+
 void Core::pushUndo(QUndoCommand *command)
 {
     undoStack()->push(command);
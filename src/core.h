@@ -14,6 +14,7 @@ the Free Software Foundation, either version 3 of the License, or
 #include "definitions.h"
 #include "kdenlivecore_export.h"
 #include "undohelper.hpp"
+#include <QElapsedTimer>
 #include <QMutex>
 #include <QObject>
 #include <QTabWidget>
@@ -144,6 +145,7 @@ public:
     /** @brief Create and push and undo object based on the corresponding functions
         Note that if you class permits and requires it, you should use the macro PUSH_UNDO instead*/
     void pushUndo(const Fun &undo, const Fun &redo, const QString &text);
+    void pushUndo(UndoTransaction &&transaction, const QString &text);
     void pushUndo(QUndoCommand *command);
     /** @brief display a user info/warning message in statusbar */
     void displayMessage(const QString &message, MessageType type, int timeout = -1);
@@ -195,6 +197,11 @@ public:
     QString getProjectFolderName();
     /** @brief Returns a timeline clip's bin id */
     QString getTimelineClipBinId(int cid);
+    /** @brief Records and logs the duration (in ms) of a startup or project loading phase.
+        Phases may be nested, e.g. the asset repositories are built with the main window */
+    void addTiming(const QString &phase, qint64 ms);
+    /** @brief Returns the recorded phases with their duration in ms, in the order they ended. Printed on exit with --timings */
+    QVector<QPair<QString, qint64>> timings() const;
 
 private:
     explicit Core();
@@ -222,6 +229,8 @@ private:
     QUrl m_mediaCaptureFile;
 
     QMutex m_thumbProfileMutex;
+    QElapsedTimer m_startupTimer;
+    QVector<QPair<QString, qint64>> m_timings;
 
 public slots:
     void triggerAction(const QString &name);
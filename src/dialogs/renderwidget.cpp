@@ -23,11 +23,14 @@
 #include "dialogs/profilesdialog.h"
 #include "doc/kdenlivedoc.h"
 #include "kdenlivesettings.h"
+#include "mainwindow.h"
 #include "monitor/monitor.h"
 #include "profiles/profilemodel.hpp"
 #include "profiles/profilerepository.hpp"
 #include "project/projectmanager.h"
 #include "timecode.h"
+#include "timeline2/view/timelinecontroller.h"
+#include "timeline2/view/timelinewidget.h"
 #include "ui_saveprofile_ui.h"
 #include "xml/xml.hpp"
 
@@ -95,6 +98,10 @@ const int ParametersRole = Qt::UserRole + 1;
 const int TimeRole = Qt::UserRole + 2;
 const int ProgressRole = Qt::UserRole + 3;
 const int ExtraInfoRole = Qt::UserRole + 5;
+const int FirstFrameRole = Qt::UserRole + 6;
+const int FirstFrameTimeRole = Qt::UserRole + 7;
+const int FpsRole = Qt::UserRole + 8;
+const int CostRole = Qt::UserRole + 9;
 
 // Running job status
 enum JOBSTATUS { WAITINGJOB = 0, STARTINGJOB, RUNNINGJOB, FINISHEDJOB, FAILEDJOB, ABORTEDJOB };
@@ -358,6 +365,12 @@ RenderWidget::RenderWidget(bool enableProxy, QWidget *parent)
 #endif
     m_view.parallel_process->setChecked(KdenliveSettings::parallelrender());
     connect(m_view.parallel_process, &QCheckBox::stateChanged, [](int state) { KdenliveSettings::setParallelrender(state == Qt::Checked); });
+    m_view.segmented_render->setChecked(KdenliveSettings::segmentedrender());
+    connect(m_view.segmented_render, &QCheckBox::stateChanged, [](int state) { KdenliveSettings::setSegmentedrender(state == Qt::Checked); });
+    connect(m_view.checkTwoPass, &QCheckBox::toggled, m_view.segmented_render, [this](bool twoPass) { m_view.segmented_render->setEnabled(!twoPass); });
+    m_view.smart_render->setChecked(KdenliveSettings::smartrender());
+    connect(m_view.smart_render, &QCheckBox::stateChanged, [](int state) { KdenliveSettings::setSmartrender(state == Qt::Checked); });
+    connect(m_view.checkTwoPass, &QCheckBox::toggled, m_view.smart_render, [this](bool twoPass) { m_view.smart_render->setEnabled(!twoPass); });
     if (KdenliveSettings::gpu_accel()) {
         // Disable parallel rendering for movit
         m_view.parallel_process->setEnabled(false);
@@ -1292,6 +1305,52 @@ void RenderWidget::prepareRendering(bool delayedRendering, const QString &chapte
     generateRenderFiles(doc, playlistPath, in, out, delayedRendering);
 }
 
+QStringList RenderWidget::smartRenderArgs(const QDomElement &consumer, int workers)
+{
+    // The chunks were rendered from the proxy clips
+    if (pCore->currentDoc()->useProxy() && !proxyRendering()) {
+        return QStringList();
+    }
+    TimelineController *controller = pCore->window()->getMainTimeline()->controller();
+    QDir folder;
+    QString extension;
+    QStringList previewParams;
+    if (!controller->previewEncoding(folder, extension, previewParams)) {
+        return QStringList();
+    }
+    QMap<QString, QString> renderParams;
+    const QDomNamedNodeMap attributes = consumer.attributes();
+    for (int i = 0; i < attributes.count(); ++i) {
+        const QDomAttr attribute = attributes.item(i).toAttr();
+        renderParams.insert(attribute.name(), attribute.value());
+    }
+    if (!RenderScheduler::sameVideoEncoding(previewParams, renderParams)) {
+        pCore->displayMessage(i18n("Timeline preview encoding does not match the render profile, all frames will be rendered"), InformationMessage);
+        return QStringList();
+    }
+    std::vector<int> chunks;
+    for (const QVariant &frame : controller->renderedChunks()) {
+        chunks.push_back(frame.toInt());
+    }
+    const int in = consumer.attribute(QStringLiteral("in")).toInt();
+    const int out = consumer.attribute(QStringLiteral("out")).toInt();
+    const int chunkSize = KdenliveSettings::timelinechunks();
+    // The frames that are not in the preview are rendered in two segments per worker
+    const std::vector<RenderScheduler::Segment> segments =
+        RenderScheduler::smartSegments(in, out, chunks, chunkSize, qMax(chunkSize, (out - in + 1) / (2 * workers)));
+    QStringList starts;
+    bool cached = false;
+    for (const RenderScheduler::Segment &segment : segments) {
+        starts << (segment.cached ? QStringLiteral("%1c").arg(segment.start) : QString::number(segment.start));
+        cached = cached || segment.cached;
+    }
+    if (!cached) {
+        return QStringList();
+    }
+    return QStringList{QStringLiteral("-segments"),  starts.join(QLatin1Char(',')), QString::number(workers), KdenliveSettings::ffmpegpath(),
+                       QStringLiteral("-cached"),    folder.absolutePath(),         extension,                previewParams.join(QLatin1Char(' '))};
+}
+
 void RenderWidget::generateRenderFiles(QDomDocument doc, const QString &playlistPath, int in, int out, bool delayedRendering)
 {
     QDomDocument clone;
@@ -1580,6 +1639,34 @@ void RenderWidget::generateRenderFiles(QDomDocument doc, const QString &playlist
         file.close();
     }
 
+    // Segmented rendering: kdenlive_render renders segments of the timeline in parallel and joins them without re-encoding.
+    // A smart render also copies the timeline preview chunks. Not used for 2-pass encodings and image sequences.
+    QStringList segmentArgs;
+    const int workers = m_scheduler.segmentWorkers(m_scheduler.playlistCost(playlistPath));
+    const bool canSegment = passes == 1 && !delayedRendering && !renderedFile.contains(QLatin1Char('%'));
+    if (canSegment && m_view.smart_render->isChecked() && m_view.smart_render->isEnabled()) {
+        segmentArgs = smartRenderArgs(consumer, workers);
+    }
+    if (canSegment && segmentArgs.isEmpty() && m_view.segmented_render->isChecked() && m_view.segmented_render->isEnabled()) {
+        std::vector<int> guides;
+        if (auto guidesModel = m_guidesModel.lock()) {
+            for (size_t pos : guidesModel->getSnapPoints()) {
+                guides.push_back((int)pos);
+            }
+        }
+        // Two segments per worker, so that they all keep busy until the end
+        std::vector<int> boundaries =
+            RenderScheduler::segmentBoundaries(consumer.attribute(QStringLiteral("in")).toInt(), consumer.attribute(QStringLiteral("out")).toInt(), guides,
+                                               consumer.attribute(QStringLiteral("g")).toInt(), workers * 2);
+        if (workers > 1 && boundaries.size() > 1) {
+            QStringList starts;
+            for (int start : boundaries) {
+                starts << QString::number(start);
+            }
+            segmentArgs = QStringList{QStringLiteral("-segments"), starts.join(QLatin1Char(',')), QString::number(workers), KdenliveSettings::ffmpegpath()};
+        }
+    }
+
     // Create job
     RenderJobItem *renderItem = nullptr;
     QList<QTreeWidgetItem *> existing = m_view.running_jobs->findItems(renderedFile, Qt::MatchExactly, 1);
@@ -1601,7 +1688,10 @@ void RenderWidget::generateRenderFiles(QDomDocument doc, const QString &playlist
             renderItem->setData(1, Qt::UserRole, i18n("Waiting..."));
             QStringList argsJob = {KdenliveSettings::rendererpath(), playlistPath, renderedFile,
                                    QStringLiteral("-pid:%1").arg(QCoreApplication::applicationPid())};
+            argsJob << segmentArgs;
             renderItem->setData(1, ParametersRole, argsJob);
+            // A segmented render uses the whole machine
+            renderItem->setData(1, CostRole, segmentArgs.isEmpty() ? QVariant() : QVariant(m_scheduler.cores()));
             renderItem->setData(1, TimeRole, QDateTime::currentDateTime());
             if (!exportAudio) {
                 renderItem->setData(1, ExtraInfoRole, i18n("Video without audio track"));
@@ -1623,7 +1713,12 @@ void RenderWidget::generateRenderFiles(QDomDocument doc, const QString &playlist
         renderItem = new RenderJobItem(m_view.running_jobs, QStringList() << QString() << renderedFile);
         renderItem->setData(1, TimeRole, QDateTime::currentDateTime());
         QStringList argsJob = {KdenliveSettings::rendererpath(), pl, renderedFile, QStringLiteral("-pid:%1").arg(QCoreApplication::applicationPid())};
+        argsJob << segmentArgs;
         renderItem->setData(1, ParametersRole, argsJob);
+        if (!segmentArgs.isEmpty()) {
+            // A segmented render uses the whole machine
+            renderItem->setData(1, CostRole, m_scheduler.cores());
+        }
         qDebug() << "* CREATED JOB WITH ARGS: " << argsJob;
         if (!exportAudio) {
             renderItem->setData(1, ExtraInfoRole, i18n("Video without audio track"));
@@ -2088,51 +2183,62 @@ void RenderWidget::slotExport(bool scriptExport, int zoneIn, int zoneOut, const
 
 void RenderWidget::checkRenderStatus()
 {
-    // check if we have a job waiting to render
+    // check if we have jobs waiting to render
     if (m_blockProcessing) {
         return;
     }
 
-    auto *item = static_cast<RenderJobItem *>(m_view.running_jobs->topLevelItem(0));
-
-    // Make sure no other rendering is running
-    while (item != nullptr) {
-        if (item->status() == RUNNINGJOB) {
-            return;
+    // Describe the queue to the scheduler
+    QList<RenderJobItem *> items;
+    std::vector<RenderScheduler::Job> jobs;
+    QMap<QString, int> playlistIndexes;
+    bool activeJob = false;
+    for (int i = 0; i < m_view.running_jobs->topLevelItemCount(); ++i) {
+        auto *item = static_cast<RenderJobItem *>(m_view.running_jobs->topLevelItem(i));
+        const QStringList jobData = item->data(1, ParametersRole).toStringList();
+        const QString playlist = jobData.size() > 2 ? jobData.at(1) : QString();
+        RenderScheduler::Job job{RenderScheduler::Done, 1, -1};
+        if (item->status() == WAITINGJOB) {
+            job.state = RenderScheduler::Waiting;
+        } else if (item->status() == STARTINGJOB || item->status() == RUNNINGJOB) {
+            job.state = RenderScheduler::Running;
         }
-        item = static_cast<RenderJobItem *>(m_view.running_jobs->itemBelow(item));
+        if (job.state != RenderScheduler::Done) {
+            activeJob = true;
+            if (item->data(1, CostRole).isNull()) {
+                item->setData(1, CostRole, playlist.isEmpty() ? m_scheduler.cost(0, 1) : m_scheduler.playlistCost(playlist));
+            }
+            job.cost = item->data(1, CostRole).toInt();
+        }
+        // The second pass of a 2-pass encoding waits for its first pass
+        if (playlist.endsWith(QStringLiteral("-pass2.mlt"))) {
+            job.after = playlistIndexes.value(playlist.section(QLatin1Char('-'), 0, -2) + QStringLiteral(".mlt"), -1);
+        }
+        if (!playlist.isEmpty()) {
+            playlistIndexes.insert(playlist, i);
+        }
+        items << item;
+        jobs.push_back(job);
     }
-    item = static_cast<RenderJobItem *>(m_view.running_jobs->topLevelItem(0));
-    bool waitingJob = false;
 
-    // Find first waiting job
-    while (item != nullptr) {
+    QList<QTreeWidgetItem *> finishedFirstPasses;
+    for (int index : m_scheduler.jobsToStart(jobs)) {
+        RenderJobItem *item = items.at(index);
+        item->setData(1, TimeRole, QDateTime::currentDateTime());
+        startRendering(item);
+        if (item->status() == FAILEDJOB) {
+            continue;
+        }
         if (item->status() == WAITINGJOB) {
-            item->setData(1, TimeRole, QDateTime::currentDateTime());
-            waitingJob = true;
-            startRendering(item);
-            // Check for 2 pass encoding
-            QStringList jobData = item->data(1, ParametersRole).toStringList();
-            if (jobData.size() > 2 && jobData.at(1).endsWith(QStringLiteral("-pass2.mlt"))) {
-                // Find and remove 1st pass job
-                QTreeWidgetItem *above = m_view.running_jobs->itemAbove(item);
-                QString firstPassName = jobData.at(1).section(QLatin1Char('-'), 0, -2) + QStringLiteral(".mlt");
-                while (above) {
-                    QStringList aboveData = above->data(1, ParametersRole).toStringList();
-                    qDebug() << "// GOT  JOB: " << aboveData.at(1);
-                    if (aboveData.size() > 2 && aboveData.at(1) == firstPassName) {
-                        delete above;
-                        break;
-                    }
-                    above = m_view.running_jobs->itemAbove(above);
-                }
-            }
             item->setStatus(STARTINGJOB);
-            break;
         }
-        item = static_cast<RenderJobItem *>(m_view.running_jobs->itemBelow(item));
+        // Remove the 1st pass job once the 2nd pass started, both passes write the same file
+        if (jobs[(size_t)index].after >= 0) {
+            finishedFirstPasses << items.at(jobs[(size_t)index].after);
+        }
     }
-    if (!waitingJob && m_view.shutdown->isChecked()) {
+    qDeleteAll(finishedFirstPasses);
+    if (!activeJob && m_view.shutdown->isChecked()) {
         emit shutdown();
     }
 }
@@ -2161,6 +2267,20 @@ int RenderWidget::waitingJobsCount() const
     return count;
 }
 
+int RenderWidget::runningJobsProgress() const
+{
+    int total = 0;
+    int count = 0;
+    for (int i = 0; i < m_view.running_jobs->topLevelItemCount(); ++i) {
+        auto *item = static_cast<RenderJobItem *>(m_view.running_jobs->topLevelItem(i));
+        if (item->status() == STARTINGJOB || item->status() == RUNNINGJOB) {
+            total += item->data(1, ProgressRole).toInt();
+            count++;
+        }
+    }
+    return count == 0 ? -1 : total / count;
+}
+
 void RenderWidget::adjustViewToProfile()
 {
     m_view.scanning_list->setCurrentIndex(0);
@@ -2820,7 +2940,7 @@ void RenderWidget::parseFile(const QString &exportFile, bool editable)
     }
 }
 
-void RenderWidget::setRenderJob(const QString &dest, int progress)
+void RenderWidget::setRenderJob(const QString &dest, int progress, int frame)
 {
     RenderJobItem *item;
     QList<QTreeWidgetItem *> existing = m_view.running_jobs->findItems(dest, Qt::MatchExactly, 1);
@@ -2834,6 +2954,18 @@ void RenderWidget::setRenderJob(const QString &dest, int progress)
     }
     item->setData(1, ProgressRole, progress);
     item->setStatus(RUNNINGJOB);
+    if (frame >= 0) {
+        // Frame rate since the first reported frame, so that the startup time and the in point are not counted
+        if (item->data(1, FirstFrameRole).isNull()) {
+            item->setData(1, FirstFrameRole, frame);
+            item->setData(1, FirstFrameTimeRole, QDateTime::currentDateTime());
+        } else {
+            qint64 elapsed = item->data(1, FirstFrameTimeRole).toDateTime().msecsTo(QDateTime::currentDateTime());
+            if (elapsed > 0) {
+                item->setData(1, FpsRole, 1000. * (frame - item->data(1, FirstFrameRole).toInt()) / elapsed);
+            }
+        }
+    }
     if (progress == 0) {
         item->setIcon(0, QIcon::fromTheme(QStringLiteral("media-record")));
         item->setData(1, TimeRole, QDateTime::currentDateTime());
@@ -2849,8 +2981,30 @@ void RenderWidget::setRenderJob(const QString &dest, int progress)
         QString est = (days > 0) ? i18np("%1 day ", "%1 days ", days) : QString();
         est.append(when.toString(QStringLiteral("hh:mm:ss")));
         QString t = i18n("Remaining time %1", est);
+        if (!item->data(1, FpsRole).isNull()) {
+            t = i18n("Remaining time %1 (%2 frames/s)", est, QString::number(item->data(1, FpsRole).toDouble(), 'f', 1));
+        }
         item->setData(1, Qt::UserRole, t);
     }
+    updateThroughput();
+}
+
+void RenderWidget::updateThroughput()
+{
+    double fps = 0;
+    int running = 0;
+    for (int i = 0; i < m_view.running_jobs->topLevelItemCount(); ++i) {
+        auto *item = static_cast<RenderJobItem *>(m_view.running_jobs->topLevelItem(i));
+        if (item->status() == RUNNINGJOB) {
+            fps += item->data(1, FpsRole).toDouble();
+            running++;
+        }
+    }
+    QString title = i18n("File");
+    if (running > 0) {
+        title = i18np("File - %1 job running, %2 frames/s", "File - %1 jobs running, %2 frames/s", running, QString::number(fps, 'f', 1));
+    }
+    m_view.running_jobs->headerItem()->setText(1, title);
 }
 
 void RenderWidget::setRenderStatus(const QString &dest, int status, const QString &error)
@@ -2916,6 +3070,7 @@ void RenderWidget::setRenderStatus(const QString &dest, int status, const QStrin
     }
     slotCheckJob();
     checkRenderStatus();
+    updateThroughput();
 }
 
 void RenderWidget::slotAbortCurrentJob()
@@ -2936,7 +3091,11 @@ void RenderWidget::slotStartCurrentJob()
 {
     auto *current = static_cast<RenderJobItem *>(m_view.running_jobs->currentItem());
     if ((current != nullptr) && current->status() == WAITINGJOB) {
+        current->setData(1, TimeRole, QDateTime::currentDateTime());
         startRendering(current);
+        if (current->status() == WAITINGJOB) {
+            current->setStatus(STARTINGJOB);
+        }
     }
     m_view.start_job->setEnabled(false);
 }
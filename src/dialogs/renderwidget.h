@@ -34,6 +34,7 @@ class Menu;
 
 #include "definitions.h"
 #include "bin/model/markerlistmodel.hpp"
+#include "utils/renderscheduler.hpp"
 #include "ui_renderwidget_ui.h"
 
 class QDomElement;
@@ -123,12 +124,14 @@ public:
     ~RenderWidget() override;
     void setGuides(std::weak_ptr<MarkerListModel> guidesModel);
     void focusFirstVisibleItem(const QString &profile = QString());
-    void setRenderJob(const QString &dest, int progress = 0);
+    void setRenderJob(const QString &dest, int progress = 0, int frame = -1);
     void setRenderStatus(const QString &dest, int status, const QString &error);
     void updateDocumentPath();
     void reloadProfiles();
     void setRenderProfile(const QMap<QString, QString> &props);
     int waitingJobsCount() const;
+    /** @brief Returns the average progress of the running jobs, or -1 if no job is running */
+    int runningJobsProgress() const;
     QString getFreeScriptName(const QUrl &projectName = QUrl(), const QString &prefix = QString());
     bool startWaitingRenderJobs();
     /** @brief Returns true if the export audio checkbox is set to automatic. */
@@ -210,6 +213,7 @@ private:
     RenderViewDelegate *m_scriptsDelegate;
     RenderViewDelegate *m_jobsDelegate;
     bool m_blockProcessing;
+    RenderScheduler m_scheduler;
     QString m_renderer;
     KMessageWidget *m_infoMessage;
     KMessageWidget *m_jobInfoMessage;
@@ -224,8 +228,10 @@ private:
     void parseFile(const QString &exportFile, bool editable);
     void updateButtons();
     QUrl filenameWithExtension(QUrl url, const QString &extension);
-    /** @brief Check if a job needs to be started. */
+    /** @brief Start the waiting jobs that fit in the available cores. */
     void checkRenderStatus();
+    /** @brief Show the total frame rate of the running jobs in the job list header. */
+    void updateThroughput();
     void startRendering(RenderJobItem *item);
     bool saveProfile(QDomElement newprofile);
     /** @brief Create a rendering profile from MLT preset. */
@@ -234,6 +240,8 @@ private:
     int getNewStuff(const QString &configFile);
     void prepareRendering(bool delayedRendering, const QString &chapterFile);
     void generateRenderFiles(QDomDocument doc, const QString &playlistPath, int in, int out, bool delayedRendering);
+    /** @brief Returns the kdenlive_render arguments of a smart render copying the timeline preview chunks, empty if they cannot be used. */
+    QStringList smartRenderArgs(const QDomElement &consumer, int workers);
 
 signals:
     void abortProcess(const QString &url);
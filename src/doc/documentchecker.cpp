@@ -23,6 +23,8 @@
 #include "kdenlivesettings.h"
 #include "kthumb.h"
 #include "titler/titlewidget.h"
+#include "utils/filehashcache.hpp"
+#include "utils/folderindex.hpp"
 
 #include <KMessageBox>
 #include <KRecentDirs>
@@ -30,12 +32,16 @@
 #include <klocalizedstring.h>
 
 #include "kdenlive_debug.h"
-#include <QCryptographicHash>
+#include <QEventLoop>
 #include <QFile>
 #include <QFileDialog>
 #include <QFontDatabase>
+#include <QFutureWatcher>
+#include <QProgressDialog>
 #include <QStandardPaths>
+#include <QTimer>
 #include <QTreeWidgetItem>
+#include <QtConcurrent>
 #include <utility>
 const int hashRole = Qt::UserRole;
 const int sizeRole = Qt::UserRole + 1;
@@ -696,68 +702,98 @@ void DocumentChecker::slotSearchClips()
     if (newpath.isEmpty()) {
         return;
     }
-    int ix = 0;
-    bool fixed = false;
     m_ui.recursiveSearch->setChecked(true);
-    // TODO: make non modal
-    QTreeWidgetItem *child = m_ui.treeWidget->topLevelItem(ix);
-    QDir searchDir(newpath);
-    while (child != nullptr) {
-        if (child->data(0, statusRole).toInt() == SOURCEMISSING) {
+    m_ui.recursiveSearch->setEnabled(false);
+    // Collect what has to be searched, the tree items are only used again once the search is over
+    std::vector<SearchItem> items;
+    for (int ix = 0; ix < m_ui.treeWidget->topLevelItemCount(); ++ix) {
+        QTreeWidgetItem *child = m_ui.treeWidget->topLevelItem(ix);
+        const int status = child->data(0, statusRole).toInt();
+        if (status == SOURCEMISSING) {
             for (int j = 0; j < child->childCount(); ++j) {
                 QTreeWidgetItem *subchild = child->child(j);
-                QString clipPath =
-                    searchFileRecursively(searchDir, subchild->data(0, sizeRole).toString(), subchild->data(0, hashRole).toString(), subchild->text(1));
-                if (!clipPath.isEmpty()) {
-                    fixed = true;
-                    subchild->setText(1, clipPath);
-                    subchild->setIcon(0, QIcon::fromTheme(QStringLiteral("dialog-ok")));
-                    subchild->setData(0, statusRole, CLIPOK);
-                }
-            }
-        } else if (child->data(0, statusRole).toInt() == CLIPMISSING) {
-            bool perfectMatch = true;
-            ClipType::ProducerType type = (ClipType::ProducerType)child->data(0, clipTypeRole).toInt();
-            QString clipPath;
-            if (type != ClipType::SlideShow) {
-                // Slideshows cannot be found with hash / size
-                clipPath = searchFileRecursively(searchDir, child->data(0, sizeRole).toString(), child->data(0, hashRole).toString(), child->text(1));
+                items.push_back(SearchItem{subchild, SOURCEMISSING, ClipType::Unknown, subchild->data(0, sizeRole).toString(),
+                                           subchild->data(0, hashRole).toString(), QUrl::fromLocalFile(subchild->text(1)).fileName()});
             }
-            if (clipPath.isEmpty()) {
-                clipPath = searchPathRecursively(searchDir, QUrl::fromLocalFile(child->text(1)).fileName(), type);
-                perfectMatch = false;
-            }
-            if (!clipPath.isEmpty()) {
-                fixed = true;
-                child->setText(1, clipPath);
-                child->setIcon(0, perfectMatch ? QIcon::fromTheme(QStringLiteral("dialog-ok")) : QIcon::fromTheme(QStringLiteral("dialog-warning")));
-                child->setData(0, statusRole, CLIPOK);
-            }
-        } else if (child->data(0, statusRole).toInt() == LUMAMISSING) {
-            QString fileName = searchLuma(searchDir, child->data(0, idRole).toString());
-            if (!fileName.isEmpty()) {
-                fixed = true;
-                child->setText(1, fileName);
-                child->setIcon(0, QIcon::fromTheme(QStringLiteral("dialog-ok")));
-                child->setData(0, statusRole, LUMAOK);
-            }
-        } else if (child->data(0, typeRole).toInt() == TITLE_IMAGE_ELEMENT && child->data(0, statusRole).toInt() == CLIPPLACEHOLDER) {
+        } else if (status == CLIPMISSING) {
+            items.push_back(SearchItem{child, CLIPMISSING, (ClipType::ProducerType)child->data(0, clipTypeRole).toInt(), child->data(0, sizeRole).toString(),
+                                       child->data(0, hashRole).toString(), QUrl::fromLocalFile(child->text(1)).fileName()});
+        } else if (status == LUMAMISSING) {
+            const QString fileName = QUrl::fromLocalFile(child->data(0, idRole).toString()).fileName();
+            SearchItem item{child, LUMAMISSING, ClipType::Unknown, QString(), QString(), fileName};
+            // Lumas are first looked for in the installed ones, which doesn't need the index
+            item.result = searchLuma(child->data(0, idRole).toString());
+            items.push_back(item);
+        } else if (child->data(0, typeRole).toInt() == TITLE_IMAGE_ELEMENT && status == CLIPPLACEHOLDER) {
             // Search missing title images
-            QString missingFileName = QUrl::fromLocalFile(child->text(1)).fileName();
-            QString newPath = searchPathRecursively(searchDir, missingFileName);
-            if (!newPath.isEmpty()) {
-                // File found
-                fixed = true;
-                child->setText(1, newPath);
-                child->setIcon(0, QIcon::fromTheme(QStringLiteral("dialog-ok")));
-                child->setData(0, statusRole, CLIPOK);
-            }
+            items.push_back(SearchItem{child, TITLE_IMAGE_ELEMENT, ClipType::Unknown, QString(), QString(), QUrl::fromLocalFile(child->text(1)).fileName()});
         }
-        ix++;
-        child = m_ui.treeWidget->topLevelItem(ix);
     }
+
+    // The folder is indexed once, then all the items are resolved against the index, in a worker thread so that the dialog stays responsive
+    FolderIndex index(newpath);
+    std::atomic<bool> cancel(false);
+    std::atomic<int> stage(0);
+    std::atomic<int> done(0);
+    std::atomic<int> total(0);
+    QProgressDialog progress(i18n("Indexing %1", newpath), i18n("Cancel"), 0, 0, m_dialog);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(500);
+    connect(&progress, &QProgressDialog::canceled, this, [&cancel]() { cancel = true; });
+    QTimer progressTimer;
+    progressTimer.setInterval(100);
+    connect(&progressTimer, &QTimer::timeout, this, [&]() {
+        if (stage == 1 && progress.maximum() != total) {
+            progress.setLabelText(i18np("Searching 1 missing file", "Searching %1 missing files", (int)total));
+        }
+        progress.setMaximum(total);
+        progress.setValue(done);
+    });
+    QEventLoop loop;
+    QFutureWatcher<void> watcher;
+    connect(&watcher, &QFutureWatcher<void>::finished, &loop, &QEventLoop::quit);
+    watcher.setFuture(QtConcurrent::run([&]() {
+        if (!index.build(cancel, [&done, &total](int walked, int count) {
+                total = count;
+                done = walked;
+            })) {
+            return;
+        }
+        done = 0;
+        total = (int)items.size();
+        stage = 1;
+        QtConcurrent::blockingMap(items, [&](SearchItem &item) {
+            if (!cancel) {
+                resolveItem(index, item, cancel);
+            }
+            ++done;
+        });
+    }));
+    progressTimer.start();
+    loop.exec();
+    progressTimer.stop();
+    progress.reset();
     m_ui.recursiveSearch->setChecked(false);
     m_ui.recursiveSearch->setEnabled(true);
+    FileHashCache::get()->save();
+    if (cancel) {
+        return;
+    }
+
+    bool fixed = false;
+    for (const SearchItem &item : items) {
+        if (item.result.isEmpty()) {
+            continue;
+        }
+        fixed = true;
+        item.item->setText(1, item.result);
+        if (item.kind == CLIPMISSING && !item.perfectMatch) {
+            item.item->setIcon(0, QIcon::fromTheme(QStringLiteral("dialog-warning")));
+        } else {
+            item.item->setIcon(0, QIcon::fromTheme(QStringLiteral("dialog-ok")));
+        }
+        item.item->setData(0, statusRole, item.kind == LUMAMISSING ? LUMAOK : CLIPOK);
+    }
     if (fixed) {
         // original doc was modified
         m_doc.documentElement().setAttribute(QStringLiteral("modified"), 1);
@@ -765,7 +801,7 @@ void DocumentChecker::slotSearchClips()
     checkStatus();
 }
 
-QString DocumentChecker::searchLuma(const QDir &dir, const QString &file) const
+QString DocumentChecker::searchLuma(const QString &file) const
 {
     QDir searchPath(KdenliveSettings::mltpath());
     QString fname = QUrl::fromLocalFile(file).fileName();
@@ -790,90 +826,75 @@ QString DocumentChecker::searchLuma(const QDir &dir, const QString &file) const
         return result.filePath();
     }
     // Try in Kdenlive's standard KDE path
-    QString res = QStandardPaths::locate(QStandardPaths::AppDataLocation, QStringLiteral("lumas/") + fname);
-    if (!res.isEmpty()) {
-        return res;
-    }
-    // Try in user's chosen folder
-    return searchPathRecursively(dir, fname);
+    return QStandardPaths::locate(QStandardPaths::AppDataLocation, QStringLiteral("lumas/") + fname);
 }
 
-QString DocumentChecker::searchPathRecursively(const QDir &dir, const QString &fileName, ClipType::ProducerType type) const
+// static
+QString DocumentChecker::searchPath(const FolderIndex &index, const QString &fileName, ClipType::ProducerType type)
 {
-    QString foundFileName;
-    QStringList filters;
     if (type == ClipType::SlideShow) {
-        if (fileName.contains(QLatin1Char('%'))) {
-            filters << fileName.section(QLatin1Char('%'), 0, -2) + QLatin1Char('*');
-        } else {
+        if (!fileName.contains(QLatin1Char('%'))) {
             return QString();
         }
-    } else {
-        filters << fileName;
+        // The slideshow is found in the first folder containing one of its images
+        const QStringList images = index.byPrefix(fileName.section(QLatin1Char('%'), 0, -2));
+        return images.isEmpty() ? QString() : QFileInfo(images.first()).absoluteDir().absoluteFilePath(fileName);
     }
-    QDir searchDir(dir);
-    searchDir.setNameFilters(filters);
-    QStringList filesAndDirs = searchDir.entryList(QDir::Files | QDir::Readable);
-    if (!filesAndDirs.isEmpty()) {
-        // File Found
-        if (type == ClipType::SlideShow) {
-            return searchDir.absoluteFilePath(fileName);
-        }
-        return searchDir.absoluteFilePath(filesAndDirs.at(0));
+    const QStringList paths = index.byName(fileName);
+    return paths.isEmpty() ? QString() : paths.first();
+}
+
+// static
+QString DocumentChecker::searchFile(const FolderIndex &index, const QString &matchSize, const QString &matchHash, const QString &fileName,
+                                    const std::atomic<bool> &cancel)
+{
+    if (matchSize.isEmpty() && matchHash.isEmpty()) {
+        return searchPath(index, fileName);
     }
-    searchDir.setNameFilters(QStringList());
-    filesAndDirs = searchDir.entryList(QDir::Dirs | QDir::Readable | QDir::Executable | QDir::NoDotAndDotDot);
-    for (int i = 0; i < filesAndDirs.size() && foundFileName.isEmpty(); ++i) {
-        foundFileName = searchPathRecursively(searchDir.absoluteFilePath(filesAndDirs.at(i)), fileName, type);
-        if (!foundFileName.isEmpty()) {
+    bool ok = false;
+    const qint64 size = matchSize.toLongLong(&ok);
+    if (!ok) {
+        return QString();
+    }
+    // Only the files having the right size are hashed, and their hash is cached for the next searches
+    for (const QString &candidate : index.bySize(size)) {
+        if (cancel) {
             break;
         }
+        if (FileHashCache::get()->hash(candidate) == matchHash) {
+            return candidate;
+        }
     }
-    return foundFileName;
+    return QString();
 }
 
-QString DocumentChecker::searchFileRecursively(const QDir &dir, const QString &matchSize, const QString &matchHash, const QString &fileName) const
+// static
+void DocumentChecker::resolveItem(const FolderIndex &index, SearchItem &item, const std::atomic<bool> &cancel)
 {
-    if (matchSize.isEmpty() && matchHash.isEmpty()) {
-        return searchPathRecursively(dir, QUrl::fromLocalFile(fileName).fileName());
-    }
-    QString foundFileName;
-    QByteArray fileData;
-    QByteArray fileHash;
-    QStringList filesAndDirs = dir.entryList(QDir::Files | QDir::Readable);
-    for (int i = 0; i < filesAndDirs.size() && foundFileName.isEmpty(); ++i) {
-        QFile file(dir.absoluteFilePath(filesAndDirs.at(i)));
-        if (QString::number(file.size()) == matchSize) {
-            if (file.open(QIODevice::ReadOnly)) {
-                /*
-                 * 1 MB = 1 second per 450 files (or faster)
-                 * 10 MB = 9 seconds per 450 files (or faster)
-                 */
-                if (file.size() > 1000000 * 2) {
-                    fileData = file.read(1000000);
-                    if (file.seek(file.size() - 1000000)) {
-                        fileData.append(file.readAll());
-                    }
-                } else {
-                    fileData = file.readAll();
-                }
-                file.close();
-                fileHash = QCryptographicHash::hash(fileData, QCryptographicHash::Md5);
-                if (QString::fromLatin1(fileHash.toHex()) == matchHash) {
-                    return file.fileName();
-                }
-            }
+    switch (item.kind) {
+    case SOURCEMISSING:
+        item.result = searchFile(index, item.size, item.hash, item.fileName, cancel);
+        break;
+    case CLIPMISSING:
+        if (item.type != ClipType::SlideShow) {
+            // Slideshows cannot be found with hash / size
+            item.result = searchFile(index, item.size, item.hash, item.fileName, cancel);
         }
-        ////qCDebug(KDENLIVE_LOG) << filesAndDirs.at(i) << file.size() << fileHash.toHex();
-    }
-    filesAndDirs = dir.entryList(QDir::Dirs | QDir::Readable | QDir::Executable | QDir::NoDotAndDotDot);
-    for (int i = 0; i < filesAndDirs.size() && foundFileName.isEmpty(); ++i) {
-        foundFileName = searchFileRecursively(dir.absoluteFilePath(filesAndDirs.at(i)), matchSize, matchHash, fileName);
-        if (!foundFileName.isEmpty()) {
-            break;
+        if (item.result.isEmpty()) {
+            item.result = searchPath(index, item.fileName, item.type);
+            item.perfectMatch = false;
+        }
+        break;
+    case LUMAMISSING:
+        if (item.result.isEmpty()) {
+            // Try in user's chosen folder
+            item.result = searchPath(index, item.fileName);
         }
+        break;
+    default:
+        item.result = searchPath(index, item.fileName);
+        break;
     }
-    return foundFileName;
 }
 
 void DocumentChecker::slotEditItem(QTreeWidgetItem *item, int)
@@ -26,6 +26,9 @@
 #include <QDir>
 #include <QDomElement>
 #include <QUrl>
+#include <atomic>
+
+class FolderIndex;
 
 class DocumentChecker : public QObject
 {
@@ -52,7 +55,8 @@ private slots:
     QString getProperty(const QDomElement &effect, const QString &name);
     void updateProperty(const QDomElement &effect, const QString &name, const QString &value);
     void setProperty(QDomElement &effect, const QString &name, const QString &value);
-    QString searchLuma(const QDir &dir, const QString &file) const;
+    /** @brief Looks for a luma file in the installed lumas */
+    QString searchLuma(const QString &file) const;
     /** @brief Check if images and fonts in this clip exists, returns a list of images that do exist so we don't check twice. */
     void checkMissingImagesAndFonts(const QStringList &images, const QStringList &fonts, const QString &id, const QString &baseClip);
     void slotCheckButtons();
@@ -63,8 +67,25 @@ private:
     Ui::MissingClips_UI m_ui;
     QDialog *m_dialog;
     QPair<QString, QString> m_rootReplacement;
-    QString searchPathRecursively(const QDir &dir, const QString &fileName, ClipType::ProducerType type = ClipType::Unknown) const;
-    QString searchFileRecursively(const QDir &dir, const QString &matchSize, const QString &matchHash, const QString &fileName) const;
+    /** @brief A missing file of the tree, looked for by slotSearchClips */
+    struct SearchItem
+    {
+        QTreeWidgetItem *item;
+        int kind;
+        ClipType::ProducerType type;
+        QString size;
+        QString hash;
+        QString fileName;
+        QString result;
+        bool perfectMatch{true};
+    };
+    /** @brief Finds the item in the index, sets its result to the found path. Called from worker threads */
+    static void resolveItem(const FolderIndex &index, SearchItem &item, const std::atomic<bool> &cancel);
+    /** @brief Returns the first indexed file with the given name, or the path of a slideshow whose images are indexed */
+    static QString searchPath(const FolderIndex &index, const QString &fileName, ClipType::ProducerType type = ClipType::Unknown);
+    /** @brief Returns the first indexed file with the given size and hash, or with the given name if size and hash are unknown */
+    static QString searchFile(const FolderIndex &index, const QString &matchSize, const QString &matchHash, const QString &fileName,
+                              const std::atomic<bool> &cancel);
     void checkStatus();
     QMap<QString, QString> m_missingTitleImages;
     QMap<QString, QString> m_missingTitleFonts;
@@ -40,6 +40,9 @@
 #include "project/projectcommands.h"
 #include "titler/titlewidget.h"
 #include "transitions/transitionsrepository.hpp"
+#include "utils/filehashcache.hpp"
+#include "utils/proxystore.hpp"
+#include "utils/thumbnailcache.hpp"
 
 #include <config-kdenlive.h>
 
@@ -56,7 +59,9 @@
 #include <QDomImplementation>
 #include <QFile>
 #include <QFileDialog>
+#include <QSaveFile>
 #include <QTimer>
+#include <QtConcurrent>
 #include <QUndoGroup>
 #include <QUndoStack>
 
@@ -87,6 +92,7 @@ KdenliveDoc::KdenliveDoc(const QUrl &url, QString projectFolder, QUndoGroup *und
     bool success = false;
     connect(m_commandStack.get(), &QUndoStack::indexChanged, this, &KdenliveDoc::slotModified);
     connect(m_commandStack.get(), &DocUndoStack::invalidate, this, &KdenliveDoc::checkPreviewStack);
+    connect(&m_autoSaveWatcher, &QFutureWatcher<bool>::finished, this, &KdenliveDoc::slotAutoSaveDone);
     // connect(m_commandStack, SIGNAL(cleanChanged(bool)), this, SLOT(setModified(bool)));
 
     // init default document properties
@@ -279,6 +285,8 @@ KdenliveDoc::KdenliveDoc(const QUrl &url, QString projectFolder, QUndoGroup *und
 
 KdenliveDoc::~KdenliveDoc()
 {
+    // The thumbnail packs live in this document's cache folder
+    ThumbnailCache::get()->resetPersistentStore();
     if (m_url.isEmpty()) {
         // Document was never saved, delete cache folder
         QString documentId = QDir::cleanPath(getDocumentProperty(QStringLiteral("documentid")));
@@ -295,6 +303,8 @@ KdenliveDoc::~KdenliveDoc()
     // Clean up guide model
     m_guideModel.reset();
     // qCDebug(KDENLIVE_LOG) << "// DEL CLP MAN done";
+    m_pendingAutoSave.clear();
+    m_autoSaveWatcher.waitForFinished();
     if (m_autosave) {
         if (!m_autosave->fileName().isEmpty()) {
             m_autosave->remove();
@@ -428,25 +438,74 @@ bool KdenliveDoc::autoGenerateImageProxy(int width) const
            width > m_documentProperties.value(QStringLiteral("proxyimageminsize")).toInt();
 }
 
-void KdenliveDoc::slotAutoSave(const QString &scene)
+namespace {
+bool writeAutoSave(KAutoSaveFile *file, QString scene, const QMap<QString, QString> &replacements)
+{
+    QMapIterator<QString, QString> i(replacements);
+    while (i.hasNext()) {
+        i.next();
+        scene.replace(i.key(), i.value());
+    }
+    const QByteArray data = scene.toUtf8();
+    // The data goes to a sibling temporary file, the previous autosave is only replaced once it is complete
+    QSaveFile save(file->fileName());
+    if (!save.open(QIODevice::WriteOnly) || save.write(data) != data.size()) {
+        return false;
+    }
+    // An open file cannot be replaced on Windows. Closing the handle keeps the lock, it is reopened once the write is done
+    file->close();
+    return save.commit();
+}
+} // namespace
+
+void KdenliveDoc::slotAutoSave(const QString &scene, const QMap<QString, QString> &replacements)
 {
     if (m_autosave != nullptr) {
+        if (scene.isEmpty()) {
+            // Make sure we don't save if scenelist is corrupted
+            KMessageBox::error(QApplication::activeWindow(), i18n("Cannot write to file %1, scene list is corrupted.", m_autosave->fileName()));
+            return;
+        }
+        if (m_autoSaveWatcher.isRunning()) {
+            // The running write owns the autosave file until it is done
+            m_pendingAutoSave = scene;
+            m_pendingReplacements = replacements;
+            return;
+        }
+        // Opening the autosave file locks it for this instance
         if (!m_autosave->isOpen() && !m_autosave->open(QIODevice::ReadWrite)) {
             // show error: could not open the autosave file
             qCDebug(KDENLIVE_LOG) << "ERROR; CANNOT CREATE AUTOSAVE FILE";
             pCore->displayMessage(i18n("Cannot create autosave file %1", m_autosave->fileName()), ErrorMessage);
             return;
         }
-        if (scene.isEmpty()) {
-            // Make sure we don't save if scenelist is corrupted
-            KMessageBox::error(QApplication::activeWindow(), i18n("Cannot write to file %1, scene list is corrupted.", m_autosave->fileName()));
-            return;
+        m_autoSaveWatcher.setFuture(QtConcurrent::run(writeAutoSave, m_autosave, scene, replacements));
+    }
+}
+
+void KdenliveDoc::slotAutoSaveDone()
+{
+    if (m_autosave != nullptr) {
+        if (!m_autosave->isOpen()) {
+            m_autosave->open(QIODevice::ReadWrite);
         }
-        m_autosave->resize(0);
-        if (m_autosave->write(scene.toUtf8()) < 0) {
+        if (!m_autoSaveWatcher.result()) {
             pCore->displayMessage(i18n("Cannot create autosave file %1", m_autosave->fileName()), ErrorMessage);
-        };
-        m_autosave->flush();
+        }
+    }
+    if (!m_pendingAutoSave.isEmpty()) {
+        QString scene;
+        scene.swap(m_pendingAutoSave);
+        slotAutoSave(scene, m_pendingReplacements);
+    }
+}
+
+void KdenliveDoc::clearAutoSave()
+{
+    m_pendingAutoSave.clear();
+    m_autoSaveWatcher.waitForFinished();
+    if (m_autosave != nullptr) {
+        m_autosave->resize(0);
     }
 }
 
@@ -622,6 +681,8 @@ bool KdenliveDoc::saveSceneList(const QString &path, const QString &scene)
     fileName.append(QStringLiteral(".kdenlive.png"));
     QDir backupFolder(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + QStringLiteral("/.backup"));
     emit saveTimelinePreview(backupFolder.absoluteFilePath(fileName));
+    updateProxyReferences();
+    FileHashCache::get()->save();
     return true;
 }
 
@@ -658,6 +719,7 @@ void KdenliveDoc::setProjectFolder(const QUrl &url)
     /*if (KMessageBox::questionYesNo(QApplication::activeWindow(), i18n("You have changed the project folder. Do you want to copy the cached data from %1 to the
      * new folder %2?", m_projectFolder, url.path())) == KMessageBox::Yes) moveProjectData(url);*/
     m_projectFolder = url.toLocalFile();
+    ThumbnailCache::get()->resetPersistentStore();
 
     updateProjectFolderPlacesEntry();
 }
@@ -1181,6 +1243,11 @@ void KdenliveDoc::slotProxyCurrentItem(bool doProxy, QList<std::shared_ptr<Proje
         initProxySettings();
     }
     QString extension = QLatin1Char('.') + m_proxyExtension;
+    // Proxies are named after the parameters used to create them, so that projects with different proxy settings don't share them
+    QString proxyParams = getDocumentProperty(QStringLiteral("proxyparams")).simplified();
+    if (proxyParams.isEmpty()) {
+        proxyParams = getAutoProxyProfile();
+    }
     // getDocumentProperty(QStringLiteral("proxyextension"));
     /*QString params = getDocumentProperty(QStringLiteral("proxyparams"));
     if (params.contains(QStringLiteral("-s "))) {
@@ -1233,7 +1300,12 @@ void KdenliveDoc::slotProxyCurrentItem(bool doProxy, QList<std::shared_ptr<Proje
                     }
                 }
                 if (path.isEmpty()) {
-                    path = dir.absoluteFilePath(item->hash() + (t == ClipType::Image ? QStringLiteral(".png") : extension));
+                    if (t == ClipType::Image) {
+                        const QString imageParams = QString::number(KdenliveSettings::proxyimagesize());
+                        path = dir.absoluteFilePath(ProxyStore::proxyName(item->hash(), imageParams, QStringLiteral(".png")));
+                    } else {
+                        path = dir.absoluteFilePath(ProxyStore::proxyName(item->hash(), proxyParams, extension));
+                    }
                 }
                 newProps.insert(QStringLiteral("kdenlive:proxy"), path);
                 // We need to insert empty proxy so that undo will work
@@ -1684,11 +1756,42 @@ QDir KdenliveDoc::getCacheDir(CacheType type, bool *ok) const
     return dir;
 }
 
-QStringList KdenliveDoc::getProxyHashList()
+QStringList KdenliveDoc::getProxyHashList(QStringList *sharedProxies)
 {
+    if (sharedProxies != nullptr) {
+        std::unique_ptr<ProxyStore> store = proxyStore();
+        *sharedProxies = store ? store->sharedProxies(getDocumentProperty(QStringLiteral("documentid"))) : QStringList();
+    }
     return pCore->bin()->getProxyHashList();
 }
 
+std::unique_ptr<ProxyStore> KdenliveDoc::proxyStore() const
+{
+    bool ok = false;
+    QDir dir = getCacheDir(CacheProxy, &ok);
+    if (!ok) {
+        return nullptr;
+    }
+    return std::unique_ptr<ProxyStore>(new ProxyStore(dir, qint64(KdenliveSettings::proxycachesize()) * 1024 * 1024, ProxyStore::LockMode::NoWait));
+}
+
+void KdenliveDoc::updateProxyReferences()
+{
+    std::unique_ptr<ProxyStore> store = proxyStore();
+    if (!store) {
+        return;
+    }
+    QStringList proxies;
+    const QList<std::shared_ptr<ProjectClip>> clipList = pCore->projectItemModel()->getRootFolder()->childClips();
+    for (const std::shared_ptr<ProjectClip> &clip : clipList) {
+        const QString proxy = clip->getProducerProperty(QStringLiteral("kdenlive:proxy"));
+        if (proxy.length() > 2) {
+            proxies << proxy;
+        }
+    }
+    store->setReferences(getDocumentProperty(QStringLiteral("documentid")), proxies);
+}
+
 std::shared_ptr<MarkerListModel> KdenliveDoc::getGuideModel() const
 {
     return m_guideModel;
@@ -26,6 +26,7 @@
 #define KDENLIVEDOC_H
 
 #include <QDir>
+#include <QFutureWatcher>
 #include <QList>
 #include <QMap>
 #include <QTimer>
@@ -45,6 +46,7 @@ class ClipController;
 class MarkerListModel;
 class Render;
 class ProfileParam;
+class ProxyStore;
 
 class QTextEdit;
 class QUndoGroup;
@@ -143,8 +145,14 @@ public:
     QDir getCacheDir(CacheType type, bool *ok) const;
     /** @brief Create standard cache dirs for the project */
     void initCacheDirs();
-    /** @brief Get a list of all proxy hash used in this project */
-    QStringList getProxyHashList();
+    /** @brief Get a list of all proxy hash used in this project
+        @param sharedProxies if not null, receives the file names of the proxies that other projects also use */
+    QStringList getProxyHashList(QStringList *sharedProxies = nullptr);
+    /** @brief Returns the store tracking the proxies of the proxy cache folder, or nullptr if the folder is not available.
+     *  It is used from the GUI thread, so its operations don't wait for the index lock held by another instance */
+    std::unique_ptr<ProxyStore> proxyStore() const;
+    /** @brief Registers the proxies of the project clips in the proxy store, so that other projects don't delete them */
+    void updateProxyReferences();
     /** @brief Move project data files to new url */
     void moveProjectData(const QString &src, const QString &dest);
 
@@ -188,6 +196,11 @@ private:
     QMap<QString, QString> m_documentProperties;
     QMap<QString, QString> m_documentMetadata;
     std::shared_ptr<MarkerListModel> m_guideModel;
+    /** @brief Watches the autosave being written */
+    QFutureWatcher<bool> m_autoSaveWatcher;
+    /** @brief The scene to autosave once the current write is done, with its replacements */
+    QString m_pendingAutoSave;
+    QMap<QString, QString> m_pendingReplacements;
 
     QString searchFileRecursively(const QDir &dir, const QString &matchSize, const QString &matchHash) const;
 
@@ -205,6 +218,8 @@ private:
     void updateProjectProfile(bool reloadProducers = false);
     /** @brief initialize proxy settings based on hw status */
     void initProxySettings();
+    /** @brief Empties the autosave file once the project is saved, after the autosave being written is done */
+    void clearAutoSave();
 
 public slots:
     void slotCreateTextTemplateClip(const QString &group, const QString &groupId, QUrl path);
@@ -217,8 +232,10 @@ public slots:
     void slotProxyCurrentItem(bool doProxy, QList<std::shared_ptr<ProjectClip>> clipList = QList<std::shared_ptr<ProjectClip>>(), bool force = false,
                               QUndoCommand *masterCommand = nullptr);
     /** @brief Saves the current project at the autosave location.
-     * @description The autosave files are in ~/.kde/data/stalefiles/kdenlive/ */
-    void slotAutoSave(const QString &scene);
+     * @description The autosave files are in ~/.kde/data/stalefiles/kdenlive/ \n
+     * The replacements are applied to the scene and the autosave file, locked by this instance, is replaced in a worker thread once the new one is complete.
+     * If a write is still running, only the latest scene is kept to be written after it. */
+    void slotAutoSave(const QString &scene, const QMap<QString, QString> &replacements = QMap<QString, QString>());
     /** @brief Groups were changed, save to MLT. */
     void groupsChanged(const QString &groups);
 
@@ -230,6 +247,8 @@ private slots:
     void checkPreviewStack();
     /** @brief Guides were changed, save to MLT. */
     void guidesChanged();
+    /** @brief The autosave thread is done, report errors and write the pending scene */
+    void slotAutoSaveDone();
 
 signals:
     void resetProjectList();
@@ -27,6 +27,7 @@
 
 #include <KLocalizedString>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QStandardPaths>
 #include <QTextStream>
@@ -38,7 +39,10 @@ std::once_flag EffectsRepository::m_onceFlag;
 EffectsRepository::EffectsRepository()
     : AbstractAssetsRepository<EffectType>()
 {
+    QElapsedTimer timer;
+    timer.start();
     init();
+    pCore->addTiming(QStringLiteral("Effects"), timer.elapsed());
     // Check that our favorite effects are valid
     QStringList invalidEffect;
     for (const QString &effect : KdenliveSettings::favorite_effects()) {
@@ -163,6 +167,11 @@ QString EffectsRepository::assetPreferredListPath() const
     return QStringLiteral(":data/preferred_effects.txt");
 }
 
+QString EffectsRepository::cacheName() const
+{
+    return QStringLiteral("effects.cache");
+}
+
 bool EffectsRepository::isPreferred(const QString &effectId) const
 {
     return m_preferred_list.contains(effectId);
@@ -27,20 +27,31 @@
 #include "doc/kthumb.h"
 #include "kdenlivesettings.h"
 #include "klocalizedstring.h"
+#include "lib/audio/audioPeaks.h"
 #include "lib/audio/audioStreamInfo.h"
 #include "macros.hpp"
 #include "utils/thumbnailcache.hpp"
-#include <QDir>
-#include <QFile>
+#include <QElapsedTimer>
+#include <QProcess>
 #include <QScopedPointer>
-#include <QTemporaryFile>
+#include <cstring>
 #include <memory>
 #include <mlt++/MltProducer.h>
 
+namespace {
+// Minimum delay between two updates of the partial audio thumbnail, in ms
+const int partialPeaksInterval = 1000;
+} // namespace
+
 AudioThumbJob::AudioThumbJob(const QString &binId)
     : AbstractClipJob(AUDIOTHUMBJOB, binId)
-    , m_ffmpegProcess(nullptr)
 {
+    // The partial thumbnails are computed in the job thread, but must be set in the clip's thread
+    connect(this, &AudioThumbJob::partialPeaksReady, this, &AudioThumbJob::updatePartialPeaks, Qt::QueuedConnection);
+    connect(this, &AudioThumbJob::jobCanceled, this, [this]() {
+        m_canceled = true;
+        discardPartialPeaks();
+    });
 }
 
 const QString AudioThumbJob::getDescription() const
@@ -50,7 +61,7 @@ const QString AudioThumbJob::getDescription() const
 
 bool AudioThumbJob::computeWithMlt()
 {
-    m_audioLevels.clear();
+    m_audioPeaks.reset();
     m_errorMessage.clear();
     // MLT audio thumbs: slower but safer
     QString service = m_prod->get("mlt_service");
@@ -67,175 +78,150 @@ bool AudioThumbJob::computeWithMlt()
     audioProducer->set("video_index", "-1");
     Mlt::Filter chans(*m_prod->profile(), "audiochannels");
     Mlt::Filter converter(*m_prod->profile(), "audioconvert");
-    Mlt::Filter levels(*m_prod->profile(), "audiolevel");
     audioProducer->attach(chans);
     audioProducer->attach(converter);
-    audioProducer->attach(levels);
 
     int last_val = 0;
     double framesPerSecond = audioProducer->get_fps();
     mlt_audio_format audioFormat = mlt_audio_s16;
-    QStringList keys;
-    keys.reserve(m_channels);
-    for (int i = 0; i < m_channels; i++) {
-        keys << "meta.media.audio_level." + QString::number(i);
-    }
+    AudioPeaksBuilder builder(m_channels, m_lengthInFrames, m_frequency / framesPerSecond);
 
     for (int z = 0; z < m_lengthInFrames; ++z) {
+        if (m_canceled) {
+            return false;
+        }
         int val = (int)(100.0 * z / m_lengthInFrames);
         if (last_val != val) {
             emit jobProgress(val);
             last_val = val;
         }
+        int samples = mlt_sample_calculator(float(framesPerSecond), m_frequency, z);
         QScopedPointer<Mlt::Frame> mltFrame(audioProducer->get_frame());
         if ((mltFrame != nullptr) && mltFrame->is_valid() && (mltFrame->get_int("test_audio") == 0)) {
-            int samples = mlt_sample_calculator(float(framesPerSecond), m_frequency, z);
-            mltFrame->get_audio(audioFormat, m_frequency, m_channels, samples);
-            for (int channel = 0; channel < m_channels; ++channel) {
-                double level = 256 * qMin(mltFrame->get_double(keys.at(channel).toUtf8().constData()) * 0.9, 1.0);
-                m_audioLevels << level;
-            }
-        } else if (!m_audioLevels.isEmpty()) {
-            for (int channel = 0; channel < m_channels; channel++) {
-                m_audioLevels << m_audioLevels.last();
+            int channels = m_channels;
+            auto *data = static_cast<const qint16 *>(mltFrame->get_audio(audioFormat, m_frequency, channels, samples));
+            if (data != nullptr && channels == m_channels) {
+                builder.addSamples(data, samples);
+                continue;
             }
         }
+        builder.addSilence(samples);
     }
+    m_audioPeaks = builder.finish();
     m_done = true;
     return true;
 }
 
 bool AudioThumbJob::computeWithFFMPEG()
 {
-    m_audioLevels.clear();
-    QStringList args;
-
-    std::vector<std::unique_ptr<QTemporaryFile>> channelFiles;
-    for (int i = 0; i < m_channels; i++) {
-        std::unique_ptr<QTemporaryFile> channelTmpfile(new QTemporaryFile());
-        if (!channelTmpfile->open()) {
-            m_errorMessage.append(i18n("Audio thumbs: cannot create temporary file, check disk space and permissions\n"));
-            return false;
-        }
-        channelTmpfile->close();
-        channelFiles.emplace_back(std::move(channelTmpfile));
-    }
-    // Always create audio thumbs from the original source file, because proxy 
+    m_audioPeaks.reset();
+    // Always create audio thumbs from the original source file, because proxy
     // can have a different audio config (channels / mono/ stereo)
     QString filePath = m_prod->get("kdenlive:originalurl");
     if (filePath.isEmpty()) {
         filePath = m_prod->get("resource");
     }
-    args << QStringLiteral("-i") << QUrl::fromLocalFile(filePath).toLocalFile();
-    // Output progress info
-    args << QStringLiteral("-progress");
-#ifdef Q_OS_WIN
-    args << QStringLiteral("-");
-#else
-    args << QStringLiteral("/dev/stdout");
-#endif
-    bool isFFmpeg = KdenliveSettings::ffmpegpath().contains(QLatin1String("ffmpeg"));
-    args << QStringLiteral("-filter_complex:a");
-    if (m_channels == 1) {
-        //TODO: this does not correcty generate the correct stream data
-        args << QStringLiteral("aformat=channel_layouts=mono,%1=100").arg(isFFmpeg ? "aresample=async" : "sample_rates");
-        args << QStringLiteral("-map") << QStringLiteral("0:a%1").arg(m_audioStream > 0 ? ":" + QString::number(m_audioStream) : QString())
-             << QStringLiteral("-c:a") << QStringLiteral("pcm_s16le") << QStringLiteral("-y") << QStringLiteral("-f") << QStringLiteral("data")
-             << channelFiles[0]->fileName();
-    } else {
-        QString aformat = QStringLiteral("[0:a%1]%2=100,channelsplit=channel_layout=%3")
-                              .arg(m_audioStream > 0 ? ":" + QString::number(m_audioStream) : QString())
-                              .arg(isFFmpeg ? "aresample=async" : "aformat=sample_rates=")
-                              .arg(m_channels > 2 ? "5.1" : "stereo");
-        for (int i = 0; i < m_channels; ++i) {
-            aformat.append(QStringLiteral("[0:%1]").arg(i));
+    // The samples are read from a single interleaved stream on ffmpeg's stdout, and processed as they arrive
+    QStringList args;
+    args << QStringLiteral("-loglevel") << QStringLiteral("error") << QStringLiteral("-i") << QUrl::fromLocalFile(filePath).toLocalFile();
+    if (KdenliveSettings::ffmpegpath().contains(QLatin1String("ffmpeg"))) {
+        args << QStringLiteral("-filter:a") << QStringLiteral("aresample=async=100");
+    }
+    args << QStringLiteral("-map") << QStringLiteral("0:a%1").arg(m_audioStream > 0 ? ":" + QString::number(m_audioStream) : QString());
+    args << QStringLiteral("-ac") << QString::number(m_channels) << QStringLiteral("-ar") << QString::number(m_frequency);
+    args << QStringLiteral("-c:a") << QStringLiteral("pcm_s16le") << QStringLiteral("-f") << QStringLiteral("s16le") << QStringLiteral("-");
+
+    QProcess ffmpeg;
+    ffmpeg.start(KdenliveSettings::ffmpegpath(), args);
+    if (!ffmpeg.waitForStarted()) {
+        qWarning() << "Failed to start FFmpeg for audio thumbs";
+        return false;
+    }
+    double samplesPerFrame = m_frequency / m_prod->get_fps();
+    qint64 expectedSamples = qMax<qint64>(1, qint64(m_lengthInFrames * samplesPerFrame));
+    AudioPeaksBuilder builder(m_channels, m_lengthInFrames, samplesPerFrame);
+    const qint64 frameSize = 2 * m_channels;
+    const int blockSize = 16384;
+    std::vector<qint16> block((size_t)(blockSize * m_channels));
+    char *buffer = reinterpret_cast<char *>(block.data());
+    qint64 buffered = 0;
+    qint64 samples = 0;
+    int progress = 0;
+    QElapsedTimer partialTimer;
+    partialTimer.start();
+    while (true) {
+        if (m_canceled) {
+            ffmpeg.kill();
+            ffmpeg.waitForFinished();
+            return false;
         }
-        args << aformat;
-        for (int i = 0; i < m_channels; i++) {
-            // Channel 1
-            args << QStringLiteral("-map") << QStringLiteral("[0:%1]").arg(i) << QStringLiteral("-c:a") << QStringLiteral("pcm_s16le") << QStringLiteral("-y")
-                 << QStringLiteral("-f") << QStringLiteral("data") << channelFiles[size_t(i)]->fileName();
+        qint64 read = ffmpeg.read(buffer + buffered, blockSize * frameSize - buffered);
+        if (read < 0) {
+            break;
         }
-    }
-    m_ffmpegProcess = new QProcess;
-    m_ffmpegProcess->start(KdenliveSettings::ffmpegpath(), args);
-    connect(m_ffmpegProcess, &QProcess::readyReadStandardOutput, this, &AudioThumbJob::updateFfmpegProgress);
-    m_ffmpegProcess->waitForFinished(-1);
-    if (m_ffmpegProcess->exitStatus() != QProcess::CrashExit) {
-        int dataSize = 0;
-        std::vector<const qint16 *> rawChannels;
-        std::vector<QByteArray> sourceChannels;
-        for (auto &channelFile : channelFiles) {
-            channelFile->open();
-            sourceChannels.emplace_back(channelFile->readAll());
-            QByteArray &res = sourceChannels.back();
-            channelFile->close();
-            if (dataSize == 0) {
-                dataSize = res.size();
-            }
-            if (res.isEmpty() || res.size() != dataSize) {
-                // Something went wrong, abort
-                m_errorMessage.append(i18n("Audio thumbs: error reading audio thumbnail created with FFmpeg\n"));
-                return false;
+        if (read == 0) {
+            if (ffmpeg.state() == QProcess::NotRunning) {
+                break;
             }
-            rawChannels.emplace_back((const qint16 *)res.constData());
+            ffmpeg.waitForReadyRead(1000);
+            continue;
         }
-        int progress = 0;
-        std::vector<long> channelsData;
-        double offset = (double)dataSize / (2.0 * m_lengthInFrames);
-        int intraOffset = 1;
-        if (offset > 1000) {
-            intraOffset = offset / 60;
-        } else if (offset > 250) {
-            intraOffset = offset / 10;
+        buffered += read;
+        int count = int(buffered / frameSize);
+        if (count == 0) {
+            continue;
         }
-        double factor = 800.0 / 32768;
-        for (int i = 0; i < m_lengthInFrames; i++) {
-            channelsData.resize((size_t)rawChannels.size());
-            std::fill(channelsData.begin(), channelsData.end(), 0);
-            int pos = (int)(i * offset);
-            int steps = 0;
-            for (int j = 0; j < (int)offset && (pos + j < dataSize); j += intraOffset) {
-                steps++;
-                for (size_t k = 0; k < rawChannels.size(); k++) {
-                    channelsData[k] += abs(rawChannels[k][pos + j]);
-                }
-            }
-            for (long &k : channelsData) {
-                if (steps != 0) {
-                    k /= steps;
-                }
-                m_audioLevels << (int)((double)k * factor);
-            }
-            int p = 80 + (i * 20 / m_lengthInFrames);
-            if (p != progress) {
-                emit jobProgress(p);
-                progress = p;
-            }
+        builder.addSamples(block.data(), count);
+        samples += count;
+        // Keep the incomplete sample frame for the next read
+        qint64 used = count * frameSize;
+        memmove(buffer, buffer + used, size_t(buffered - used));
+        buffered -= used;
+        int p = (int)qMin<qint64>(100, samples * 100 / expectedSamples);
+        if (p != progress) {
+            emit jobProgress(p);
+            progress = p;
+        }
+        if (partialTimer.elapsed() > partialPeaksInterval) {
+            // Display what is already computed while the job runs
+            QMutexLocker lock(&m_partialMutex);
+            m_partialPeaks = builder.snapshot();
+            emit partialPeaksReady();
+            partialTimer.restart();
         }
-        m_done = true;
-        return true;
     }
-    QString err = m_ffmpegProcess->readAllStandardError();
-    delete m_ffmpegProcess;
-    // m_errorMessage += err;
-    // m_errorMessage.append(i18n("Failed to create FFmpeg audio thumbnails, we now try to use MLT"));
-    qWarning() << "Failed to create FFmpeg audio thumbs:\n" << err << "\n---------------------";
-    return false;
+    ffmpeg.waitForFinished(-1);
+    m_logDetails += QString::fromUtf8(ffmpeg.readAllStandardError());
+    if (ffmpeg.exitStatus() == QProcess::CrashExit || ffmpeg.exitCode() != 0 || samples == 0) {
+        // m_errorMessage.append(i18n("Failed to create FFmpeg audio thumbnails, we now try to use MLT"));
+        qWarning() << "Failed to create FFmpeg audio thumbs:\n" << m_logDetails << "\n---------------------";
+        return false;
+    }
+    m_audioPeaks = builder.finish();
+    m_done = true;
+    return true;
 }
 
-void AudioThumbJob::updateFfmpegProgress()
+void AudioThumbJob::updatePartialPeaks()
 {
-    QString result = m_ffmpegProcess->readAllStandardOutput();
-    const QStringList lines = result.split(QLatin1Char('\n'));
-    for (const QString &data : lines) {
-        if (data.startsWith(QStringLiteral("out_time_ms"))) {
-            double ms = data.section(QLatin1Char('='), 1).toDouble();
-            emit jobProgress((int)(ms / m_binClip->duration().ms() / 10));
-        } else {
-            m_logDetails += data + QStringLiteral("\n");
-        }
+    std::shared_ptr<AudioPeaks> peaks;
+    {
+        QMutexLocker lock(&m_partialMutex);
+        peaks = std::move(m_partialPeaks);
     }
+    if (peaks && !m_resultConsumed && !m_canceled) {
+        // The builder fills the same peaks during the whole job, the clip only reads the newly published frames
+        m_displayedPeaks = peaks;
+        m_binClip->updateAudioThumbnail(std::move(peaks), false);
+    }
+}
+
+void AudioThumbJob::discardPartialPeaks()
+{
+    if (m_displayedPeaks && m_binClip && m_binClip->audioThumbPartial() && m_binClip->audioPeaks() == m_displayedPeaks) {
+        m_binClip->updateAudioThumbnail(nullptr, false);
+    }
+    m_displayedPeaks.reset();
 }
 
 bool AudioThumbJob::startJob()
@@ -268,49 +254,19 @@ bool AudioThumbJob::startJob()
     }
     m_cachePath = m_binClip->getAudioThumbPath();
 
-    // checking for cached thumbs
-    QImage image(m_cachePath);
-    if (!image.isNull()) {
-        // convert cached image
-        int n = image.width() * image.height();
-        for (int i = 0; i < n; i++) {
-            QRgb p = image.pixel(i / m_channels, i % m_channels);
-            m_audioLevels << qRed(p);
-            m_audioLevels << qGreen(p);
-            m_audioLevels << qBlue(p);
-            m_audioLevels << qAlpha(p);
-        }
-    }
-    if (!m_audioLevels.isEmpty()) {
+    // checking for cached peaks
+    m_audioPeaks = AudioPeaks::load(m_cachePath);
+    if (m_audioPeaks && m_audioPeaks->channels() == m_channels && m_audioPeaks->frames() == m_lengthInFrames) {
         m_done = true;
         m_successful = true;
         return true;
     }
     bool ok = m_binClip->clipType() == ClipType::Playlist ? false : computeWithFFMPEG();
-    ok = ok ? ok : computeWithMlt();
+    ok = ok || (!m_canceled && computeWithMlt());
     Q_ASSERT(ok == m_done);
 
-    if (ok && m_done && !m_audioLevels.isEmpty()) {
-        // Put into an image for caching.
-        int count = m_audioLevels.size();
-        image = QImage((int)lrint((count + 3) / 4.0 / m_channels), m_channels, QImage::Format_ARGB32);
-        int n = image.width() * image.height();
-        for (int i = 0; i < n; i++) {
-            QRgb p;
-            if ((4 * i + 3) < count) {
-                p = qRgba(m_audioLevels.at(4 * i), m_audioLevels.at(4 * i + 1), m_audioLevels.at(4 * i + 2),
-                          m_audioLevels.at(4 * i + 3));
-            } else {
-                int last = m_audioLevels.last();
-                int r = (4 * i + 0) < count ? m_audioLevels.at(4 * i + 0) : last;
-                int g = (4 * i + 1) < count ? m_audioLevels.at(4 * i + 1) : last;
-                int b = (4 * i + 2) < count ? m_audioLevels.at(4 * i + 2) : last;
-                int a = last;
-                p = qRgba(r, g, b, a);
-            }
-            image.setPixel(i / m_channels, i % m_channels, p);
-        }
-        image.save(m_cachePath);
+    if (ok && m_done && m_audioPeaks) {
+        m_audioPeaks->save(m_cachePath);
         m_successful = true;
         return true;
     }
@@ -328,12 +284,15 @@ bool AudioThumbJob::commitResult(Fun &undo, Fun &redo)
     }
     m_resultConsumed = true;
     if (!m_successful) {
+        discardPartialPeaks();
         return false;
     }
-    QList <double>old = m_binClip->audioFrameCache;
+    // Partial peaks are not restored on undo
+    std::shared_ptr<AudioPeaks> old = m_binClip->audioThumbCreated() ? m_binClip->audioPeaks() : nullptr;
+    m_displayedPeaks.reset();
 
-    // note that the image is moved into lambda, it won't be available from this class anymore
-    auto operation = [clip = m_binClip, audio = std::move(m_audioLevels)]() {
+    // note that the peaks are moved into lambda, they won't be available from this class anymore
+    auto operation = [clip = m_binClip, audio = std::move(m_audioPeaks)]() {
         clip->updateAudioThumbnail(audio);
         return true;
     };
@@ -23,11 +23,14 @@
 
 #include "abstractclipjob.h"
 
+#include <QMutex>
+#include <atomic>
 #include <memory>
 
 /* @brief This class represents the job that corresponds to computing the audio thumb of a clip (waveform)
  */
 
+class AudioPeaks;
 class ProjectClip;
 namespace Mlt {
 class Producer;
@@ -57,8 +60,10 @@ protected:
     // MLT audio thumbs: slower but safer
     bool computeWithMlt();
 
-    // process the stdout/stderr from ffmpeg
-    void updateFfmpegProgress();
+    // display the partial thumbnail in the clip
+    void updatePartialPeaks();
+    // remove the partial thumbnail from the clip when the job is canceled or fails
+    void discardPartialPeaks();
 
 private:
     std::shared_ptr<ProjectClip> m_binClip;
@@ -68,6 +73,14 @@ private:
 
     bool m_done{false}, m_successful{false};
     int m_channels, m_frequency, m_lengthInFrames, m_audioStream;
-    QList <double>m_audioLevels;
-    QProcess *m_ffmpegProcess;
+    std::shared_ptr<AudioPeaks> m_audioPeaks;
+    // partial thumbnail computed by the job thread and not displayed yet
+    std::shared_ptr<AudioPeaks> m_partialPeaks;
+    QMutex m_partialMutex;
+    // partial thumbnail displayed in the clip
+    std::shared_ptr<AudioPeaks> m_displayedPeaks;
+    std::atomic<bool> m_canceled{false};
+
+signals:
+    void partialPeaksReady();
 };
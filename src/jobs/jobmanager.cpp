@@ -29,15 +29,21 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "undohelper.hpp"
 
 #include <KMessageWidget>
-#include <QFuture>
-#include <QFutureWatcher>
 #include <QThread>
 
+namespace {
+// Priority added to the jobs of the clip selected by the user
+const int priorityClipBoost = 10;
+} // namespace
+
 int JobManager::m_currentId = 0;
 JobManager::JobManager(QObject *parent)
     : QAbstractListModel(parent)
     , m_lock(QReadWriteLock::Recursive)
 {
+    // The jobs are run in the scheduler's threads, the results are processed in the main thread
+    connect(this, &JobManager::jobFinished, this, &JobManager::slotManageFinishedJob, Qt::QueuedConnection);
+    connect(this, &JobManager::jobCanceled, this, &JobManager::slotManageCanceledJob, Qt::QueuedConnection);
 }
 
 JobManager::~JobManager()
@@ -51,7 +57,7 @@ int JobManager::getBlockingJobId(const QString &id, AbstractClipJob::JOBTYPE typ
     std::vector<int> result;
     if (m_jobsByClip.count(id) > 0) {
         for (int jobId : m_jobsByClip.at(id)) {
-            if (!m_jobs.at(jobId)->m_future.isFinished() && !m_jobs.at(jobId)->m_future.isCanceled()) {
+            if (isActive(m_jobs.at(jobId))) {
                 if (type == AbstractClipJob::NOJOBTYPE || m_jobs.at(jobId)->m_type == type) {
                     return jobId;
                 }
@@ -67,7 +73,7 @@ std::vector<int> JobManager::getPendingJobsIds(const QString &id, AbstractClipJo
     std::vector<int> result;
     if (m_jobsByClip.count(id) > 0) {
         for (int jobId : m_jobsByClip.at(id)) {
-            if (!m_jobs.at(jobId)->m_future.isFinished() && !m_jobs.at(jobId)->m_future.isCanceled()) {
+            if (isActive(m_jobs.at(jobId))) {
                 if (type == AbstractClipJob::NOJOBTYPE || m_jobs.at(jobId)->m_type == type) {
                     result.push_back(jobId);
                 }
@@ -83,7 +89,7 @@ std::vector<int> JobManager::getFinishedJobsIds(const QString &id, AbstractClipJ
     std::vector<int> result;
     if (m_jobsByClip.count(id) > 0) {
         for (int jobId : m_jobsByClip.at(id)) {
-            if (m_jobs.at(jobId)->m_future.isFinished() || m_jobs.at(jobId)->m_future.isCanceled()) {
+            if (!isActive(m_jobs.at(jobId))) {
                 if (type == AbstractClipJob::NOJOBTYPE || m_jobs.at(jobId)->m_type == type) {
                     result.push_back(jobId);
                 }
@@ -101,10 +107,7 @@ void JobManager::discardJobs(const QString &binId, AbstractClipJob::JOBTYPE type
     }
     for (int jobId : m_jobsByClip.at(binId)) {
         if (type == AbstractClipJob::NOJOBTYPE || m_jobs.at(jobId)->m_type == type) {
-            for (const std::shared_ptr<AbstractClipJob> &job : m_jobs.at(jobId)->m_job) {
-                job->jobCanceled();
-            }
-            m_jobs.at(jobId)->m_future.cancel();
+            cancelJob(m_jobs.at(jobId));
         }
     }
 }
@@ -114,8 +117,7 @@ bool JobManager::hasPendingJob(const QString &clipId, AbstractClipJob::JOBTYPE t
     READ_LOCK();
     if (m_jobsByClip.count(clipId) > 0) {
         for (int jobId : m_jobsByClip.at(clipId)) {
-            if ((type == AbstractClipJob::NOJOBTYPE || m_jobs.at(jobId)->m_type == type) && !m_jobs.at(jobId)->m_future.isFinished() &&
-                !m_jobs.at(jobId)->m_future.isCanceled()) {
+            if ((type == AbstractClipJob::NOJOBTYPE || m_jobs.at(jobId)->m_type == type) && isActive(m_jobs.at(jobId))) {
                 if (foundId) {
                     *foundId = jobId;
                 }
@@ -134,13 +136,8 @@ void JobManager::updateJobCount()
     READ_LOCK();
     int count = 0;
     for (const auto &j : m_jobs) {
-        if (!j.second->m_future.isFinished() && !j.second->m_future.isCanceled()) {
+        if (isActive(j.second)) {
             count++;
-            /*for (int i = 0; i < j.second->m_future.future().resultCount(); ++i) {
-                if (j.second->m_future.future().isResultReadyAt(i)) {
-                    count++;
-                }
-            }*/
         }
     }
     // Set jobs count
@@ -187,10 +184,7 @@ void JobManager::slotDiscardClipJobs(const QString &binId)
     if (m_jobsByClip.count(binId) > 0) {
         for (int jobId : m_jobsByClip.at(binId)) {
             Q_ASSERT(m_jobs.count(jobId) > 0);
-            for (const std::shared_ptr<AbstractClipJob> &job : m_jobs.at(jobId)->m_job) {
-                job->jobCanceled();
-            }
-            m_jobs[jobId]->m_future.cancel();
+            cancelJob(m_jobs.at(jobId));
         }
     }
 }
@@ -199,11 +193,8 @@ void JobManager::slotCancelPendingJobs()
 {
     QWriteLocker locker(&m_lock);
     for (const auto &j : m_jobs) {
-        if (!j.second->m_future.isStarted()) {
-            for (const std::shared_ptr<AbstractClipJob> &job : j.second->m_job) {
-                job->jobCanceled();
-            }
-            j.second->m_future.cancel();
+        if (j.second->m_status == JobManagerStatus::Pending) {
+            cancelJob(j.second);
         }
     }
 }
@@ -212,38 +203,72 @@ void JobManager::slotCancelJobs()
 {
     QWriteLocker locker(&m_lock);
     for (const auto &j : m_jobs) {
-        for (const std::shared_ptr<AbstractClipJob> &job : j.second->m_job) {
-            job->jobCanceled();
-        }
-        j.second->m_future.cancel();
+        cancelJob(j.second);
+    }
+}
+
+bool JobManager::isActive(const std::shared_ptr<Job_t> &job)
+{
+    JobManagerStatus status = job->m_status;
+    return status == JobManagerStatus::Pending || status == JobManagerStatus::Running;
+}
+
+int JobManager::basePriority(AbstractClipJob::JOBTYPE type)
+{
+    switch (type) {
+    case AbstractClipJob::LOADJOB:
+        return 3;
+    case AbstractClipJob::THUMBJOB:
+        return 2;
+    case AbstractClipJob::AUDIOTHUMBJOB:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+JobScheduler::Resource JobManager::jobResource(AbstractClipJob::JOBTYPE type)
+{
+    switch (type) {
+    // These jobs wait for an ffmpeg or melt process
+    case AbstractClipJob::PROXYJOB:
+    case AbstractClipJob::CUTJOB:
+    case AbstractClipJob::TRANSCODEJOB:
+    case AbstractClipJob::FILTERCLIPJOB:
+    case AbstractClipJob::AUDIOTHUMBJOB:
+        return JobScheduler::Resource::IoBound;
+    default:
+        return JobScheduler::Resource::CpuBound;
+    }
+}
+
+void JobManager::scheduleJob(const std::shared_ptr<Job_t> &job, int parentId)
+{
+    QWriteLocker locker(&m_lock);
+    std::shared_ptr<Job_t> parent = (parentId != -1 && m_jobs.count(parentId) > 0) ? m_jobs.at(parentId) : nullptr;
+    if (parent && (parent->m_failed || parent->m_status == JobManagerStatus::Canceled)) {
+        cancelJob(job);
+    } else if (parent && !parent->m_processed) {
+        // The job will be started once its parent's results are committed
+        m_jobsByParents[parentId].push_back(job->m_id);
+    } else {
+        createJob(job);
     }
+    locker.unlock();
+    updateJobCount();
 }
 
 void JobManager::createJob(const std::shared_ptr<Job_t> &job)
 {
-    /*
-    // This thread wait mechanism was broken and caused a race condition locking the application
-    // so I switched to a simpler model
-    bool ok = false;
-    // wait for parents to finish
-    while (!ok) {
-        ok = true;
-        for (int p : parents) {
-            if (!m_jobs[p]->m_completionMutex.tryLock()) {
-                ok = false;
-                qDebug()<<"********\nWAITING FOR JOB COMPLETION MUTEX!!: "<<job->m_id<<" : "<<m_jobs[p]->m_id<<"="<<m_jobs[p]->m_type;
-                break;
-            } else {
-                qDebug()<<">>>>>>>>>>\nJOB COMPLETION MUTEX DONE: "<<job->m_id;
-                m_jobs[p]->m_completionMutex.unlock();
-            }
-        }
-        if (!ok) {
-            QThread::msleep(10);
-        }
-    }*/
+    if (!isActive(job)) {
+        return;
+    }
+    if (job->m_job.empty()) {
+        job->m_status = JobManagerStatus::Finished;
+        emit jobFinished(job->m_id);
+        return;
+    }
     // connect progress signals
-    QReadLocker locker(&m_lock);
     for (const auto &it : job->m_indices) {
         size_t i = it.second;
         auto binId = it.first;
@@ -252,21 +277,83 @@ void JobManager::createJob(const std::shared_ptr<Job_t> &job)
             pCore->projectItemModel()->onItemUpdated(binId, AbstractProjectItem::JobProgress);
         });
     }
-    connect(&job->m_future, &QFutureWatcher<bool>::started, this, &JobManager::updateJobCount);
-    connect(&job->m_future, &QFutureWatcher<bool>::finished, [this, id = job->m_id]() { slotManageFinishedJob(id); });
-    connect(&job->m_future, &QFutureWatcher<bool>::canceled, [this, id = job->m_id]() { slotManageCanceledJob(id); });
-    job->m_actualFuture = QtConcurrent::mapped(job->m_job, AbstractClipJob::execute);
-    job->m_future.setFuture(job->m_actualFuture);
-
-    // In the unlikely event that the job finished before the signal connection was made, we check manually for finish and cancel
-    /*if (job->m_future.isFinished()) {
-        //emit job->m_future.finished();
-        slotManageFinishedJob(job->m_id);
-    }
-    if (job->m_future.isCanceled()) {
-        //emit job->m_future.canceled();
-        slotManageCanceledJob(job->m_id);
-    }*/
+    job->m_priority = basePriority(job->m_type);
+    for (const auto &it : job->m_indices) {
+        if (it.first == m_priorityClip) {
+            job->m_priority += priorityClipBoost;
+            break;
+        }
+    }
+    JobScheduler::Resource resource = jobResource(job->m_type);
+    for (size_t i = 0; i < job->m_job.size(); ++i) {
+        m_scheduler.submit(job->m_id, resource, job->m_priority, [this, job, i]() {
+            JobManagerStatus expected = JobManagerStatus::Pending;
+            job->m_status.compare_exchange_strong(expected, JobManagerStatus::Running);
+            if (job->m_status != JobManagerStatus::Canceled) {
+                job->m_results[i] = AbstractClipJob::execute(job->m_job[i]) ? 1 : 0;
+            }
+            if (--job->m_remaining == 0) {
+                expected = JobManagerStatus::Running;
+                if (job->m_status.compare_exchange_strong(expected, JobManagerStatus::Finished)) {
+                    emit jobFinished(job->m_id);
+                }
+            }
+        });
+    }
+}
+
+void JobManager::cancelJob(const std::shared_ptr<Job_t> &job)
+{
+    for (const std::shared_ptr<AbstractClipJob> &clipJob : job->m_job) {
+        clipJob->jobCanceled();
+    }
+    m_scheduler.cancel(job->m_id);
+    JobManagerStatus status = job->m_status;
+    while (status == JobManagerStatus::Pending || status == JobManagerStatus::Running) {
+        if (job->m_status.compare_exchange_weak(status, JobManagerStatus::Canceled)) {
+            emit jobCanceled(job->m_id);
+            break;
+        }
+    }
+    // Children will never get the results they depend on
+    if (m_jobsByParents.count(job->m_id) > 0) {
+        std::vector<int> children = m_jobsByParents[job->m_id];
+        m_jobsByParents.erase(job->m_id);
+        for (int cid : children) {
+            cancelJob(m_jobs.at(cid));
+        }
+    }
+}
+
+void JobManager::prioritizeClip(const QString &binId)
+{
+    QWriteLocker locker(&m_lock);
+    if (binId == m_priorityClip) {
+        return;
+    }
+    // Jobs of the previous clip are back to their normal priority
+    for (const QString &clip : {m_priorityClip, binId}) {
+        if (m_jobsByClip.count(clip) == 0) {
+            continue;
+        }
+        int boost = clip == binId ? priorityClipBoost : 0;
+        for (int jobId : m_jobsByClip.at(clip)) {
+            if (m_jobs.count(jobId) == 0) {
+                continue;
+            }
+            const std::shared_ptr<Job_t> &job = m_jobs.at(jobId);
+            if (job->m_status == JobManagerStatus::Pending) {
+                job->m_priority = basePriority(job->m_type) + boost;
+                m_scheduler.setPriority(jobId, job->m_priority);
+            }
+        }
+    }
+    m_priorityClip = binId;
+}
+
+JobScheduler::Metrics JobManager::queueMetrics() const
+{
+    return m_scheduler.metrics();
 }
 
 void JobManager::slotManageCanceledJob(int id)
@@ -275,12 +362,10 @@ void JobManager::slotManageCanceledJob(int id)
     Q_ASSERT(m_jobs.count(id) > 0);
     if (m_jobs[id]->m_processed) return;
     m_jobs[id]->m_processed = true;
-    //m_jobs[id]->m_completionMutex.unlock(); // crashing on Windows
     // send notification to refresh view
     for (const auto &it : m_jobs[id]->m_indices) {
         pCore->projectItemModel()->onItemUpdated(it.first, AbstractProjectItem::JobStatus);
     }
-    // TODO: delete child jobs
     updateJobCount();
 }
 void JobManager::slotManageFinishedJob(int id)
@@ -295,16 +380,26 @@ void JobManager::slotManageFinishedJob(int id)
         pCore->projectItemModel()->onItemUpdated(it.first, AbstractProjectItem::JobStatus);
     }
     bool ok = true;
-    for (bool res : m_jobs[id]->m_future.future()) {
-        ok = ok && res;
+    for (char res : m_jobs[id]->m_results) {
+        ok = ok && res != 0;
     }
     Fun undo = []() { return true; };
     Fun redo = []() { return true; };
     if (!ok) {
         qDebug() << " * * * ** * * *\nWARNING + + +\nJOB NOT CORRECT FINISH: " << id << "\n------------------------";
-        // TODO: delete child jobs
-        m_jobs[id]->m_completionMutex.unlock();
+        m_jobs[id]->m_processed = true;
+        m_jobs[id]->m_failed = true;
         locker.unlock();
+        {
+            QWriteLocker writeLocker(&m_lock);
+            if (m_jobsByParents.count(id) > 0) {
+                std::vector<int> children = m_jobsByParents[id];
+                m_jobsByParents.erase(id);
+                for (int cid : children) {
+                    cancelJob(m_jobs.at(cid));
+                }
+            }
+        }
         if (m_jobs.at(id)->m_type == AbstractClipJob::LOADJOB) {
             // loading failed, remove clip
             for (const auto &it : m_jobs[id]->m_indices) {
@@ -359,17 +454,22 @@ void JobManager::slotManageFinishedJob(int id)
             }
         }
     }
-    m_jobs[id]->m_completionMutex.unlock();
     if (ok && !m_jobs[id]->m_undoString.isEmpty()) {
         pCore->pushUndo(undo, redo, m_jobs[id]->m_undoString);
     }
+    QWriteLocker writeLocker(&m_lock);
     if (m_jobsByParents.count(id) > 0) {
         std::vector<int> children = m_jobsByParents[id];
+        m_jobsByParents.erase(id);
         for (int cid : children) {
-            QtConcurrent::run(this, &JobManager::createJob, m_jobs[cid]);
+            if (ok) {
+                createJob(m_jobs[cid]);
+            } else {
+                cancelJob(m_jobs[cid]);
+            }
         }
-        m_jobsByParents.erase(id);
     }
+    writeLocker.unlock();
     updateJobCount();
 }
 
@@ -384,17 +484,7 @@ JobManagerStatus JobManager::getJobStatus(int jobId) const
 {
     READ_LOCK();
     Q_ASSERT(m_jobs.count(jobId) > 0);
-    auto job = m_jobs.at(jobId);
-    if (job->m_future.isFinished()) {
-        return JobManagerStatus::Finished;
-    }
-    if (job->m_future.isCanceled()) {
-        return JobManagerStatus::Canceled;
-    }
-    if (job->m_future.isRunning()) {
-        return JobManagerStatus::Running;
-    }
-    return JobManagerStatus::Pending;
+    return m_jobs.at(jobId)->m_status;
 }
 
 bool JobManager::jobSucceded(int jobId) const
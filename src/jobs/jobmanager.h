@@ -25,11 +25,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "abstractclipjob.h"
 #include "definitions.h"
+#include "jobscheduler.hpp"
 
 #include <QAbstractListModel>
-#include <QFutureWatcher>
 #include <QObject>
 #include <QReadWriteLock>
+#include <atomic>
 #include <map>
 #include <memory>
 #include <unordered_map>
@@ -49,10 +50,11 @@ struct Job_t
 {
     std::vector<std::shared_ptr<AbstractClipJob>> m_job; // List of the jobs
     std::vector<int> m_progress;                         // progress of the job, for each clip
-    std::unordered_map<QString, size_t> m_indices;       // keys are binIds, value are ids in the vectors m_job and m_progress;
-    QFutureWatcher<bool> m_future;                       // future of the job
-    QFuture<bool> m_actualFuture;
-    QMutex m_completionMutex; // mutex that is locked during execution of the process
+    std::vector<char> m_results;                         // result of the job, for each clip
+    std::unordered_map<QString, size_t> m_indices;       // keys are binIds, value are ids in the vectors m_job, m_progress and m_results;
+    std::atomic<JobManagerStatus> m_status{JobManagerStatus::Pending};
+    std::atomic<int> m_remaining{0}; // number of clips not processed yet
+    int m_priority = 0;
     AbstractClipJob::JOBTYPE m_type;
     QString m_undoString;
     int m_id;
@@ -132,14 +134,28 @@ public:
     /** @brief return the message of a given job on a given clip (message, detailed log)*/
     QPair<QString, QString> getJobMessageForClip(int jobId, const QString &binId) const;
 
+    /** @brief Run the pending jobs of a clip before the background ones, for example because it is displayed */
+    void prioritizeClip(const QString &binId);
+
+    /** @brief return the queue depth and wait time of the jobs waiting for a thread */
+    JobScheduler::Metrics queueMetrics() const;
+
     // Mandatory overloads
     QVariant data(const QModelIndex &index, int role) const override;
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
 
 protected:
-    // Helper function to launch a given job.
-    // This has to be launched asynchrnously since it blocks until all parents are finished
+    // Launch a job once its parent is done, or queue it as a child of its parent otherwise
+    void scheduleJob(const std::shared_ptr<Job_t> &job, int parentId);
+    // Helper function to launch a given job, once all its parents are finished. m_lock must be locked for writing
     void createJob(const std::shared_ptr<Job_t> &job);
+    // Cancel a pending or running job and its children. m_lock must be locked for writing
+    void cancelJob(const std::shared_ptr<Job_t> &job);
+    // Returns true if the job is pending or running
+    static bool isActive(const std::shared_ptr<Job_t> &job);
+    // Jobs needed to display a clip are run first
+    static int basePriority(AbstractClipJob::JOBTYPE type);
+    static JobScheduler::Resource jobResource(AbstractClipJob::JOBTYPE type);
 
     void updateJobCount();
 
@@ -164,9 +180,16 @@ private:
     /** @brief List of all the jobs by clip. */
     std::unordered_map<QString, std::vector<int>> m_jobsByClip;
     std::unordered_map<int, std::vector<int>> m_jobsByParents;
+    /** @brief Clip whose jobs are run first */
+    QString m_priorityClip;
+    /** @brief This runs the jobs. It must be the last member, so that it waits for the running jobs before the others are destroyed */
+    JobScheduler m_scheduler;
 
 signals:
     void jobCount(int);
+    /** @brief Sent from the worker threads when all the clips of a job are processed, or when it is canceled */
+    void jobFinished(int id);
+    void jobCanceled(int id);
 };
 
 #include "jobmanager.ipp"
@@ -20,7 +20,6 @@ You should have received a copy of the GNU General Public License
 along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
-#include <QtConcurrent>
 #include <type_traits>
 template <typename T, typename... Args>
 int JobManager::startJob(const std::vector<QString> &binIds, int parentId, QString undoString,
@@ -30,16 +29,17 @@ int JobManager::startJob(const std::vector<QString> &binIds, int parentId, QStri
     // QWriteLocker locker(&m_lock);
     int jobId = m_currentId++;
     std::shared_ptr<Job_t> job(new Job_t());
-    job->m_completionMutex.lock();
     job->m_undoString = std::move(undoString);
     job->m_id = jobId;
     for (const auto &id : binIds) {
         job->m_job.push_back(createFn(id, args...));
         job->m_progress.push_back(0);
+        job->m_results.push_back(0);
         job->m_indices[id] = size_t(int(job->m_job.size()) - 1);
         job->m_type = job->m_job.back()->jobType();
         m_jobsByClip[id].push_back(jobId);
     }
+    job->m_remaining = int(job->m_job.size());
     m_lock.lockForWrite();
     int insertionRow = static_cast<int>(m_jobs.size());
     beginInsertRows(QModelIndex(), insertionRow, insertionRow);
@@ -47,14 +47,7 @@ int JobManager::startJob(const std::vector<QString> &binIds, int parentId, QStri
     m_jobs[jobId] = job;
     endInsertRows();
     m_lock.unlock();
-    if (parentId == -1 || m_jobs[parentId]->m_completionMutex.tryLock()) {
-        if (parentId != -1) {
-            m_jobs[parentId]->m_completionMutex.unlock();
-        }
-        QtConcurrent::run(this, &JobManager::createJob, job);
-    } else {
-        m_jobsByParents[parentId].push_back(jobId);
-    }
+    scheduleJob(job, parentId);
     return jobId;
 }
 
@@ -0,0 +1,189 @@
+/***************************************************************************
+ *   Copyright (C) 2019 by Kdenlive contributors                           *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "jobscheduler.hpp"
+#include <QRunnable>
+#include <QThread>
+#include <algorithm>
+
+class JobScheduler::Runner : public QRunnable
+{
+public:
+    Runner(JobScheduler *scheduler, Task &&task)
+        : m_scheduler(scheduler)
+        , m_task(std::move(task))
+    {
+    }
+
+    void run() override
+    {
+        m_task.run();
+        m_scheduler->taskDone(m_task.resource);
+    }
+
+private:
+    JobScheduler *m_scheduler;
+    Task m_task;
+};
+
+qint64 JobScheduler::Metrics::averageWait() const
+{
+    return started > 0 ? totalWait / started : 0;
+}
+
+JobScheduler::JobScheduler()
+{
+    int threads = QThread::idealThreadCount();
+    m_limits[int(Resource::CpuBound)] = std::max(1, threads);
+    // External processes are mostly multithreaded themselves, running too many of them only makes each one slower
+    m_limits[int(Resource::IoBound)] = std::max(2, threads / 2);
+    updatePoolSize();
+}
+
+JobScheduler::~JobScheduler()
+{
+    m_mutex.lock();
+    for (auto &queue : m_queues) {
+        queue.clear();
+    }
+    m_mutex.unlock();
+    m_pool.waitForDone();
+}
+
+void JobScheduler::updatePoolSize()
+{
+    // Each resource must be able to reach its limit whatever the others do
+    m_pool.setMaxThreadCount(m_limits[0] + m_limits[1]);
+}
+
+void JobScheduler::setLimit(Resource resource, int limit)
+{
+    QMutexLocker locker(&m_mutex);
+    m_limits[int(resource)] = std::max(1, limit);
+    updatePoolSize();
+    dispatch();
+}
+
+int JobScheduler::limit(Resource resource) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_limits[int(resource)];
+}
+
+void JobScheduler::submit(int group, Resource resource, int priority, std::function<void()> task)
+{
+    QMutexLocker locker(&m_mutex);
+    Task t{group, resource, QElapsedTimer(), std::move(task)};
+    t.queued.start();
+    m_queues[int(resource)].emplace(Key(-priority, m_sequence++), std::move(t));
+    dispatch();
+}
+
+int JobScheduler::cancel(int group)
+{
+    QMutexLocker locker(&m_mutex);
+    int count = 0;
+    for (auto &queue : m_queues) {
+        for (auto it = queue.begin(); it != queue.end();) {
+            if (it->second.group == group) {
+                it = queue.erase(it);
+                ++count;
+            } else {
+                ++it;
+            }
+        }
+    }
+    return count;
+}
+
+void JobScheduler::setPriority(int group, int priority)
+{
+    QMutexLocker locker(&m_mutex);
+    for (auto &queue : m_queues) {
+        std::vector<std::pair<Key, Task>> moved;
+        for (auto it = queue.begin(); it != queue.end();) {
+            if (it->second.group == group && it->first.first != -priority) {
+                // Keep the submission order among the tasks of the new priority
+                moved.emplace_back(Key(-priority, it->first.second), std::move(it->second));
+                it = queue.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        for (auto &task : moved) {
+            queue.emplace(task.first, std::move(task.second));
+        }
+    }
+}
+
+void JobScheduler::dispatch()
+{
+    for (int r = 0; r < 2; ++r) {
+        auto &queue = m_queues[r];
+        Metrics &metrics = m_metrics[r];
+        while (!queue.empty() && metrics.running < m_limits[r]) {
+            auto it = queue.begin();
+            Task task = std::move(it->second);
+            queue.erase(it);
+            qint64 wait = task.queued.elapsed();
+            metrics.running++;
+            metrics.started++;
+            metrics.totalWait += wait;
+            metrics.maxWait = std::max(metrics.maxWait, wait);
+            m_pool.start(new Runner(this, std::move(task)));
+        }
+    }
+}
+
+void JobScheduler::taskDone(Resource resource)
+{
+    QMutexLocker locker(&m_mutex);
+    m_metrics[int(resource)].running--;
+    dispatch();
+}
+
+JobScheduler::Metrics JobScheduler::metrics(Resource resource) const
+{
+    QMutexLocker locker(&m_mutex);
+    Metrics result = m_metrics[int(resource)];
+    result.queued = int(m_queues[int(resource)].size());
+    return result;
+}
+
+JobScheduler::Metrics JobScheduler::metrics() const
+{
+    Metrics result;
+    for (Resource resource : {Resource::CpuBound, Resource::IoBound}) {
+        Metrics m = metrics(resource);
+        result.queued += m.queued;
+        result.running += m.running;
+        result.started += m.started;
+        result.totalWait += m.totalWait;
+        result.maxWait = std::max(result.maxWait, m.maxWait);
+    }
+    return result;
+}
+
+bool JobScheduler::waitForDone(int msecs)
+{
+    // Finished tasks dispatch the pending ones before returning, so the pool only becomes idle once the queues are empty
+    return m_pool.waitForDone(msecs);
+}
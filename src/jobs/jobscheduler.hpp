@@ -0,0 +1,108 @@
+/***************************************************************************
+ *   Copyright (C) 2019 by Kdenlive contributors                           *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QThreadPool>
+#include <functional>
+#include <map>
+
+/* @brief This class runs the tasks of the clip jobs on a dedicated thread pool.
+   Tasks never block waiting for each other: dependencies are handled by the caller, that only submits a task once it can run.
+   Pending tasks are run by decreasing priority, and in submission order for a given priority.
+   Each kind of resource has its own concurrency limit, so that tasks waiting on an external process don't prevent the in-process ones to run.
+   This class is thread safe.
+ */
+class JobScheduler
+{
+
+public:
+    /* @brief The kind of work done by a task */
+    enum class Resource {
+        CpuBound = 0, // Work done in process, like MLT producers and consumers
+        IoBound = 1   // Tasks mostly waiting on an external process (ffmpeg, melt) or on the disk
+    };
+
+    struct Metrics
+    {
+        int queued{0};       // number of pending tasks
+        int running{0};      // number of running tasks
+        int started{0};      // number of tasks started since the creation of the scheduler
+        qint64 totalWait{0}; // total time spent by the started tasks in the queue, in ms
+        qint64 maxWait{0};   // longest time spent by a task in the queue, in ms
+        /* @brief Returns the average time spent by the started tasks in the queue, in ms */
+        qint64 averageWait() const;
+    };
+
+    JobScheduler();
+    /* @brief Drops the pending tasks and waits for the running ones */
+    ~JobScheduler();
+
+    /* @brief Sets the maximum number of tasks of a given resource running at the same time */
+    void setLimit(Resource resource, int limit);
+    int limit(Resource resource) const;
+
+    /* @brief Queues a task
+       @param group identifies the tasks that are canceled or reprioritized together
+       @param priority tasks with a higher priority are started first
+     */
+    void submit(int group, Resource resource, int priority, std::function<void()> task);
+
+    /* @brief Removes the pending tasks of a group, running ones are not affected. Returns the number of removed tasks */
+    int cancel(int group);
+
+    /* @brief Changes the priority of the pending tasks of a group */
+    void setPriority(int group, int priority);
+
+    /* @brief Returns the metrics of a given resource, or the sum for all resources */
+    Metrics metrics(Resource resource) const;
+    Metrics metrics() const;
+
+    /* @brief Waits until all the tasks are done. Returns false on timeout */
+    bool waitForDone(int msecs = -1);
+
+protected:
+    struct Task
+    {
+        int group;
+        Resource resource;
+        QElapsedTimer queued;
+        std::function<void()> run;
+    };
+    class Runner;
+    // Pending tasks are sorted by decreasing priority, then by submission order
+    using Key = std::pair<int, quint64>;
+
+    /* @brief Starts pending tasks until the limits are reached. The mutex must be locked */
+    void dispatch();
+    /* @brief Called by the pool threads when a task is done */
+    void taskDone(Resource resource);
+    void updatePoolSize();
+
+    mutable QMutex m_mutex;
+    std::map<Key, Task> m_queues[2];
+    int m_limits[2];
+    Metrics m_metrics[2];
+    quint64 m_sequence{0};
+    QThreadPool m_pool;
+};
@@ -27,6 +27,7 @@
 #include "kdenlive_debug.h"
 #include "kdenlivesettings.h"
 #include "macros.hpp"
+#include "utils/proxystore.hpp"
 
 #include <QProcess>
 #include <QTemporaryFile>
@@ -370,6 +371,13 @@ bool ProxyJob::commitResult(Fun &undo, Fun &redo)
     bool ok = operation();
     if (ok) {
         UPDATE_UNDO_REDO_NOLOCK(operation, reverse, undo, redo);
+        // The proxy may live in the shared proxy folder, record that this project uses it
+        std::unique_ptr<ProxyStore> store = pCore->currentDoc()->proxyStore();
+        if (store) {
+            auto binClip = pCore->projectItemModel()->getClipByBinID(m_clipId);
+            store->addReference(binClip->getProducerProperty(QStringLiteral("kdenlive:proxy")),
+                                pCore->currentDoc()->getDocumentProperty(QStringLiteral("documentid")));
+        }
     }
     return ok;
     return true;
@@ -9,13 +9,52 @@ the Free Software Foundation, either version 3 of the License, or
 */
 
 #include "audioCorrelation.h"
-#include "fftCorrelation.h"
 
 #include "kdenlive_debug.h"
 #include "klocalizedstring.h"
 #include <QTime>
+#include <QtConcurrent>
+#include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <limits>
+
+namespace {
+/* Sums the values of each block of factor entries */
+std::vector<qint64> decimate(const std::vector<qint64> &envelope, size_t factor)
+{
+    std::vector<qint64> decimated((envelope.size() + factor - 1) / factor, 0);
+    for (size_t i = 0; i < envelope.size(); ++i) {
+        decimated[i / factor] += envelope[i];
+    }
+    return decimated;
+}
+} // namespace
+
+AudioCorrelation::References::References(const std::vector<qint64> &envelope)
+    : m_envelope(envelope)
+{
+}
+
+const std::vector<qint64> &AudioCorrelation::References::envelope() const
+{
+    return m_envelope;
+}
+
+const FFTCorrelation::Reference &AudioCorrelation::References::at(size_t factor)
+{
+    QMutexLocker lock(&m_mutex);
+    std::unique_ptr<FFTCorrelation::Reference> &reference = m_spectra[factor];
+    if (!reference) {
+        if (factor == 1) {
+            reference.reset(new FFTCorrelation::Reference(m_envelope.data(), m_envelope.size()));
+        } else {
+            const std::vector<qint64> decimated = decimate(m_envelope, factor);
+            reference.reset(new FFTCorrelation::Reference(decimated.data(), decimated.size()));
+        }
+    }
+    return *reference;
+}
 
 AudioCorrelation::AudioCorrelation(std::unique_ptr<AudioEnvelope> mainTrackEnvelope)
     : m_mainTrackEnvelope(std::move(mainTrackEnvelope))
@@ -27,6 +66,13 @@ AudioCorrelation::AudioCorrelation(std::unique_ptr<AudioEnvelope> mainTrackEnvel
 
 AudioCorrelation::~AudioCorrelation()
 {
+    // The correlations still running use the main envelope
+    for (auto it = m_pending.constBegin(); it != m_pending.constEnd(); ++it) {
+        it.key()->waitForFinished();
+        delete it.key()->result();
+        delete it.key();
+        delete it.value();
+    }
     for (AudioEnvelope *envelope : m_children) {
         delete envelope;
     }
@@ -54,33 +100,37 @@ void AudioCorrelation::addChild(AudioEnvelope *envelope)
 
 void AudioCorrelation::slotProcessChild(AudioEnvelope *envelope)
 {
-    // Note that at this point the computation of the envelope of the
-    // main track might not be finished. envelope() will block until
-    // the computation is done.
-    const size_t sizeMain = m_mainTrackEnvelope->envelope().size();
-    const size_t sizeSub = envelope->envelope().size();
-
-    auto *info = new AudioCorrelationInfo(sizeMain, sizeSub);
-    qint64 *correlation = info->correlationVector();
+    // The correlation runs in a worker thread, so that several children
+    // are correlated at once. Note that at this point the computation of
+    // the envelope of the main track might not be finished.
+    auto *watcher = new QFutureWatcher<AudioCorrelationInfo *>();
+    m_pending.insert(watcher, envelope);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher]() {
+        AudioEnvelope *child = m_pending.take(watcher);
+        m_children.append(child);
+        m_correlations.append(watcher->result());
+        watcher->deleteLater();
+        Q_ASSERT(m_correlations.size() == m_children.size());
+        int shift = getShift(m_children.size() - 1);
+        emit gotAudioAlignData(child->clipId(), shift);
+    });
+    watcher->setFuture(QtConcurrent::run(this, &AudioCorrelation::computeCorrelation, envelope));
+}
 
+AudioCorrelationInfo *AudioCorrelation::computeCorrelation(AudioEnvelope *envelope)
+{
+    // envelope() blocks until the computation is done.
     const std::vector<qint64> &envMain = m_mainTrackEnvelope->envelope();
     const std::vector<qint64> &envSub = envelope->envelope();
-    qint64 max = 0;
-
-    if (sizeSub > 200) {
-        FFTCorrelation::correlate(&envMain[0], sizeMain, &envSub[0], sizeSub, correlation);
-    } else {
-        correlate(&envMain[0], sizeMain, &envSub[0], sizeSub, correlation, &max);
-        info->setMax(max);
+    auto *info = new AudioCorrelationInfo(envMain.size(), envSub.size());
+    {
+        QMutexLocker lock(&m_referencesMutex);
+        if (!m_references) {
+            m_references.reset(new References(envMain));
+        }
     }
-
-    m_children.append(envelope);
-    m_correlations.append(info);
-
-    Q_ASSERT(m_correlations.size() == m_children.size());
-    int index = m_children.indexOf(envelope);
-    int shift = getShift(index);
-    emit gotAudioAlignData(envelope->clipId(), shift);
+    correlateCoarseToFine(*m_references, envSub, info->correlationVector());
+    return info;
 }
 
 int AudioCorrelation::getShift(int childIndex) const
@@ -103,10 +153,70 @@ AudioCorrelationInfo const *AudioCorrelation::info(int childIndex) const
     return m_correlations.at(childIndex);
 }
 
+size_t AudioCorrelation::decimationFactor(size_t sizeMain, size_t sizeSub, size_t coarseSize)
+{
+    const size_t largestSize = std::max(sizeMain, sizeSub);
+    size_t factor = 1;
+    while (largestSize > coarseSize * factor) {
+        factor = factor << 1;
+    }
+    return factor;
+}
+
+void AudioCorrelation::correlateCoarseToFine(References &references, const std::vector<qint64> &envSub, qint64 *correlation, size_t coarseSize)
+{
+    const std::vector<qint64> &envMain = references.envelope();
+    const size_t sizeMain = envMain.size();
+    const size_t sizeSub = envSub.size();
+    if (sizeMain == 0 || sizeSub == 0) {
+        std::fill(correlation, correlation + sizeMain + sizeSub + 1, 0);
+        return;
+    }
+    const size_t factor = decimationFactor(sizeMain, sizeSub, coarseSize);
+    if (factor == 1) {
+        FFTCorrelation::correlate(references.at(1), &envSub[0], sizeSub, correlation);
+        return;
+    }
+
+    QTime t;
+    t.start();
+    // Find the best shift at the reduced resolution
+    const std::vector<qint64> coarseSub = decimate(envSub, factor);
+    const FFTCorrelation::Reference &coarseMain = references.at(factor);
+    std::vector<float> coarse(coarseMain.size() + coarseSub.size() + 1);
+    FFTCorrelation::correlate(coarseMain, &coarseSub[0], coarseSub.size(), &coarse[0]);
+    const int coarseShift = int(std::max_element(coarse.begin(), coarse.end()) - coarse.begin()) - (int)coarseSub.size();
+
+    // Then refine it around the coarse match. The blocks may start up to one block apart
+    // from the actual shift, and one more block is taken for safety.
+    // The other shifts must never be picked as the best match, even if all the computed correlations are negative.
+    std::fill(correlation, correlation + sizeMain + sizeSub + 1, std::numeric_limits<qint64>::min());
+    const int firstShift = std::max(-(int)sizeSub, (coarseShift - 2) * (int)factor);
+    const int lastShift = std::min((int)sizeMain, (coarseShift + 2) * (int)factor);
+    correlateRange(&envMain[0], sizeMain, &envSub[0], sizeSub, firstShift, lastShift, correlation);
+    qCDebug(KDENLIVE_LOG) << "Coarse to fine correlation (factor" << factor << ") calculated. Time taken: " << t.elapsed() << " ms.";
+}
+
 void AudioCorrelation::correlate(const qint64 *envMain, size_t sizeMain, const qint64 *envSub, size_t sizeSub, qint64 *correlation, qint64 *out_max)
 {
     Q_ASSERT(correlation != nullptr);
 
+    QTime t;
+    t.start();
+    qint64 max = correlateRange(envMain, sizeMain, envSub, sizeSub, -(int)sizeSub, (int)sizeMain, correlation);
+    for (size_t i = 0; i <= sizeMain + sizeSub; ++i) {
+        correlation[i] = qAbs(correlation[i]);
+    }
+    qCDebug(KDENLIVE_LOG) << "Correlation calculated. Time taken: " << t.elapsed() << " ms.";
+
+    if (out_max != nullptr) {
+        *out_max = max;
+    }
+}
+
+qint64 AudioCorrelation::correlateRange(const qint64 *envMain, size_t sizeMain, const qint64 *envSub, size_t sizeSub, int firstShift, int lastShift,
+                                        qint64 *correlation)
+{
     qint64 const *left;
     qint64 const *right;
     int size;
@@ -128,10 +238,7 @@ void AudioCorrelation::correlate(const qint64 *envMain, size_t sizeMain, const q
 
     */
 
-    QTime t;
-    t.start();
-    for (int shift = -(int)sizeSub; shift <= (int)sizeMain; ++shift) {
-
+    for (int shift = firstShift; shift <= lastShift; ++shift) {
         if (shift <= 0) {
             left = envSub - shift;
             right = envMain;
@@ -148,15 +255,11 @@ void AudioCorrelation::correlate(const qint64 *envMain, size_t sizeMain, const q
             left++;
             right++;
         }
-        correlation[sizeSub + (size_t)shift] = (qint64)qAbs(sum);
+        correlation[sizeSub + (size_t)shift] = sum;
 
         if (sum > max) {
             max = sum;
         }
     }
-    qCDebug(KDENLIVE_LOG) << "Correlation calculated. Time taken: " << t.elapsed() << " ms.";
-
-    if (out_max != nullptr) {
-        *out_max = max;
-    }
+    return max;
 }
@@ -14,7 +14,12 @@
 #include "audioCorrelationInfo.h"
 #include "audioEnvelope.h"
 #include "definitions.h"
+#include "fftCorrelation.h"
+#include <QFutureWatcher>
 #include <QList>
+#include <QMap>
+#include <QMutex>
+#include <map>
 
 /**
   This class does the correlation between two tracks
@@ -22,6 +27,9 @@
 
   It uses one main track (used in the initializer); further tracks will be
   aligned relative to this main track.
+
+  The children are correlated concurrently, all of them against the
+  same precomputed spectrum of the main track.
   */
 class AudioCorrelation : public QObject
 {
@@ -62,8 +70,62 @@ public:
       */
     static void correlate(const qint64 *envMain, size_t sizeMain, const qint64 *envSub, size_t sizeSub, qint64 *correlation, qint64 *out_max = nullptr);
 
+    /**
+      The spectra of a reference envelope at each resolution used by
+      correlateCoarseToFine(). They are computed on first use, and can be
+      shared by several threads.
+      */
+    class References
+    {
+    public:
+        /** The envelope must outlive this object */
+        explicit References(const std::vector<qint64> &envelope);
+
+        const std::vector<qint64> &envelope() const;
+        /** Returns the reference decimated by the given factor */
+        const FFTCorrelation::Reference &at(size_t factor);
+
+    private:
+        const std::vector<qint64> &m_envelope;
+        QMutex m_mutex;
+        std::map<size_t, std::unique_ptr<FFTCorrelation::Reference>> m_spectra;
+    };
+
+    /**
+      Correlates \c envSub against the reference, filling \c correlation
+      like correlate(). When the envelopes are longer than \c coarseSize,
+      they are first aligned at a resolution reduced to fit in \c coarseSize
+      and only the shifts close to the best coarse match are then computed at
+      full resolution. As with FFTCorrelation, the correlations are signed,
+      and the other entries of \c correlation are set to the lowest qint64
+      value so that they are never picked by AudioCorrelationInfo::maxIndex().
+      */
+    static void correlateCoarseToFine(References &references, const std::vector<qint64> &envSub, qint64 *correlation, size_t coarseSize = 1 << 15);
+
+    /**
+      Returns the smallest power of 2 by which envelopes of the given sizes
+      must be decimated so that they fit in \c coarseSize.
+      */
+    static size_t decimationFactor(size_t sizeMain, size_t sizeSub, size_t coarseSize);
+
 private:
+    /**
+      Computes the signed correlations of the shifts in [firstShift, lastShift] only,
+      see correlate(). Returns the largest one.
+      */
+    static qint64 correlateRange(const qint64 *envMain, size_t sizeMain, const qint64 *envSub, size_t sizeSub, int firstShift, int lastShift,
+                                 qint64 *correlation);
+
+    /**
+      Correlates a child envelope against the main one, in a worker thread.
+      Blocks until both envelopes are computed.
+      */
+    AudioCorrelationInfo *computeCorrelation(AudioEnvelope *envelope);
+
     std::unique_ptr<AudioEnvelope> m_mainTrackEnvelope;
+    QMutex m_referencesMutex;
+    std::unique_ptr<References> m_references;
+    QMap<QFutureWatcher<AudioCorrelationInfo *> *, AudioEnvelope *> m_pending;
 
     QList<AudioEnvelope *> m_children;
     QList<AudioCorrelationInfo *> m_correlations;
@@ -71,7 +133,7 @@ private:
 private slots:
     /**
      This is invoked when the child envelope is computed. This
-     triggers the actual computations of the cross-correlation for
+     starts the actual computations of the cross-correlation for
      aligning the envelope to the reference envelope.
 
      Takes ownership of @p envelope.
@@ -10,6 +10,8 @@
 
 #include "audioCorrelationInfo.h"
 
+#include <limits>
+
 AudioCorrelationInfo::AudioCorrelationInfo(size_t mainSize, size_t subSize)
     : m_mainSize(mainSize)
     , m_subSize(subSize)
@@ -51,7 +53,8 @@ qint64 AudioCorrelationInfo::max() const
 
 size_t AudioCorrelationInfo::maxIndex() const
 {
-    qint64 max = 0;
+    // Correlations computed with FFT may all be negative
+    qint64 max = std::numeric_limits<qint64>::min();
     size_t index = 0;
     size_t width = size();
 
@@ -13,13 +13,25 @@
 #include "bin/bin.h"
 #include "bin/projectclip.h"
 #include "core.h"
+#include "doc/kdenlivedoc.h"
 #include "kdenlive_debug.h"
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
 #include <QImage>
+#include <QSaveFile>
 #include <QTime>
 #include <QtConcurrent>
 #include <algorithm>
 #include <cmath>
 #include <memory>
+
+namespace {
+// Envelope cache files are a local cache, so the values are written with the native byte order
+const quint32 envelopeMagic = 0x4b454e56; // KENV
+const quint32 envelopeVersion = 1;
+} // namespace
+
 AudioEnvelope::AudioEnvelope(const QString &binId, int clipId, size_t offset, size_t length, size_t startPos)
     : m_offset(offset)
     , m_clipId(clipId)
@@ -34,6 +46,18 @@ AudioEnvelope::AudioEnvelope(const QString &binId, int clipId, size_t offset, si
     }
     m_envelopeSize = m_producer->get_playtime();
 
+    // The envelopes are cached in the project's audio cache folder, keyed by the clip hash
+    bool ok = false;
+    QDir cacheFolder = pCore->currentDoc()->getCacheDir(CacheAudio, &ok);
+    const QString clipHash = clip->hash();
+    if (ok && !clipHash.isEmpty()) {
+        QString name = QStringLiteral("%1_%2_%3").arg(clipHash).arg(clip->getProducerIntProperty(QStringLiteral("audio_index"))).arg(m_producer->get_fps());
+        if (length > 2000) {
+            name.append(QStringLiteral("_%1_%2").arg(offset).arg(length));
+        }
+        m_cachePath = cacheFolder.absoluteFilePath(name + QStringLiteral(".envelope"));
+    }
+
     m_producer->set("set.test_image", 1);
     connect(&m_watcher, &QFutureWatcherBase::finished, this, [this] { envelopeReady(this); });
     if (!m_producer || !m_producer->is_valid()) {
@@ -100,6 +124,25 @@ AudioEnvelope::AudioSummary AudioEnvelope::loadAndNormalizeEnvelope() const
     if (!m_info || m_info->size() < 1) {
         return summary;
     }
+    if (!loadCachedEnvelope(summary.audioAmplitudes)) {
+        computeEnvelope(summary.audioAmplitudes);
+        saveCachedEnvelope(summary.audioAmplitudes);
+    }
+    qCDebug(KDENLIVE_LOG) << "Normalizing envelope ...";
+    const qint64 meanBeforeNormalization =
+        std::accumulate(summary.audioAmplitudes.begin(), summary.audioAmplitudes.end(), 0LL) / (qint64)summary.audioAmplitudes.size();
+
+    // Normalize the envelope.
+    summary.amplitudeMax = 0;
+    for (size_t i = 0; i < summary.audioAmplitudes.size(); ++i) {
+        summary.audioAmplitudes[i] -= meanBeforeNormalization;
+        summary.amplitudeMax = std::max(summary.amplitudeMax, qAbs(summary.audioAmplitudes[i]));
+    }
+    return summary;
+}
+
+void AudioEnvelope::computeEnvelope(std::vector<qint64> &amplitudes) const
+{
     int samplingRate = m_info->info(0)->samplingRate();
     mlt_audio_format format_s16 = mlt_audio_s16;
     int channels = 1;
@@ -107,29 +150,60 @@ AudioEnvelope::AudioSummary AudioEnvelope::loadAndNormalizeEnvelope() const
     QTime t;
     t.start();
     m_producer->seek(0);
-    for (size_t i = 0; i < summary.audioAmplitudes.size(); ++i) {
+    for (size_t i = 0; i < amplitudes.size(); ++i) {
         std::unique_ptr<Mlt::Frame> frame(m_producer->get_frame((int)i));
         qint64 position = mlt_frame_get_position(frame->get_frame());
         int samples = mlt_sample_calculator(m_producer->get_fps(), samplingRate, position);
         auto *data = static_cast<qint16 *>(frame->get_audio(format_s16, samplingRate, channels, samples));
 
-        summary.audioAmplitudes[i] = 0;
+        amplitudes[i] = 0;
         for (int k = 0; k < samples; ++k) {
-            summary.audioAmplitudes[i] += abs(data[k]);
+            amplitudes[i] += abs(data[k]);
         }
     }
     qCDebug(KDENLIVE_LOG) << "Calculating the envelope (" << m_envelopeSize << " frames) took " << t.elapsed() << " ms.";
-    qCDebug(KDENLIVE_LOG) << "Normalizing envelope ...";
-    const qint64 meanBeforeNormalization =
-        std::accumulate(summary.audioAmplitudes.begin(), summary.audioAmplitudes.end(), 0LL) / (qint64)summary.audioAmplitudes.size();
+}
 
-    // Normalize the envelope.
-    summary.amplitudeMax = 0;
-    for (size_t i = 0; i < summary.audioAmplitudes.size(); ++i) {
-        summary.audioAmplitudes[i] -= meanBeforeNormalization;
-        summary.amplitudeMax = std::max(summary.amplitudeMax, qAbs(summary.audioAmplitudes[i]));
+bool AudioEnvelope::loadCachedEnvelope(std::vector<qint64> &amplitudes) const
+{
+    if (m_cachePath.isEmpty()) {
+        return false;
+    }
+    QFile file(m_cachePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    quint32 magic, version;
+    quint64 size;
+    stream >> magic >> version >> size;
+    if (stream.status() != QDataStream::Ok || magic != envelopeMagic || version != envelopeVersion || size != amplitudes.size()) {
+        return false;
+    }
+    const int bytes = int(size * sizeof(qint64));
+    if (stream.readRawData(reinterpret_cast<char *>(amplitudes.data()), bytes) != bytes) {
+        return false;
+    }
+    qCDebug(KDENLIVE_LOG) << "Envelope loaded from cache" << m_cachePath;
+    return true;
+}
+
+void AudioEnvelope::saveCachedEnvelope(const std::vector<qint64> &amplitudes) const
+{
+    if (m_cachePath.isEmpty()) {
+        return;
+    }
+    // Written through a temporary file, so that an interrupted write does not leave a truncated envelope
+    QSaveFile file(m_cachePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    QDataStream stream(&file);
+    stream << envelopeMagic << envelopeVersion << (quint64)amplitudes.size();
+    stream.writeRawData(reinterpret_cast<const char *>(amplitudes.data()), int(amplitudes.size() * sizeof(qint64)));
+    if (!file.commit()) {
+        qCDebug(KDENLIVE_LOG) << "Cannot write envelope cache" << m_cachePath;
     }
-    return summary;
 }
 
 int AudioEnvelope::clipId() const
@@ -89,6 +89,18 @@ private:
     */
     AudioSummary loadAndNormalizeEnvelope() const;
 
+    /**
+     Decodes the audio of the producer to compute the raw envelope.
+    */
+    void computeEnvelope(std::vector<qint64> &amplitudes) const;
+
+    /**
+     Reads the raw envelope from the project cache. Returns false if
+     it is not cached yet.
+    */
+    bool loadCachedEnvelope(std::vector<qint64> &amplitudes) const;
+    void saveCachedEnvelope(const std::vector<qint64> &amplitudes) const;
+
     std::shared_ptr<Mlt::Producer> m_producer;
     std::unique_ptr<AudioInfo> m_info;
     QFutureWatcher<AudioSummary> m_watcher;
@@ -98,6 +110,8 @@ private:
     const int m_clipId;
     const size_t m_startpos;
     size_t m_envelopeSize;
+    // Path of the envelope in the project cache, empty if it cannot be cached
+    QString m_cachePath;
 
 signals:
     void envelopeReady(AudioEnvelope *envelope);
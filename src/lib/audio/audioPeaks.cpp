@@ -0,0 +1,350 @@
+/*
+Copyright (C) 2019  Kdenlive contributors
+This file is part of kdenlive. See www.kdenlive.org.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+#include "audioPeaks.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+static_assert(sizeof(AudioPeaks::Peak) == 6, "Peak must be packed for the peak file");
+
+namespace {
+// Peak files are a local cache, so they are written with the native byte order
+const char peakMagic[4] = {'K', 'P', 'K', 'S'};
+const quint32 peakVersion = 1;
+// Files with more channels than this are considered corrupt
+const quint32 maxChannels = 64;
+
+struct PeakFileHeader
+{
+    char magic[4];
+    quint32 version;
+    quint32 channels;
+    quint32 frames;
+    quint32 bucketsPerFrame;
+    quint32 levelCount;
+    qint64 offsets[AudioPeaks::LevelCount];
+    qint64 counts[AudioPeaks::LevelCount];
+};
+
+AudioPeaks::Peak mergePeaks(const AudioPeaks::Peak *peaks, int count, int stride)
+{
+    AudioPeaks::Peak result{0, 0, 0};
+    if (count <= 0) {
+        return result;
+    }
+    result.min = std::numeric_limits<qint16>::max();
+    result.max = std::numeric_limits<qint16>::min();
+    double squares = 0;
+    for (int i = 0; i < count; ++i) {
+        const AudioPeaks::Peak &p = peaks[i * stride];
+        result.min = qMin(result.min, p.min);
+        result.max = qMax(result.max, p.max);
+        squares += double(p.rms) * p.rms;
+    }
+    result.rms = qint16(std::sqrt(squares / count));
+    return result;
+}
+} // namespace
+
+AudioPeaks::AudioPeaks()
+    : m_channels(0)
+    , m_frames(0)
+    , m_peaks(nullptr)
+{
+    m_offsets.fill(0);
+    m_counts.fill(0);
+    for (auto &available : m_available) {
+        available.store(0);
+    }
+}
+
+AudioPeaks::AudioPeaks(int channels, int frames)
+    : m_channels(channels)
+    , m_frames(frames)
+    , m_peaks(nullptr)
+{
+    const qint64 total = layout((qint64)frames * BucketsPerFrame);
+    for (auto &available : m_available) {
+        available.store(0);
+    }
+    m_data.assign((size_t)total, Peak{0, 0, 0});
+    m_peaks = m_data.data();
+}
+
+AudioPeaks::~AudioPeaks() = default;
+
+qint64 AudioPeaks::layout(qint64 baseCount)
+{
+    qint64 total = 0;
+    qint64 count = baseCount;
+    for (int level = 0; level < LevelCount; ++level) {
+        m_offsets[(size_t)level] = total;
+        m_counts[(size_t)level] = count;
+        total += count * m_channels;
+        count = (count + LevelFactor - 1) / LevelFactor;
+    }
+    return total;
+}
+
+void AudioPeaks::publish(qint64 baseCount, bool complete)
+{
+    std::array<qint64, LevelCount> ready;
+    ready[0] = complete ? m_counts[0] : qMin(baseCount, m_counts[0]);
+    for (int level = 1; level < LevelCount; ++level) {
+        // A bucket is only merged once all its sources are known, so it is never written again after being published
+        ready[(size_t)level] = complete ? m_counts[(size_t)level] : ready[(size_t)level - 1] / LevelFactor;
+        const Peak *source = m_data.data() + m_offsets[(size_t)level - 1];
+        Peak *target = m_data.data() + m_offsets[(size_t)level];
+        for (qint64 i = m_available[(size_t)level].load(std::memory_order_relaxed); i < ready[(size_t)level]; ++i) {
+            int merged = (int)qMin<qint64>(LevelFactor, m_counts[(size_t)level - 1] - i * LevelFactor);
+            for (int channel = 0; channel < m_channels; ++channel) {
+                target[i * m_channels + channel] = mergePeaks(source + i * LevelFactor * m_channels + channel, merged, m_channels);
+            }
+        }
+    }
+    for (int level = 0; level < LevelCount; ++level) {
+        m_available[(size_t)level].store(ready[(size_t)level], std::memory_order_release);
+    }
+}
+
+std::shared_ptr<AudioPeaks> AudioPeaks::load(const QString &path)
+{
+    std::unique_ptr<QFile> file(new QFile(path));
+    if (!file->open(QIODevice::ReadOnly)) {
+        return nullptr;
+    }
+    PeakFileHeader header;
+    if (file->read(reinterpret_cast<char *>(&header), sizeof(PeakFileHeader)) != (qint64)sizeof(PeakFileHeader)) {
+        return nullptr;
+    }
+    if (memcmp(header.magic, peakMagic, 4) != 0 || header.version != peakVersion || header.bucketsPerFrame != BucketsPerFrame ||
+        header.levelCount != LevelCount || header.channels == 0 || header.channels > maxChannels) {
+        return nullptr;
+    }
+    std::shared_ptr<AudioPeaks> peaks(new AudioPeaks());
+    peaks->m_channels = (int)header.channels;
+    peaks->m_frames = (int)qMin<quint32>(header.frames, std::numeric_limits<int>::max());
+    // The levels only depend on the number of frames and channels, so the header must describe exactly the layout we would build
+    const qint64 total = peaks->layout((qint64)peaks->m_frames * BucketsPerFrame);
+    for (int level = 0; level < LevelCount; ++level) {
+        if (header.offsets[level] != peaks->m_offsets[(size_t)level] || header.counts[level] != peaks->m_counts[(size_t)level]) {
+            return nullptr;
+        }
+    }
+    const qint64 size = (qint64)sizeof(PeakFileHeader) + total * (qint64)sizeof(Peak);
+    if (file->size() < size) {
+        // Truncated file
+        return nullptr;
+    }
+    uchar *data = file->map(0, size);
+    if (data == nullptr) {
+        return nullptr;
+    }
+    peaks->m_peaks = reinterpret_cast<const Peak *>(data + sizeof(PeakFileHeader));
+    peaks->m_file = std::move(file);
+    for (int level = 0; level < LevelCount; ++level) {
+        peaks->m_available[(size_t)level].store(peaks->m_counts[(size_t)level]);
+    }
+    return peaks;
+}
+
+bool AudioPeaks::save(const QString &path) const
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    PeakFileHeader header;
+    memcpy(header.magic, peakMagic, 4);
+    header.version = peakVersion;
+    header.channels = (quint32)m_channels;
+    header.frames = (quint32)m_frames;
+    header.bucketsPerFrame = BucketsPerFrame;
+    header.levelCount = LevelCount;
+    qint64 total = 0;
+    for (int level = 0; level < LevelCount; ++level) {
+        header.offsets[level] = m_offsets[level];
+        header.counts[level] = m_counts[level];
+        total += m_counts[level] * m_channels;
+    }
+    file.write(reinterpret_cast<const char *>(&header), sizeof(PeakFileHeader));
+    file.write(reinterpret_cast<const char *>(m_peaks), total * (qint64)sizeof(Peak));
+    return file.commit();
+}
+
+int AudioPeaks::channels() const
+{
+    return m_channels;
+}
+
+int AudioPeaks::frames() const
+{
+    return m_frames;
+}
+
+int AudioPeaks::availableFrames() const
+{
+    // Level 1 holds one bucket per frame
+    return (int)qMin<qint64>(m_frames, m_available[1].load(std::memory_order_acquire));
+}
+
+int AudioPeaks::bucketCount(int level) const
+{
+    return (int)m_counts[(size_t)level];
+}
+
+double AudioPeaks::framesPerBucket(int level) const
+{
+    double frames = 1. / BucketsPerFrame;
+    for (int i = 0; i < level; ++i) {
+        frames *= LevelFactor;
+    }
+    return frames;
+}
+
+int AudioPeaks::levelForFramesPerPixel(double framesPerPixel) const
+{
+    int level = 0;
+    while (level + 1 < LevelCount && framesPerBucket(level + 1) <= framesPerPixel) {
+        level++;
+    }
+    return level;
+}
+
+const AudioPeaks::Peak *AudioPeaks::bucket(int level, int index) const
+{
+    return m_peaks + m_offsets[(size_t)level] + (qint64)index * m_channels;
+}
+
+AudioPeaks::Peak AudioPeaks::range(int level, double startFrame, double endFrame, int channel) const
+{
+    int count = bucketCount(level);
+    if (count == 0 || channel < 0 || channel >= m_channels) {
+        return Peak{0, 0, 0};
+    }
+    double framesInBucket = framesPerBucket(level);
+    int first = qBound(0, (int)(startFrame / framesInBucket), count - 1);
+    int last = qBound(first, (int)std::ceil(endFrame / framesInBucket) - 1, count - 1);
+    // Buckets that are not computed yet are silent
+    const int available = (int)m_available[(size_t)level].load(std::memory_order_acquire);
+    if (first >= available) {
+        return Peak{0, 0, 0};
+    }
+    last = qMin(last, available - 1);
+    return mergePeaks(bucket(level, first) + channel, last - first + 1, m_channels);
+}
+
+QList<double> AudioPeaks::frameLevels() const
+{
+    QList<double> levels;
+    // Level 1 holds one bucket per frame
+    int count = bucketCount(1);
+    levels.reserve(count * m_channels);
+    for (int i = 0; i < count * m_channels; ++i) {
+        levels << 0.;
+    }
+    fillFrameLevels(levels, 0, count);
+    return levels;
+}
+
+void AudioPeaks::fillFrameLevels(QList<double> &levels, int first, int end) const
+{
+    end = qMin(end, qMin(availableFrames(), levels.size() / qMax(1, m_channels)));
+    for (int i = qMax(0, first); i < end; ++i) {
+        const Peak *peaks = bucket(1, i);
+        for (int channel = 0; channel < m_channels; ++channel) {
+            int peak = qMax(-(int)peaks[channel].min, (int)peaks[channel].max);
+            levels[i * m_channels + channel] = 256. * peak / 32768.;
+        }
+    }
+}
+
+AudioPeaksBuilder::AudioPeaksBuilder(int channels, int frames, double samplesPerFrame)
+    : m_channels(channels)
+    , m_frames(frames)
+    , m_samplesPerBucket(samplesPerFrame / AudioPeaks::BucketsPerFrame)
+    , m_position(0)
+    , m_bucket(0)
+    , m_count(0)
+    , m_peaks(std::make_shared<AudioPeaks>(channels, frames))
+    , m_min((size_t)channels, std::numeric_limits<qint16>::max())
+    , m_max((size_t)channels, std::numeric_limits<qint16>::min())
+    , m_squares((size_t)channels, 0.)
+{
+}
+
+void AudioPeaksBuilder::addSamples(const qint16 *samples, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        const qint16 *frame = samples + (qint64)i * m_channels;
+        for (int channel = 0; channel < m_channels; ++channel) {
+            qint16 value = frame[channel];
+            m_min[(size_t)channel] = qMin(m_min[(size_t)channel], value);
+            m_max[(size_t)channel] = qMax(m_max[(size_t)channel], value);
+            m_squares[(size_t)channel] += double(value) * value;
+        }
+        m_count++;
+        m_position++;
+        if (m_position >= (m_bucket + 1) * m_samplesPerBucket) {
+            flushBucket();
+        }
+    }
+}
+
+void AudioPeaksBuilder::addSilence(int count)
+{
+    std::vector<qint16> silence((size_t)m_channels, 0);
+    for (int i = 0; i < count; ++i) {
+        addSamples(silence.data(), 1);
+    }
+}
+
+int AudioPeaksBuilder::processedFrames() const
+{
+    return (int)qMin<qint64>(m_frames, m_bucket / AudioPeaks::BucketsPerFrame);
+}
+
+void AudioPeaksBuilder::flushBucket()
+{
+    if (m_count > 0 && m_bucket < m_peaks->m_counts[0]) {
+        // Level 0 starts the storage, and this bucket is not published yet
+        AudioPeaks::Peak *peaks = m_peaks->m_data.data() + m_bucket * m_channels;
+        for (int channel = 0; channel < m_channels; ++channel) {
+            peaks[channel].min = m_min[(size_t)channel];
+            peaks[channel].max = m_max[(size_t)channel];
+            peaks[channel].rms = qint16(qMin(32767., std::sqrt(m_squares[(size_t)channel] / m_count)));
+        }
+    }
+    std::fill(m_min.begin(), m_min.end(), std::numeric_limits<qint16>::max());
+    std::fill(m_max.begin(), m_max.end(), std::numeric_limits<qint16>::min());
+    std::fill(m_squares.begin(), m_squares.end(), 0.);
+    m_count = 0;
+    m_bucket++;
+}
+
+std::shared_ptr<AudioPeaks> AudioPeaksBuilder::snapshot()
+{
+    m_peaks->publish(m_bucket, false);
+    return m_peaks;
+}
+
+std::shared_ptr<AudioPeaks> AudioPeaksBuilder::finish()
+{
+    if (m_count > 0) {
+        flushBucket();
+    }
+    m_peaks->publish(m_bucket, true);
+    return m_peaks;
+}
@@ -0,0 +1,129 @@
+/*
+Copyright (C) 2019  Kdenlive contributors
+This file is part of kdenlive. See www.kdenlive.org.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+#ifndef AUDIOPEAKS_H
+#define AUDIOPEAKS_H
+
+#include <QList>
+#include <QString>
+#include <QtGlobal>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class QFile;
+
+/**
+  Audio peaks of a clip (min, max and rms value of the samples, per channel)
+  stored at several resolutions. Level 0 holds BucketsPerFrame buckets per
+  frame, each following level merges LevelFactor buckets of the previous one,
+  so that the last level holds one bucket per 256 frames.
+
+  A view drawing the waveform picks the level matching its zoom factor with
+  levelForFramesPerPixel(), so that drawing cost does not depend on the zoom.
+  The peaks can be shared between threads. While AudioPeaksBuilder fills them,
+  only the buckets published so far are read, the following frames being
+  silent. When loaded from a peak file, the data is memory mapped.
+  */
+class AudioPeaks
+{
+public:
+    struct Peak
+    {
+        qint16 min;
+        qint16 max;
+        qint16 rms;
+    };
+    enum { BucketsPerFrame = 4, LevelFactor = 4, LevelCount = 6 };
+
+    /** @brief Creates silent peaks, filled progressively by AudioPeaksBuilder */
+    AudioPeaks(int channels, int frames);
+    ~AudioPeaks();
+
+    /** @brief Loads a peak file previously written by save(). Returns nullptr if the file is missing or invalid */
+    static std::shared_ptr<AudioPeaks> load(const QString &path);
+    /** @brief Writes the peaks to a file that can be mapped by load() */
+    bool save(const QString &path) const;
+
+    int channels() const;
+    int frames() const;
+    /** @brief Number of frames whose peaks are computed. Equals frames() unless the peaks are still being built */
+    int availableFrames() const;
+    int bucketCount(int level) const;
+    /** @brief Number of frames covered by one bucket of the given level */
+    double framesPerBucket(int level) const;
+    /** @brief Returns the coarsest level still providing at least one bucket per pixel */
+    int levelForFramesPerPixel(double framesPerPixel) const;
+    /** @brief Returns the merged peak of a channel between two frame positions, using the buckets of the given level */
+    Peak range(int level, double startFrame, double endFrame, int channel) const;
+    /** @brief Per frame levels (0-256, channels interleaved), as used by the monitor audio display */
+    QList<double> frameLevels() const;
+    /** @brief Writes the levels of the frames [first, end) in a list holding the levels of all frames, see frameLevels() */
+    void fillFrameLevels(QList<double> &levels, int first, int end) const;
+
+private:
+    AudioPeaks();
+    /** @brief Merges the level 0 buckets published so far into the upper levels, then makes them readable.
+        Only the upper buckets not computed yet are merged. If complete, the last partial buckets are merged too */
+    void publish(qint64 baseCount, bool complete);
+    /** @brief Sets the offset and count of each level from the number of level 0 buckets, returns the total number of peaks */
+    qint64 layout(qint64 baseCount);
+    const Peak *bucket(int level, int index) const;
+
+    int m_channels;
+    int m_frames;
+    std::array<qint64, LevelCount> m_offsets;
+    std::array<qint64, LevelCount> m_counts;
+    /** @brief Number of readable buckets per level */
+    std::array<std::atomic<qint64>, LevelCount> m_available;
+    /** @brief Storage of the peaks when they were computed in this session */
+    std::vector<Peak> m_data;
+    /** @brief Mapped peak file, when loaded from disk */
+    std::unique_ptr<QFile> m_file;
+    const Peak *m_peaks;
+    friend class AudioPeaksBuilder;
+};
+
+/**
+  Computes the level 0 buckets of AudioPeaks from a stream of interleaved
+  16 bit samples. The buckets are written in place, so that the peaks can be
+  displayed while they are computed.
+  */
+class AudioPeaksBuilder
+{
+public:
+    AudioPeaksBuilder(int channels, int frames, double samplesPerFrame);
+    /** @brief Process count interleaved sample frames */
+    void addSamples(const qint16 *samples, int count);
+    /** @brief Process count silent sample frames */
+    void addSilence(int count);
+    /** @brief Returns the number of frames for which all buckets are computed */
+    int processedFrames() const;
+    /** @brief Publish the buckets of the samples processed so far and return the peaks being built */
+    std::shared_ptr<AudioPeaks> snapshot();
+    /** @brief Flush the pending samples and return the complete peaks */
+    std::shared_ptr<AudioPeaks> finish();
+
+private:
+    void flushBucket();
+    int m_channels;
+    int m_frames;
+    double m_samplesPerBucket;
+    qint64 m_position;
+    qint64 m_bucket;
+    int m_count;
+    std::shared_ptr<AudioPeaks> m_peaks;
+    std::vector<qint16> m_min;
+    std::vector<qint16> m_max;
+    std::vector<double> m_squares;
+};
+
+#endif
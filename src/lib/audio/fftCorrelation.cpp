@@ -15,71 +15,179 @@ extern "C" {
 }
 
 #include "kdenlive_debug.h"
+#include <QThread>
 #include <QTime>
 #include <algorithm>
-#include <vector>
+#include <unordered_map>
 
-void FFTCorrelation::correlate(const qint64 *left, const size_t leftSize, const qint64 *right, const size_t rightSize, qint64 *out_correlated)
+namespace {
+// Workspaces are not kept in the pool beyond this number of floats (about 64 MB)
+const size_t maxPooledFloats = 1 << 24;
+
+/*
+  The plans and buffers needed for transforms of one size.
+  kiss_fftr uses scratch memory stored in its plans, so a workspace
+  must only be used by one thread at a time.
+  */
+struct Workspace
 {
-    auto *correlatedFloat = new float[leftSize + rightSize + 1];
-    correlate(left, leftSize, right, rightSize, correlatedFloat);
+    explicit Workspace(size_t fftSize)
+        : size(fftSize)
+        , forward(kiss_fftr_alloc((int)fftSize, 0, nullptr, nullptr))
+        , inverse(kiss_fftr_alloc((int)fftSize, 1, nullptr, nullptr))
+        , data(fftSize)
+        , spectrum(fftSize / 2 + 1)
+        , product(fftSize / 2 + 1)
+    {
+    }
+    ~Workspace()
+    {
+        kiss_fftr_free(forward);
+        kiss_fftr_free(inverse);
+    }
+    Q_DISABLE_COPY(Workspace)
 
-    // The correlation vector will have entries up to N (number of entries
-    // of the vector), so converting to integers will not lose that much
-    // of precision.
-    for (size_t i = 0; i < leftSize + rightSize + 1; ++i) {
-        out_correlated[i] = correlatedFloat[i];
+    // Number of floats held by this workspace
+    size_t footprint() const { return data.size() + 2 * (spectrum.size() + product.size()); }
+
+    const size_t size;
+    kiss_fftr_cfg forward;
+    kiss_fftr_cfg inverse;
+    std::vector<float> data;
+    std::vector<kiss_fft_cpx> spectrum;
+    std::vector<kiss_fft_cpx> product;
+};
+
+class WorkspacePool
+{
+public:
+    std::unique_ptr<Workspace> acquire(size_t size)
+    {
+        QMutexLocker lock(&m_mutex);
+        auto &available = m_available[size];
+        if (available.empty()) {
+            lock.unlock();
+            return std::make_unique<Workspace>(size);
+        }
+        std::unique_ptr<Workspace> workspace = std::move(available.back());
+        available.pop_back();
+        m_pooled -= workspace->footprint();
+        return workspace;
     }
-    delete[] correlatedFloat;
+
+    void release(std::unique_ptr<Workspace> workspace)
+    {
+        QMutexLocker lock(&m_mutex);
+        auto &available = m_available[workspace->size];
+        if (available.size() < (size_t)QThread::idealThreadCount() && m_pooled + workspace->footprint() <= maxPooledFloats) {
+            m_pooled += workspace->footprint();
+            available.push_back(std::move(workspace));
+        }
+    }
+
+private:
+    QMutex m_mutex;
+    std::unordered_map<size_t, std::vector<std::unique_ptr<Workspace>>> m_available;
+    size_t m_pooled = 0;
+};
+
+WorkspacePool &workspacePool()
+{
+    static WorkspacePool pool;
+    return pool;
 }
 
-void FFTCorrelation::correlate(const qint64 *left, const size_t leftSize, const qint64 *right, const size_t rightSize, float *out_correlated)
+/* Borrows a workspace from the pool for the duration of a transform */
+class WorkspaceLease
 {
-    QTime t;
-    t.start();
+public:
+    explicit WorkspaceLease(size_t size)
+        : m_workspace(workspacePool().acquire(size))
+    {
+    }
+    ~WorkspaceLease() { workspacePool().release(std::move(m_workspace)); }
+    Q_DISABLE_COPY(WorkspaceLease)
+
+    Workspace *operator->() const { return m_workspace.get(); }
+
+private:
+    std::unique_ptr<Workspace> m_workspace;
+};
 
-    auto *leftF = new float[leftSize];
-    auto *rightF = new float[rightSize];
+qint64 maxAbs(const qint64 *data, size_t size)
+{
+    qint64 max = 1;
+    for (size_t i = 0; i < size; ++i) {
+        max = std::max(max, (qint64)labs(data[i]));
+    }
+    return max;
+}
 
+/*
+  Multiplies the spectrum in the workspace product buffer with the given one,
+  and transforms the result back into out_convolved as done by FFTCorrelation::convolve.
+  */
+void convolveSpectra(const WorkspaceLease &workspace, const kiss_fft_cpx *spectrum, size_t outSize, float *out_convolved)
+{
+    // Convolution in spacial domain is a multiplication in fourier domain. O(n).
+    std::vector<kiss_fft_cpx> &product = workspace->product;
+    for (size_t i = 0; i < product.size(); ++i) {
+        const kiss_fft_cpx other = product[i];
+        product[i].r = spectrum[i].r * other.r - spectrum[i].i * other.i;
+        product[i].i = spectrum[i].r * other.i + spectrum[i].i * other.r;
+    }
+
+    // Inverse fourier transformation to get the convolved data.
+    // Insert one element at the beginning to obtain the same result
+    // that we also get with the nested for loop correlation.
+    *out_convolved = 0;
+    kiss_fftri(workspace->inverse, &product[0], &workspace->data[0]);
+    std::copy(workspace->data.begin(), workspace->data.begin() + (int)outSize - 1, out_convolved + 1);
+}
+} // namespace
+
+struct FFTCorrelation::Reference::Spectrum
+{
+    std::vector<kiss_fft_cpx> values;
+};
+
+FFTCorrelation::Reference::Reference(const qint64 *data, const size_t size)
+    : m_data(size)
+{
     // First the qint64 values need to be normalized to floats
     // Dividing by the max value is maybe not the best solution, but the
     // maximum value after correlation should not be larger than the longest
     // vector since each value should be at most 1
-    qint64 maxLeft = 1;
-    qint64 maxRight = 1;
-    for (size_t i = 0; i < leftSize; ++i) {
-        if (labs(left[i]) > maxLeft) {
-            maxLeft = labs(left[i]);
-        }
-    }
-    for (size_t i = 0; i < rightSize; ++i) {
-        if (labs(right[i]) > maxRight) {
-            maxRight = labs(right[i]);
-        }
-    }
-
-    // One side needs to be reversed, since multiplication in frequency domain (fourier space)
-    // calculates the convolution: \sum l[x]r[N-x] and not the correlation: \sum l[x]r[x]
-    for (size_t i = 0; i < leftSize; ++i) {
-        leftF[i] = double(left[i]) / (double)maxLeft;
-    }
-    for (size_t i = 0; i < rightSize; ++i) {
-        rightF[rightSize - 1 - i] = double(right[i]) / (double)maxRight;
+    const qint64 max = maxAbs(data, size);
+    for (size_t i = 0; i < size; ++i) {
+        m_data[i] = double(data[i]) / (double)max;
     }
+}
 
-    // Now we can convolve to get the correlation
-    convolve(leftF, leftSize, rightF, rightSize, out_correlated);
+FFTCorrelation::Reference::~Reference() = default;
 
-    qCDebug(KDENLIVE_LOG) << "Correlation (FFT based) computed in " << t.elapsed() << " ms.";
-    delete[] leftF;
-    delete[] rightF;
+size_t FFTCorrelation::Reference::size() const
+{
+    return m_data.size();
 }
 
-void FFTCorrelation::convolve(const float *left, const size_t leftSize, const float *right, const size_t rightSize, float *out_convolved)
+const FFTCorrelation::Reference::Spectrum &FFTCorrelation::Reference::spectrum(const size_t fftSize) const
 {
-    QTime time;
-    time.start();
+    QMutexLocker lock(&m_mutex);
+    std::unique_ptr<Spectrum> &spectrum = m_spectra[fftSize];
+    if (!spectrum) {
+        WorkspaceLease workspace(fftSize);
+        std::fill(workspace->data.begin(), workspace->data.end(), 0.f);
+        std::copy(m_data.begin(), m_data.end(), workspace->data.begin());
+        spectrum.reset(new Spectrum);
+        spectrum->values.resize(fftSize / 2 + 1);
+        kiss_fftr(workspace->forward, &workspace->data[0], &spectrum->values[0]);
+    }
+    return *spectrum;
+}
 
+size_t FFTCorrelation::fftSize(const size_t leftSize, const size_t rightSize)
+{
     // To avoid issues with repetition (we are dealing with cosine waves
     // in the fourier domain) we need to pad the vectors to at least twice their size,
     // otherwise convolution would convolve with the repeated pattern as well
@@ -91,44 +199,75 @@ void FFTCorrelation::convolve(const float *left, const size_t leftSize, const fl
     while (size / 2 < largestSize) {
         size = size << 1;
     }
+    return size;
+}
 
-    const size_t fft_size = size / 2 + 1;
-    kiss_fftr_cfg fftConfig = kiss_fftr_alloc((int)size, 0, nullptr, nullptr);
-    kiss_fftr_cfg ifftConfig = kiss_fftr_alloc((int)size, 1, nullptr, nullptr);
-    std::vector<kiss_fft_cpx> leftFFT(fft_size);
-    std::vector<kiss_fft_cpx> rightFFT(fft_size);
-    std::vector<kiss_fft_cpx> correlatedFFT(fft_size);
+void FFTCorrelation::correlate(const qint64 *left, const size_t leftSize, const qint64 *right, const size_t rightSize, qint64 *out_correlated)
+{
+    Reference reference(left, leftSize);
+    correlate(reference, right, rightSize, out_correlated);
+}
 
-    // Fill in the data into our new vectors with padding
-    std::vector<float> leftData(size, 0);
-    std::vector<float> rightData(size, 0);
-    std::vector<float> convolved(size);
+void FFTCorrelation::correlate(const qint64 *left, const size_t leftSize, const qint64 *right, const size_t rightSize, float *out_correlated)
+{
+    Reference reference(left, leftSize);
+    correlate(reference, right, rightSize, out_correlated);
+}
 
-    std::copy(left, left + leftSize, leftData.begin());
-    std::copy(right, right + rightSize, rightData.begin());
+void FFTCorrelation::correlate(const Reference &reference, const qint64 *right, const size_t rightSize, qint64 *out_correlated)
+{
+    std::vector<float> correlatedFloat(reference.size() + rightSize + 1);
+    correlate(reference, right, rightSize, &correlatedFloat[0]);
 
-    // Fourier transformation of the vectors
-    kiss_fftr(fftConfig, &leftData[0], &leftFFT[0]);
-    kiss_fftr(fftConfig, &rightData[0], &rightFFT[0]);
+    // The correlation vector will have entries up to N (number of entries
+    // of the vector), so converting to integers will not lose that much
+    // of precision.
+    for (size_t i = 0; i < correlatedFloat.size(); ++i) {
+        out_correlated[i] = correlatedFloat[i];
+    }
+}
 
-    // Convolution in spacial domain is a multiplication in fourier domain. O(n).
-    for (size_t i = 0; i < correlatedFFT.size(); ++i) {
-        correlatedFFT[i].r = leftFFT[i].r * rightFFT[i].r - leftFFT[i].i * rightFFT[i].i;
-        correlatedFFT[i].i = leftFFT[i].r * rightFFT[i].i + leftFFT[i].i * rightFFT[i].r;
+void FFTCorrelation::correlate(const Reference &reference, const qint64 *right, const size_t rightSize, float *out_correlated)
+{
+    QTime t;
+    t.start();
+
+    const size_t size = fftSize(reference.size(), rightSize);
+    const Reference::Spectrum &referenceSpectrum = reference.spectrum(size);
+    WorkspaceLease workspace(size);
+
+    // One side needs to be reversed, since multiplication in frequency domain (fourier space)
+    // calculates the convolution: \sum l[x]r[N-x] and not the correlation: \sum l[x]r[x]
+    const qint64 maxRight = maxAbs(right, rightSize);
+    std::vector<float> &rightData = workspace->data;
+    std::fill(rightData.begin() + (int)rightSize, rightData.end(), 0.f);
+    for (size_t i = 0; i < rightSize; ++i) {
+        rightData[rightSize - 1 - i] = double(right[i]) / (double)maxRight;
     }
+    kiss_fftr(workspace->forward, &rightData[0], &workspace->product[0]);
 
-    // Inverse fourier transformation to get the convolved data.
-    // Insert one element at the beginning to obtain the same result
-    // that we also get with the nested for loop correlation.
-    *out_convolved = 0;
-    size_t out_size = leftSize + rightSize + 1;
+    // Now we can convolve to get the correlation
+    convolveSpectra(workspace, &referenceSpectrum.values[0], reference.size() + rightSize + 1, out_correlated);
+
+    qCDebug(KDENLIVE_LOG) << "Correlation (FFT based) computed in " << t.elapsed() << " ms.";
+}
+
+void FFTCorrelation::convolve(const float *left, const size_t leftSize, const float *right, const size_t rightSize, float *out_convolved)
+{
+    QTime time;
+    time.start();
+
+    const size_t size = fftSize(leftSize, rightSize);
+    WorkspaceLease workspace(size);
 
-    kiss_fftri(ifftConfig, &correlatedFFT[0], &convolved[0]);
-    std::copy(convolved.begin(), convolved.begin() + (int)out_size - 1, out_convolved + 1);
+    // Fill in the data into the padded buffer and transform it
+    std::vector<float> &data = workspace->data;
+    std::fill(std::copy(left, left + leftSize, data.begin()), data.end(), 0.f);
+    kiss_fftr(workspace->forward, &data[0], &workspace->spectrum[0]);
+    std::fill(std::copy(right, right + rightSize, data.begin()), data.end(), 0.f);
+    kiss_fftr(workspace->forward, &data[0], &workspace->product[0]);
 
-    // Finally some cleanup.
-    kiss_fftr_free(fftConfig);
-    kiss_fftr_free(ifftConfig);
+    convolveSpectra(workspace, &workspace->spectrum[0], leftSize + rightSize + 1, out_convolved);
 
     qCDebug(KDENLIVE_LOG) << "FFT convolution computed. Time taken: " << time.elapsed() << " ms";
 }
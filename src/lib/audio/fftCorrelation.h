@@ -11,12 +11,21 @@ the Free Software Foundation, either version 3 of the License, or
 #ifndef FFTCORRELATION_H
 #define FFTCORRELATION_H
 
+#include <QMutex>
 #include <QtGlobal>
+#include <map>
+#include <memory>
+#include <vector>
+
 /**
   This class provides methods to calculate convolution
   and correlation of two vectors by means of FFT, which
   is O(n log n) (convolution in spacial domain would be
   O(n²)).
+
+  The FFT plans and padded buffers are kept in a pool shared by
+  all the correlations, so that they are only allocated once per
+  transform size and thread.
   */
 class FFTCorrelation
 {
@@ -36,6 +45,45 @@ public:
     static void correlate(const qint64 *left, const size_t leftSize, const qint64 *right, const size_t rightSize, float *out_correlated);
 
     static void correlate(const qint64 *left, const size_t leftSize, const qint64 *right, const size_t rightSize, qint64 *out_correlated);
+
+    /**
+      The normalized spectrum of a vector, to correlate several
+      vectors against it without transforming it again each time.
+      The spectrum is computed on first use for each transform size.
+      A Reference can be used by several threads at once.
+      */
+    class Reference
+    {
+    public:
+        Reference(const qint64 *data, const size_t size);
+        ~Reference();
+
+        size_t size() const;
+
+    private:
+        friend class FFTCorrelation;
+        struct Spectrum;
+        /** Returns the spectrum of the reference, padded to \c fftSize */
+        const Spectrum &spectrum(const size_t fftSize) const;
+
+        std::vector<float> m_data;
+        mutable QMutex m_mutex;
+        mutable std::map<size_t, std::unique_ptr<Spectrum>> m_spectra;
+        Q_DISABLE_COPY(Reference)
+    };
+
+    /**
+      Computes the correlation between a precomputed \c reference and \c right,
+      with the same result as correlate() above.
+      */
+    static void correlate(const Reference &reference, const qint64 *right, const size_t rightSize, float *out_correlated);
+
+    static void correlate(const Reference &reference, const qint64 *right, const size_t rightSize, qint64 *out_correlated);
+
+    /**
+      Returns the size of the transforms used to convolve vectors of the given sizes.
+      */
+    static size_t fftSize(const size_t leftSize, const size_t rightSize);
 };
 
 #endif // FFTCORRELATION_H
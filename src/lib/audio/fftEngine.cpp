@@ -0,0 +1,167 @@
+/***************************************************************************
+ *   Copyright (C) 2019 by Kdenlive contributors                           *
+ *   This file is part of kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include "fftEngine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace {
+// Alignment of the scratch buffers, in bytes
+const size_t bufferAlignment = 32;
+
+template <typename T> T *alignedStart(std::vector<T> &storage)
+{
+    auto address = reinterpret_cast<uintptr_t>(storage.data());
+    address = (address + bufferAlignment - 1) & ~(uintptr_t)(bufferAlignment - 1);
+    return reinterpret_cast<T *>(address);
+}
+} // namespace
+
+struct FFTEngine::Plan
+{
+    explicit Plan(int size)
+        : cfg(kiss_fftr_alloc(size, 0, nullptr, nullptr))
+        , size(size)
+    {
+    }
+    ~Plan() { kiss_fftr_free(cfg); }
+    kiss_fftr_cfg cfg;
+    int size;
+};
+
+FFTEngine::FFTEngine() = default;
+
+FFTEngine::~FFTEngine() = default;
+
+FFTEngine::Plan *FFTEngine::plan(int size)
+{
+    if (m_lastPlan != nullptr && m_lastPlan->size == size) {
+        return m_lastPlan;
+    }
+    std::unique_ptr<Plan> &cached = m_plans[size];
+    if (!cached) {
+        cached.reset(new Plan(size));
+    }
+    m_lastPlan = cached.get();
+    return m_lastPlan;
+}
+
+const std::vector<float> &FFTEngine::window(FFTTools::WindowType windowType, int size, float param)
+{
+    const auto key = std::make_tuple(size, (int)windowType, param);
+    if (m_lastWindow != nullptr && key == m_lastWindowKey) {
+        return *m_lastWindow;
+    }
+    std::vector<float> &cached = m_windows[key];
+    if (cached.empty()) {
+        const QVector<float> values = FFTTools::window(windowType, size, param);
+        cached.assign(values.constBegin(), values.constEnd());
+    }
+    m_lastWindowKey = key;
+    m_lastWindow = &cached;
+    return cached;
+}
+
+void FFTEngine::reserve(int size)
+{
+    if (size <= m_reserved) {
+        return;
+    }
+    const size_t padding = bufferAlignment / sizeof(float);
+    // Windowed input, then the power of each frequency
+    m_inputStorage.assign((size_t)size + (size_t)size / 2 + 1 + 2 * padding, 0.f);
+    m_outputStorage.resize((size_t)size / 2 + 1 + bufferAlignment / sizeof(kiss_fft_cpx));
+    m_input = alignedStart(m_inputStorage);
+    m_power = m_input + ((size_t)size + padding - 1) / padding * padding;
+    m_output = alignedStart(m_outputStorage);
+    m_reserved = size;
+}
+
+int FFTEngine::windowCount(int numSamples, int windowSize, int hop)
+{
+    if (hop <= 0 || numSamples <= windowSize) {
+        return 1;
+    }
+    return 1 + (numSamples - windowSize + hop - 1) / hop;
+}
+
+void FFTEngine::spectra(const qint16 *samples, int numSamples, int channel, int numChannels, int windowSize, int hop, int windowCount,
+                        FFTTools::WindowType windowType, float param, float *out)
+{
+    if ((windowSize & 1) != 0 || windowSize < 2 || numChannels < 1) {
+        return;
+    }
+    reserve(windowSize);
+    Plan *currentPlan = plan(windowSize);
+    const float *windowFunction = nullptr;
+    float windowScaleFactor = 1;
+    if (windowType != FFTTools::Window_Rect) {
+        const std::vector<float> &values = window(windowType, windowSize, param);
+        windowFunction = values.data();
+        windowScaleFactor = 1.f / values[(size_t)windowSize];
+    }
+    const int bins = windowSize / 2;
+    // 20 * log10(2 * magnitude * scale / N) = 10 * log10(power) + 20 * log10(2 * scale / N), see FFTTools::fftNormalized
+    const float offset = 20.f * std::log10(windowScaleFactor / (float)bins);
+    float *input = m_input;
+    float *power = m_power;
+    const kiss_fft_cpx *output = m_output;
+
+    for (int w = 0; w < windowCount; ++w) {
+        const int first = w * hop;
+        const int available = qBound(0, numSamples - first, windowSize);
+        const qint16 *source = samples + (ptrdiff_t)first * numChannels + channel;
+        // Normalize signals to [0,1] to get correct dB values later on
+        for (int i = 0; i < available; ++i) {
+            input[i] = (float)source[(ptrdiff_t)i * numChannels] / 32767.0f;
+        }
+        std::fill(input + available, input + windowSize, 0.f);
+        if (windowFunction != nullptr) {
+            for (int i = 0; i < available; ++i) {
+                input[i] *= windowFunction[i];
+            }
+        }
+
+        kiss_fftr(currentPlan->cfg, input, m_output);
+
+        // The power is computed first in a loop the compiler can vectorise, the logarithms are then taken in a second pass
+        for (int i = 0; i < bins; ++i) {
+            power[i] = output[i].r * output[i].r + output[i].i * output[i].i;
+        }
+        float *target = out + (ptrdiff_t)w * bins;
+        for (int i = 0; i < bins; ++i) {
+            target[i] = power[i] > 0 ? 10.f * std::log10(power[i]) + offset : -std::numeric_limits<float>::infinity();
+        }
+    }
+}
+
+void FFTEngine::peakSpectrum(const qint16 *samples, int numSamples, int channel, int numChannels, int windowSize, FFTTools::WindowType windowType,
+                             float param, float *out)
+{
+    const int hop = windowSize / 2;
+    const int count = windowCount(numSamples, windowSize, hop);
+    if (count == 1) {
+        spectra(samples, numSamples, channel, numChannels, windowSize, hop, 1, windowType, param, out);
+        return;
+    }
+    const int bins = windowSize / 2;
+    m_peakScratch.resize((size_t)count * (size_t)bins);
+    spectra(samples, numSamples, channel, numChannels, windowSize, hop, count, windowType, param, m_peakScratch.data());
+    std::copy(m_peakScratch.begin(), m_peakScratch.begin() + bins, out);
+    for (int w = 1; w < count; ++w) {
+        const float *spectrum = m_peakScratch.data() + (size_t)w * (size_t)bins;
+        for (int i = 0; i < bins; ++i) {
+            out[i] = std::max(out[i], spectrum[i]);
+        }
+    }
+}
@@ -0,0 +1,82 @@
+/***************************************************************************
+ *   Copyright (C) 2019 by Kdenlive contributors                           *
+ *   This file is part of kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#ifndef FFTENGINE_H
+#define FFTENGINE_H
+
+#include "fftTools.h"
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+/**
+  Computes the power spectra of audio samples for the audio scopes.
+
+  The kiss_fft plans and the window functions are cached by size (and type
+  and parameter for the windows), the last ones used being looked up without
+  any search. The scratch buffers are allocated once for the largest window
+  used, aligned so that the windowing and power loops can be vectorised.
+  Several overlapping windows of a frame are processed in a single call.
+
+  An engine is meant to be owned by a single scope: it is not thread safe.
+  */
+class FFTEngine
+{
+public:
+    FFTEngine();
+    ~FFTEngine();
+
+    /** Computes the spectra of \c windowCount windows of \c windowSize samples of a channel, starting every \c hop samples.
+        Values are given in relative decibel, as by FFTTools::fftNormalized(). Samples past \c numSamples are taken as 0.
+        * samples: interleaved format with \c numChannels channels, \c numSamples samples per channel
+        * windowSize must be even
+        * out receives \c windowCount spectra of \c windowSize / 2 values each
+    */
+    void spectra(const qint16 *samples, int numSamples, int channel, int numChannels, int windowSize, int hop, int windowCount,
+                 FFTTools::WindowType windowType, float param, float *out);
+
+    /** Computes the spectra of the overlapping windows (half a window apart) covering the samples,
+        and writes the highest value of each frequency in \c out, of size \c windowSize / 2.
+        The peaks of the whole frame are shown this way, instead of the ones of its first window only. */
+    void peakSpectrum(const qint16 *samples, int numSamples, int channel, int numChannels, int windowSize, FFTTools::WindowType windowType,
+                      float param, float *out);
+
+    /** Returns the number of windows of \c windowSize samples, \c hop samples apart, needed to cover \c numSamples. At least 1 */
+    static int windowCount(int numSamples, int windowSize, int hop);
+
+private:
+    struct Plan;
+    /** Returns the plan of the given size, creating it if needed */
+    Plan *plan(int size);
+    /** Returns the window function (with its scale factor as last element), creating it if needed */
+    const std::vector<float> &window(FFTTools::WindowType windowType, int size, float param);
+    /** Makes the scratch buffers large enough for the given window size */
+    void reserve(int size);
+
+    std::map<int, std::unique_ptr<Plan>> m_plans;
+    std::map<std::tuple<int, int, float>, std::vector<float>> m_windows;
+    Plan *m_lastPlan{nullptr};
+    const std::vector<float> *m_lastWindow{nullptr};
+    std::tuple<int, int, float> m_lastWindowKey{0, 0, 0.f};
+
+    // Scratch buffers, over allocated to align their start
+    std::vector<float> m_inputStorage;
+    std::vector<kiss_fft_cpx> m_outputStorage;
+    float *m_input{nullptr};
+    kiss_fft_cpx *m_output{nullptr};
+    float *m_power{nullptr};
+    int m_reserved{0};
+    std::vector<float> m_peakScratch;
+
+    Q_DISABLE_COPY(FFTEngine)
+};
+
+#endif // FFTENGINE_H
@@ -9,6 +9,7 @@
  ***************************************************************************/
 
 #include "fftTools.h"
+#include "fftEngine.h"
 
 #include <cmath>
 #include <iostream>
@@ -25,26 +26,11 @@
 #endif
 
 FFTTools::FFTTools()
-    : m_fftCfgs()
-    , m_windowFunctions()
+    : m_engine(new FFTEngine)
 {
 }
-FFTTools::~FFTTools()
-{
-    QHash<QString, kiss_fftr_cfg>::iterator i;
-    for (i = m_fftCfgs.begin(); i != m_fftCfgs.end(); ++i) {
-        free(*i);
-    }
-}
 
-const QString FFTTools::windowSignature(const WindowType windowType, const int size, const float param)
-{
-    return QStringLiteral("s%1_t%2_p%3").arg(size).arg(windowType).arg(param, 0, 'f', 3);
-}
-const QString FFTTools::cfgSignature(const int size)
-{
-    return QStringLiteral("s%1").arg(size);
-}
+FFTTools::~FFTTools() = default;
 
 // http://cplusplus.syntaxerrors.info/index.php?title=Cannot_declare_member_function_%E2%80%98static_int_Foo::bar%28%29%E2%80%99_to_have_static_linkage
 const QVector<float> FFTTools::window(const WindowType windowType, const int size, const float param)
@@ -118,116 +104,16 @@ void FFTTools::fftNormalized(const audioShortVector &audioFrame, const uint chan
     QTime start = QTime::currentTime();
 #endif
 
-    const uint numSamples = (uint)audioFrame.size() / numChannels;
-
-    if (((windowSize & 1) != 0u) || windowSize < 2) {
+    if (((windowSize & 1) != 0u) || windowSize < 2 || numChannels == 0) {
         return;
     }
-
-    const QString cfgSig = cfgSignature((int)windowSize);
-    const QString winSig = windowSignature(windowType, (int)windowSize, param);
-
-    // Get the kiss_fft configuration from the config cache
-    // or build a new configuration if the requested one is not available.
-    kiss_fftr_cfg myCfg;
-    if (m_fftCfgs.contains(cfgSig)) {
-#ifdef DEBUG_FFTTOOLS
-        qCDebug(KDENLIVE_LOG) << "Re-using FFT configuration with size " << windowSize;
-#endif
-        myCfg = m_fftCfgs.value(cfgSig);
-    } else {
-#ifdef DEBUG_FFTTOOLS
-        qCDebug(KDENLIVE_LOG) << "Creating FFT configuration with size " << windowSize;
-#endif
-        myCfg = kiss_fftr_alloc((int)windowSize, 0, nullptr, nullptr);
-        m_fftCfgs.insert(cfgSig, myCfg);
-    }
-
-    // Get the window function from the cache
-    // (except for a rectangular window; nothing to do there).
-    QVector<float> window;
-    float windowScaleFactor = 1;
-    if (windowType != FFTTools::Window_Rect) {
-
-        if (m_windowFunctions.contains(winSig)) {
-#ifdef DEBUG_FFTTOOLS
-            qCDebug(KDENLIVE_LOG) << "Re-using window function with signature " << winSig;
-#endif
-            window = m_windowFunctions.value(winSig);
-        } else {
-#ifdef DEBUG_FFTTOOLS
-            qCDebug(KDENLIVE_LOG) << "Building new window function with signature " << winSig;
-#endif
-            window = FFTTools::window(windowType, (int)windowSize, 0);
-            m_windowFunctions.insert(winSig, window);
-        }
-        windowScaleFactor = 1.0 / window[(int)windowSize];
-    }
-
-    // Prepare frequency space vector. The resulting FFT vector is only half as long.
-    auto *freqData = new kiss_fft_cpx[int(windowSize) / 2];
-    auto *data = new float[(int)windowSize];
-
-    // Copy the first channel's audio into a vector for the FFT display;
-    // Fill the data vector indices that cannot be covered with sample data with 0
-    if (numSamples < windowSize) {
-        std::fill(&data[numSamples], &data[windowSize - 1], 0);
-    }
-    // Normalize signals to [0,1] to get correct dB values later on
-    for (uint i = 0; i < numSamples && i < windowSize; ++i) {
-        // Performance note: Benchmarking has shown that using the if/else inside the loop
-        // does not do noticeable worse than keeping it outside (perhaps the branch predictor
-        // is good enough), so it remains in there for better readability.
-        if (windowType != FFTTools::Window_Rect) {
-            data[i] = (float)audioFrame.data()[i * numChannels + channel] / 32767.0f * window[(int)i];
-        } else {
-            data[i] = (float)audioFrame.data()[i * numChannels + channel] / 32767.0f;
-        }
-    }
-
-    // Calculate the Fast Fourier Transform for the input data
-    kiss_fftr(myCfg, data, freqData);
-
-    // Logarithmic scale: 20 * log ( 2 * magnitude / N ) with magnitude = sqrt(r² + i²)
-    // with N = FFT size (after FFT, 1/2 window size)
-    for (uint i = 0; i < windowSize / 2; ++i) {
-        // Logarithmic scale: 20 * log ( 2 * magnitude / N ) with magnitude = sqrt(r² + i²)
-        // with N = FFT size (after FFT, 1/2 window size)
-        freqSpectrum[i] =
-            20 * log(pow(pow(fabs(freqData[i].r * windowScaleFactor), 2) + pow(fabs(freqData[i].i * windowScaleFactor), 2), .5) / ((float)windowSize / 2.0f)) /
-            log(10);
-        ;
-    }
-
-#ifdef DEBUG_FFTTOOLS
-    std::ofstream mFile;
-    mFile.open("/tmp/freq.m");
-    if (!mFile) {
-        qCDebug(KDENLIVE_LOG) << "Opening file failed.";
-    } else {
-        mFile << "val = [ ";
-
-        for (int sample = 0; sample < 256; ++sample) {
-            mFile << data[sample] << ' ';
-        }
-        mFile << " ];\n";
-
-        mFile << "freq = [ ";
-        for (int sample = 0; sample < 256; ++sample) {
-            mFile << freqData[sample].r << '+' << freqData[sample].i << "*i ";
-        }
-        mFile << " ];\n";
-
-        mFile.close();
-        qCDebug(KDENLIVE_LOG) << "File written.";
-    }
-#endif
+    const int numSamples = audioFrame.size() / (int)numChannels;
+    m_engine->spectra(audioFrame.constData(), numSamples, (int)channel, (int)numChannels, (int)windowSize, (int)windowSize, 1, windowType, param,
+                      freqSpectrum);
 
 #ifdef DEBUG_FFTTOOLS
     qCDebug(KDENLIVE_LOG) << "Calculated FFT in " << start.elapsed() << " ms.";
 #endif
-    delete[] freqData;
-    delete[] data;
 }
 
 const QVector<float> FFTTools::interpolatePeakPreserving(const QVector<float> &in, const uint targetSize, uint left, uint right, float fill)
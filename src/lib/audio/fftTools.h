@@ -13,8 +13,10 @@
 
 #include "../../definitions.h"
 #include "../external/kiss_fft/tools/kiss_fftr.h"
-#include <QHash>
 #include <QVector>
+#include <memory>
+
+class FFTEngine;
 
 class FFTTools
 {
@@ -39,12 +41,6 @@ public:
     */
     static const QVector<float> window(const WindowType windowType, const int size, const float param = 0);
 
-    static const QString windowSignature(const WindowType windowType, const int size, const float param = 0);
-
-    /** Returns a signature for a kiss_fft configuration
-        used as a hash in the cache */
-    static const QString cfgSignature(const int size);
-
     /** Calculates the Fourier Transformation of the input audio frame.
         The resulting values will be given in relative decibel: The maximum power is 0 dB, lower powers have
         negative dB values.
@@ -74,8 +70,7 @@ public:
     static const QVector<float> interpolatePeakPreserving(const QVector<float> &in, const uint targetSize, uint left = 0, uint right = 0, float fill = 0.0);
 
 private:
-    QHash<QString, kiss_fftr_cfg> m_fftCfgs;          // FFT cfg cache
-    QHash<QString, QVector<float>> m_windowFunctions; // Window function cache
+    std::unique_ptr<FFTEngine> m_engine; // Caches the FFT configurations, window functions and buffers
 };
 
 #endif // FFTTOOLS_H
@@ -52,6 +52,7 @@
 #include <QQmlEngine>
 #include <QUrl> //new
 #include <klocalizedstring.h>
+#include <cstdio>
 
 int main(int argc, char *argv[])
 {
@@ -173,6 +174,7 @@ int main(int argc, char *argv[])
     parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("mlt-path"), i18n("Set the path for MLT environment"), QStringLiteral("mlt-path")));
     parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("mlt-log"), i18n("MLT log level"), QStringLiteral("verbose/debug")));
     parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("i"), i18n("Comma separated list of clips to add"), QStringLiteral("clips")));
+    parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("timings"), i18n("Print the duration of the loading phases on exit")));
     parser.addPositionalArgument(QStringLiteral("file"), i18n("Document to open"));
 
     // Parse command line
@@ -218,6 +220,12 @@ int main(int argc, char *argv[])
     //splash->endSplash();
     //qApp->processEvents();
     int result = app.exec();
+    if (parser.isSet(QStringLiteral("timings"))) {
+        // Meant for performance regression checks
+        for (const auto &timing : pCore->timings()) {
+            fprintf(stderr, "%s: %lld ms\n", timing.first.toUtf8().constData(), (long long)timing.second);
+        }
+    }
     Core::clean();
 
     if (result == EXIT_RESTART || result == EXIT_CLEAN_RESTART) {
@@ -1811,20 +1811,27 @@ void MainWindow::slotCheckRenderStatus()
         m_renderWidget->missingClips(pCore->bin()->hasMissingClips());*/
 }
 
-void MainWindow::setRenderingProgress(const QString &url, int progress)
+void MainWindow::setRenderingProgress(const QString &url, int progress, int frame)
 {
-    emit setRenderProgress(progress);
     if (m_renderWidget) {
-        m_renderWidget->setRenderJob(url, progress);
+        m_renderWidget->setRenderJob(url, progress, frame);
+        // Several jobs may render at once, the render button shows their average progress
+        progress = qMax(0, m_renderWidget->runningJobsProgress());
     }
+    emit setRenderProgress(progress);
 }
 
 void MainWindow::setRenderingFinished(const QString &url, int status, const QString &error)
 {
-    emit setRenderProgress(100);
+    int progress = 100;
     if (m_renderWidget) {
         m_renderWidget->setRenderStatus(url, status, error);
+        int running = m_renderWidget->runningJobsProgress();
+        if (running >= 0) {
+            progress = running;
+        }
     }
+    emit setRenderProgress(progress);
 }
 
 void MainWindow::addProjectClip(const QString &url)
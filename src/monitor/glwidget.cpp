@@ -98,6 +98,7 @@ GLWidget::GLWidget(int id, QObject *parent)
     , m_audioWaveDisplayed(false)
     , m_fbo(nullptr)
     , m_shareContext(nullptr)
+    , m_audioRing(new AudioRing())
     , m_openGLSync(false)
     , m_ClientWaitSync(nullptr)
 {
@@ -113,6 +114,7 @@ GLWidget::GLWidget(int id, QObject *parent)
     m_texture[0] = m_texture[1] = m_texture[2] = 0;
     qRegisterMetaType<Mlt::Frame>("Mlt::Frame");
     qRegisterMetaType<SharedFrame>("SharedFrame");
+    qRegisterMetaType<ScopeFrame>("ScopeFrame");
 
     qmlRegisterType<QmlAudioThumb>("AudioThumb", 1, 0, "QmlAudioThumb");
     setPersistentOpenGLContext(true);
@@ -172,10 +174,21 @@ GLWidget::~GLWidget()
 void GLWidget::updateAudioForAnalysis()
 {
     if (m_frameRenderer) {
-        m_frameRenderer->sendAudioForAnalysis = KdenliveSettings::monitor_audio();
+        m_frameRenderer->sendAudioForAnalysis = KdenliveSettings::monitor_audio() || m_audioMeter;
     }
 }
 
+void GLWidget::setAudioMeter(bool enabled)
+{
+    m_audioMeter = enabled;
+    updateAudioForAnalysis();
+}
+
+std::shared_ptr<AudioRing> GLWidget::audioRing() const
+{
+    return m_audioRing;
+}
+
 void GLWidget::initializeGL()
 {
     if (m_isInitialized || !isVisible() || (openglContext() == nullptr)) return;
@@ -211,17 +224,15 @@ void GLWidget::initializeGL()
         m_shareContext->create();
     }
 
-    m_frameRenderer = new FrameRenderer(openglContext(), &m_offscreenSurface, m_ClientWaitSync);
+    m_frameRenderer = new FrameRenderer(openglContext(), &m_offscreenSurface, m_ClientWaitSync, m_audioRing.get());
 
-    m_frameRenderer->sendAudioForAnalysis = KdenliveSettings::monitor_audio();
+    m_frameRenderer->sendAudioForAnalysis = KdenliveSettings::monitor_audio() || m_audioMeter;
 
     openglContext()->makeCurrent(this);
     // openglContext()->blockSignals(false);
     connect(m_frameRenderer, &FrameRenderer::frameDisplayed, this, &GLWidget::frameDisplayed, Qt::QueuedConnection);
     connect(m_frameRenderer, &FrameRenderer::textureReady, this, &GLWidget::updateTexture, Qt::DirectConnection);
     connect(m_frameRenderer, &FrameRenderer::frameDisplayed, this, &GLWidget::onFrameDisplayed, Qt::QueuedConnection);
-
-    connect(m_frameRenderer, &FrameRenderer::audioSamplesSignal, this, &GLWidget::audioSamplesSignal, Qt::QueuedConnection);
     m_initSem.release();
     m_isInitialized = true;
     reconfigure();
@@ -590,27 +601,37 @@ void GLWidget::paintGL()
     check_error(f);
 
     if (m_sendFrame && m_analyseSem.tryAcquire(1)) {
-        // Render RGB frame for analysis
-        int fullWidth = pCore->getCurrentProfile()->width();
-        int fullHeight = pCore->getCurrentProfile()->height();
-        if ((m_fbo == nullptr) || m_fbo->size() != QSize(fullWidth, fullHeight)) {
-            delete m_fbo;
-            QOpenGLFramebufferObjectFormat fmt;
-            fmt.setSamples(1);
-            fmt.setInternalTextureFormat(GL_RGB);                             // GL_RGBA32F);  // which one is the fastest ?
-            m_fbo = new QOpenGLFramebufferObject(fullWidth, fullHeight, fmt); // GL_TEXTURE_2D);
+        // Frames rendered on the CPU are shared with the scopes as they are, without reading back the texture
+        SharedFrame frame;
+        if (m_glslManager == nullptr) {
+            QMutexLocker locker(&m_contextSharedAccess);
+            frame = m_sharedFrame;
         }
-        m_fbo->bind();
-        glViewport(0, 0, fullWidth, fullHeight);
+        if (frame.is_valid() && frame.get_image_format() == mlt_image_yuv420p) {
+            emit analyseFrame(ScopeFrame(frame));
+        } else {
+            // Render RGB frame for analysis
+            int fullWidth = pCore->getCurrentProfile()->width();
+            int fullHeight = pCore->getCurrentProfile()->height();
+            if ((m_fbo == nullptr) || m_fbo->size() != QSize(fullWidth, fullHeight)) {
+                delete m_fbo;
+                QOpenGLFramebufferObjectFormat fmt;
+                fmt.setSamples(1);
+                fmt.setInternalTextureFormat(GL_RGB);                             // GL_RGBA32F);  // which one is the fastest ?
+                m_fbo = new QOpenGLFramebufferObject(fullWidth, fullHeight, fmt); // GL_TEXTURE_2D);
+            }
+            m_fbo->bind();
+            glViewport(0, 0, fullWidth, fullHeight);
 
-        QMatrix4x4 projection2;
-        projection2.scale(2.0f / (float)width, 2.0f / (float)height);
-        m_shader->setUniformValue(m_projectionLocation, projection2);
+            QMatrix4x4 projection2;
+            projection2.scale(2.0f / (float)width, 2.0f / (float)height);
+            m_shader->setUniformValue(m_projectionLocation, projection2);
 
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, vertices.size());
-        check_error(f);
-        m_fbo->release();
-        emit analyseFrame(m_fbo->toImage());
+            glDrawArrays(GL_TRIANGLE_STRIP, 0, vertices.size());
+            check_error(f);
+            m_fbo->release();
+            emit analyseFrame(ScopeFrame(m_fbo->toImage()));
+        }
         m_sendFrame = false;
     }
     // Cleanup
@@ -1592,12 +1613,13 @@ void RenderThread::run()
     }
 }
 
-FrameRenderer::FrameRenderer(QOpenGLContext *shareContext, QSurface *surface, GLWidget::ClientWaitSync_fp clientWaitSync)
+FrameRenderer::FrameRenderer(QOpenGLContext *shareContext, QSurface *surface, GLWidget::ClientWaitSync_fp clientWaitSync, AudioRing *audioRing)
     : QThread(nullptr)
     , m_semaphore(3)
     , m_context(nullptr)
     , m_surface(surface)
     , m_ClientWaitSync(clientWaitSync)
+    , m_audioRing(audioRing)
     , m_gl32(nullptr)
     , sendAudioForAnalysis(false)
 {
@@ -1647,6 +1669,7 @@ void FrameRenderer::showFrame(Mlt::Frame frame)
         emit textureReady(m_displayTexture[0], m_displayTexture[1], m_displayTexture[2]);
         m_context->doneCurrent();
     }
+    publishAudio(frame);
     // The frame is now done being modified and can be shared with the rest
     // of the application.
     emit frameDisplayed(m_displayFrame);
@@ -1671,6 +1694,7 @@ void FrameRenderer::showGLFrame(Mlt::Frame frame)
         // Save this frame for future use and to keep a reference to the GL Texture.
         m_displayFrame = SharedFrame(frame);
     }
+    publishAudio(frame);
     // The frame is now done being modified and can be shared with the rest
     // of the application.
     emit frameDisplayed(m_displayFrame);
@@ -1694,12 +1718,32 @@ void FrameRenderer::showGLNoSyncFrame(Mlt::Frame frame)
         // Save this frame for future use and to keep a reference to the GL Texture.
         m_displayFrame = SharedFrame(frame);
     }
+    publishAudio(frame);
     // The frame is now done being modified and can be shared with the rest
     // of the application.
     emit frameDisplayed(m_displayFrame);
     m_semaphore.release();
 }
 
+void FrameRenderer::publishAudio(Mlt::Frame &frame)
+{
+    if (!sendAudioForAnalysis || m_audioRing == nullptr) {
+        return;
+    }
+    mlt_audio_format format = mlt_audio_s16;
+    int frequency = frame.get_int("audio_frequency");
+    int channels = frame.get_int("audio_channels");
+    int samples = frame.get_int("audio_samples");
+    if (samples <= 0 || channels <= 0) {
+        return;
+    }
+    // The samples are copied to a preallocated block, the readers pick them from the ring when they need them
+    const auto *data = static_cast<const qint16 *>(frame.get_audio(format, frequency, channels, samples));
+    if (data != nullptr && format == mlt_audio_s16) {
+        m_audioRing->write(data, channels, samples, frequency);
+    }
+}
+
 void FrameRenderer::cleanup()
 {
     if ((m_renderTexture[0] != 0u) && (m_renderTexture[1] != 0u) && (m_renderTexture[2] != 0u)) {
@@ -37,6 +37,8 @@
 #include "bin/model/markerlistmodel.hpp"
 #include "definitions.h"
 #include "kdenlivesettings.h"
+#include "scopes/audioring.h"
+#include "scopes/scopeframe.h"
 #include "scopes/sharedframe.h"
 
 class QOpenGLFunctions_3_2_Core;
@@ -94,6 +96,10 @@ public:
 
     int displayWidth() const { return m_rect.width(); }
     void updateAudioForAnalysis();
+    /** @brief Enables the audio sent to the ring when the audio meter is shown, even if the audio scopes are not used */
+    void setAudioMeter(bool enabled);
+    /** @brief Returns the ring receiving the audio of the displayed frames, read by the audio scopes and meter */
+    std::shared_ptr<AudioRing> audioRing() const;
     int displayHeight() const { return m_rect.height(); }
 
     QObject *videoWidget() { return this; }
@@ -179,8 +185,7 @@ signals:
     void switchFullScreen(bool minimizeOnly = false);
     void mouseSeek(int eventDelta, uint modifiers);
     void startDrag();
-    void analyseFrame(const QImage &);
-    void audioSamplesSignal(const audioShortVector &, int, int, int);
+    void analyseFrame(const ScopeFrame &);
     void showContextMenu(const QPoint &);
     void lockMonitor(bool);
     void passKeyEvent(QKeyEvent *);
@@ -254,6 +259,8 @@ protected:
     QOffscreenSurface m_offscreenSurface;
     SharedFrame m_sharedFrame;
     QOpenGLContext *m_shareContext;
+    std::shared_ptr<AudioRing> m_audioRing;
+    bool m_audioMeter{false};
 
     bool acquireSharedFrameTextures();
     void bindShaderProgram();
@@ -306,7 +313,7 @@ class FrameRenderer : public QThread
 {
     Q_OBJECT
 public:
-    explicit FrameRenderer(QOpenGLContext *shareContext, QSurface *surface, GLWidget::ClientWaitSync_fp clientWaitSync);
+    explicit FrameRenderer(QOpenGLContext *shareContext, QSurface *surface, GLWidget::ClientWaitSync_fp clientWaitSync, AudioRing *audioRing);
     ~FrameRenderer() override;
     QSemaphore *semaphore() { return &m_semaphore; }
     QOpenGLContext *context() const { return m_context; }
@@ -320,7 +327,6 @@ public slots:
 signals:
     void textureReady(GLuint yName, GLuint uName = 0, GLuint vName = 0);
     void frameDisplayed(const SharedFrame &frame);
-    void audioSamplesSignal(const audioShortVector &, int, int, int);
 
 private:
     QSemaphore m_semaphore;
@@ -328,8 +334,11 @@ private:
     QOpenGLContext *m_context;
     QSurface *m_surface;
     GLWidget::ClientWaitSync_fp m_ClientWaitSync;
+    AudioRing *m_audioRing;
 
     void pipelineSyncToFrame(Mlt::Frame &);
+    /** @brief Copies the audio of the frame to the audio ring if it is used */
+    void publishAudio(Mlt::Frame &frame);
 
 public:
     GLuint m_renderTexture[3];
@@ -51,6 +51,7 @@
 #include "kdenlive_debug.h"
 #include <QDesktopWidget>
 #include <QDrag>
+#include <QMetaMethod>
 #include <QFileDialog>
 #include <QMenu>
 #include <QMimeData>
@@ -301,8 +302,7 @@ Monitor::Monitor(Kdenlive::MonitorId id, MonitorManager *manager, QWidget *paren
     setMinimumHeight(200);
 
     connect(this, &Monitor::scopesClear, m_glMonitor, &GLWidget::releaseAnalyse, Qt::DirectConnection);
-    connect(m_glMonitor, &GLWidget::analyseFrame, this, &Monitor::frameUpdated);
-    connect(m_glMonitor, &GLWidget::audioSamplesSignal, this, &Monitor::audioSamplesSignal);
+    connect(m_glMonitor, &GLWidget::analyseFrame, this, &Monitor::slotAnalyseFrame);
 
     if (id != Kdenlive::ClipMonitor) {
         // TODO: reimplement
@@ -341,6 +341,7 @@ Monitor::Monitor(Kdenlive::MonitorId id, MonitorManager *manager, QWidget *paren
     int bm = 0;
     m_toolbar->getContentsMargins(nullptr, &tm, nullptr, &bm);
     m_audioMeterWidget = new MonitorAudioLevel(m_toolbar->height() - tm - bm, this);
+    m_audioMeterWidget->setAudioRing(m_glMonitor->audioRing());
     m_toolbar->addWidget(m_audioMeterWidget);
     if (!m_audioMeterWidget->isValid) {
         KdenliveSettings::setMonitoraudio(0x01);
@@ -1398,7 +1399,7 @@ void Monitor::slotOpenClip(const std::shared_ptr<ProjectClip> &controller, int i
         }
         m_glMonitor->setProducer(m_controller->originalProducer(), isActive(), in);
         m_audioMeterWidget->audioChannels = controller->audioInfo() ? controller->audioInfo()->channels() : 0;
-        m_glMonitor->setAudioThumb(controller->audioChannels(), controller->audioFrameCache);
+        m_glMonitor->setAudioThumb(controller->audioChannels(), controller->audioFrameLevels());
         m_controller->getMarkerModel()->registerSnapModel(m_snaps);
         m_glMonitor->getControllerProxy()->setClipHasAV(controller->hasAudioAndVideo());
         // hasEffects =  controller->hasEffects();
@@ -1676,6 +1677,11 @@ void Monitor::updateAudioForAnalysis()
     m_glMonitor->updateAudioForAnalysis();
 }
 
+std::shared_ptr<AudioRing> Monitor::audioRing() const
+{
+    return m_glMonitor->audioRing();
+}
+
 void Monitor::onFrameDisplayed(const SharedFrame &frame)
 {
     m_monitorManager->frameDisplayed(frame);
@@ -2037,11 +2043,9 @@ void Monitor::slotSwitchAudioMonitor()
 void Monitor::displayAudioMonitor(bool isActive)
 {
     bool enable = isActive && ((KdenliveSettings::monitoraudio() & m_id) != 0);
-    if (enable) {
-        connect(m_monitorManager, &MonitorManager::frameDisplayed, m_audioMeterWidget, &ScopeWidget::onNewFrame, Qt::UniqueConnection);
-    } else {
-        disconnect(m_monitorManager, &MonitorManager::frameDisplayed, m_audioMeterWidget, &ScopeWidget::onNewFrame);
-    }
+    // The meter reads the audio of this monitor from its ring
+    m_glMonitor->setAudioMeter(enable);
+    m_audioMeterWidget->setActive(enable);
     m_audioMeterWidget->setVisibility((KdenliveSettings::monitoraudio() & m_id) != 0);
 }
 
@@ -2119,6 +2123,15 @@ void Monitor::removeSnapPoint(int pos)
     m_snaps->removePoint(pos);
 }
 
+void Monitor::slotAnalyseFrame(const ScopeFrame &frame)
+{
+    emit scopeFrameUpdated(frame);
+    // Converting the frame to RGB is only worth it if someone needs the image
+    if (isSignalConnected(QMetaMethod::fromSignal(&AbstractMonitor::frameUpdated))) {
+        emit frameUpdated(frame.image());
+    }
+}
+
 void Monitor::slotZoomIn()
 {
     m_glMonitor->slotZoom(true);
@@ -24,6 +24,8 @@
 #include "bin/model/markerlistmodel.hpp"
 #include "definitions.h"
 #include "gentime.h"
+#include "scopes/audioring.h"
+#include "scopes/scopeframe.h"
 #include "scopes/sharedframe.h"
 #include "timecodedisplay.h"
 
@@ -130,6 +132,8 @@ public:
     void setEffectKeyframe(bool enable);
     void sendFrameForAnalysis(bool analyse);
     void updateAudioForAnalysis();
+    /** @brief Returns the ring receiving the audio of the displayed frames */
+    std::shared_ptr<AudioRing> audioRing() const;
     void switchMonitorInfo(int code);
     void switchDropFrames(bool drop);
     void updateMonitorGamma();
@@ -272,6 +276,8 @@ private slots:
     void slotSeekPosition(int);
     void addSnapPoint(int pos);
     void removeSnapPoint(int pos);
+    /** @brief Forward a frame rendered for analysis to the scopes, and as an image to the title widget if it listens */
+    void slotAnalyseFrame(const ScopeFrame &frame);
 
 public slots:
     void slotOpenDvdFile(const QString &);
@@ -362,6 +368,8 @@ signals:
     void removeSplitOverlay();
     void acceptRipple(bool);
     void switchTrimMode(int);
+    /** @brief The frame to analyse in the color scopes. */
+    void scopeFrameUpdated(const ScopeFrame &);
 };
 
 #endif
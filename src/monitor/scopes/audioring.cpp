@@ -0,0 +1,111 @@
+/***************************************************************************
+ *   Copyright (C) 2019 by Kdenlive contributors                           *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "audioring.h"
+
+#include <cstring>
+#include <vector>
+
+struct AudioRing::Block
+{
+    // Twice the number of the block once written, odd while it is being written
+    std::atomic<quint64> version{0};
+    int channels{0};
+    int samples{0};
+    int frequency{0};
+    std::vector<qint16> data;
+};
+
+AudioRing::AudioRing(int blocks, int maxSamples)
+    : m_blocks(new Block[(size_t)qMax(2, blocks)])
+    , m_count(qMax(2, blocks))
+    , m_maxSamples(qMax(1, maxSamples))
+{
+    for (int i = 0; i < m_count; ++i) {
+        m_blocks[(size_t)i].data.resize((size_t)m_maxSamples);
+    }
+}
+
+AudioRing::~AudioRing() = default;
+
+void AudioRing::write(const qint16 *data, int channels, int samples, int frequency)
+{
+    if (data == nullptr || channels <= 0 || samples <= 0) {
+        return;
+    }
+    const quint64 sequence = m_written.load(std::memory_order_relaxed) + 1;
+    Block &block = m_blocks[(size_t)(sequence % (quint64)m_count)];
+    // Only whole sample frames are kept
+    samples = qMin(samples, m_maxSamples / channels);
+    block.version.store(2 * sequence - 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    block.channels = channels;
+    block.samples = samples;
+    block.frequency = frequency;
+    memcpy(block.data.data(), data, (size_t)(channels * samples) * sizeof(qint16));
+    block.version.store(2 * sequence, std::memory_order_release);
+    m_written.store(sequence, std::memory_order_release);
+}
+
+quint64 AudioRing::lastSequence() const
+{
+    return m_written.load(std::memory_order_acquire);
+}
+
+int AudioRing::size() const
+{
+    return m_count;
+}
+
+bool AudioRing::read(quint64 sequence, AudioBlock &block) const
+{
+    if (sequence == 0) {
+        return false;
+    }
+    const Block &source = m_blocks[(size_t)(sequence % (quint64)m_count)];
+    if (block.data.capacity() < m_maxSamples) {
+        block.data.reserve(m_maxSamples);
+    }
+    if (source.version.load(std::memory_order_acquire) != 2 * sequence) {
+        return false;
+    }
+    const int channels = source.channels;
+    const int samples = source.samples;
+    const int frequency = source.frequency;
+    // The values may be torn if the block is written meanwhile, they are only trusted once the version is checked again
+    const int count = qBound(0, channels * samples, m_maxSamples);
+    block.data.resize(count);
+    memcpy(block.data.data(), source.data.data(), (size_t)count * sizeof(qint16));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (source.version.load(std::memory_order_relaxed) != 2 * sequence) {
+        return false;
+    }
+    block.channels = channels;
+    block.samples = samples;
+    block.frequency = frequency;
+    block.sequence = sequence;
+    return true;
+}
+
+bool AudioRing::readLatest(AudioBlock &block) const
+{
+    return read(lastSequence(), block);
+}
@@ -0,0 +1,86 @@
+/***************************************************************************
+ *   Copyright (C) 2019 by Kdenlive contributors                           *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef AUDIORING_H
+#define AUDIORING_H
+
+#include "definitions.h"
+#include <atomic>
+#include <memory>
+
+/** @brief A block of interleaved 16 bit samples, read from an AudioRing */
+struct AudioBlock
+{
+    audioShortVector data;
+    int channels{0};
+    int samples{0};
+    int frequency{0};
+    quint64 sequence{0};
+};
+
+/*!
+  \class AudioRing
+  \brief The audio of the frames played by a monitor, for the audio scopes and meters.
+
+  \threadsafe
+
+  The monitor renderer writes the samples of each displayed frame in the next
+  block of a preallocated ring, and the readers copy the blocks they need at
+  their own pace, so that no memory is allocated while playing. There is a
+  single writer and any number of readers, none of them ever waits: each
+  block carries a version that is odd while it is written, a reader checks it
+  before and after copying the block and discards the copy if it changed.
+
+  Blocks are numbered from 1. A reader falling behind more than the size of
+  the ring only gets the most recent blocks.
+*/
+class AudioRing
+{
+public:
+    /** @brief Allocates the ring
+        @param blocks is the number of blocks kept
+        @param maxSamples is the maximum number of samples of a block, all channels included. Longer frames are truncated */
+    explicit AudioRing(int blocks = 16, int maxSamples = 16384);
+    ~AudioRing();
+
+    /** @brief Copies the samples of a frame in the next block. Only called by the writer */
+    void write(const qint16 *data, int channels, int samples, int frequency);
+
+    /** @brief Returns the number of the last written block, 0 if none was written */
+    quint64 lastSequence() const;
+    /** @brief Returns the number of blocks kept by the ring */
+    int size() const;
+
+    /** @brief Copies a block. The capacity of the block data is reserved on the first call.
+        Returns false if the block was not written yet or was overwritten */
+    bool read(quint64 sequence, AudioBlock &block) const;
+    /** @brief Copies the last written block, returns false if there is none */
+    bool readLatest(AudioBlock &block) const;
+
+private:
+    struct Block;
+    std::unique_ptr<Block[]> m_blocks;
+    const int m_count;
+    const int m_maxSamples;
+    std::atomic<quint64> m_written{0};
+};
+
+#endif // AUDIORING_H
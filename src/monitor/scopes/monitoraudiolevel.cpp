@@ -20,11 +20,6 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "monitoraudiolevel.h"
-#include "core.h"
-#include "profiles/profilemodel.hpp"
-
-#include "mlt++/Mlt.h"
-
 #include <cmath>
 
 #include <QFont>
@@ -44,66 +39,100 @@ static inline double levelToDB(double level)
 MonitorAudioLevel::MonitorAudioLevel(int height, QWidget *parent)
     : ScopeWidget(parent)
     , audioChannels(2)
+    , isValid(true)
     , m_height(height)
     , m_channelHeight(height / 2)
     , m_channelDistance(2)
     , m_channelFillHeight(m_channelHeight)
 {
     setSizePolicy(QSizePolicy::MinimumExpanding, QSizePolicy::Preferred);
-    m_filter = new Mlt::Filter(pCore->getCurrentProfile()->profile(), "audiolevel");
-    if (!m_filter->is_valid()) {
-        isValid = false;
-        return;
+    // The meter is refreshed at most 25 times per second, whatever the frame rate
+    m_pollTimer.setInterval(40);
+    connect(&m_pollTimer, &QTimer::timeout, this, &MonitorAudioLevel::checkAudio);
+}
+
+MonitorAudioLevel::~MonitorAudioLevel() = default;
+
+void MonitorAudioLevel::setAudioRing(std::shared_ptr<AudioRing> ring)
+{
+    m_ring = std::move(ring);
+}
+
+void MonitorAudioLevel::setActive(bool active)
+{
+    if (active && m_ring) {
+        m_pollTimer.start();
+    } else {
+        m_pollTimer.stop();
     }
-    m_filter->set("iec_scale", 0);
-    isValid = true;
 }
 
-MonitorAudioLevel::~MonitorAudioLevel()
+void MonitorAudioLevel::checkAudio()
 {
-    delete m_filter;
+    if (m_ring->lastSequence() != m_readSequence) {
+        requestRefresh();
+    }
 }
 
 void MonitorAudioLevel::refreshScope(const QSize & /*size*/, bool /*full*/)
 {
-    SharedFrame sFrame;
-    while (m_queue.count() > 0) {
-        sFrame = m_queue.pop();
-        if (sFrame.is_valid() && sFrame.get_audio_samples() > 0) {
-            mlt_audio_format format = mlt_audio_s16;
-            int channels = sFrame.get_audio_channels();
-            int frequency = sFrame.get_audio_frequency();
-            int samples = sFrame.get_audio_samples();
-            Mlt::Frame mFrame = sFrame.clone(true, false, false);
-            m_filter->process(mFrame);
-            mFrame.get_audio(format, frequency, channels, samples);
-            if (samples == 0) {
-                // There was an error processing audio from frame
-                continue;
-            }
-            QVector<int> levels;
-            for (int i = 0; i < audioChannels; i++) {
-                QString s = QStringLiteral("meta.media.audio_level.%1").arg(i);
-                levels << (int)levelToDB(mFrame.get_double(s.toLatin1().constData()));
+    if (!m_ring) {
+        return;
+    }
+    const quint64 last = m_ring->lastSequence();
+    quint64 sequence = m_readSequence;
+    if (last == sequence) {
+        return;
+    }
+    // Peaks of all the blocks received since the last refresh, the older ones are lost anyway
+    sequence = qMax(sequence + 1, last >= (quint64)m_ring->size() ? last - (quint64)m_ring->size() + 1 : (quint64)1);
+    const int channels = audioChannels;
+    int peaks[32] = {0};
+    int blockChannels = 0;
+    for (; sequence <= last; ++sequence) {
+        if (!m_ring->read(sequence, m_block)) {
+            continue;
+        }
+        blockChannels = qMin(m_block.channels, 32);
+        const qint16 *data = m_block.data.constData();
+        for (int i = 0; i < m_block.samples; ++i) {
+            for (int c = 0; c < blockChannels; ++c) {
+                peaks[c] = qMax(peaks[c], qAbs((int)data[i * m_block.channels + c]));
             }
-            QMetaObject::invokeMethod(this, "setAudioValues", Qt::QueuedConnection, Q_ARG(const QVector<int> &, levels));
+        }
+    }
+    m_readSequence = last;
+    QMutexLocker lock(&m_levelMutex);
+    const auto count = (size_t)qBound(0, channels, 32);
+    const bool reset = m_values.size() != count;
+    m_values.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        // Same scale as the peak level of the MLT audiolevel filter
+        m_values[i] = (int)i < blockChannels ? (int)levelToDB(peaks[i] / 32768.) : -100;
+    }
+    if (reset) {
+        m_peaks = m_values;
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            m_peaks[i] = qMax(m_peaks[i] - 1, m_values[i]);
         }
     }
 }
 
 void MonitorAudioLevel::resizeEvent(QResizeEvent *event)
 {
-    drawBackground(m_peaks.size());
+    drawBackground(m_drawnChannels);
     ScopeWidget::resizeEvent(event);
 }
 
 void MonitorAudioLevel::refreshPixmap()
 {
-    drawBackground(m_peaks.size());
+    drawBackground(m_drawnChannels);
 }
 
 void MonitorAudioLevel::drawBackground(int channels)
 {
+    m_drawnChannels = channels;
     if (height() == 0) {
         return;
     }
@@ -191,24 +220,6 @@ void MonitorAudioLevel::drawBackground(int channels)
     p.end();
 }
 
-// cppcheck-suppress unusedFunction
-void MonitorAudioLevel::setAudioValues(const QVector<int> &values)
-{
-    m_values = values;
-    if (m_peaks.size() != m_values.size()) {
-        m_peaks = values;
-        drawBackground(values.size());
-    } else {
-        for (int i = 0; i < m_values.size(); i++) {
-            m_peaks[i]--;
-            if (m_values.at(i) > m_peaks.at(i)) {
-                m_peaks[i] = m_values.at(i);
-            }
-        }
-    }
-    update();
-}
-
 void MonitorAudioLevel::setVisibility(bool enable)
 {
     if (enable) {
@@ -226,10 +237,14 @@ void MonitorAudioLevel::paintEvent(QPaintEvent *pe)
     if (!isVisible()) {
         return;
     }
+    QMutexLocker lock(&m_levelMutex);
+    if ((int)m_values.size() != m_drawnChannels) {
+        drawBackground((int)m_values.size());
+    }
     QPainter p(this);
     p.setClipRect(pe->rect());
     QRect rect(0, 0, width(), height());
-    if (m_values.isEmpty()) {
+    if (m_values.empty()) {
         p.setOpacity(0.2);
         p.drawPixmap(rect, m_pixmap);
         return;
@@ -238,12 +253,13 @@ void MonitorAudioLevel::paintEvent(QPaintEvent *pe)
     p.setPen(palette().dark().color());
     p.setOpacity(0.9);
     int width = m_channelDistance == 1 ? rect.width() : rect.width() - 1;
-    for (int i = 0; i < m_values.count(); i++) {
-        if (m_values.at(i) >= 100) {
+    for (int i = 0; i < (int)m_values.size(); i++) {
+        if (m_values[(size_t)i] >= 100) {
             continue;
         }
-        int val = (50 + m_values.at(i)) / 150.0 * rect.width();
+        int val = (50 + m_values[(size_t)i]) / 150.0 * rect.width();
         p.fillRect(val, i * (m_channelHeight + m_channelDistance) + 1, width - val, m_channelFillHeight, palette().dark());
-        p.fillRect((50 + m_peaks.at(i)) / 150.0 * rect.width(), i * (m_channelHeight + m_channelDistance) + 1, 1, m_channelFillHeight, palette().text());
+        p.fillRect((50 + m_peaks[(size_t)i]) / 150.0 * rect.width(), i * (m_channelHeight + m_channelDistance) + 1, 1, m_channelFillHeight,
+                   palette().text());
     }
 }
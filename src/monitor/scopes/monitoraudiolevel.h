@@ -22,12 +22,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef MONITORAUDIOLEVEL_H
 #define MONITORAUDIOLEVEL_H
 
+#include "audioring.h"
 #include "scopewidget.h"
+#include <QTimer>
 #include <QWidget>
-
-namespace Mlt {
-class Filter;
-} // namespace Mlt
+#include <atomic>
+#include <memory>
+#include <vector>
 
 class MonitorAudioLevel : public ScopeWidget
 {
@@ -39,17 +40,28 @@ public:
     int audioChannels;
     bool isValid;
     void setVisibility(bool enable);
+    /** @brief Sets the ring the levels are computed from */
+    void setAudioRing(std::shared_ptr<AudioRing> ring);
+    /** @brief Starts or stops reading the audio ring */
+    void setActive(bool active);
 
 protected:
     void paintEvent(QPaintEvent *) override;
     void resizeEvent(QResizeEvent *event) override;
 
 private:
-    Mlt::Filter *m_filter;
     int m_height;
     QPixmap m_pixmap;
-    QVector<int> m_peaks;
-    QVector<int> m_values;
+    // Levels and peaks in dB, written by the refresh thread
+    QMutex m_levelMutex;
+    std::vector<int> m_peaks;
+    std::vector<int> m_values;
+    int m_drawnChannels{0};
+    // Audio ring, read at the pace of m_pollTimer
+    std::shared_ptr<AudioRing> m_ring;
+    QTimer m_pollTimer;
+    AudioBlock m_block;
+    std::atomic<quint64> m_readSequence{0};
     int m_channelHeight;
     int m_channelDistance;
     int m_channelFillHeight;
@@ -57,7 +69,7 @@ private:
     void refreshScope(const QSize &size, bool full) override;
 
 private slots:
-    void setAudioValues(const QVector<int> &values);
+    void checkAudio();
 };
 
 #endif
@@ -0,0 +1,129 @@
+/***************************************************************************
+ *   Copyright (C) 2019 by Kdenlive contributors                           *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "scopeframe.h"
+#include "scopes/colorscopes/scopekernels.h"
+
+#include <QMutex>
+#include <cstring>
+
+struct ScopeFrame::Private
+{
+    SharedFrame frame;
+    // Y, U and V planes of a yuv420p frame, null otherwise
+    const uchar *planes[3]{nullptr, nullptr, nullptr};
+    int strides[3]{0, 0, 0};
+    int width{0};
+    int height{0};
+    bool rec709{false};
+    bool fullRange{false};
+    uchar lumaTable[256];
+    QMutex mutex;
+    QImage image;
+};
+
+ScopeFrame::ScopeFrame()
+    : d(std::make_shared<Private>())
+{
+}
+
+ScopeFrame::ScopeFrame(const QImage &image)
+    : d(std::make_shared<Private>())
+{
+    d->image = image;
+    d->width = image.width();
+    d->height = image.height();
+}
+
+ScopeFrame::ScopeFrame(const SharedFrame &frame)
+    : d(std::make_shared<Private>())
+{
+    d->frame = frame;
+    if (!frame.is_valid() || frame.get_image_format() != mlt_image_yuv420p || frame.get_image() == nullptr) {
+        return;
+    }
+    d->width = frame.get_image_width();
+    d->height = frame.get_image_height();
+    d->planes[0] = frame.get_image();
+    d->strides[0] = d->width;
+    d->planes[1] = d->planes[0] + d->width * d->height;
+    d->strides[1] = d->width / 2;
+    d->planes[2] = d->planes[1] + (d->width / 2) * (d->height / 2);
+    d->strides[2] = d->width / 2;
+    // Frames without colorspace follow the usual convention: Rec. 709 for HD, Rec. 601 below
+    int colorspace = frame.get_int("colorspace");
+    d->rec709 = colorspace == 0 ? d->height >= 720 : colorspace == 709;
+    d->fullRange = frame.get_int("full_luma") != 0;
+    ScopeKernels::lumaRangeTable(d->fullRange, d->lumaTable);
+}
+
+bool ScopeFrame::isValid() const
+{
+    return d->width > 0 && d->height > 0;
+}
+
+int ScopeFrame::width() const
+{
+    return d->width;
+}
+
+int ScopeFrame::height() const
+{
+    return d->height;
+}
+
+bool ScopeFrame::hasLumaPlane(bool rec709) const
+{
+    return d->planes[0] != nullptr && d->rec709 == rec709;
+}
+
+void ScopeFrame::lumaLine(int row, uchar *luma) const
+{
+    const uchar *line = d->planes[0] + row * d->strides[0];
+    if (d->fullRange) {
+        memcpy(luma, line, (size_t)d->width);
+        return;
+    }
+    for (int x = 0; x < d->width; ++x) {
+        luma[x] = d->lumaTable[line[x]];
+    }
+}
+
+QImage ScopeFrame::image() const
+{
+    QMutexLocker lock(&d->mutex);
+    if (!d->image.isNull() || d->planes[0] == nullptr) {
+        return d->image;
+    }
+    QImage image(d->width, d->height, QImage::Format_ARGB32);
+    uchar *bits = image.bits();
+    const int bytesPerLine = image.bytesPerLine();
+    ScopeKernels::forEachBand(d->height, ScopeKernels::bandCount(d->height), [this, bits, bytesPerLine](int, int first, int end) {
+        for (int row = first; row < end; ++row) {
+            const uchar *y = d->planes[0] + row * d->strides[0];
+            const uchar *u = d->planes[1] + (row / 2) * d->strides[1];
+            const uchar *v = d->planes[2] + (row / 2) * d->strides[2];
+            ScopeKernels::yuvToRgb(y, u, v, d->width, d->rec709, d->fullRange, reinterpret_cast<QRgb *>(bits + row * bytesPerLine));
+        }
+    });
+    d->image = image;
+    return d->image;
+}
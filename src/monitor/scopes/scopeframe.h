@@ -0,0 +1,68 @@
+/***************************************************************************
+ *   Copyright (C) 2019 by Kdenlive contributors                           *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef SCOPEFRAME_H
+#define SCOPEFRAME_H
+
+#include "sharedframe.h"
+#include <QImage>
+#include <memory>
+
+/*!
+  \class ScopeFrame
+  \brief The frame sent by a monitor to the color scopes.
+
+  \threadsafe
+
+  ScopeFrame shares the frame shown by the monitor instead of copying it. When the
+  monitor displays a yuv420p frame, the scopes only needing the luma read it from
+  the Y plane. The ARGB32 image is converted on the first call to image(), and then
+  shared by all the scopes analysing the frame.
+
+  ScopeFrame is reference counted and can be copied and read from several threads.
+*/
+class ScopeFrame
+{
+public:
+    ScopeFrame();
+    /** @brief Wraps an image, for the monitors rendering their frames on the GPU */
+    explicit ScopeFrame(const QImage &image);
+    /** @brief Wraps a frame, its planes are only read directly if its image format is yuv420p */
+    explicit ScopeFrame(const SharedFrame &frame);
+
+    bool isValid() const;
+    int width() const;
+    int height() const;
+
+    /** @brief Returns true if the luma computed with the given recommendation can be read from the Y plane */
+    bool hasLumaPlane(bool rec709) const;
+    /** @brief Writes the full range luma of a row, read from the Y plane. Only valid if hasLumaPlane() */
+    void lumaLine(int row, uchar *luma) const;
+
+    /** @brief Returns the frame as an ARGB32 image, converting it on the first call */
+    QImage image() const;
+
+private:
+    struct Private;
+    std::shared_ptr<Private> d; // NOLINT
+};
+
+#endif // SCOPEFRAME_H
@@ -48,6 +48,14 @@ ProfileModel::ProfileModel(const QString &path)
     m_description = QString(m_profile->description());
 }
 
+ProfileModel::ProfileModel(const QString &path, Mlt::Properties &properties)
+    : m_path(path)
+    , m_invalid(false)
+    , m_profile(std::make_unique<Mlt::Profile>(properties))
+{
+    m_description = QString(m_profile->description());
+}
+
 bool ProfileModel::is_valid() const
 {
     return (!m_invalid) && m_profile->is_valid();
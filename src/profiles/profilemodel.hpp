@@ -43,6 +43,10 @@ public:
     /* @brief Constructs a profile using the path to the profile description
      */
     ProfileModel(const QString &path);
+
+    /* @brief Constructs a profile from already parsed values (as found in a profile description) instead of reading its file
+     */
+    ProfileModel(const QString &path, Mlt::Properties &properties);
     ~ProfileModel() override = default;
 
     bool is_valid() const override;
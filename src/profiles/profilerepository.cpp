@@ -23,13 +23,16 @@
 #include "kdenlive_debug.h"
 #include "kdenlivesettings.h"
 #include "profilemodel.hpp"
+#include "utils/metadatacache.hpp"
 #include <KLocalizedString>
 #include <KMessageBox>
 #include <KMessageWidget>
+#include <QDataStream>
 #include <QDir>
 #include <QStandardPaths>
 #include <algorithm>
 #include <mlt++/MltProfile.h>
+#include <mlt++/MltProperties.h>
 
 std::unique_ptr<ProfileRepository> ProfileRepository::instance;
 std::once_flag ProfileRepository::m_onceFlag;
@@ -81,13 +84,84 @@ void ProfileRepository::refresh(bool fullRefresh)
         }
     }
 
+    // The profiles parsed by a previous run are reused until one of the profile folders changes
+    QStringList folders = customProfilesDir;
+    folders << mltDir.absolutePath();
+    const MetadataCache cache(MetadataCache::location(QStringLiteral("profiles.cache")));
+    const QByteArray signature = MetadataCache::signature(folders);
+    if (loadCache(cache, signature)) {
+        return;
+    }
+
+    // Profiles that are already loaded are kept as they are, so the cache is only written if all profiles come from the current files
+    const bool parseAll = m_profiles.empty();
     // Iterate through files
     for (const auto &file : profilesFiles) {
+        if (m_profiles.count(file) > 0) {
+            // Already loaded, don't parse it again
+            continue;
+        }
         std::unique_ptr<ProfileModel> profile(new ProfileModel(file));
         if (check_profile(profile, file)) {
             m_profiles.insert(std::make_pair(file, std::move(profile)));
         }
     }
+    if (parseAll) {
+        saveCache(cache, signature);
+    }
+}
+
+bool ProfileRepository::loadCache(const MetadataCache &cache, const QByteArray &signature)
+{
+    QByteArray payload;
+    if (!cache.read(signature, payload)) {
+        return false;
+    }
+    QDataStream stream(payload);
+    quint32 count = 0;
+    stream >> count;
+    std::vector<std::pair<QString, QMap<QString, QString>>> profiles(count);
+    for (auto &profile : profiles) {
+        stream >> profile.first >> profile.second;
+    }
+    if (stream.status() != QDataStream::Ok) {
+        return false;
+    }
+    for (const auto &profile : profiles) {
+        if (m_profiles.count(profile.first) > 0) {
+            continue;
+        }
+        Mlt::Properties properties;
+        for (auto it = profile.second.constBegin(); it != profile.second.constEnd(); ++it) {
+            properties.set(it.key().toUtf8().constData(), it.value().toUtf8().constData());
+        }
+        m_profiles.insert(std::make_pair(profile.first, std::unique_ptr<ProfileModel>(new ProfileModel(profile.first, properties))));
+    }
+    return true;
+}
+
+void ProfileRepository::saveCache(const MetadataCache &cache, const QByteArray &signature) const
+{
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    stream << (quint32)m_profiles.size();
+    for (const auto &profile : m_profiles) {
+        const std::unique_ptr<ProfileModel> &model = profile.second;
+        QMap<QString, QString> values;
+        values.insert(QStringLiteral("description"), model->description());
+        values.insert(QStringLiteral("frame_rate_num"), QString::number(model->frame_rate_num()));
+        values.insert(QStringLiteral("frame_rate_den"), QString::number(model->frame_rate_den()));
+        values.insert(QStringLiteral("width"), QString::number(model->width()));
+        values.insert(QStringLiteral("height"), QString::number(model->height()));
+        values.insert(QStringLiteral("progressive"), QString::number(static_cast<int>(model->progressive())));
+        values.insert(QStringLiteral("sample_aspect_num"), QString::number(model->sample_aspect_num()));
+        values.insert(QStringLiteral("sample_aspect_den"), QString::number(model->sample_aspect_den()));
+        values.insert(QStringLiteral("display_aspect_num"), QString::number(model->display_aspect_num()));
+        values.insert(QStringLiteral("display_aspect_den"), QString::number(model->display_aspect_den()));
+        values.insert(QStringLiteral("colorspace"), QString::number(model->colorspace()));
+        stream << profile.first << values;
+    }
+    cache.write(signature, payload);
 }
 
 QVector<QPair<QString, QString>> ProfileRepository::getAllProfiles() const
@@ -35,6 +35,7 @@
  * Note that this class is a Singleton, with Mutex protections to allow concurrent access.
  */
 
+class MetadataCache;
 class ProfileModel;
 
 class ProfileRepository
@@ -83,6 +84,11 @@ protected:
     // Constructor is protected because class is a Singleton
     ProfileRepository();
 
+    /* @brief Adds the profiles stored in the cache by a previous refresh, returns false if the cache is missing or outdated */
+    bool loadCache(const MetadataCache &cache, const QByteArray &signature);
+    /* @brief Stores the values of the loaded profiles in the cache */
+    void saveCache(const MetadataCache &cache, const QByteArray &signature) const;
+
     static std::unique_ptr<ProfileRepository> instance;
     static std::once_flag m_onceFlag; // flag to create the repository only once;
 
@@ -21,6 +21,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "temporarydata.h"
 #include "doc/kdenlivedoc.h"
+#include "utils/proxystore.hpp"
+#include "utils/thumbnailcache.hpp"
 
 #include <KLocalizedString>
 #include <KMessageBox>
@@ -187,7 +189,7 @@ TemporaryData::TemporaryData(KdenliveDoc *doc, bool currentProjectOnly, QWidget
     m_grid->addWidget(del, 6, 4);
 
     m_currentPage->setLayout(m_grid);
-    m_proxies = m_doc->getProxyHashList();
+    m_proxies = m_doc->getProxyHashList(&m_sharedProxies);
     for (int i = 0; i < m_proxies.count(); i++) {
         m_proxies[i].append(QLatin1Char('*'));
     }
@@ -228,10 +230,14 @@ void TemporaryData::updateDataInfo()
         preview.setNameFilters(m_proxies);
         const QFileInfoList fList = preview.entryInfoList();
         KIO::filesize_t size = 0;
+        KIO::filesize_t shared = 0;
         for (const QFileInfo &info : fList) {
             size += (uint)info.size();
+            if (m_sharedProxies.contains(info.fileName())) {
+                shared += (uint)info.size();
+            }
         }
-        gotProxySize(size);
+        gotProxySize(size, shared);
     }
 
     preview = m_doc->getCacheDir(CacheAudio, &ok);
@@ -266,7 +272,7 @@ void TemporaryData::gotPreviewSize(KJob *job)
     updateTotal();
 }
 
-void TemporaryData::gotProxySize(KIO::filesize_t total)
+void TemporaryData::gotProxySize(KIO::filesize_t total, KIO::filesize_t shared)
 {
     QLayoutItem *button = m_grid->itemAtPosition(1, 4);
     if ((button != nullptr) && (button->widget() != nullptr)) {
@@ -274,7 +280,11 @@ void TemporaryData::gotProxySize(KIO::filesize_t total)
     }
     m_totalCurrent += total;
     m_currentSizes[1] = total;
-    m_proxySize->setText(KIO::convertSize(total));
+    if (shared > 0) {
+        m_proxySize->setText(i18n("%1 (%2 shared with other projects)", KIO::convertSize(total), KIO::convertSize(shared)));
+    } else {
+        m_proxySize->setText(KIO::convertSize(total));
+    }
     updateTotal();
 }
 
@@ -357,11 +367,27 @@ void TemporaryData::deleteProxy()
     }
     dir.setNameFilters(m_proxies);
     QStringList files = dir.entryList(QDir::Files);
-    if (KMessageBox::warningContinueCancelList(this, i18n("Delete all project data in the cache proxy folder:\n%1", dir.absolutePath()), files) !=
-        KMessageBox::Continue) {
+    // Proxies used by other projects are kept, only this project stops referencing them
+    for (const QString &file : m_sharedProxies) {
+        files.removeAll(file);
+    }
+    if (files.isEmpty() && !m_sharedProxies.isEmpty()) {
+        KMessageBox::information(this, i18n("All the proxy clips of this project are used by other projects, they will not be deleted."));
+    } else if (KMessageBox::warningContinueCancelList(this, i18n("Delete all project data in the cache proxy folder:\n%1", dir.absolutePath()), files) !=
+               KMessageBox::Continue) {
         return;
     }
+    std::unique_ptr<ProxyStore> store = m_doc->proxyStore();
+    const QString documentId = m_doc->getDocumentProperty(QStringLiteral("documentid"));
+    if (store) {
+        for (const QString &file : m_sharedProxies) {
+            store->removeReference(dir.absoluteFilePath(file), documentId);
+        }
+    }
     for (const QString &file : files) {
+        if (store) {
+            store->removeReference(dir.absoluteFilePath(file), documentId);
+        }
         dir.remove(file);
     }
     emit disableProxies();
@@ -396,6 +422,7 @@ void TemporaryData::deleteThumbs()
         return;
     }
     if (dir.dirName() == QLatin1String("videothumbs")) {
+        ThumbnailCache::get()->resetPersistentStore();
         dir.removeRecursively();
         dir.mkpath(QStringLiteral("."));
         updateDataInfo();
@@ -415,6 +442,7 @@ void TemporaryData::deleteCurrentCacheData()
     if (dir.dirName() == m_doc->getDocumentProperty(QStringLiteral("documentid"))) {
         emit disablePreview();
         emit disableProxies();
+        ThumbnailCache::get()->resetPersistentStore();
         dir.removeRecursively();
         m_doc->initCacheDirs();
         updateDataInfo();
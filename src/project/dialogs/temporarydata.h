@@ -117,6 +117,8 @@ private:
     QString m_processingDirectory;
     QDir m_globalDir;
     QStringList m_proxies;
+    /** @brief Proxy files of this project that other projects also use */
+    QStringList m_sharedProxies;
     QPushButton *m_globalDelete;
     void updateDataInfo();
     void updateGlobalInfo();
@@ -126,7 +128,7 @@ private:
 
 private slots:
     void gotPreviewSize(KJob *job);
-    void gotProxySize(KIO::filesize_t total);
+    void gotProxySize(KIO::filesize_t total, KIO::filesize_t shared);
     void gotAudioSize(KJob *job);
     void gotThumbSize(KJob *job);
     void gotFolderSize(KJob *job);
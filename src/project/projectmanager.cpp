@@ -44,6 +44,7 @@ the Free Software Foundation, either version 3 of the License, or
 #include <KConfigGroup>
 #include <QAction>
 #include <QCryptographicHash>
+#include <QElapsedTimer>
 #include <QFileDialog>
 #include <QLocale>
 #include <QMimeDatabase>
@@ -313,6 +314,8 @@ bool ProjectManager::saveFileAs(const QString &outputFileName)
         // The file filename does not have to exist for KAutoSaveFile to be constructed (if it exists, it will not be touched).
         m_project->m_autosave = new KAutoSaveFile(autosaveUrl, m_project);
     } else {
+        // The project was just saved, and the autosave must not be written while its file changes
+        m_project->clearAutoSave();
         m_project->m_autosave->setManagedFile(autosaveUrl);
     }
 
@@ -380,7 +383,7 @@ bool ProjectManager::saveFile()
         return saveFileAs();
     }
     bool result = saveFileAs(m_project->url().toLocalFile());
-    m_project->m_autosave->resize(0);
+    m_project->clearAutoSave();
     return result;
 }
 
@@ -654,15 +657,9 @@ void ProjectManager::slotAutoSave()
 {
     prepareSave();
     QString saveFolder = m_project->url().adjusted(QUrl::RemoveFilename | QUrl::StripTrailingSlash).toLocalFile();
-    QString scene = projectSceneList(saveFolder);
-    if (!m_replacementPattern.isEmpty()) {
-        QMapIterator<QString, QString> i(m_replacementPattern);
-        while (i.hasNext()) {
-            i.next();
-            scene.replace(i.key(), i.value());
-        }
-    }
-    m_project->slotAutoSave(scene);
+    // The scene list has to be built here: the MLT xml consumer walks the live tractor, which is modified on this thread
+    // and has no cheaper copy to hand to a worker. The replacements and the writing are done in a thread
+    m_project->slotAutoSave(projectSceneList(saveFolder), m_replacementPattern);
     m_lastSave.start();
 }
 
@@ -850,7 +847,10 @@ bool ProjectManager::updateTimeline(int pos, int scrollPos)
     }*/
     pCore->window()->getMainTimeline()->loading = true;
     pCore->window()->slotSwitchTimelineZone(m_project->getDocumentProperty(QStringLiteral("enableTimelineZone")).toInt() == 1);
+    QElapsedTimer timer;
+    timer.start();
     QScopedPointer<Mlt::Producer> xmlProd(new Mlt::Producer(pCore->getCurrentProfile()->profile(), "xml-string", m_project->getProjectXml().constData()));
+    pCore->addTiming(QStringLiteral("Project xml parsing"), timer.elapsed());
     Mlt::Service s(*xmlProd);
     Mlt::Tractor tractor(s);
     if (tractor.count() == 0) {
@@ -878,6 +878,7 @@ bool ProjectManager::updateTimeline(int pos, int scrollPos)
     if (!groupsData.isEmpty()) {
         m_mainTimelineModel->loadGroups(groupsData);
     }
+    pCore->addTiming(QStringLiteral("Project loading"), timer.elapsed());
 
     pCore->monitorManager()->projectMonitor()->setProducer(m_mainTimelineModel->producer(), pos);
     pCore->monitorManager()->projectMonitor()->adjustRulerSize(m_mainTimelineModel->duration() - 1, m_project->getGuideModel());
@@ -21,23 +21,20 @@
 
 AbstractAudioScopeWidget::AbstractAudioScopeWidget(bool trackMouse, QWidget *parent)
     : AbstractScopeWidget(trackMouse, parent)
-    , m_audioFrame()
-    , m_newData(0)
 {
 }
 
-void AbstractAudioScopeWidget::slotReceiveAudio(const audioShortVector &sampleData, int freq, int num_channels, int num_samples)
+void AbstractAudioScopeWidget::setAudioRing(std::shared_ptr<AudioRing> ring)
+{
+    // The ring is read by the rendering thread
+    std::atomic_store(&m_ring, std::move(ring));
+}
+
+void AbstractAudioScopeWidget::slotAudioUpdated()
 {
 #ifdef DEBUG_AASW
     qCDebug(KDENLIVE_LOG) << "Received audio for " << widgetName() << '.';
 #endif
-    m_audioFrame = sampleData;
-    m_freq = freq;
-    m_nChannels = num_channels;
-    m_nSamples = num_samples;
-
-    m_newData.fetchAndAddAcquire(1);
-
     AbstractScopeWidget::slotRenderZoneUpdated();
 }
 
@@ -45,9 +42,24 @@ AbstractAudioScopeWidget::~AbstractAudioScopeWidget() = default;
 
 QImage AbstractAudioScopeWidget::renderScope(uint accelerationFactor)
 {
-    const int newData = m_newData.fetchAndStoreAcquire(0);
-
-    return renderAudioScope(accelerationFactor, m_audioFrame, m_freq, m_nChannels, m_nSamples, newData);
+    int newData = 0;
+    const std::shared_ptr<AudioRing> ring = std::atomic_load(&m_ring);
+    if (ring) {
+        const quint64 previous = m_audioBlock.sequence;
+        // The block may be overwritten while it is copied, the next one is then read
+        for (int tries = 0; tries < 2 && ring->lastSequence() > m_audioBlock.sequence; ++tries) {
+            if (ring->readLatest(m_audioBlock)) {
+                break;
+            }
+        }
+        if (m_audioBlock.sequence != previous) {
+            newData = (int)qMin(m_audioBlock.sequence - previous, (quint64)ring->size());
+            m_freq = m_audioBlock.frequency;
+            m_nChannels = m_audioBlock.channels;
+            m_nSamples = m_audioBlock.samples;
+        }
+    }
+    return renderAudioScope(accelerationFactor, m_audioBlock.data, m_freq, m_nChannels, m_nSamples, newData);
 }
 
 #ifdef DEBUG_AASW
@@ -14,14 +14,19 @@
 #include <QWidget>
 
 #include <cstdint>
+#include <memory>
 
 #include "../../definitions.h"
 #include "../abstractscopewidget.h"
+#include "monitor/scopes/audioring.h"
 
 class Render;
 
 /**
  \brief Abstract class for scopes analyzing audio samples.
+
+ The samples are read from the audio ring of the active monitor when the scope
+ is rendered, so a scope only copies the last block of audio it needs.
  */
 class AbstractAudioScopeWidget : public AbstractScopeWidget
 {
@@ -30,8 +35,12 @@ public:
     explicit AbstractAudioScopeWidget(bool trackMouse = false, QWidget *parent = nullptr);
     ~AbstractAudioScopeWidget() override;
 
+    /** @brief Sets the ring the audio is read from, may be null */
+    void setAudioRing(std::shared_ptr<AudioRing> ring);
+
 public slots:
-    void slotReceiveAudio(const audioShortVector &sampleData, int freq, int num_channels, int num_samples);
+    /** @brief Tells the scope that new audio was written to its ring */
+    void slotAudioUpdated();
 
 protected:
     /** @brief This is just a wrapper function, subclasses can use renderAudioScope. */
@@ -49,8 +58,9 @@ protected:
     int m_nSamples{0};
 
 private:
-    audioShortVector m_audioFrame;
-    QAtomicInt m_newData;
+    std::shared_ptr<AudioRing> m_ring;
+    /** @brief The last block read, its capacity is allocated once */
+    AudioBlock m_audioBlock;
 };
 
 #endif // ABSTRACTAUDIOSCOPEWIDGET_H
@@ -28,6 +28,7 @@
 
 // (defined in the header file)
 #ifdef DETECT_OVERMODULATION
+#include <algorithm>
 #include <cmath>
 #include <limits>
 #endif
@@ -44,7 +45,6 @@
 
 AudioSpectrum::AudioSpectrum(QWidget *parent)
     : AbstractAudioScopeWidget(true, parent)
-    , m_fftTools()
     , m_lastFFT()
     , m_lastFFTLock(1)
     , m_peaks()
@@ -205,17 +205,18 @@ QImage AudioSpectrum::renderAudioScope(uint, const audioShortVector &audioFrame,
         m_ui->labelFFTSizeNumber->setText(QVariant(fftWindow).toString());
 
         // Get the spectral power distribution of the input samples,
-        // using the given window size and function
-        auto *freqSpectrum = new float[(uint)fftWindow / 2];
+        // using the given window size and function. All the windows covering
+        // the frame are analysed, keeping the peak of each frequency.
+        m_spectrum.resize((size_t)fftWindow / 2);
         FFTTools::WindowType windowType = (FFTTools::WindowType)m_ui->windowFunction->itemData(m_ui->windowFunction->currentIndex()).toInt();
-        m_fftTools.fftNormalized(audioFrame, 0, (uint)num_channels, freqSpectrum, windowType, (uint)fftWindow, 0);
+        m_fftEngine.peakSpectrum(audioFrame.constData(), num_samples, 0, num_channels, fftWindow, windowType, 0, m_spectrum.data());
 
         // Store the current FFT window (for the HUD) and run the interpolation
         // for easy pixel-based dB value access
         QVector<float> dbMap;
         m_lastFFTLock.acquire();
-        m_lastFFT = QVector<float>(fftWindow / 2);
-        memcpy(m_lastFFT.data(), &(freqSpectrum[0]), (uint)fftWindow / 2 * sizeof(float));
+        m_lastFFT.resize(fftWindow / 2);
+        std::copy(m_spectrum.begin(), m_spectrum.end(), m_lastFFT.begin());
 
         uint right = uint(((float)m_freqMax) / ((float)m_freq / 2.) * float(m_lastFFT.size() - 1));
         dbMap = FFTTools::interpolatePeakPreserving(m_lastFFT, (uint)m_innerScopeRect.width(), 0, right, -180);
@@ -224,7 +225,6 @@ QImage AudioSpectrum::renderAudioScope(uint, const audioShortVector &audioFrame,
 #ifdef DEBUG_AUDIOSPEC
         QTime drawTime = QTime::currentTime();
 #endif
-        delete[] freqSpectrum;
         // Draw the spectrum
         QImage spectrum(m_scopeRect.size(), QImage::Format_ARGB32);
         spectrum.fill(qRgba(0, 0, 0, 0));
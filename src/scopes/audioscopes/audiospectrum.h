@@ -12,7 +12,7 @@
 #define AUDIOSPECTRUM_H
 
 #include "abstractaudioscopewidget.h"
-#include "lib/audio/fftTools.h"
+#include "lib/audio/fftEngine.h"
 #include "lib/external/kiss_fft/tools/kiss_fftr.h"
 #include "ui_audiospectrum_ui.h"
 
@@ -64,7 +64,9 @@ private:
     QAction *m_aTrackMouse;
     QAction *m_aShowMax;
 
-    FFTTools m_fftTools;
+    FFTEngine m_fftEngine;
+    /** Spectrum of the last frame, kept to avoid an allocation per frame */
+    std::vector<float> m_spectrum;
     QVector<float> m_lastFFT;
     QSemaphore m_lastFFTLock;
 
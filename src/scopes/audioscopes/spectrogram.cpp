@@ -36,7 +36,6 @@
 
 Spectrogram::Spectrogram(QWidget *parent)
     : AbstractAudioScopeWidget(true, parent)
-    , m_fftTools()
     , m_fftHistory()
     , m_fftHistoryImg()
 
@@ -318,19 +317,15 @@ QImage Spectrogram::renderAudioScope(uint, const audioShortVector &audioFrame, c
 
         if (newDataAvailable) {
 
-            auto *freqSpectrum = new float[(uint)fftWindow / 2];
-
             // Get the spectral power distribution of the input samples,
-            // using the given window size and function
-            FFTTools::WindowType windowType = (FFTTools::WindowType)m_ui->windowFunction->itemData(m_ui->windowFunction->currentIndex()).toInt();
-            m_fftTools.fftNormalized(audioFrame, 0, (uint)num_channels, freqSpectrum, windowType, (uint)fftWindow, 0);
-
+            // using the given window size and function. All the windows
+            // covering the frame are analysed, keeping the peak of each frequency.
             // This method might be called also when a simple refresh is required.
             // In this case there is no data to append to the history. Only append new data.
+            FFTTools::WindowType windowType = (FFTTools::WindowType)m_ui->windowFunction->itemData(m_ui->windowFunction->currentIndex()).toInt();
             QVector<float> spectrumVector(fftWindow / 2);
-            memcpy(spectrumVector.data(), &freqSpectrum[0], (uint)fftWindow / 2 * sizeof(float));
+            m_fftEngine.peakSpectrum(audioFrame.constData(), num_samples, 0, num_channels, fftWindow, windowType, 0, spectrumVector.data());
             m_fftHistory.prepend(spectrumVector);
-            delete[] freqSpectrum;
         }
 #ifdef DEBUG_SPECTROGRAM
         else {
@@ -26,7 +26,7 @@
 #define SPECTROGRAM_H
 
 #include "abstractaudioscopewidget.h"
-#include "lib/audio/fftTools.h"
+#include "lib/audio/fftEngine.h"
 #include "ui_spectrogram_ui.h"
 
 class Spectrogram_UI;
@@ -57,7 +57,7 @@ protected:
 
 private:
     Ui::Spectrogram_UI *m_ui;
-    FFTTools m_fftTools;
+    FFTEngine m_fftEngine;
     QAction *m_aResetHz;
     QAction *m_aGrid;
     QAction *m_aTrackMouse;
@@ -16,6 +16,7 @@
 #include <QtCore>
 
 #include "../abstractscopewidget.h"
+#include "monitor/scopes/scopeframe.h"
 
 /**
 \brief Abstract class for scopes analyzing image frames.
@@ -34,21 +35,21 @@ protected:
     /** @brief Scope renderer. Must emit signalScopeRenderingFinished()
         when calculation has finished, to allow multi-threading.
         accelerationFactor hints how much faster than usual the calculation should be accomplished, if possible. */
-    virtual QImage renderGfxScope(uint accelerationFactor, const QImage &) = 0;
+    virtual QImage renderGfxScope(uint accelerationFactor, const ScopeFrame &) = 0;
 
     QImage renderScope(uint accelerationFactor) override;
 
     void mouseReleaseEvent(QMouseEvent *) override;
 
 private:
-    QImage m_scopeImage;
+    ScopeFrame m_scopeFrame;
     QMutex m_mutex;
 
 public slots:
     /** @brief Must be called when the active monitor has shown a new frame.
       This slot must be connected in the implementing class, it is *not*
       done in this abstract class. */
-    void slotRenderZoneUpdated(const QImage &);
+    void slotRenderZoneUpdated(const ScopeFrame &);
 
 protected slots:
     virtual void slotAutoRefreshToggled(bool autoRefresh);
@@ -122,7 +122,7 @@ QImage Histogram::renderHUD(uint)
     emit signalHUDRenderingFinished(0, 1);
     return QImage();
 }
-QImage Histogram::renderGfxScope(uint accelFactor, const QImage &qimage)
+QImage Histogram::renderGfxScope(uint accelFactor, const ScopeFrame &frame)
 {
     QTime start = QTime::currentTime();
     start.start();
@@ -133,7 +133,7 @@ QImage Histogram::renderGfxScope(uint accelFactor, const QImage &qimage)
 
     HistogramGenerator::Rec rec = m_aRec601->isChecked() ? HistogramGenerator::Rec_601 : HistogramGenerator::Rec_709;
 
-    QImage histogram = m_histogramGenerator->calculateHistogram(m_scopeRect.size(), qimage, componentFlags, rec, m_aUnscaled->isChecked(), accelFactor);
+    QImage histogram = m_histogramGenerator->calculateHistogram(m_scopeRect.size(), frame, componentFlags, rec, m_aUnscaled->isChecked(), accelFactor);
 
     emit signalScopeRenderingFinished(uint(start.elapsed()), accelFactor);
     return histogram;
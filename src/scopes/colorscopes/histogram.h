@@ -44,7 +44,7 @@ private:
     bool isScopeDependingOnInput() const override;
     bool isBackgroundDependingOnInput() const override;
     QImage renderHUD(uint accelerationFactor) override;
-    QImage renderGfxScope(uint accelerationFactor, const QImage &) override;
+    QImage renderGfxScope(uint accelerationFactor, const ScopeFrame &) override;
     QImage renderBackground(uint accelerationFactor) override;
     Ui::Histogram_UI *m_ui;
 };
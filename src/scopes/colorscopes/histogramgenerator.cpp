@@ -11,6 +11,8 @@
 #include "histogramgenerator.h"
 
 #include "klocalizedstring.h"
+#include "monitor/scopes/scopeframe.h"
+#include "scopekernels.h"
 #include <QImage>
 #include <QPainter>
 #include <algorithm>
@@ -18,10 +20,10 @@
 
 HistogramGenerator::HistogramGenerator() = default;
 
-QImage HistogramGenerator::calculateHistogram(const QSize &paradeSize, const QImage &image, const int &components, HistogramGenerator::Rec rec, bool unscaled,
-                                              uint accelFactor) const
+QImage HistogramGenerator::calculateHistogram(const QSize &paradeSize, const ScopeFrame &frame, const int &components, HistogramGenerator::Rec rec,
+                                              bool unscaled, uint accelFactor) const
 {
-    if (paradeSize.height() <= 0 || paradeSize.width() <= 0 || image.width() <= 0 || image.height() <= 0) {
+    if (paradeSize.height() <= 0 || paradeSize.width() <= 0 || !frame.isValid()) {
         return QImage();
     }
 
@@ -39,33 +41,66 @@ QImage HistogramGenerator::calculateHistogram(const QSize &paradeSize, const QIm
     std::fill(y, y + 256, 0);
     std::fill(s, s + 766, 0);
 
-    const uint iw = (uint)image.bytesPerLine();
-    const uint ih = (uint)image.height();
+    // The RGB components need the frame converted to RGB, the luma can be read from its Y plane
+    const bool rec709 = rec == HistogramGenerator::Rec_709;
+    const bool drawRGB = drawR || drawG || drawB || drawSum;
+    const bool lumaPlane = frame.hasLumaPlane(rec709);
+    QImage image;
+    if (drawRGB || (drawY && !lumaPlane)) {
+        image = frame.image();
+        if (image.depth() != 32) {
+            image = image.convertToFormat(QImage::Format_ARGB32);
+        }
+    }
     const uint ww = (uint)paradeSize.width();
     const uint wh = (uint)paradeSize.height();
-    const uint byteCount = iw * ih;
-
-    // Read the stats from the input image
-    for (int Y = 0; Y < image.height(); ++Y) {
-        for (int X = 0; X < image.width(); X += (int)accelFactor) {
-            QRgb col = image.pixel(X, Y);
-            r[qRed(col)]++;
-            g[qGreen(col)]++;
-            b[qBlue(col)]++;
+    const uint byteCount = 4 * (uint)frame.width() * (uint)frame.height();
+
+    // Read the stats from the input image. The acceleration factor skips rows, so that each analyzed row is read sequentially.
+    // Each band of rows counts the red, green, blue and luma values in its own histograms.
+    const int width = frame.width();
+    const int rowStep = (int)accelFactor;
+    const int rows = (frame.height() + rowStep - 1) / rowStep;
+    const int bands = ScopeKernels::bandCount(rows);
+    std::vector<std::vector<uint>> counts((size_t)bands);
+    ScopeKernels::forEachBand(rows, bands, [&](int band, int first, int end) {
+        std::vector<uint> &values = counts[(size_t)band];
+        values.assign(4 * 256, 0);
+        uint *red = values.data();
+        uint *green = red + 256;
+        uint *blue = green + 256;
+        uint *luma = blue + 256;
+        std::vector<uchar> lumaLine((size_t)width);
+        for (int row = first; row < end; ++row) {
+            const auto *line = image.isNull() ? nullptr : reinterpret_cast<const QRgb *>(image.constScanLine(row * rowStep));
+            if (drawRGB) {
+                for (int x = 0; x < width; ++x) {
+                    red[qRed(line[x])]++;
+                    green[qGreen(line[x])]++;
+                    blue[qBlue(line[x])]++;
+                }
+            }
             if (drawY) {
-                // Use if branch to avoid expensive multiplication if Y disabled
-                if (rec == HistogramGenerator::Rec_601) {
-                    y[(int)floor(.299 * qRed(col) + .587 * qGreen(col) + .114 * qBlue(col))]++;
+                // Only compute luma if Y is enabled
+                if (lumaPlane) {
+                    frame.lumaLine(row * rowStep, lumaLine.data());
                 } else {
-                    y[(int)floor(.2125 * qRed(col) + .7154 * qGreen(col) + .0721 * qBlue(col))]++;
+                    ScopeKernels::computeLuma(line, width, rec709, lumaLine.data());
+                }
+                for (int x = 0; x < width; ++x) {
+                    luma[lumaLine[(size_t)x]]++;
                 }
             }
-            if (drawSum) {
-                // Use an if branch here because the sum takes more operations than rgb
-                s[qRed(col)]++;
-                s[qGreen(col)]++;
-                s[qBlue(col)]++;
-            }
+        }
+    });
+    const std::vector<uint> &values = ScopeKernels::mergeCounts(counts);
+    for (int i = 0; i < 256; ++i) {
+        r[i] = (int)values[(size_t)i];
+        g[i] = (int)values[(size_t)i + 256];
+        b[i] = (int)values[(size_t)i + 512];
+        y[i] = (int)values[(size_t)i + 768];
+        if (drawSum) {
+            s[i] = r[i] + g[i] + b[i];
         }
     }
 
@@ -129,6 +164,7 @@ QImage HistogramGenerator::drawComponent(const int *y, const QSize &size, const
 
     const int partH = size.height();
 
+    std::vector<int> tops(max);
     for (uint x = 0; x < max; ++x) {
         // Calculate the height of the curve at position x
         int partY = int(scaling * (float)y[x]);
@@ -137,10 +173,16 @@ QImage HistogramGenerator::drawComponent(const int *y, const QSize &size, const
         if (partY > partH - 1) {
             partY = partH - 1;
         }
-        partY = partH - 1 - partY;
+        tops[x] = partH - 1 - partY;
+    }
 
-        for (int k = partH - 1; k >= partY; --k) {
-            component.setPixel((int)x, k, color.rgba());
+    const QRgb rgba = color.rgba();
+    for (int k = 0; k < partH; ++k) {
+        auto *line = reinterpret_cast<QRgb *>(component.scanLine(k));
+        for (uint x = 0; x < max; ++x) {
+            if (k >= tops[x]) {
+                line[x] = rgba;
+            }
         }
     }
     if (unscaled && size.width() >= component.width()) {
@@ -18,6 +18,7 @@ class QImage;
 class QPainter;
 class QRect;
 class QSize;
+class ScopeFrame;
 
 class HistogramGenerator : public QObject
 {
@@ -32,8 +33,9 @@ public:
     /**
         Calculates a histogram display from the input image.
         components are OR-ed HistogramGenerator::Components flags and decide with components (Y, R, G, B) to paint.
-        unscaled = true leaves the width at 256 if the widget is wider (to avoid scaling). */
-    QImage calculateHistogram(const QSize &paradeSize, const QImage &image, const int &components, const HistogramGenerator::Rec rec, bool unscaled,
+        unscaled = true leaves the width at 256 if the widget is wider (to avoid scaling).
+        When only Y is painted and the frame has a matching Y plane, the frame is not converted to RGB. */
+    QImage calculateHistogram(const QSize &paradeSize, const ScopeFrame &frame, const int &components, const HistogramGenerator::Rec rec, bool unscaled,
                               uint accelFactor = 1) const;
 
     QImage drawComponent(const int *y, const QSize &size, const float &scaling, const QColor &color, bool unscaled, uint max) const;
@@ -125,13 +125,13 @@ QImage RGBParade::renderHUD(uint)
     return hud;
 }
 
-QImage RGBParade::renderGfxScope(uint accelerationFactor, const QImage &qimage)
+QImage RGBParade::renderGfxScope(uint accelerationFactor, const ScopeFrame &frame)
 {
     QTime start = QTime::currentTime();
     start.start();
 
     int paintmode = m_ui->paintMode->itemData(m_ui->paintMode->currentIndex()).toInt();
-    QImage parade = m_rgbParadeGenerator->calculateRGBParade(m_scopeRect.size(), qimage, (RGBParadeGenerator::PaintMode)paintmode, m_aAxis->isChecked(),
+    QImage parade = m_rgbParadeGenerator->calculateRGBParade(m_scopeRect.size(), frame.image(), (RGBParadeGenerator::PaintMode)paintmode, m_aAxis->isChecked(),
                                                              m_aGradRef->isChecked(), accelerationFactor);
     emit signalScopeRenderingFinished((uint)start.elapsed(), accelerationFactor);
     return parade;
@@ -10,8 +10,10 @@
 
 #include "rgbparadegenerator.h"
 #include "klocalizedstring.h"
+#include "scopekernels.h"
 #include <QColor>
 #include <QPainter>
+#include <algorithm>
 
 #define CHOP255(a) ((255) < (a) ? (255) : int(a))
 #define CHOP1255(a) ((a) < (1) ? (1) : ((a) > (255) ? (255) : (a)))
@@ -23,13 +25,6 @@ const QColor RGBParadeGenerator::colSoft(150, 150, 150, 255);
 const uchar RGBParadeGenerator::distRight(40);
 const uchar RGBParadeGenerator::distBottom(40);
 
-struct StructRGB
-{
-    uint r;
-    uint g;
-    uint b;
-};
-
 RGBParadeGenerator::RGBParadeGenerator() = default;
 
 QImage RGBParadeGenerator::calculateRGBParade(const QSize &paradeSize, const QImage &image, const RGBParadeGenerator::PaintMode paintMode, bool drawAxis,
@@ -44,107 +39,109 @@ QImage RGBParadeGenerator::calculateRGBParade(const QSize &paradeSize, const QIm
     parade.fill(Qt::transparent);
 
     QPainter davinci(&parade);
+    const QImage frame = image.depth() == 32 ? image : image.convertToFormat(QImage::Format_ARGB32);
 
     const uint ww = (uint)paradeSize.width();
     const uint wh = (uint)paradeSize.height();
-    const uint iw = (uint)image.bytesPerLine();
-    const uint ih = (uint)image.height();
-    const uint byteCount = iw * ih; // Note that 1 px = 4 B
+    const int iw = frame.width();
+    const int ih = frame.height();
+    // The acceleration factor skips rows, so that each analyzed row is read sequentially
+    const int rowStep = (int)accelFactor;
+    const int rows = (ih + rowStep - 1) / rowStep;
 
     const uchar offset = 10;
     const uint partW = (ww - 2 * offset - distRight) / 3;
     const uint partH = wh - distBottom;
 
-    // Statistics
-    uchar minR = 255, minG = 255, minB = 255, maxR = 0, maxG = 0, maxB = 0, r, g, b;
-
     // Number of input pixels that will fall on one scope pixel.
     // Must be a float because the acceleration factor can be high, leading to <1 expected px per px.
-    const float pixelDepth = (float)((byteCount >> 2) / accelFactor) / float(partW * 255);
+    const float pixelDepth = (float)(iw * rows) / float(partW * 255);
     const float gain = 255 / (8 * pixelDepth);
     //        qCDebug(KDENLIVE_LOG) << "Pixel depth: expected " << pixelDepth << "; Gain: using " << gain << " (acceleration: " << accelFactor << "x)";
 
     QImage unscaled((int)ww - distRight, 256, QImage::Format_ARGB32);
     unscaled.fill(qRgba(0, 0, 0, 0));
 
-    const float wPrediv = (float)(partW - 1) / float((int)iw - 1);
-
-    std::vector<std::vector<StructRGB>> paradeVals(partW, std::vector<StructRGB>(256, {0, 0, 0}));
-
-    const uchar *bits = image.bits();
-    const uint stepsize = uint(uint(image.depth() / 8) * accelFactor);
-
-    for (uint i = 0, x = 0; i < byteCount; i += stepsize) {
-        auto *col = (const QRgb *)(bits);
-        r = (uchar)qRed(*col);
-        g = (uchar)qGreen(*col);
-        b = (uchar)qBlue(*col);
-
-        double dx = x * (double)wPrediv;
-
-        paradeVals[(size_t)dx][r].r++;
-        paradeVals[(size_t)dx][g].g++;
-        paradeVals[(size_t)dx][b].b++;
+    const float wPrediv = iw > 1 ? (float)(partW - 1) / float(iw - 1) : 0;
+    std::vector<uint> columns((size_t)iw);
+    for (int x = 0; x < iw; ++x) {
+        columns[(size_t)x] = uint((float)x * wPrediv);
+    }
 
-        if (r < minR) {
-            minR = r;
-        }
-        if (g < minG) {
-            minG = g;
-        }
-        if (b < minB) {
-            minB = b;
-        }
-        if (r > maxR) {
-            maxR = r;
-        }
-        if (g > maxG) {
-            maxG = g;
-        }
-        if (b > maxB) {
-            maxB = b;
+    // Histograms of the red, green and blue components, one after the other.
+    // Each of them is stored value by value, with one count per parade column.
+    const uint channelSize = 256 * partW;
+    const int bands = ScopeKernels::bandCount(rows, (qint64)iw * rows, 3 * (qint64)channelSize);
+    m_bandValues.resize((size_t)bands);
+    ScopeKernels::forEachBand(rows, bands, [&](int band, int first, int end) {
+        std::vector<uint> &values = m_bandValues[(size_t)band];
+        values.assign(3 * channelSize, 0);
+        uint *red = values.data();
+        uint *green = red + channelSize;
+        uint *blue = green + channelSize;
+        for (int row = first; row < end; ++row) {
+            const auto *line = reinterpret_cast<const QRgb *>(frame.constScanLine(row * rowStep));
+            for (int x = 0; x < iw; ++x) {
+                const QRgb col = line[x];
+                const uint column = columns[(size_t)x];
+                red[(uint)qRed(col) * partW + column]++;
+                green[(uint)qGreen(col) * partW + column]++;
+                blue[(uint)qBlue(col) * partW + column]++;
+            }
         }
+    });
+    const std::vector<uint> &values = ScopeKernels::mergeCounts(m_bandValues);
 
-        bits += stepsize;
-        x += stepsize;
-        x %= iw; // Modulo image width, to represent the current x position in the image
-    }
-
-    const int offset1 = (int)partW + (int)offset;
-    const int offset2 = 2 * (int)partW + 2 * (int)offset;
-    switch (paintMode) {
-    case PaintMode_RGB:
-        for (int i = 0; i < (int)partW; ++i) {
-            for (int j = 0; j < 256; ++j) {
-                unscaled.setPixel(i, j, qRgba(255, 10, 10, CHOP255(gain * (float)paradeVals[(size_t)i][(size_t)j].r)));
-                unscaled.setPixel(i + offset1, j, qRgba(10, 255, 10, CHOP255(gain * (float)paradeVals[(size_t)i][(size_t)j].g)));
-                unscaled.setPixel(i + offset2, j, qRgba(10, 10, 255, CHOP255(gain * (float)paradeVals[(size_t)i][(size_t)j].b)));
+    // Statistics
+    uchar minima[3] = {255, 255, 255};
+    uchar maxima[3] = {0, 0, 0};
+    for (uint channel = 0; channel < 3; ++channel) {
+        const uint *counts = values.data() + channel * channelSize;
+        for (uint j = 0; j < 256; ++j) {
+            if (std::any_of(counts + j * partW, counts + (j + 1) * partW, [](uint count) { return count > 0; })) {
+                minima[channel] = qMin(minima[channel], (uchar)j);
+                maxima[channel] = (uchar)j;
             }
         }
-        break;
-    default:
-        for (int i = 0; i < (int)partW; ++i) {
-            for (int j = 0; j < 256; ++j) {
-                unscaled.setPixel(i, j, qRgba(255, 255, 255, CHOP255(gain * (float)paradeVals[(size_t)i][(size_t)j].r)));
-                unscaled.setPixel(i + offset1, j, qRgba(255, 255, 255, CHOP255(gain * (float)paradeVals[(size_t)i][(size_t)j].g)));
-                unscaled.setPixel(i + offset2, j, qRgba(255, 255, 255, CHOP255(gain * (float)paradeVals[(size_t)i][(size_t)j].b)));
+    }
+    const uchar minR = minima[0], minG = minima[1], minB = minima[2];
+    const uchar maxR = maxima[0], maxG = maxima[1], maxB = maxima[2];
+
+    const QRgb channelColors[3] = {paintMode == PaintMode_RGB ? qRgb(255, 10, 10) : qRgb(255, 255, 255),
+                                   paintMode == PaintMode_RGB ? qRgb(10, 255, 10) : qRgb(255, 255, 255),
+                                   paintMode == PaintMode_RGB ? qRgb(10, 10, 255) : qRgb(255, 255, 255)};
+    std::vector<uint> alphas((size_t)qMin(ScopeKernels::maxCount(values), 65535u) + 1);
+    for (size_t count = 0; count < alphas.size(); ++count) {
+        alphas[count] = (uint)CHOP255(gain * (float)count);
+    }
+
+    // Value 0 is on the bottom line, the image is scaled to the target height afterwards
+    for (uint channel = 0; channel < 3; ++channel) {
+        const uint *counts = values.data() + channel * channelSize;
+        const uint partOffset = channel * (partW + offset);
+        const QRgb color = channelColors[channel] & 0xffffff;
+        for (uint j = 0; j < 256; ++j) {
+            auto *line = reinterpret_cast<QRgb *>(unscaled.scanLine(int(255 - j))) + partOffset;
+            const uint *row = counts + j * partW;
+            for (uint i = 0; i < partW; ++i) {
+                const uint alpha = row[i] < alphas.size() ? alphas[row[i]] : (uint)CHOP255(gain * (float)row[i]);
+                line[i] = color | (alpha << 24);
             }
         }
-        break;
     }
 
     // Scale the image to the target height. Scaling is not accomplished before because
     // there are only 255 different values which would lead to gaps if the height is not exactly 255.
     // Don't use bilinear transformation because the fast transformation meets the goal better.
-    davinci.drawImage(0, 0, unscaled.mirrored(false, true).scaled(unscaled.width(), (int)partH, Qt::IgnoreAspectRatio, Qt::FastTransformation));
+    davinci.drawImage(0, 0, unscaled.scaled(unscaled.width(), (int)partH, Qt::IgnoreAspectRatio, Qt::FastTransformation));
 
     if (drawAxis) {
-        QRgb opx;
         for (int i = 0; i <= 10; ++i) {
             double dy = (float)i / 10. * float((int)partH - 1);
+            auto *line = reinterpret_cast<QRgb *>(parade.scanLine((int)dy));
             for (int x = 0; x < (int)ww - (int)distRight; ++x) {
-                opx = parade.pixel(x, dy);
-                parade.setPixel(x, dy, qRgba(CHOP255(150 + qRed(opx)), 255, CHOP255(200 + qBlue(opx)), CHOP255(32 + qAlpha(opx))));
+                QRgb opx = line[x];
+                line[x] = qRgba(CHOP255(150 + qRed(opx)), 255, CHOP255(200 + qBlue(opx)), CHOP255(32 + qAlpha(opx)));
             }
         }
     }
@@ -12,6 +12,7 @@
 #define RGBPARADEGENERATOR_H
 
 #include <QObject>
+#include <vector>
 
 class QColor;
 class QImage;
@@ -32,6 +33,10 @@ public:
 
     static const uchar distRight;
     static const uchar distBottom;
+
+private:
+    /** @brief Histograms of each band of rows, kept between frames so that they are not allocated again */
+    std::vector<std::vector<uint>> m_bandValues;
 };
 
 #endif // RGBPARADEGENERATOR_H
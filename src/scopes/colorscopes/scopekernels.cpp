@@ -0,0 +1,215 @@
+/***************************************************************************
+ *   Copyright (C) 2019 by Kdenlive contributors                           *
+ *   This file is part of kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include "scopekernels.h"
+
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+// Luma coefficients in 1.15 fixed point, so that they fit the signed 16 bit multiplications of SSE2.
+// They sum up to 32768 so that white stays at 255.
+const int lumaWeights[2][3] = {
+    {9798, 19235, 3735}, // Rec. 601: .299, .587, .114
+    {6963, 23442, 2363}  // Rec. 709: .2125, .7154, .0721
+};
+
+// Chroma factors of the Y'CbCr to R'G'B' conversion: Cr for red, Cb and Cr for green, Cb for blue
+const double chromaFactors[2][4] = {
+    {1.402, .344136, .714136, 1.772},  // Rec. 601
+    {1.5748, .187324, .468124, 1.8556} // Rec. 709
+};
+
+// Bands smaller than this are not worth a thread
+const int minBandSize = 16;
+// Minimum number of pixels counted by a band for each entry of its histogram
+const qint64 minPixelsPerEntry = 2;
+// Histograms smaller than this are merged by a single thread
+const int minMergeSize = 65536;
+// Palettes are only cached for the counts below this limit
+const uint maxPaletteSize = 65536;
+
+inline uchar lumaOf(QRgb pixel, const int *weights)
+{
+    return uchar((qRed(pixel) * weights[0] + qGreen(pixel) * weights[1] + qBlue(pixel) * weights[2]) >> 15);
+}
+} // namespace
+
+void ScopeKernels::computeLumaGeneric(const QRgb *pixels, int count, bool rec709, uchar *luma)
+{
+    const int *weights = lumaWeights[rec709 ? 1 : 0];
+    for (int i = 0; i < count; ++i) {
+        luma[i] = lumaOf(pixels[i], weights);
+    }
+}
+
+void ScopeKernels::computeLuma(const QRgb *pixels, int count, bool rec709, uchar *luma)
+{
+    int i = 0;
+#ifdef __SSE2__
+    const int *weights = lumaWeights[rec709 ? 1 : 0];
+    const __m128i mask = _mm_set1_epi32(0xff);
+    // Blue in the low and green in the high 16 bits of each lane, so that a single madd computes b * kb + g * kg
+    const __m128i weightsBG = _mm_set1_epi32((weights[1] << 16) | weights[2]);
+    const __m128i weightsR = _mm_set1_epi32(weights[0]);
+    auto lumaOf4 = [&](const QRgb *source) {
+        __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source));
+        __m128i b = _mm_and_si128(p, mask);
+        __m128i g = _mm_and_si128(_mm_srli_epi32(p, 8), mask);
+        __m128i r = _mm_and_si128(_mm_srli_epi32(p, 16), mask);
+        __m128i bg = _mm_or_si128(b, _mm_slli_epi32(g, 16));
+        __m128i sum = _mm_add_epi32(_mm_madd_epi16(bg, weightsBG), _mm_madd_epi16(r, weightsR));
+        return _mm_srli_epi32(sum, 15);
+    };
+    for (; i + 8 <= count; i += 8) {
+        __m128i words = _mm_packs_epi32(lumaOf4(pixels + i), lumaOf4(pixels + i + 4));
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(luma + i), _mm_packus_epi16(words, words));
+    }
+#endif
+    computeLumaGeneric(pixels + i, count - i, rec709, luma + i);
+}
+
+void ScopeKernels::computeChromaGeneric(const QRgb *pixels, int count, const float coefficients[6], float *u, float *v)
+{
+    for (int i = 0; i < count; ++i) {
+        auto r = (float)qRed(pixels[i]);
+        auto g = (float)qGreen(pixels[i]);
+        auto b = (float)qBlue(pixels[i]);
+        u[i] = coefficients[0] * r + coefficients[1] * g + coefficients[2] * b;
+        v[i] = coefficients[3] * r + coefficients[4] * g + coefficients[5] * b;
+    }
+}
+
+void ScopeKernels::computeChroma(const QRgb *pixels, int count, const float coefficients[6], float *u, float *v)
+{
+    int i = 0;
+#ifdef __SSE2__
+    const __m128i mask = _mm_set1_epi32(0xff);
+    const __m128 ur = _mm_set1_ps(coefficients[0]);
+    const __m128 ug = _mm_set1_ps(coefficients[1]);
+    const __m128 ub = _mm_set1_ps(coefficients[2]);
+    const __m128 vr = _mm_set1_ps(coefficients[3]);
+    const __m128 vg = _mm_set1_ps(coefficients[4]);
+    const __m128 vb = _mm_set1_ps(coefficients[5]);
+    for (; i + 4 <= count; i += 4) {
+        __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pixels + i));
+        __m128 b = _mm_cvtepi32_ps(_mm_and_si128(p, mask));
+        __m128 g = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(p, 8), mask));
+        __m128 r = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(p, 16), mask));
+        // Same evaluation order as the generic version, so that both give the same results
+        _mm_storeu_ps(u + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(ur, r), _mm_mul_ps(ug, g)), _mm_mul_ps(ub, b)));
+        _mm_storeu_ps(v + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(vr, r), _mm_mul_ps(vg, g)), _mm_mul_ps(vb, b)));
+    }
+#endif
+    computeChromaGeneric(pixels + i, count - i, coefficients, u + i, v + i);
+}
+
+void ScopeKernels::yuvToRgb(const uchar *y, const uchar *u, const uchar *v, int count, bool rec709, bool fullRange, QRgb *pixels)
+{
+    // Conversion in 16.16 fixed point, video levels are scaled to the full range
+    const double *factors = chromaFactors[rec709 ? 1 : 0];
+    const double chromaScale = fullRange ? 65536. : 65536. * 255. / 224.;
+    const int lumaScale = fullRange ? 65536 : qRound(65536. * 255. / 219.);
+    const int lumaOffset = fullRange ? 0 : 16;
+    const int crRed = qRound(factors[0] * chromaScale);
+    const int cbGreen = qRound(factors[1] * chromaScale);
+    const int crGreen = qRound(factors[2] * chromaScale);
+    const int cbBlue = qRound(factors[3] * chromaScale);
+    for (int i = 0; i < count; ++i) {
+        const int luma = (y[i] - lumaOffset) * lumaScale + 32768;
+        const int cb = u[i / 2] - 128;
+        const int cr = v[i / 2] - 128;
+        pixels[i] = qRgb(qBound(0, (luma + crRed * cr) >> 16, 255), qBound(0, (luma - cbGreen * cb - crGreen * cr) >> 16, 255),
+                         qBound(0, (luma + cbBlue * cb) >> 16, 255));
+    }
+}
+
+void ScopeKernels::lumaRangeTable(bool fullRange, uchar table[256])
+{
+    for (int i = 0; i < 256; ++i) {
+        table[i] = fullRange ? uchar(i) : uchar(qBound(0, qRound((i - 16) * 255. / 219.), 255));
+    }
+}
+
+int ScopeKernels::bandCount(int count)
+{
+    return qBound(1, count / minBandSize, QThread::idealThreadCount());
+}
+
+int ScopeKernels::bandCount(int count, qint64 pixels, qint64 histogramSize)
+{
+    // Each band clears and merges a whole histogram, which is only worth it if the band counts more pixels than that
+    const qint64 maxBands = pixels / qMax<qint64>(1, minPixelsPerEntry * histogramSize);
+    return (int)qBound<qint64>(1, maxBands, bandCount(count));
+}
+
+void ScopeKernels::forEachBand(int count, int bands, const std::function<void(int, int, int)> &func)
+{
+    if (bands <= 1) {
+        func(0, 0, count);
+        return;
+    }
+    auto runBand = [count, bands, &func](int band) {
+        int first = int((qint64)count * band / bands);
+        int end = int((qint64)count * (band + 1) / bands);
+        func(band, first, end);
+    };
+    // The scopes are computed from threads of the global pool, waiting there for other tasks of the same pool could starve it
+    static QThreadPool pool;
+    std::vector<QFuture<void>> futures;
+    futures.reserve((size_t)bands - 1);
+    for (int band = 1; band < bands; ++band) {
+        futures.push_back(QtConcurrent::run(&pool, runBand, band));
+    }
+    // The calling thread processes the first band instead of just waiting
+    runBand(0);
+    for (auto &future : futures) {
+        future.waitForFinished();
+    }
+}
+
+std::vector<uint> &ScopeKernels::mergeCounts(std::vector<std::vector<uint>> &counts)
+{
+    std::vector<uint> &total = counts.front();
+    if (counts.size() < 2) {
+        return total;
+    }
+    const int size = (int)total.size();
+    forEachBand(size, qBound(1, size / minMergeSize, (int)counts.size()), [&counts, &total](int, int first, int end) {
+        uint *target = total.data();
+        for (size_t band = 1; band < counts.size(); ++band) {
+            const uint *source = counts[band].data();
+            for (int i = first; i < end; ++i) {
+                target[i] += source[i];
+            }
+        }
+    });
+    return total;
+}
+
+uint ScopeKernels::maxCount(const std::vector<uint> &counts)
+{
+    return counts.empty() ? 0 : *std::max_element(counts.begin(), counts.end());
+}
+
+std::vector<QRgb> ScopeKernels::buildPalette(uint maxCount, const std::function<QRgb(uint)> &color)
+{
+    std::vector<QRgb> palette((size_t)qMin(maxCount, maxPaletteSize - 1) + 1);
+    for (size_t i = 0; i < palette.size(); ++i) {
+        palette[i] = color((uint)i);
+    }
+    return palette;
+}
@@ -0,0 +1,67 @@
+/***************************************************************************
+ *   Copyright (C) 2019 by Kdenlive contributors                           *
+ *   This file is part of kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#ifndef SCOPEKERNELS_H
+#define SCOPEKERNELS_H
+
+#include <QRgb>
+#include <functional>
+#include <vector>
+
+/**
+  Building blocks shared by the color scope generators.
+
+  The per pixel conversions have a SSE2 implementation (used on all x86-64
+  builds) and a generic one giving exactly the same results, which is used
+  on other architectures and for the pixels left over by the vector loop.
+  Accumulation is done in parallel over bands of rows, each band filling
+  its own histogram which are summed afterwards.
+  */
+namespace ScopeKernels {
+
+/** @brief Computes the luma (0-255, truncated) of count ARGB32 pixels, using the Rec. 601 or Rec. 709 coefficients */
+void computeLuma(const QRgb *pixels, int count, bool rec709, uchar *luma);
+void computeLumaGeneric(const QRgb *pixels, int count, bool rec709, uchar *luma);
+
+/** @brief Computes the chroma components of count ARGB32 pixels.
+    coefficients holds the r, g, b factors of u followed by the ones of v */
+void computeChroma(const QRgb *pixels, int count, const float coefficients[6], float *u, float *v);
+void computeChromaGeneric(const QRgb *pixels, int count, const float coefficients[6], float *u, float *v);
+
+/** @brief Converts a row of yuv420p samples to count ARGB32 pixels, u and v holding one sample for two pixels.
+    fullRange is true if the samples use the whole [0, 255] range instead of the video levels */
+void yuvToRgb(const uchar *y, const uchar *u, const uchar *v, int count, bool rec709, bool fullRange, QRgb *pixels);
+/** @brief Fills the table mapping the samples of a Y plane to full range luma (0-255) */
+void lumaRangeTable(bool fullRange, uchar table[256]);
+
+/** @brief Returns the number of bands a loop over count rows should be split into */
+int bandCount(int count);
+/** @brief Returns the number of bands a loop over count rows, counting pixels values in a histogram of histogramSize entries per band, should be split
+    into */
+int bandCount(int count, qint64 pixels, qint64 histogramSize);
+/** @brief Calls func(band, first, end) for each of the bands splitting [0, count), in parallel.
+    The bands run on a pool dedicated to the scopes, the calling thread processing the first one. Returns once all bands are processed. */
+void forEachBand(int count, int bands, const std::function<void(int, int, int)> &func);
+/** @brief Adds the histograms of all bands into the first one, and returns it */
+std::vector<uint> &mergeCounts(std::vector<std::vector<uint>> &counts);
+
+/** @brief Returns the highest value of a histogram */
+uint maxCount(const std::vector<uint> &counts);
+/** @brief Computes the colors of the counts up to maxCount (at most 65536 of them) so that each color is only computed once */
+std::vector<QRgb> buildPalette(uint maxCount, const std::function<QRgb(uint)> &color);
+
+/** @brief Clamps a color component to [0, 255], negative or undefined values giving 0 */
+inline int clampByte(float value)
+{
+    return value > 0 ? (value < 255 ? int(value) : 255) : 0;
+}
+} // namespace ScopeKernels
+
+#endif // SCOPEKERNELS_H
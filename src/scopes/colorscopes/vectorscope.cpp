@@ -261,7 +261,7 @@ QImage Vectorscope::renderHUD(uint)
     return hud;
 }
 
-QImage Vectorscope::renderGfxScope(uint accelerationFactor, const QImage &qimage)
+QImage Vectorscope::renderGfxScope(uint accelerationFactor, const ScopeFrame &frame)
 {
     QTime start = QTime::currentTime();
     QImage scope;
@@ -273,7 +273,7 @@ QImage Vectorscope::renderGfxScope(uint accelerationFactor, const QImage &qimage
         VectorscopeGenerator::ColorSpace colorSpace =
             m_aColorSpace_YPbPr->isChecked() ? VectorscopeGenerator::ColorSpace_YPbPr : VectorscopeGenerator::ColorSpace_YUV;
         VectorscopeGenerator::PaintMode paintMode = (VectorscopeGenerator::PaintMode)m_ui->paintMode->itemData(m_ui->paintMode->currentIndex()).toInt();
-        scope = m_vectorscopeGenerator->calculateVectorscope(m_scopeRect.size(), qimage, m_gain, paintMode, colorSpace, m_aAxisEnabled->isChecked(),
+        scope = m_vectorscopeGenerator->calculateVectorscope(m_scopeRect.size(), frame.image(), m_gain, paintMode, colorSpace, m_aAxisEnabled->isChecked(),
                                                              accelerationFactor);
     }
 
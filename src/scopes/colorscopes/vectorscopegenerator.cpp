@@ -64,6 +64,7 @@ mRgb2YPbPr =                        r =
  */
 
 #include "vectorscopegenerator.h"
+#include "scopekernels.h"
 #include <QImage>
 #include <cmath>
 
@@ -122,109 +123,163 @@ QImage VectorscopeGenerator::calculateVectorscope(const QSize &vectorscopeSize,
     QImage scope = QImage(cw, cw, QImage::Format_ARGB32);
     scope.fill(qRgba(0, 0, 0, 0));
 
-    const uchar *bits = image.bits();
-
-    double dy, dr, dg, db, dmax;
-    double /*y,*/ u, v;
-    QPoint pt;
-    QRgb px;
-
-    const int stepsize = int(uint(image.depth() / 8) * accelFactor);
+    const QImage frame = image.depth() == 32 ? image : image.convertToFormat(QImage::Format_ARGB32);
+    const int iw = frame.width();
+    // The acceleration factor skips rows, so that each analyzed row is read sequentially
+    const int rowStep = (int)accelFactor;
+    const int rows = (frame.height() + rowStep - 1) / rowStep;
 
     // Just an average for the number of image pixels per scope pixel.
-    // NOTE: byteCount() has to be replaced by (img.bytesPerLine()*img.height()) for Qt 4.5 to compile, see:
-    // http://doc.trolltech.org/4.6/qimage.html#bytesPerLine
-    double avgPxPerPx = (double)image.depth() / 8 * (image.bytesPerLine() * image.height()) / scope.size().width() / scope.size().height() / accelFactor;
-
-    for (int i = 0; i < (image.bytesPerLine() * image.height()); i += stepsize) {
-        auto *col = (const QRgb *)(bits);
-
-        int r = qRed(*col);
-        int g = qGreen(*col);
-        int b = qBlue(*col);
-
-        switch (colorSpace) {
-        case VectorscopeGenerator::ColorSpace_YUV:
-            //             y = (double)  0.001173 * r +0.002302 * g +0.0004471* b;
-            u = (double)-0.0005781 * r - 0.001135 * g + 0.001713 * b;
-            v = (double)0.002411 * r - 0.002019 * g - 0.0003921 * b;
-            break;
-        case VectorscopeGenerator::ColorSpace_YPbPr:
-        default:
-            //             y = (double)  0.001173 * r +0.002302 * g +0.0004471* b;
-            u = (double)-0.0006671 * r - 0.001299 * g + 0.0019608 * b;
-            v = (double)0.001961 * r - 0.001642 * g - 0.0003189 * b;
-            break;
-        }
-
-        pt = mapToCircle(vectorscopeSize, QPointF(SCALING * gain * u, SCALING * gain * v));
-
-        if (pt.x() >= scope.width() || pt.x() < 0 || pt.y() >= scope.height() || pt.y() < 0) {
-            // Point lies outside (because of scaling), don't plot it
-
-        } else {
-
-            // Draw the pixel using the chosen draw mode.
-            switch (paintMode) {
-            case PaintMode_YUV:
-                // see yuvColorWheel
-                dy = 128; // Default Y value. Lower = darker.
-
-                // Calculate the RGB values from YUV/YPbPr
-                switch (colorSpace) {
-                case VectorscopeGenerator::ColorSpace_YUV:
-                    dr = dy + 290.8 * v;
-                    dg = dy - 100.6 * u - 148 * v;
-                    db = dy + 517.2 * u;
-                    break;
-                case VectorscopeGenerator::ColorSpace_YPbPr:
-                default:
-                    dr = dy + 357.5 * v;
-                    dg = dy - 87.75 * u - 182 * v;
-                    db = dy + 451.9 * u;
-                    break;
-                }
+    double avgPxPerPx = (double)iw * rows / scope.size().width() / scope.size().height();
+
+    float coefficients[6];
+    switch (colorSpace) {
+    case VectorscopeGenerator::ColorSpace_YUV:
+        //             y = (double)  0.001173 * r +0.002302 * g +0.0004471* b;
+        coefficients[0] = -0.0005781f;
+        coefficients[1] = -0.001135f;
+        coefficients[2] = 0.001713f;
+        coefficients[3] = 0.002411f;
+        coefficients[4] = -0.002019f;
+        coefficients[5] = -0.0003921f;
+        break;
+    case VectorscopeGenerator::ColorSpace_YPbPr:
+    default:
+        //             y = (double)  0.001173 * r +0.002302 * g +0.0004471* b;
+        coefficients[0] = -0.0006671f;
+        coefficients[1] = -0.001299f;
+        coefficients[2] = 0.0019608f;
+        coefficients[3] = 0.001961f;
+        coefficients[4] = -0.001642f;
+        coefficients[5] = -0.0003189f;
+        break;
+    }
 
-                if (dr < 0) {
-                    dr = 0;
-                }
-                if (dg < 0) {
-                    dg = 0;
-                }
-                if (db < 0) {
-                    db = 0;
-                }
-                if (dr > 255) {
-                    dr = 255;
+    // Same mapping as mapToCircle(), factored out of the pixel loop
+    const float xFactor = (float)(vectorscopeSize.width() - 1) / 2;
+    const float yFactor = (float)(vectorscopeSize.height() - 1);
+    const float uvScaling = SCALING * gain;
+
+    // The color of the YUV, Chroma and Original modes only depends on the last pixel hitting a point,
+    // the other modes only depend on the number of hits. Each band of rows records both for its rows.
+    const bool keepLast = paintMode == PaintMode_YUV || paintMode == PaintMode_Chroma || paintMode == PaintMode_Original;
+    const size_t scopeSize = (size_t)cw * (size_t)cw;
+    const int bands = ScopeKernels::bandCount(rows, (qint64)iw * rows, (qint64)scopeSize);
+    std::vector<std::vector<uint>> &hits = m_bandHits;
+    std::vector<std::vector<QRgb>> &lastPixels = m_bandLastPixels;
+    hits.resize((size_t)bands);
+    lastPixels.resize((size_t)bands);
+    ScopeKernels::forEachBand(rows, bands, [&](int band, int first, int end) {
+        std::vector<uint> &bandHits = hits[(size_t)band];
+        std::vector<QRgb> &bandLast = lastPixels[(size_t)band];
+        bandHits.assign(scopeSize, 0);
+        if (keepLast) {
+            bandLast.assign(scopeSize, 0);
+        }
+        std::vector<float> u((size_t)iw);
+        std::vector<float> v((size_t)iw);
+        for (int row = first; row < end; ++row) {
+            const auto *line = reinterpret_cast<const QRgb *>(frame.constScanLine(row * rowStep));
+            ScopeKernels::computeChroma(line, iw, coefficients, u.data(), v.data());
+            for (int x = 0; x < iw; ++x) {
+                int px = int(xFactor * (uvScaling * u[(size_t)x] + 1));
+                int py = int(yFactor * (1 - (uvScaling * v[(size_t)x] + 1) / 2));
+                if (px >= cw || px < 0 || py >= cw || py < 0) {
+                    // Point lies outside (because of scaling), don't plot it
+                    continue;
                 }
-                if (dg > 255) {
-                    dg = 255;
+                size_t index = (size_t)py * (size_t)cw + (size_t)px;
+                bandHits[index]++;
+                if (keepLast) {
+                    bandLast[index] = line[x];
                 }
-                if (db > 255) {
-                    db = 255;
+            }
+        }
+    });
+
+    // The last band hitting a point holds the pixel that would have been drawn last
+    std::vector<QRgb> &last = lastPixels.front();
+    if (keepLast) {
+        for (size_t band = 1; band < lastPixels.size(); ++band) {
+            for (size_t i = 0; i < scopeSize; ++i) {
+                if (hits[band][i] > 0) {
+                    last[i] = lastPixels[band][i];
                 }
-
-                scope.setPixel(pt, qRgba(dr, dg, db, 255));
+            }
+        }
+    }
+    const std::vector<uint> &counts = ScopeKernels::mergeCounts(hits);
+
+    // Colors of the modes blending each hit with the current color, indexed by the number of hits
+    std::vector<QRgb> palette;
+    if (!keepLast) {
+        palette.resize((size_t)qMin(ScopeKernels::maxCount(counts), 65535u) + 1);
+        palette[0] = qRgba(0, 0, 0, 0);
+        for (size_t i = 1; i < palette.size(); ++i) {
+            const QRgb px = palette[i - 1];
+            switch (paintMode) {
+            case PaintMode_Green:
+                palette[i] = qRgba(qRed(px) + (255 - qRed(px)) / (3 * avgPxPerPx), qGreen(px) + 20 * (255 - qGreen(px)) / (avgPxPerPx),
+                                   qBlue(px) + (255 - qBlue(px)) / (avgPxPerPx), qAlpha(px) + (255 - qAlpha(px)) / (avgPxPerPx));
+                break;
+            case PaintMode_Green2:
+                palette[i] = qRgba(qRed(px) + ceil((255 - (float)qRed(px)) / (4 * avgPxPerPx)), 255, qBlue(px) + ceil((255 - (float)qBlue(px)) / (avgPxPerPx)),
+                                   qAlpha(px) + ceil((255 - (float)qAlpha(px)) / (avgPxPerPx)));
+                break;
+            case PaintMode_Black:
+            default:
+                palette[i] = qRgba(0, 0, 0, qAlpha(px) + (255 - qAlpha(px)) / 20);
                 break;
+            }
+        }
+    }
 
-            case PaintMode_Chroma:
-                dy = 200; // Default Y value. Lower = darker.
-
-                // Calculate the RGB values from YUV/YPbPr
-                switch (colorSpace) {
-                case VectorscopeGenerator::ColorSpace_YUV:
-                    dr = dy + 290.8 * v;
-                    dg = dy - 100.6 * u - 148 * v;
-                    db = dy + 517.2 * u;
-                    break;
-                case VectorscopeGenerator::ColorSpace_YPbPr:
-                default:
-                    dr = dy + 357.5 * v;
-                    dg = dy - 87.75 * u - 182 * v;
-                    db = dy + 451.9 * u;
-                    break;
-                }
+    for (int j = 0; j < cw; ++j) {
+        auto *line = reinterpret_cast<QRgb *>(scope.scanLine(j));
+        const size_t offset = (size_t)j * (size_t)cw;
+        for (int i = 0; i < cw; ++i) {
+            const uint count = counts[offset + (size_t)i];
+            if (count == 0) {
+                continue;
+            }
+            if (!keepLast) {
+                // Past the end of the palette, the blending has converged
+                line[i] = count < palette.size() ? palette[count] : palette.back();
+                continue;
+            }
+            const QRgb col = last[offset + (size_t)i];
+            if (paintMode == PaintMode_Original) {
+                line[i] = col;
+                continue;
+            }
+            double dy, dr, dg, db, dmax;
+            double u = (double)coefficients[0] * qRed(col) + coefficients[1] * qGreen(col) + coefficients[2] * qBlue(col);
+            double v = (double)coefficients[3] * qRed(col) + coefficients[4] * qGreen(col) + coefficients[5] * qBlue(col);
+
+            // see yuvColorWheel
+            // Default Y value. Lower = darker.
+            dy = paintMode == PaintMode_YUV ? 128 : 200;
+
+            // Calculate the RGB values from YUV/YPbPr
+            switch (colorSpace) {
+            case VectorscopeGenerator::ColorSpace_YUV:
+                dr = dy + 290.8 * v;
+                dg = dy - 100.6 * u - 148 * v;
+                db = dy + 517.2 * u;
+                break;
+            case VectorscopeGenerator::ColorSpace_YPbPr:
+            default:
+                dr = dy + 357.5 * v;
+                dg = dy - 87.75 * u - 182 * v;
+                db = dy + 451.9 * u;
+                break;
+            }
 
+            if (paintMode == PaintMode_YUV) {
+                dr = qBound(0., dr, 255.);
+                dg = qBound(0., dg, 255.);
+                db = qBound(0., db, 255.);
+            } else {
                 // Scale the RGB values back to max 255
                 dmax = dr;
                 if (dg > dmax) {
@@ -238,31 +293,9 @@ QImage VectorscopeGenerator::calculateVectorscope(const QSize &vectorscopeSize,
                 dr *= dmax;
                 dg *= dmax;
                 db *= dmax;
-
-                scope.setPixel(pt, qRgba(dr, dg, db, 255));
-                break;
-            case PaintMode_Original:
-                scope.setPixel(pt, *col);
-                break;
-            case PaintMode_Green:
-                px = scope.pixel(pt);
-                scope.setPixel(pt, qRgba(qRed(px) + (255 - qRed(px)) / (3 * avgPxPerPx), qGreen(px) + 20 * (255 - qGreen(px)) / (avgPxPerPx),
-                                         qBlue(px) + (255 - qBlue(px)) / (avgPxPerPx), qAlpha(px) + (255 - qAlpha(px)) / (avgPxPerPx)));
-                break;
-            case PaintMode_Green2:
-                px = scope.pixel(pt);
-                scope.setPixel(pt,
-                               qRgba(qRed(px) + ceil((255 - (float)qRed(px)) / (4 * avgPxPerPx)), 255,
-                                     qBlue(px) + ceil((255 - (float)qBlue(px)) / (avgPxPerPx)), qAlpha(px) + ceil((255 - (float)qAlpha(px)) / (avgPxPerPx))));
-                break;
-            case PaintMode_Black:
-                px = scope.pixel(pt);
-                scope.setPixel(pt, qRgba(0, 0, 0, qAlpha(px) + (255 - qAlpha(px)) / 20));
-                break;
             }
+            line[i] = qRgba(dr, dg, db, 255);
         }
-
-        bits += stepsize;
     }
     return scope;
 }
@@ -13,6 +13,7 @@
 
 #include <QImage>
 #include <QObject>
+#include <vector>
 
 class QImage;
 class QPoint;
@@ -35,6 +36,11 @@ public:
 
 signals:
     void signalCalculationFinished(const QImage &image, uint ms);
+
+private:
+    /** @brief Hit counts and last hitting pixel of each band of rows, kept between frames so that they are not allocated again */
+    mutable std::vector<std::vector<uint>> m_bandHits;
+    mutable std::vector<std::vector<QRgb>> m_bandLastPixels;
 };
 
 #endif // VECTORSCOPEGENERATOR_H
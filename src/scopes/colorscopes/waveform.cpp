@@ -174,14 +174,14 @@ QImage Waveform::renderHUD(uint)
     return hud;
 }
 
-QImage Waveform::renderGfxScope(uint accelFactor, const QImage &qimage)
+QImage Waveform::renderGfxScope(uint accelFactor, const ScopeFrame &frame)
 {
     QTime start = QTime::currentTime();
     start.start();
 
     const int paintmode = m_ui->paintMode->itemData(m_ui->paintMode->currentIndex()).toInt();
     WaveformGenerator::Rec rec = m_aRec601->isChecked() ? WaveformGenerator::Rec_601 : WaveformGenerator::Rec_709;
-    QImage wave = m_waveformGenerator->calculateWaveform(scopeRect().size() - m_textWidth - QSize(0, m_paddingBottom), qimage,
+    QImage wave = m_waveformGenerator->calculateWaveform(scopeRect().size() - m_textWidth - QSize(0, m_paddingBottom), frame,
                                                          (WaveformGenerator::PaintMode)paintmode, true, rec, accelFactor);
 
     emit signalScopeRenderingFinished((uint)start.elapsed(), 1);
@@ -9,6 +9,8 @@
  ***************************************************************************/
 
 #include "waveformgenerator.h"
+#include "monitor/scopes/scopeframe.h"
+#include "scopekernels.h"
 
 #include <cmath>
 
@@ -24,7 +26,7 @@ WaveformGenerator::WaveformGenerator() = default;
 
 WaveformGenerator::~WaveformGenerator() = default;
 
-QImage WaveformGenerator::calculateWaveform(const QSize &waveformSize, const QImage &image, WaveformGenerator::PaintMode paintMode, bool drawAxis,
+QImage WaveformGenerator::calculateWaveform(const QSize &waveformSize, const ScopeFrame &frame, WaveformGenerator::PaintMode paintMode, bool drawAxis,
                                             WaveformGenerator::Rec rec, uint accelFactor)
 {
     Q_ASSERT(accelFactor >= 1);
@@ -32,107 +34,109 @@ QImage WaveformGenerator::calculateWaveform(const QSize &waveformSize, const QIm
     // QTime time;
     // time.start();
 
-    QImage wave(waveformSize, QImage::Format_ARGB32);
-
-    if (waveformSize.width() <= 0 || waveformSize.height() <= 0 || image.width() <= 0 || image.height() <= 0) {
+    if (waveformSize.width() <= 0 || waveformSize.height() <= 0 || !frame.isValid()) {
         return QImage();
     }
 
-    // Fill with transparent color
-    wave.fill(qRgba(0, 0, 0, 0));
+    QImage wave(waveformSize, QImage::Format_ARGB32);
+    // Only convert the frame to RGB if its luma cannot be read from the Y plane
+    const bool rec709 = rec == WaveformGenerator::Rec_709;
+    const bool lumaPlane = frame.hasLumaPlane(rec709);
+    QImage image;
+    if (!lumaPlane) {
+        image = frame.image();
+        if (image.depth() != 32) {
+            image = image.convertToFormat(QImage::Format_ARGB32);
+        }
+    }
 
     const uint ww = (uint)waveformSize.width();
     const uint wh = (uint)waveformSize.height();
-    const uint iw = (uint)image.bytesPerLine();
-    const uint ih = (uint)image.height();
-    const uint byteCount = iw * ih;
-
-    std::vector<std::vector<uint>> waveValues((size_t)waveformSize.width(), std::vector<uint>((size_t)waveformSize.height(), 0));
+    const int iw = frame.width();
+    const int ih = frame.height();
+    // The acceleration factor skips rows, so that each analyzed row is read sequentially
+    const int rowStep = (int)accelFactor;
+    const int rows = (ih + rowStep - 1) / rowStep;
 
     // Number of input pixels that will fall on one scope pixel.
     // Must be a float because the acceleration factor can be high, leading to <1 expected px per px.
-    const float pixelDepth = (float)((byteCount >> 2) / accelFactor) / float(ww * wh);
+    const float pixelDepth = (float)(iw * rows) / float(ww * wh);
     const float gain = 255. / (8. * pixelDepth);
     // qCDebug(KDENLIVE_LOG) << "Pixel depth: expected " << pixelDepth << "; Gain: using " << gain << " (acceleration: " << accelFactor << "x)";
 
     // Subtract 1 from sizes because we start counting from 0.
     // Not doing it would result in attempts to paint outside of the image.
     const float hPrediv = (float)(wh - 1) / 255.;
-    const float wPrediv = (float)(ww - 1) / float(iw - 1);
-
-    const uchar *bits = image.bits();
-    const int bpp = image.depth() / 8;
-
-    for (uint i = 0, x = 0; i < byteCount; i += (uint)bpp) {
-
-        Q_ASSERT(bits < image.bits() + byteCount);
-
-        double dY, dx, dy;
-        auto *col = (const QRgb *)bits;
+    const float wPrediv = iw > 1 ? (float)(ww - 1) / float(iw - 1) : 0;
+    std::vector<uint> columns((size_t)iw);
+    for (int x = 0; x < iw; ++x) {
+        columns[(size_t)x] = uint((float)x * wPrediv);
+    }
+    // Offset in the histogram of each luma value, the histogram is stored row by row (one row per luma level)
+    uint lumaOffsets[256];
+    for (uint y = 0; y < 256; ++y) {
+        lumaOffsets[y] = uint((float)y * hPrediv) * ww;
+    }
 
-        if (rec == WaveformGenerator::Rec_601) {
-            // CIE 601 Luminance
-            dY = .299 * qRed(*col) + .587 * qGreen(*col) + .114 * qBlue(*col);
-        } else {
-            // CIE 709 Luminance
-            dY = .2125 * qRed(*col) + .7154 * qGreen(*col) + .0721 * qBlue(*col);
-        }
-        // dY is on [0,255] now.
-
-        dy = dY * hPrediv;
-        dx = (float)x * wPrediv;
-        waveValues[(size_t)dx][(size_t)dy]++;
-
-        bits += bpp;
-        x += (uint)bpp;
-        if (x > iw) {
-            x -= iw;
-            if (accelFactor > 1) {
-                bits += bpp * (int)iw * ((int)accelFactor - 1);
-                i += (uint)bpp * iw * (accelFactor - 1);
+    // Each band of rows fills its own histogram
+    const int bands = ScopeKernels::bandCount(rows, (qint64)iw * rows, (qint64)ww * wh);
+    m_bandValues.resize((size_t)bands);
+    ScopeKernels::forEachBand(rows, bands, [&](int band, int first, int end) {
+        std::vector<uint> &values = m_bandValues[(size_t)band];
+        values.assign(ww * wh, 0);
+        std::vector<uchar> luma((size_t)iw);
+        for (int row = first; row < end; ++row) {
+            if (lumaPlane) {
+                frame.lumaLine(row * rowStep, luma.data());
+            } else {
+                const auto *line = reinterpret_cast<const QRgb *>(image.constScanLine(row * rowStep));
+                ScopeKernels::computeLuma(line, iw, rec709, luma.data());
+            }
+            for (int x = 0; x < iw; ++x) {
+                values[lumaOffsets[luma[(size_t)x]] + columns[(size_t)x]]++;
             }
         }
-    }
+    });
+    const std::vector<uint> &values = ScopeKernels::mergeCounts(m_bandValues);
 
+    std::function<QRgb(uint)> color;
     switch (paintMode) {
     case PaintMode_Green:
-        for (int i = 0; i < waveformSize.width(); ++i) {
-            for (int j = 0; j < waveformSize.height(); ++j) {
-                // Logarithmic scale. Needs fine tuning by hand, but looks great.
-                wave.setPixel(i, waveformSize.height() - j - 1,
-                              qRgba(CHOP255(52 * log(0.1 * gain * (float)waveValues[(size_t)i][(size_t)j])),
-                                    CHOP255(52 * std::log(gain * (float)waveValues[(size_t)i][(size_t)j])),
-                                    CHOP255(52 * log(.25 * gain * (float)waveValues[(size_t)i][(size_t)j])),
-                                    CHOP255(64 * std::log(gain * (float)waveValues[(size_t)i][(size_t)j]))));
-            }
-        }
+        color = [gain](uint count) {
+            // Logarithmic scale. Needs fine tuning by hand, but looks great.
+            const float value = gain * (float)count;
+            return qRgba(ScopeKernels::clampByte(52 * std::log(0.1f * value)), ScopeKernels::clampByte(52 * std::log(value)),
+                         ScopeKernels::clampByte(52 * std::log(.25f * value)), ScopeKernels::clampByte(64 * std::log(value)));
+        };
         break;
     case PaintMode_Yellow:
-        for (int i = 0; i < waveformSize.width(); ++i) {
-            for (int j = 0; j < waveformSize.height(); ++j) {
-                wave.setPixel(i, waveformSize.height() - j - 1, qRgba(255, 242, 0, CHOP255(gain * (float)waveValues[(size_t)i][(size_t)j])));
-            }
-        }
+        color = [gain](uint count) { return qRgba(255, 242, 0, ScopeKernels::clampByte(gain * (float)count)); };
         break;
     default:
-        for (int i = 0; i < waveformSize.width(); ++i) {
-            for (int j = 0; j < waveformSize.height(); ++j) {
-                wave.setPixel(i, waveformSize.height() - j - 1, qRgba(255, 255, 255, CHOP255(2. * gain * (float)waveValues[(size_t)i][(size_t)j])));
-            }
-        }
+        color = [gain](uint count) { return qRgba(255, 255, 255, ScopeKernels::clampByte(2.f * gain * (float)count)); };
         break;
     }
+    const std::vector<QRgb> palette = ScopeKernels::buildPalette(ScopeKernels::maxCount(values), color);
+
+    // Luma level 0 is on the bottom line
+    for (uint j = 0; j < wh; ++j) {
+        auto *line = reinterpret_cast<QRgb *>(wave.scanLine(int(wh - j - 1)));
+        const uint *counts = values.data() + j * ww;
+        for (uint i = 0; i < ww; ++i) {
+            line[i] = counts[i] < palette.size() ? palette[counts[i]] : color(counts[i]);
+        }
+    }
 
     if (drawAxis) {
         QPainter davinci(&wave);
-        QRgb opx;
         davinci.setPen(qRgba(150, 255, 200, 32));
         davinci.setCompositionMode(QPainter::CompositionMode_Overlay);
         for (int i = 0; i <= 10; ++i) {
             float dy = (float)i / 10. * ((int)wh - 1);
+            auto *line = reinterpret_cast<QRgb *>(wave.scanLine((int)dy));
             for (int x = 0; x < (int)ww; ++x) {
-                opx = wave.pixel(x, dy);
-                wave.setPixel(x, dy, qRgba(CHOP255(150 + qRed(opx)), 255, CHOP255(200 + qBlue(opx)), CHOP255(32 + qAlpha(opx))));
+                QRgb opx = line[x];
+                line[x] = qRgba(CHOP255(150 + qRed(opx)), 255, CHOP255(200 + qBlue(opx)), CHOP255(32 + qAlpha(opx)));
             }
         }
     }
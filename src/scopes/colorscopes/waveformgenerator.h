@@ -12,8 +12,10 @@
 #define WAVEFORMGENERATOR_H
 
 #include <QObject>
+#include <vector>
 class QImage;
 class QSize;
+class ScopeFrame;
 
 class WaveformGenerator : public QObject
 {
@@ -26,8 +28,13 @@ public:
     WaveformGenerator();
     ~WaveformGenerator() override;
 
-    QImage calculateWaveform(const QSize &waveformSize, const QImage &image, WaveformGenerator::PaintMode paintMode, bool drawAxis,
+    /** @brief Calculates the waveform of a frame. The luma is read from the Y plane of the frame if it has a matching one */
+    QImage calculateWaveform(const QSize &waveformSize, const ScopeFrame &frame, WaveformGenerator::PaintMode paintMode, bool drawAxis,
                              const WaveformGenerator::Rec rec, uint accelFactor = 1);
+
+private:
+    /** @brief Histogram of each band of rows, kept between frames so that they are not allocated again */
+    std::vector<std::vector<uint>> m_bandValues;
 };
 
 #endif // WAVEFORMGENERATOR_H
@@ -40,6 +40,9 @@ ScopeManager::ScopeManager(QObject *parent)
     connect(pCore->monitorManager(), &MonitorManager::clearScopes, this, &ScopeManager::slotClearColorScopes);
     connect(pCore->monitorManager(), &MonitorManager::checkScopes, this, &ScopeManager::slotCheckActiveScopes);
     connect(m_signalMapper, SIGNAL(mapped(QString)), SLOT(slotRequestFrame(QString)));
+    // Audio scopes read the ring at most 25 times per second
+    m_audioTimer.setInterval(40);
+    connect(&m_audioTimer, &QTimer::timeout, this, &ScopeManager::slotDistributeAudio);
 
     slotUpdateActiveRenderer();
 
@@ -68,6 +71,7 @@ bool ScopeManager::addScope(AbstractAudioScopeWidget *audioScope, QDockWidget *a
         AudioScopeData asd;
         asd.scope = audioScope;
         m_audioScopes.append(asd);
+        audioScope->setAudioRing(m_audioRing);
 
         connect(audioScope, &AbstractScopeWidget::requestAutoRefresh, this, &ScopeManager::slotCheckActiveScopes);
         if (audioScopeWidget != nullptr) {
@@ -113,16 +117,20 @@ bool ScopeManager::addScope(AbstractGfxScopeWidget *colorScope, QDockWidget *col
     return added;
 }
 
-void ScopeManager::slotDistributeAudio(const audioShortVector &sampleData, int freq, int num_channels, int num_samples)
+void ScopeManager::slotDistributeAudio()
 {
+    if (!m_audioRing || m_audioRing->lastSequence() == m_audioSequence) {
+        return;
+    }
+    m_audioSequence = m_audioRing->lastSequence();
 #ifdef DEBUG_SM
     qCDebug(KDENLIVE_LOG) << "ScopeManager: Starting to distribute audio.";
 #endif
     for (auto &m_audioScope : m_audioScopes) {
-        // Distribute audio to all scopes that are visible and want to be refreshed
+        // Notify all scopes that are visible and want to be refreshed, they read the audio themselves
         if (!m_audioScope.scope->visibleRegion().isEmpty()) {
             if (m_audioScope.scope->autoRefreshEnabled()) {
-                m_audioScope.scope->slotReceiveAudio(sampleData, freq, num_channels, num_samples);
+                m_audioScope.scope->slotAudioUpdated();
 #ifdef DEBUG_SM
                 qCDebug(KDENLIVE_LOG) << "ScopeManager: Distributed audio to " << m_audioScopes[i].scope->widgetName();
 #endif
@@ -130,7 +138,7 @@ void ScopeManager::slotDistributeAudio(const audioShortVector &sampleData, int f
         }
     }
 }
-void ScopeManager::slotDistributeFrame(const QImage &image)
+void ScopeManager::slotDistributeFrame(const ScopeFrame &frame)
 {
 #ifdef DEBUG_SM
     qCDebug(KDENLIVE_LOG) << "ScopeManager: Starting to distribute frame.";
@@ -138,7 +146,7 @@ void ScopeManager::slotDistributeFrame(const QImage &image)
     for (auto &m_colorScope : m_colorScopes) {
         if (!m_colorScope.scope->visibleRegion().isEmpty()) {
             if (m_colorScope.scope->autoRefreshEnabled()) {
-                m_colorScope.scope->slotRenderZoneUpdated(image);
+                m_colorScope.scope->slotRenderZoneUpdated(frame);
 #ifdef DEBUG_SM
                 qCDebug(KDENLIVE_LOG) << "ScopeManager: Distributed frame to " << m_colorScopes[i].scope->widgetName();
 #endif
@@ -146,7 +154,7 @@ void ScopeManager::slotDistributeFrame(const QImage &image)
                 // Special case: Auto refresh is disabled, but user requested an update (e.g. by clicking).
                 // Force the scope to update.
                 m_colorScope.singleFrameRequested = false;
-                m_colorScope.scope->slotRenderZoneUpdated(image);
+                m_colorScope.scope->slotRenderZoneUpdated(frame);
                 m_colorScope.scope->forceUpdateScope();
 #ifdef DEBUG_SM
                 qCDebug(KDENLIVE_LOG) << "ScopeManager: Distributed forced frame to " << m_colorScopes[i].scope->widgetName();
@@ -194,6 +202,16 @@ void ScopeManager::slotRequestFrame(const QString &widgetName)
 void ScopeManager::slotClearColorScopes()
 {
     m_lastConnectedRenderer = nullptr;
+    setAudioRing(nullptr);
+}
+
+void ScopeManager::setAudioRing(const std::shared_ptr<AudioRing> &ring)
+{
+    m_audioRing = ring;
+    m_audioSequence = 0;
+    for (auto &m_audioScope : m_audioScopes) {
+        m_audioScope.scope->setAudioRing(ring);
+    }
 }
 
 void ScopeManager::slotUpdateActiveRenderer()
@@ -213,9 +231,11 @@ void ScopeManager::slotUpdateActiveRenderer()
     }
 
     // Connect new renderer
-    if (m_lastConnectedRenderer != nullptr) {
-        connect(m_lastConnectedRenderer, &Monitor::frameUpdated, this, &ScopeManager::slotDistributeFrame, Qt::UniqueConnection);
-        connect(m_lastConnectedRenderer, &Monitor::audioSamplesSignal, this, &ScopeManager::slotDistributeAudio, Qt::UniqueConnection);
+    if (m_lastConnectedRenderer == nullptr) {
+        setAudioRing(nullptr);
+    } else {
+        connect(m_lastConnectedRenderer, &Monitor::scopeFrameUpdated, this, &ScopeManager::slotDistributeFrame, Qt::UniqueConnection);
+        setAudioRing(static_cast<Monitor *>(m_lastConnectedRenderer)->audioRing());
 
 #ifdef DEBUG_SM
         qCDebug(KDENLIVE_LOG) << "Renderer connected to ScopeManager: " << m_lastConnectedRenderer->id();
@@ -279,6 +299,11 @@ void ScopeManager::checkActiveAudioScopes()
 
     KdenliveSettings::setMonitor_audio(audioStillRequested);
     pCore->monitorManager()->slotUpdateAudioMonitoring();
+    if (audioStillRequested) {
+        m_audioTimer.start();
+    } else {
+        m_audioTimer.stop();
+    }
 }
 
 void ScopeManager::checkActiveColourScopes()
@@ -15,6 +15,8 @@
 #include "colorscopes/abstractgfxscopewidget.h"
 
 #include <QList>
+#include <QTimer>
+#include <memory>
 
 class QDockWidget;
 class AbstractMonitor;
@@ -72,6 +74,10 @@ private:
     QList<GfxScopeData> m_colorScopes;
 
     AbstractMonitor *m_lastConnectedRenderer{nullptr};
+    /** @brief Audio ring of the active monitor, checked by m_audioTimer while audio scopes are shown */
+    std::shared_ptr<AudioRing> m_audioRing;
+    QTimer m_audioTimer;
+    quint64 m_audioSequence{0};
 
     QSignalMapper *m_signalMapper;
 
@@ -91,6 +97,8 @@ private:
       New scopes are not detected automatically but have to be added.
      */
     void createScopes();
+    /** @brief Sets the audio ring read by the audio scopes */
+    void setAudioRing(const std::shared_ptr<AudioRing> &ring);
 
     /**
       Creates a dock for @param scopeWidget with the title @param title and
@@ -127,8 +135,9 @@ private slots:
       */
     void checkActiveColourScopes();
 
-    void slotDistributeFrame(const QImage &image);
-    void slotDistributeAudio(const audioShortVector &sampleData, int freq, int num_channels, int num_samples);
+    void slotDistributeFrame(const ScopeFrame &frame);
+    /** @brief Notifies the audio scopes if new audio was written to the ring */
+    void slotDistributeAudio();
     /**
       Allows a scope to explicitly request a new frame, even if the scope's autoRefresh is disabled.
       */
@@ -33,6 +33,7 @@
 #include <KLocalizedString>
 #include <KMessageBox>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QSet>
 #include <mlt++/MltPlaylist.h>
 #include <mlt++/MltProducer.h>
@@ -42,12 +43,14 @@
 static QStringList m_errorMessage;
 
 bool constructTrackFromMelt(const std::shared_ptr<TimelineItemModel> &timeline, int tid, Mlt::Tractor &track,
-                            const std::unordered_map<QString, QString> &binIdCorresp, Fun &undo, Fun &redo, bool audioTrack);
+                            const std::unordered_map<QString, QString> &binIdCorresp, bool audioTrack);
 bool constructTrackFromMelt(const std::shared_ptr<TimelineItemModel> &timeline, int tid, Mlt::Playlist &track,
-                            const std::unordered_map<QString, QString> &binIdCorresp, Fun &undo, Fun &redo, bool audioTrack);
+                            const std::unordered_map<QString, QString> &binIdCorresp, bool audioTrack);
 
 bool constructTimelineFromMelt(const std::shared_ptr<TimelineItemModel> &timeline, Mlt::Tractor tractor)
 {
+    QElapsedTimer timer;
+    timer.start();
     Fun undo = []() { return true; };
     Fun redo = []() { return true; };
     // First, we destruct the previous tracks
@@ -55,6 +58,7 @@ bool constructTimelineFromMelt(const std::shared_ptr<TimelineItemModel> &timelin
     m_errorMessage.clear();
     std::unordered_map<QString, QString> binIdCorresp;
     pCore->projectItemModel()->loadBinPlaylist(&tractor, timeline->tractor(), binIdCorresp);
+    pCore->addTiming(QStringLiteral("Project bin producers"), timer.restart());
 
     QSet<QString> reserved_names{QLatin1String("playlistmain"), QLatin1String("timeline_preview"), QLatin1String("timeline_overlay"),
                                  QLatin1String("black_track")};
@@ -79,7 +83,7 @@ bool constructTimelineFromMelt(const std::shared_ptr<TimelineItemModel> &timelin
             ok = timeline->requestTrackInsertion(-1, tid, QString(), audioTrack, undo, redo, false);
             int lockState = track->get_int("kdenlive:locked_track");
             Mlt::Tractor local_tractor(*track);
-            ok = ok && constructTrackFromMelt(timeline, tid, local_tractor, binIdCorresp, undo, redo, audioTrack);
+            ok = ok && constructTrackFromMelt(timeline, tid, local_tractor, binIdCorresp, audioTrack);
             timeline->setTrackProperty(tid, QStringLiteral("kdenlive:thumbs_format"), track->get("kdenlive:thumbs_format"));
             timeline->setTrackProperty(tid, QStringLiteral("kdenlive:audio_rec"), track->get("kdenlive:audio_rec"));
             if (lockState > 0) {
@@ -100,7 +104,7 @@ bool constructTimelineFromMelt(const std::shared_ptr<TimelineItemModel> &timelin
                 timeline->setTrackProperty(tid, QStringLiteral("hide"), QString::number(muteState));
             }
             int lockState = local_playlist.get_int("kdenlive:locked_track");
-            ok = ok && constructTrackFromMelt(timeline, tid, local_playlist, binIdCorresp, undo, redo, audioTrack);
+            ok = ok && constructTrackFromMelt(timeline, tid, local_playlist, binIdCorresp, audioTrack);
             timeline->setTrackProperty(tid, QStringLiteral("kdenlive:thumbs_format"), local_playlist.get("kdenlive:thumbs_format"));
             timeline->setTrackProperty(tid, QStringLiteral("kdenlive:audio_rec"), track->get("kdenlive:audio_rec"));
             if (lockState > 0) {
@@ -113,6 +117,7 @@ bool constructTimelineFromMelt(const std::shared_ptr<TimelineItemModel> &timelin
         }
     }
     timeline->_resetView();
+    pCore->addTiming(QStringLiteral("Project tracks and clips"), timer.restart());
 
     // Loading compositions
     QScopedPointer<Mlt::Service> service(tractor.producer());
@@ -164,10 +169,17 @@ bool constructTimelineFromMelt(const std::shared_ptr<TimelineItemModel> &timelin
     // build internal track compositing
     timeline->buildTrackCompositing();
     timeline->updateDuration();
+    pCore->addTiming(QStringLiteral("Project compositions"), timer.elapsed());
 
     if (!ok) {
         // TODO log error
         // Don't abort loading because of failed composition
+        // The clips are inserted without undo, they have to be removed before the tracks
+        for (int tid : timeline->getAllTracksIds()) {
+            for (int cid : timeline->getItemsInRange(tid, 0, -1, false)) {
+                timeline->requestItemDeletion(cid, false);
+            }
+        }
         undo();
         return false;
     }
@@ -178,7 +190,7 @@ bool constructTimelineFromMelt(const std::shared_ptr<TimelineItemModel> &timelin
 }
 
 bool constructTrackFromMelt(const std::shared_ptr<TimelineItemModel> &timeline, int tid, Mlt::Tractor &track,
-                            const std::unordered_map<QString, QString> &binIdCorresp, Fun &undo, Fun &redo, bool audioTrack)
+                            const std::unordered_map<QString, QString> &binIdCorresp, bool audioTrack)
 {
     if (track.count() != 2) {
         // we expect a tractor with two tracks (a "fake" track)
@@ -192,7 +204,7 @@ bool constructTrackFromMelt(const std::shared_ptr<TimelineItemModel> &timeline,
             return false;
         }
         Mlt::Playlist playlist(*sub_track);
-        constructTrackFromMelt(timeline, tid, playlist, binIdCorresp, undo, redo, audioTrack);
+        constructTrackFromMelt(timeline, tid, playlist, binIdCorresp, audioTrack);
         if (i == 0) {
             // Pass track properties
             int height = track.get_int("kdenlive:trackheight");
@@ -253,8 +265,11 @@ PlaylistState::ClipState inferState(const std::shared_ptr<Mlt::Producer> &prod,
 } // namespace
 
 bool constructTrackFromMelt(const std::shared_ptr<TimelineItemModel> &timeline, int tid, Mlt::Playlist &track,
-                            const std::unordered_map<QString, QString> &binIdCorresp, Fun &undo, Fun &redo, bool audioTrack)
+                            const std::unordered_map<QString, QString> &binIdCorresp, bool audioTrack)
 {
+    // The clips are created first, then inserted in the track in a single pass
+    std::vector<std::pair<int, int>> clips;
+    std::unordered_map<int, QString> clipNames;
     for (int i = 0; i < track.count(); i++) {
         if (track.is_blank(i)) {
             continue;
@@ -264,7 +279,6 @@ bool constructTrackFromMelt(const std::shared_ptr<TimelineItemModel> &timeline,
         switch (clip->type()) {
         case unknown_type:
         case producer_type: {
-            qDebug() << "Looking for clip clip " << clip->parent().get("kdenlive:id") << " = " << clip->parent().get("kdenlive:clipname");
             QString binId;
             if (clip->parent().get_int("_kdenlive_processed") == 1) {
                 // This is a bin clip, already processed no need to change id
@@ -282,23 +296,14 @@ bool constructTrackFromMelt(const std::shared_ptr<TimelineItemModel> &timeline,
                 clip->parent().set("kdenlive:id", binId.toUtf8().constData());
                 clip->parent().set("_kdenlive_processed", 1);
             }
-            bool ok = false;
-            int cid = -1;
             if (pCore->bin()->getBinClip(binId)) {
                 PlaylistState::ClipState st = inferState(clip, audioTrack);
-                cid = ClipModel::construct(timeline, binId, clip, st);
-                ok = timeline->requestClipMove(cid, tid, position, true, false, true, undo, redo);
+                int cid = ClipModel::construct(timeline, binId, clip, st);
+                clips.emplace_back(cid, position);
+                clipNames[cid] = clip->parent().get("id");
             } else {
                 qDebug() << "// Cannot find bin clip: " << binId << " - " << clip->get("id");
             }
-            if (!ok && cid > -1) {
-                qDebug() << "ERROR : failed to insert clip in track" << tid << "position" << position;
-                timeline->requestItemDeletion(cid, false);
-                m_errorMessage << i18n("Invalid clip %1 found on track %2 at %3.", clip->parent().get("id"), track.get("id"), position);
-                break;
-            }
-            qDebug() << "Inserted clip in track" << tid << "at " << position;
-
             break;
         }
         case tractor_type: {
@@ -312,6 +317,13 @@ bool constructTrackFromMelt(const std::shared_ptr<TimelineItemModel> &timeline,
             break;
         }
     }
+    const std::vector<int> rejected = timeline->bulkInsertClips(tid, clips);
+    for (int cid : rejected) {
+        int position = std::find_if(clips.begin(), clips.end(), [cid](const std::pair<int, int> &clip) { return clip.first == cid; })->second;
+        qDebug() << "ERROR : failed to insert clip in track" << tid << "position" << position;
+        timeline->requestItemDeletion(cid, false);
+        m_errorMessage << i18n("Invalid clip %1 found on track %2 at %3.", clipNames[cid], track.get("id"), position);
+    }
     std::shared_ptr<Mlt::Service> serv = std::make_shared<Mlt::Service>(track.get_service());
     timeline->importTrackEffects(tid, serv);
     return true;
@@ -464,7 +464,7 @@ QVariant ClipModel::getAudioWaveform()
     READ_LOCK();
     std::shared_ptr<ProjectClip> binClip = pCore->projectItemModel()->getClipByBinID(m_binClipId);
     if (binClip) {
-        return QVariant::fromValue(binClip->audioFrameCache);
+        return QVariant::fromValue(binClip->audioFrameLevels());
     }
     return QVariant();
 }
@@ -1190,8 +1190,17 @@ bool TimelineFunctions::pasteClips(const std::shared_ptr<TimelineItemModel> &tim
     } else {
         return false;
     }
-    std::function<bool(void)> undo = []() { return true; };
-    std::function<bool(void)> redo = []() { return true; };
+    // Each pasted item is recorded separately, so that pasting many items does not build a deep chain of lambdas
+    UndoTransaction transaction;
+    // unsure to clear selection in undo/redo too.
+    Fun unselect = [timeline]() {
+        qDebug() << "starting undo or redo. Selection " << timeline->m_currentSelection;
+        timeline->requestClearSelection();
+        qDebug() << "after Selection " << timeline->m_currentSelection;
+        return true;
+    };
+    // The selection is cleared before the other steps: first in redo, and by the reverse recorded last in undo
+    transaction.push(unselect, []() { return true; });
     const QString docId = copiedItems.documentElement().attribute(QStringLiteral("documentid"));
     QMap<QString, QString> mappedIds;
     // Check available tracks
@@ -1347,7 +1356,8 @@ bool TimelineFunctions::pasteClips(const std::shared_ptr<TimelineItemModel> &tim
             // Folder doe not exist
             const QString rootId = pCore->projectItemModel()->getRootFolder()->clipId();
             folderId = QString::number(pCore->projectItemModel()->getFreeFolderId());
-            pCore->projectItemModel()->requestAddFolder(folderId, i18n("Pasted clips"), rootId, undo, redo);
+            transaction.record(
+                [&](Fun &undo, Fun &redo) { return pCore->projectItemModel()->requestAddFolder(folderId, i18n("Pasted clips"), rootId, undo, redo); });
         }
         QDomNodeList binClips = copiedItems.documentElement().elementsByTagName(QStringLiteral("producer"));
         for (int i = 0; i < binClips.count(); ++i) {
@@ -1359,7 +1369,7 @@ bool TimelineFunctions::pasteClips(const std::shared_ptr<TimelineItemModel> &tim
                 mappedIds.insert(clipId, updatedId);
                 clipId = updatedId;
             }
-            pCore->projectItemModel()->requestAddBinClip(clipId, currentProd, folderId, undo, redo);
+            transaction.record([&](Fun &undo, Fun &redo) { return pCore->projectItemModel()->requestAddBinClip(clipId, currentProd, folderId, undo, redo); });
         }
     }
 
@@ -1388,7 +1398,9 @@ bool TimelineFunctions::pasteClips(const std::shared_ptr<TimelineItemModel> &tim
         int pos = prod.attribute(QStringLiteral("position")).toInt() - offset;
         double speed = locale.toDouble(prod.attribute(QStringLiteral("speed")));
         int newId;
-        bool created = timeline->requestClipCreation(originalId, newId, timeline->getTrackById_const(curTrackId)->trackType(), speed, undo, redo);
+        bool created = transaction.record([&](Fun &undo, Fun &redo) {
+            return timeline->requestClipCreation(originalId, newId, timeline->getTrackById_const(curTrackId)->trackType(), speed, undo, redo);
+        });
         if (created) {
             // Master producer is ready
             // ids.removeAll(originalId);
@@ -1406,12 +1418,15 @@ bool TimelineFunctions::pasteClips(const std::shared_ptr<TimelineItemModel> &tim
         timeline->m_allClips[newId]->setInOut(in, out);
         int targetId = prod.attribute(QStringLiteral("id")).toInt();
         correspondingIds[targetId] = newId;
-        res = res && timeline->getTrackById(curTrackId)->requestClipInsertion(newId, position + pos, true, true, undo, redo);
-        // paste effects
-        if (res) {
-            std::shared_ptr<EffectStackModel> destStack = timeline->getClipEffectStackModel(newId);
-            destStack->fromXml(prod.firstChildElement(QStringLiteral("effects")), undo, redo);
-        }
+        res = res && transaction.record([&](Fun &undo, Fun &redo) {
+            bool inserted = timeline->getTrackById(curTrackId)->requestClipInsertion(newId, position + pos, true, true, undo, redo);
+            // paste effects
+            if (inserted) {
+                std::shared_ptr<EffectStackModel> destStack = timeline->getClipEffectStackModel(newId);
+                destStack->fromXml(prod.firstChildElement(QStringLiteral("effects")), undo, redo);
+            }
+            return inserted;
+        });
     }
 
     // Compositions
@@ -1433,27 +1448,22 @@ bool TimelineFunctions::pasteClips(const std::shared_ptr<TimelineItemModel> &tim
             transProps->set(props.at(j).toElement().attribute(QStringLiteral("name")).toUtf8().constData(),
                             props.at(j).toElement().text().toUtf8().constData());
         }
-        res = timeline->requestCompositionInsertion(originalId, curTrackId, aTrackId, position + pos, out - in + 1, std::move(transProps), newId, undo, redo);
+        res = transaction.record([&](Fun &undo, Fun &redo) {
+            return timeline->requestCompositionInsertion(originalId, curTrackId, aTrackId, position + pos, out - in + 1, std::move(transProps), newId, undo,
+                                                         redo);
+        });
     }
     if (!res) {
-        undo();
+        transaction.undo();
         return false;
     }
     // Rebuild groups
     const QString groupsData = copiedItems.documentElement().firstChildElement(QStringLiteral("groups")).text();
     if (!groupsData.isEmpty()) {
-        timeline->m_groups->fromJsonWithOffset(groupsData, tracksMap, position - offset, undo, redo);
+        transaction.record([&](Fun &undo, Fun &redo) { return timeline->m_groups->fromJsonWithOffset(groupsData, tracksMap, position - offset, undo, redo); });
     }
-    // unsure to clear selection in undo/redo too.
-    Fun unselect = [&]() {
-        qDebug() << "starting undo or redo. Selection " << timeline->m_currentSelection;
-        timeline->requestClearSelection();
-        qDebug() << "after Selection " << timeline->m_currentSelection;
-        return true;
-    };
-    PUSH_FRONT_LAMBDA(unselect, undo);
-    PUSH_FRONT_LAMBDA(unselect, redo);
-    pCore->pushUndo(undo, redo, i18n("Paste clips"));
+    transaction.push([]() { return true; }, unselect);
+    pCore->pushUndo(std::move(transaction), i18n("Paste clips"));
     return true;
 }
 
@@ -582,6 +582,13 @@ bool TimelineModel::requestClipMove(int clipId, int trackId, int position, bool
     return true;
 }
 
+std::vector<int> TimelineModel::bulkInsertClips(int trackId, const std::vector<std::pair<int, int>> &clips)
+{
+    QWriteLocker locker(&m_lock);
+    Q_ASSERT(isTrack(trackId));
+    return getTrackById(trackId)->bulkInsertClips(clips);
+}
+
 bool TimelineModel::requestFakeClipMove(int clipId, int trackId, int position, bool updateView, bool logUndo, bool invalidateTimeline)
 {
     QWriteLocker locker(&m_lock);
@@ -1335,8 +1342,8 @@ bool TimelineModel::requestGroupMove(int itemId, int groupId, int delta_track, i
     bool ok = true;
     auto all_items = m_groups->getLeaves(groupId);
     Q_ASSERT(all_items.size() > 1);
-    Fun local_undo = []() { return true; };
-    Fun local_redo = []() { return true; };
+    // Each item move is recorded separately, so that moving many items does not build a deep chain of lambdas
+    UndoTransaction transaction;
     std::unordered_set<int> all_clips;
     std::unordered_set<int> all_compositions;
     // Separate clips from compositions to sort
@@ -1403,7 +1410,9 @@ bool TimelineModel::requestGroupMove(int itemId, int groupId, int delta_track, i
         if (old_trackId != -1) {
             bool updateThisView = allowViewRefresh;
             if (isClip(item)) {
-                ok = ok && getTrackById(old_trackId)->requestClipDeletion(item, updateThisView, finalMove, local_undo, local_redo);
+                ok = ok && transaction.record([&](Fun &local_undo, Fun &local_redo) {
+                    return getTrackById(old_trackId)->requestClipDeletion(item, updateThisView, finalMove, local_undo, local_redo);
+                });
                 old_position[item] = m_allClips[item]->getPosition();
             } else {
                 // ok = ok && getTrackById(old_trackId)->requestCompositionDeletion(item, updateThisView, finalMove, local_undo, local_redo);
@@ -1411,7 +1420,7 @@ bool TimelineModel::requestGroupMove(int itemId, int groupId, int delta_track, i
                 old_forced_track[item] = m_allCompositions[item]->getForcedTrack();
             }
             if (!ok) {
-                bool undone = local_undo();
+                bool undone = transaction.undo();
                 Q_ASSERT(undone);
                 return false;
             }
@@ -1443,22 +1452,24 @@ bool TimelineModel::requestGroupMove(int itemId, int groupId, int delta_track, i
             std::advance(it, target_track_position);
             int target_track = (*it)->getId();
             int target_position = old_position[item] + delta_pos;
-            if (isClip(item)) {
-                ok = ok && requestClipMove(item, target_track, target_position, updateThisView, finalMove, finalMove, local_undo, local_redo);
-            } else {
-                ok = ok &&
-                     requestCompositionMove(item, target_track, old_forced_track[item], target_position, updateThisView, finalMove, local_undo, local_redo);
-            }
+            ok = ok && transaction.record([&](Fun &local_undo, Fun &local_redo) {
+                if (isClip(item)) {
+                    return requestClipMove(item, target_track, target_position, updateThisView, finalMove, finalMove, local_undo, local_redo);
+                }
+                return requestCompositionMove(item, target_track, old_forced_track[item], target_position, updateThisView, finalMove, local_undo, local_redo);
+            });
         } else {
             qDebug() << "// ABORTING; MOVE TRIED ON TRACK: " << target_track_position << "..\n..\n..";
             ok = false;
         }
         if (!ok) {
-            bool undone = local_undo();
+            bool undone = transaction.undo();
             Q_ASSERT(undone);
             return false;
         }
     }
+    Fun local_undo = transaction.takeUndo();
+    Fun local_redo = transaction.takeRedo();
     if (updatePositionOnly) {
         update_model();
         PUSH_LAMBDA(update_model, local_redo);
@@ -1488,6 +1499,9 @@ bool TimelineModel::requestGroupDeletion(int clipId, Fun &undo, Fun &redo)
     group_queue.push(m_groups->getRootId(clipId));
     std::unordered_set<int> all_items;
     std::unordered_set<int> all_compositions;
+    // Each deletion is recorded separately, so that deleting many items does not build a deep chain of lambdas.
+    // On failure, the recorded deletions are reverted, then the caller's undo as before, so that everything done so far is rolled back
+    UndoTransaction transaction;
     while (!group_queue.empty()) {
         int current_group = group_queue.front();
         bool isSelection = m_currentSelection == current_group;
@@ -1519,8 +1533,9 @@ bool TimelineModel::requestGroupDeletion(int clipId, Fun &undo, Fun &redo)
                 Fun tmp_redo = []() { return true; };
                 m_groups->ungroupItem(one_child, tmp_undo, tmp_redo);
             } else {
-                bool res = m_groups->ungroupItem(one_child, undo, redo);
+                bool res = transaction.record([&](Fun &local_undo, Fun &local_redo) { return m_groups->ungroupItem(one_child, local_undo, local_redo); });
                 if (!res) {
+                    transaction.undo();
                     undo();
                     return false;
                 }
@@ -1528,19 +1543,24 @@ bool TimelineModel::requestGroupDeletion(int clipId, Fun &undo, Fun &redo)
         }
     }
     for (int clip : all_items) {
-        bool res = requestClipDeletion(clip, undo, redo);
+        bool res = transaction.record([&](Fun &local_undo, Fun &local_redo) { return requestClipDeletion(clip, local_undo, local_redo); });
         if (!res) {
+            transaction.undo();
             undo();
             return false;
         }
     }
     for (int compo : all_compositions) {
-        bool res = requestCompositionDeletion(compo, undo, redo);
+        bool res = transaction.record([&](Fun &local_undo, Fun &local_redo) { return requestCompositionDeletion(compo, local_undo, local_redo); });
         if (!res) {
+            transaction.undo();
             undo();
             return false;
         }
     }
+    Fun local_undo = transaction.takeUndo();
+    Fun local_redo = transaction.takeRedo();
+    UPDATE_UNDO_REDO_NOLOCK(local_redo, local_undo, undo, redo);
     return true;
 }
 
@@ -2517,7 +2537,7 @@ bool TimelineModel::requestCompositionMove(int compoId, int trackId, int composi
             int oldAtrack = m_allCompositions[compoId]->getATrack();
             delete_reverse = [this, compoId, oldAtrack, updateView]() {
                 m_allCompositions[compoId]->setATrack(oldAtrack, oldAtrack <= 0 ? -1 : getTrackIndexFromPosition(oldAtrack - 1));
-                return replantCompositions(compoId, updateView);
+                return plantComposition(compoId, updateView);
             };
         }
         ok = delete_operation();
@@ -2546,7 +2566,7 @@ bool TimelineModel::requestCompositionMove(int compoId, int trackId, int composi
             insert_operation = [this, compoId, compositionTrack, updateView]() {
                 qDebug() << "-------------- ATRACK ----------------\n" << compositionTrack << " = " << getTrackIndexFromPosition(compositionTrack);
                 m_allCompositions[compoId]->setATrack(compositionTrack, compositionTrack <= 0 ? -1 : getTrackIndexFromPosition(compositionTrack - 1));
-                return replantCompositions(compoId, updateView);
+                return plantComposition(compoId, updateView);
             };
             insert_reverse = [this, compoId]() {
                 bool res = unplantComposition(compoId);
@@ -2573,80 +2593,56 @@ bool TimelineModel::requestCompositionMove(int compoId, int trackId, int composi
     return true;
 }
 
-bool TimelineModel::replantCompositions(int currentCompo, bool updateView)
+bool TimelineModel::plantComposition(int compoId, bool updateView)
 {
-    // We ensure that the compositions are planted in a decreasing order of b_track.
-    // For that, there is no better option than to disconnect every composition and then reinsert everything in the correct order.
-    std::vector<std::pair<int, int>> compos;
-    for (const auto &compo : m_allCompositions) {
-        int trackId = compo.second->getCurrentTrackId();
-        if (trackId == -1 || compo.second->getATrack() == -1) {
-            continue;
-        }
-        // Note: we need to retrieve the position of the track, that is its melt index.
-        int trackPos = getTrackMltIndex(trackId);
-        compos.emplace_back(trackPos, compo.first);
-        if (compo.first != currentCompo) {
-            unplantComposition(compo.first);
-        }
-    }
-    // sort by decreasing b_track
-    std::sort(compos.begin(), compos.end(), [](const std::pair<int, int> &a, const std::pair<int, int> &b) { return a.first > b.first; });
-    // replant
+    // We ensure that the compositions are planted in a decreasing order of b_track, under the track compositing.
+    // The field is walked from its top until the first composition that must be applied before this one, and the composition is inserted above it,
+    // so that the other compositions don't need to be unplanted.
+    Mlt::Transition &transition = *m_allCompositions[compoId].get();
+    int aTrack = m_allCompositions[compoId]->getATrack();
+    // Note: we need to retrieve the position of the track, that is its melt index.
+    int bTrack = getTrackMltIndex(m_allCompositions[compoId]->getCurrentTrackId());
+    Q_ASSERT(aTrack != -1 && aTrack < m_tractor->count());
+
     QScopedPointer<Mlt::Field> field(m_tractor->field());
     field->lock();
-
-    // Unplant track compositing
+    mlt_service consumer = nullptr;
     mlt_service nextservice = mlt_service_get_producer(field->get_service());
-    mlt_properties properties = MLT_SERVICE_PROPERTIES(nextservice);
-    QString resource = mlt_properties_get(properties, "mlt_service");
-
-    mlt_service_type mlt_type = mlt_service_identify(nextservice);
-    QList<Mlt::Transition *> trackCompositions;
-    while (mlt_type == transition_type) {
-        Mlt::Transition transition((mlt_transition)nextservice);
-        nextservice = mlt_service_producer(nextservice);
-        int internal = transition.get_int("internal_added");
-        if (internal > 0 && resource != QLatin1String("mix")) {
-            trackCompositions << new Mlt::Transition(transition);
-            field->disconnect_service(transition);
-            transition.disconnect_all_producers();
-        }
-        if (nextservice == nullptr) {
+    while (nextservice != nullptr && mlt_service_identify(nextservice) == transition_type) {
+        // The track compositing and audio mixes are skipped, they stay in place
+        bool internal = mlt_properties_get_int(MLT_SERVICE_PROPERTIES(nextservice), "internal_added") > 0;
+        if (!internal && mlt_transition_get_b_track((mlt_transition)nextservice) >= bTrack) {
             break;
         }
-        mlt_type = mlt_service_identify(nextservice);
-        properties = MLT_SERVICE_PROPERTIES(nextservice);
-        resource = mlt_properties_get(properties, "mlt_service");
-    }
-    // Sort track compositing
-    std::sort(trackCompositions.begin(), trackCompositions.end(), [](Mlt::Transition *a, Mlt::Transition *b) { return a->get_b_track() < b->get_b_track(); });
-
-    for (const auto &compo : compos) {
-        int aTrack = m_allCompositions[compo.second]->getATrack();
-        Q_ASSERT(aTrack != -1 && aTrack < m_tractor->count());
-
-        int ret = field->plant_transition(*m_allCompositions[compo.second].get(), aTrack, compo.first);
-        qDebug() << "Planting composition " << compo.second << "in " << aTrack << "/" << compo.first << "IN = " << m_allCompositions[compo.second]->getIn()
-                 << "OUT = " << m_allCompositions[compo.second]->getOut() << "ret=" << ret;
-
-        Mlt::Transition &transition = *m_allCompositions[compo.second].get();
-        transition.set_tracks(aTrack, compo.first);
-        mlt_service consumer = mlt_service_consumer(transition.get_service());
-        Q_ASSERT(consumer != nullptr);
-        if (ret != 0) {
-            field->unlock();
-            return false;
-        }
+        consumer = nextservice;
+        nextservice = mlt_service_producer(nextservice);
     }
-    // Replant last tracks compositing
-    while (!trackCompositions.isEmpty()) {
-        Mlt::Transition *firstTr = trackCompositions.takeFirst();
-        field->plant_transition(*firstTr, firstTr->get_a_track(), firstTr->get_b_track());
+
+    int ret = 0;
+    if (consumer == nullptr) {
+        ret = field->plant_transition(transition, aTrack, bTrack);
+    } else {
+        // Insert the composition between the consumer and its producer, the reverse of Mlt::Field::disconnect_service
+        ret = mlt_transition_connect(transition.get_transition(), nextservice, aTrack, bTrack);
+        if (ret == 0) {
+            auto consumerTransition = (mlt_transition)consumer;
+            ret = mlt_service_connect_producer(consumer, transition.get_service(), mlt_transition_get_a_track(consumerTransition));
+            consumerTransition->producer = transition.get_service();
+        }
     }
+    qDebug() << "Planting composition " << compoId << "in " << aTrack << "/" << bTrack << "IN = " << transition.get_in() << "OUT = " << transition.get_out()
+             << "ret=" << ret;
     field->unlock();
+    if (ret != 0) {
+        return false;
+    }
+    if (consumer != nullptr) {
+        // Like Mlt::Field::plant_transition, let the listeners of the field know that its chain changed
+        field->fire_event("service-changed");
+    }
+    Q_ASSERT(mlt_service_consumer(transition.get_service()) != nullptr);
     if (updateView) {
-        QModelIndex modelIndex = makeCompositionIndexFromID(currentCompo);
+        QModelIndex modelIndex = makeCompositionIndexFromID(compoId);
         notifyChange(modelIndex, modelIndex, ItemATrack);
     }
     return true;
@@ -2792,6 +2788,8 @@ bool TimelineModel::checkConsistency()
     QScopedPointer<Mlt::Field> field(m_tractor->field());
     field->lock();
 
+    // The compositions must be planted in a decreasing order of b_track, so that we find them in increasing order from the top of the field
+    int previousTrack = -1;
     mlt_service nextservice = mlt_service_get_producer(field->get_service());
     mlt_service_type mlt_type = mlt_service_identify(nextservice);
     while (nextservice != nullptr) {
@@ -2820,6 +2818,12 @@ bool TimelineModel::checkConsistency()
                 return false;
             }
             qDebug() << "Found";
+            if (currentTrack < previousTrack) {
+                qDebug() << "Error, composition on track " << currentTrack << " is planted above a composition on track " << previousTrack;
+                field->unlock();
+                return false;
+            }
+            previousTrack = currentTrack;
 
             remaining_compo.erase(foundId);
         }
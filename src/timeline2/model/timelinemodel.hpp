@@ -357,6 +357,14 @@ public:
     /* Same function, but accumulates undo and redo, and doesn't check
        for group*/
     bool requestClipMove(int clipId, int trackId, int position, bool updateView, bool invalidateTimeline, bool finalMove, Fun &undo, Fun &redo);
+
+    /* @brief Insert clips in a track in a single pass, when the timeline is constructed from a trusted source.
+       No undo is stored and nothing is sent to the view, which must be reset once the timeline is built.
+       @param trackId is the ID of the target track
+       @param clips is the list of (clipId, position) to insert, sorted by position
+       Returns the ids of the clips that could not be inserted, see TrackModel::bulkInsertClips
+    */
+    std::vector<int> bulkInsertClips(int trackId, const std::vector<std::pair<int, int>> &clips);
     bool requestCompositionMove(int transid, int trackId, int compositionTrack, int position, bool updateView, bool finalMove, Fun &undo, Fun &redo);
 
     /* When timeline edit mode is insert or overwrite, we fake the move (as it will overlap existing clips, and only process the real move on drop */
@@ -704,10 +712,11 @@ protected:
      */
     static int getNextId();
 
-    /* @brief unplant and the replant all the compositions in the correct order
-       @param currentCompo is the id of a compo that have not yet been planted, if any. Otherwise send -1
+    /* @brief Plant a composition that is not planted yet at its place in the field.
+       The compositions are kept in a decreasing order of b_track, so that only the given composition is connected,
+       the other ones and the track compositing stay in place.
      */
-    bool replantCompositions(int currentCompo, bool updateView);
+    bool plantComposition(int compoId, bool updateView);
 
     /* @brief Unplant the composition with given Id */
     bool unplantComposition(int compoId);
@@ -141,6 +141,7 @@ Fun TrackModel::requestClipInsertion_lambda(int clipId, int position, bool updat
             // update clip position and track
             clip->setPosition(position);
             clip->setSubPlaylistIndex(subPlaylist);
+            indexClip(clipId);
             int new_in = clip->getPosition();
             int new_out = new_in + clip->getPlaytime();
             ptr->m_snaps->addPoint(new_in);
@@ -251,6 +252,76 @@ bool TrackModel::requestClipInsertion(int clipId, int position, bool updateView,
     return false;
 }
 
+std::vector<int> TrackModel::bulkInsertClips(const std::vector<std::pair<int, int>> &clips)
+{
+    QWriteLocker locker(&m_lock);
+    std::vector<int> rejected;
+    auto ptr = m_parent.lock();
+    if (!ptr) {
+        qDebug() << "impossible to get parent timeline";
+        for (const auto &clip : clips) {
+            rejected.push_back(clip.first);
+        }
+        return rejected;
+    }
+    std::vector<int> inserted;
+    inserted.reserve(clips.size());
+    // Clips starting before the end of the track can only go in a blank, they are inserted the regular way
+    std::vector<std::pair<int, int>> deferred;
+    m_playlists[0].lock();
+    int end = m_playlists[0].get_playtime();
+    for (const auto &item : clips) {
+        int clipId = item.first;
+        int position = item.second;
+        std::shared_ptr<ClipModel> clip = ptr->getClipPtr(clipId);
+        Q_ASSERT(clip->getCurrentTrackId() == -1);
+        // Same checks as a regular clip move
+        PlaylistState::ClipState state = clip->clipState();
+        bool validType = state == PlaylistState::Disabled ? (isAudioTrack() ? clip->canBeAudio() : clip->canBeVideo()) : state == trackType();
+        if (!validType) {
+            rejected.push_back(clipId);
+            continue;
+        }
+        if (position < end) {
+            deferred.push_back(item);
+            continue;
+        }
+        clip->setCurrentTrackId(m_id, true);
+        if (position > end) {
+            m_playlists[0].blank(position - end - 1);
+        }
+        if (m_playlists[0].append(*clip) != 0) {
+            clip->setCurrentTrackId(-1, false);
+            rejected.push_back(clipId);
+            end = m_playlists[0].get_playtime();
+            continue;
+        }
+        m_allClips[clipId] = clip;
+        clip->setPosition(position);
+        clip->setSubPlaylistIndex(0);
+        inserted.push_back(clipId);
+        end = position + clip->getPlaytime();
+    }
+    m_playlists[0].unlock();
+
+    // Build the indexes and snaps
+    for (int clipId : inserted) {
+        const auto &clip = m_allClips.at(clipId);
+        m_clipRows.push_back(clipId);
+        m_clipPos[0].emplace_hint(m_clipPos[0].end(), clip->getPosition(), clipId);
+        ptr->m_snaps->addPoint(clip->getPosition());
+        ptr->m_snaps->addPoint(clip->getPosition() + clip->getPlaytime());
+    }
+    std::sort(m_clipRows.begin(), m_clipRows.end());
+
+    for (const auto &item : deferred) {
+        if (!requestClipInsertion_lambda(item.first, item.second, false, true)()) {
+            rejected.push_back(item.first);
+        }
+    }
+    return rejected;
+}
+
 void TrackModel::replugClip(int clipId)
 {
     QWriteLocker locker(&m_lock);
@@ -304,6 +375,7 @@ Fun TrackModel::requestClipDeletion_lambda(int clipId, bool updateView, bool fin
         auto prod = m_playlists[target_track].replace_with_blank(target_clip);
         if (prod != nullptr) {
             m_playlists[target_track].consolidate_blanks();
+            unindexClip(clipId);
             m_allClips[clipId]->setCurrentTrackId(-1);
             m_allClips[clipId]->setSubPlaylistIndex(-1);
             m_allClips.erase(clipId);
@@ -510,7 +582,7 @@ Fun TrackModel::requestClipResize_lambda(int clipId, int in, int out, bool right
             // The second is parameter is delta - 1 because this function expects an out time, which is basically size - 1
             m_playlists[target_track].insert_blank(blank_index, delta - 1);
             if (!right) {
-                m_allClips[clipId]->setPosition(clip_position + delta);
+                updateClipPosition(clipId, clip_position + delta);
                 // Because we inserted blank before, the index of our clip has increased
                 target_clip_mutable++;
             }
@@ -591,7 +663,7 @@ Fun TrackModel::requestClipResize_lambda(int clipId, int in, int out, bool right
                     err = m_playlists[target_track].resize_clip(target_clip_mutable, in, out);
                 }
                 if (!right && err == 0) {
-                    m_allClips[clipId]->setPosition(m_playlists[target_track].clip_start(target_clip_mutable));
+                    updateClipPosition(clipId, m_playlists[target_track].clip_start(target_clip_mutable));
                 }
                 if (err == 0) {
                     update_snaps(m_allClips[clipId]->getPosition(), m_allClips[clipId]->getPosition() + out - in + 1);
@@ -657,26 +729,28 @@ int TrackModel::getCompositionByPosition(int position)
 int TrackModel::getClipByRow(int row) const
 {
     READ_LOCK();
-    if (row >= static_cast<int>(m_allClips.size())) {
+    if (row >= static_cast<int>(m_clipRows.size())) {
         return -1;
     }
-    auto it = m_allClips.cbegin();
-    std::advance(it, row);
-    return (*it).first;
+    return m_clipRows[(size_t)row];
 }
 
 std::unordered_set<int> TrackModel::getClipsInRange(int position, int end)
 {
     READ_LOCK();
     std::unordered_set<int> ids;
-    for (const auto &clp : m_allClips) {
-        int pos = clp.second->getPosition();
-        int length = clp.second->getPlaytime();
-        if (end > -1 && pos >= end) {
-            continue;
+    for (const auto &positions : m_clipPos) {
+        // Only the clip starting before position can overlap it, since clips of a sub-playlist don't intersect
+        auto it = positions.upper_bound(position);
+        if (it != positions.begin()) {
+            auto previous = std::prev(it);
+            int pos = previous->first;
+            if ((end == -1 || pos < end) && pos + m_allClips.at(previous->second)->getPlaytime() - 1 >= position) {
+                ids.insert(previous->second);
+            }
         }
-        if (pos >= position || pos + length - 1 >= position) {
-            ids.insert(clp.first);
+        for (; it != positions.end() && (end == -1 || it->first < end); ++it) {
+            ids.insert(it->second);
         }
     }
     return ids;
@@ -686,7 +760,7 @@ int TrackModel::getRowfromClip(int clipId) const
 {
     READ_LOCK();
     Q_ASSERT(m_allClips.count(clipId) > 0);
-    return (int)std::distance(m_allClips.begin(), m_allClips.find(clipId));
+    return (int)std::distance(m_clipRows.begin(), std::lower_bound(m_clipRows.begin(), m_clipRows.end(), clipId));
 }
 
 std::unordered_set<int> TrackModel::getCompositionsInRange(int position, int end)
@@ -694,16 +768,18 @@ std::unordered_set<int> TrackModel::getCompositionsInRange(int position, int end
     READ_LOCK();
     // TODO: this function doesn't take into accounts the fact that there are two tracks
     std::unordered_set<int> ids;
-    for (const auto &compo : m_allCompositions) {
-        int pos = compo.second->getPosition();
-        int length = compo.second->getPlaytime();
-        if (end > -1 && pos >= end) {
-            continue;
-        }
-        if (pos >= position || pos + length - 1 >= position) {
-            ids.insert(compo.first);
+    // Compositions of a track never intersect, so only the one starting before position can overlap it
+    auto it = m_compoPos.upper_bound(position);
+    if (it != m_compoPos.begin()) {
+        auto previous = std::prev(it);
+        int pos = previous->first;
+        if ((end == -1 || pos < end) && pos + m_allCompositions.at(previous->second)->getPlaytime() - 1 >= position) {
+            ids.insert(previous->second);
         }
     }
+    for (; it != m_compoPos.end() && (end == -1 || it->first < end); ++it) {
+        ids.insert(it->second);
+    }
     return ids;
 }
 
@@ -711,7 +787,32 @@ int TrackModel::getRowfromComposition(int tid) const
 {
     READ_LOCK();
     Q_ASSERT(m_allCompositions.count(tid) > 0);
-    return (int)m_allClips.size() + (int)std::distance(m_allCompositions.begin(), m_allCompositions.find(tid));
+    return (int)m_clipRows.size() + (int)std::distance(m_compoRows.begin(), std::lower_bound(m_compoRows.begin(), m_compoRows.end(), tid));
+}
+
+void TrackModel::indexClip(int clipId)
+{
+    const auto &clip = m_allClips.at(clipId);
+    m_clipRows.insert(std::lower_bound(m_clipRows.begin(), m_clipRows.end(), clipId), clipId);
+    m_clipPos[clip->getSubPlaylistIndex()][clip->getPosition()] = clipId;
+}
+
+void TrackModel::unindexClip(int clipId)
+{
+    const auto &clip = m_allClips.at(clipId);
+    auto row = std::lower_bound(m_clipRows.begin(), m_clipRows.end(), clipId);
+    Q_ASSERT(row != m_clipRows.end() && *row == clipId);
+    m_clipRows.erase(row);
+    m_clipPos[clip->getSubPlaylistIndex()].erase(clip->getPosition());
+}
+
+void TrackModel::updateClipPosition(int clipId, int position)
+{
+    const auto &clip = m_allClips.at(clipId);
+    auto &positions = m_clipPos[clip->getSubPlaylistIndex()];
+    positions.erase(clip->getPosition());
+    clip->setPosition(position);
+    positions[position] = clipId;
 }
 
 QVariant TrackModel::getProperty(const QString &name) const
@@ -857,6 +958,24 @@ bool TrackModel::checkConsistency()
         return false;
     }
 
+    // We now check the row and position indexes
+    if (m_clipRows.size() != m_allClips.size() || m_clipPos[0].size() + m_clipPos[1].size() != m_allClips.size()) {
+        qDebug() << "Error: the number of indexed clips doesn't match number of clips";
+        return false;
+    }
+    for (const auto &c : m_allClips) {
+        const auto &positions = m_clipPos[c.second->getSubPlaylistIndex()];
+        auto it = positions.find(c.second->getPosition());
+        if (it == positions.end() || it->second != c.first) {
+            qDebug() << "Error: the position of clip " << c.first << " is not properly indexed";
+            return false;
+        }
+    }
+    if (!std::is_sorted(m_clipRows.begin(), m_clipRows.end()) || m_compoRows.size() != m_allCompositions.size()) {
+        qDebug() << "Error: the rows of the track items are not properly indexed";
+        return false;
+    }
+
     // We now check compositions positions
     if (m_allCompositions.size() != m_compoPos.size()) {
         qDebug() << "Error: the number of compositions position doesn't match number of compositions";
@@ -1075,6 +1194,7 @@ Fun TrackModel::requestCompositionDeletion_lambda(int compoId, bool updateView,
         }
         m_allCompositions[compoId]->setCurrentTrackId(-1);
         m_allCompositions.erase(compoId);
+        m_compoRows.erase(std::lower_bound(m_compoRows.begin(), m_compoRows.end(), compoId));
         m_compoPos.erase(old_in);
         ptr->m_snaps->removePoint(old_in);
         ptr->m_snaps->removePoint(old_out);
@@ -1092,9 +1212,7 @@ int TrackModel::getCompositionByRow(int row) const
         return -1;
     }
     Q_ASSERT(row <= (int)m_allClips.size() + (int)m_allCompositions.size());
-    auto it = m_allCompositions.cbegin();
-    std::advance(it, row - (int)m_allClips.size());
-    return (*it).first;
+    return m_compoRows[(size_t)(row - (int)m_clipRows.size())];
 }
 
 int TrackModel::getCompositionsCount() const
@@ -1118,6 +1236,7 @@ Fun TrackModel::requestCompositionInsertion_lambda(int compoId, int position, bo
             if (auto ptr = m_parent.lock()) {
                 std::shared_ptr<CompositionModel> composition = ptr->getCompositionPtr(compoId);
                 m_allCompositions[composition->getId()] = composition; // store clip
+                m_compoRows.insert(std::lower_bound(m_compoRows.begin(), m_compoRows.end(), compoId), compoId);
                 // update clip position and track
                 composition->setCurrentTrackId(getId());
                 int new_in = position;
@@ -26,11 +26,13 @@
 #include "undohelper.hpp"
 #include <QReadWriteLock>
 #include <QSharedPointer>
+#include <map>
 #include <memory>
 #include <mlt++/MltPlaylist.h>
 #include <mlt++/MltTractor.h>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 class TimelineModel;
 class ClipModel;
@@ -141,6 +143,15 @@ protected:
     /* @brief This function returns a lambda that performs the requested operation */
     Fun requestClipInsertion_lambda(int clipId, int position, bool updateView, bool finalMove);
 
+    /* @brief Appends clips to the track in a single pass, for the construction of the timeline.
+       Nothing is sent to the view and no undo is recorded, the snaps and indexes are updated once all the clips are appended.
+       Clips starting before the end of the track are inserted in the blanks through the regular insertion.
+       This method is protected because it shouldn't be called directly. Call the function in the timeline instead.
+       @param clips is the list of (clipId, position) to insert, sorted by position
+       Returns the ids of the clips that could not be inserted (overlapping other clips, or not matching the track type)
+    */
+    std::vector<int> bulkInsertClips(const std::vector<std::pair<int, int>> &clips);
+
     /* @brief Performs an deletion of the given clip.
        Returns true if the operation succeeded, and otherwise, the track is not modified.
        This method is protected because it shouldn't be called directly. Call the function in the timeline instead.
@@ -263,6 +274,12 @@ public slots:
     void slotDelete();
 
 private:
+    /* @brief Book-keeping of the row and position indexes when a clip enters or leaves the track */
+    void indexClip(int clipId);
+    void unindexClip(int clipId);
+    /* @brief Moves the start of a clip already on the track, keeping the position index in sync */
+    void updateClipPosition(int clipId, int position);
+
     std::weak_ptr<TimelineModel> m_parent;
     int m_id; // this is the creation id of the track, used for book-keeping
 
@@ -279,6 +296,14 @@ private:
     std::map<int, int> m_compoPos; // We store the positions of the compositions. In Melt, the compositions are not inserted at the track level, but we keep
                                    // those positions here to check for moves and resize
 
+    /* Sorted ids of the clips and compositions, so that the row of an item (its rank in id order) and the item at a given row can be found without walking
+       the maps above. Tracks hold a few thousand items at most, so a sorted vector is cheaper to maintain than a tree */
+    std::vector<int> m_clipRows;
+    std::vector<int> m_compoRows;
+    /* Positions of the clips, for each sub-playlist (position -> clip id). Clips of the same sub-playlist never overlap, so range queries only need to look
+       at the entry preceding the range start and at the entries inside the range */
+    std::map<int, int> m_clipPos[2];
+
     mutable QReadWriteLock m_lock; // This is a lock that ensures safety in case of concurrent access
 
 protected:
@@ -31,6 +31,7 @@
 #include <QScopedPointer>
 #include <QStandardPaths>
 #include <QtConcurrent>
+#include <algorithm>
 
 PreviewManager::PreviewManager(TimelineController *controller, Mlt::Tractor *tractor)
     : QObject()
@@ -40,12 +41,11 @@ PreviewManager::PreviewManager(TimelineController *controller, Mlt::Tractor *tra
     , m_previewTrack(nullptr)
     , m_overlayTrack(nullptr)
     , m_previewTrackIndex(-1)
+    , m_previewFailed(false)
     , m_initialized(false)
 {
     m_previewGatherTimer.setSingleShot(true);
     m_previewGatherTimer.setInterval(200);
-    QObject::connect(&m_previewProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, &PreviewManager::processEnded);
-
 
     // Find path for Kdenlive renderer
 #ifdef Q_OS_WIN
@@ -59,14 +59,13 @@ PreviewManager::PreviewManager(TimelineController *controller, Mlt::Tractor *tra
             m_renderer = QStringLiteral("kdenlive_render");
         }
     }
-    connect(this, &PreviewManager::abortPreview, &m_previewProcess, &QProcess::kill, Qt::DirectConnection);
-    connect(&m_previewProcess, &QProcess::readyReadStandardError, this, &PreviewManager::receivedStderr);
 }
 
 PreviewManager::~PreviewManager()
 {
     if (m_initialized) {
         abortRendering();
+        m_previewProcesses.clear();
         if (m_undoDir.dirName() == QLatin1String("undo")) {
             m_undoDir.removeRecursively();
         }
@@ -434,12 +433,12 @@ void PreviewManager::addPreviewRange(const QPoint zone, bool add)
     if (add) {
         qDebug() << "CHUNKS CHANGED: " << m_dirtyChunks;
         m_controller->dirtyChunksChanged();
-        if (m_previewProcess.state() == QProcess::NotRunning && KdenliveSettings::autopreview()) {
+        if (!isRendering() && KdenliveSettings::autopreview()) {
             m_previewTimer.start();
         }
     } else {
         // Remove processed chunks
-        bool isRendering = m_previewProcess.state() != QProcess::NotRunning;
+        bool wasRendering = isRendering();
         m_previewGatherTimer.stop();
         abortRendering();
         m_tractor->lock();
@@ -461,24 +460,41 @@ void PreviewManager::addPreviewRange(const QPoint zone, bool add)
         m_controller->renderedChunksChanged();
         m_controller->dirtyChunksChanged();
         m_tractor->unlock();
-        if (isRendering || KdenliveSettings::autopreview()) {
+        if (wasRendering || KdenliveSettings::autopreview()) {
             m_previewTimer.start();
         }
     }
 }
 
+bool PreviewManager::isRendering() const
+{
+    for (const auto &process : m_previewProcesses) {
+        if (process->state() != QProcess::NotRunning) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void PreviewManager::waitForProcesses()
+{
+    for (const auto &process : m_previewProcesses) {
+        process->waitForFinished();
+        if (process->state() != QProcess::NotRunning) {
+            process->kill();
+            process->waitForFinished();
+        }
+    }
+}
+
 void PreviewManager::abortRendering()
 {
-    if (m_previewProcess.state() == QProcess::NotRunning) {
+    if (!isRendering()) {
         return;
     }
     qDebug() << "/// ABORTING RENDEIGN 1\nRRRRRRRRRR";
     emit abortPreview();
-    m_previewProcess.waitForFinished();
-    if (m_previewProcess.state() != QProcess::NotRunning) {
-        m_previewProcess.kill();
-        m_previewProcess.waitForFinished();
-    }
+    waitForProcesses();
     // Re-init time estimation
     emit previewRender(-1, QString(), 1000);
 }
@@ -503,17 +519,19 @@ void PreviewManager::startPreviewRender()
     }
 }
 
-void PreviewManager::receivedStderr()
+void PreviewManager::receivedStderr(QProcess *process)
 {
-    QStringList resultList = QString::fromLocal8Bit(m_previewProcess.readAllStandardError()).split(QLatin1Char('\n'));
+    QStringList resultList = QString::fromLocal8Bit(process->readAllStandardError()).split(QLatin1Char('\n'));
     for (auto &result : resultList) {
         qDebug() << "GOT PROCESS RESULT: " << result;
         if (result.startsWith(QLatin1String("START:"))) {
             workingPreview = result.section(QLatin1String("START:"), 1).simplified().toInt();
+            m_workingChunks.insert(process, workingPreview);
             qDebug() << "// GOT START INFO: " << workingPreview;
             m_controller->workingPreviewChanged();
         } else if (result.startsWith(QLatin1String("DONE:"))) {
             int chunk = result.section(QLatin1String("DONE:"), 1).simplified().toInt();
+            m_workingChunks.remove(process);
             m_processedChunks++;
             QString fileName = QStringLiteral("%1.%2").arg(chunk).arg(m_extension);
             qDebug() << "---------------\nJOB PROGRRESS: " << m_chunksToRender << ", " << m_processedChunks << " = "
@@ -532,48 +550,78 @@ void PreviewManager::doPreviewRender(const QString &scene)
     if (m_dirtyChunks.isEmpty()) {
         return;
     }
-    Q_ASSERT(m_previewProcess.state() == QProcess::NotRunning);
+    Q_ASSERT(!isRendering());
+    m_previewProcesses.clear();
+    m_workingChunks.clear();
+    m_previewFailed = false;
 
-    QStringList chunks;
+    int chunkSize = KdenliveSettings::timelinechunks();
+    // Render the chunks closest to the playhead first
+    int position = m_controller->position();
+    QList<int> chunks;
     for (QVariant &frame : m_dirtyChunks) {
-        chunks << frame.toString();
+        chunks << frame.toInt();
     }
-    m_chunksToRender = m_dirtyChunks.count();
+    std::stable_sort(chunks.begin(), chunks.end(), [position, chunkSize](int a, int b) {
+        return qAbs(a + chunkSize / 2 - position) < qAbs(b + chunkSize / 2 - position);
+    });
+    m_chunksToRender = chunks.count();
     m_processedChunks = 0;
-    int chunkSize = KdenliveSettings::timelinechunks();
-    QStringList args{KdenliveSettings::rendererpath(),
-                     scene,
-                     m_cacheDir.absolutePath(),
-                     QStringLiteral("-split"),
-                     chunks.join(QLatin1Char(',')),
-                     QString::number(chunkSize - 1),
-                     m_extension,
-                     m_consumerParams.join(QLatin1Char(' '))};
-    qDebug() << " -  - -STARTING PREVIEW JOBS: " << args;
+
+    // Dispatch chunks between the preview processes so that they all progress outwards from the playhead
+    int processCount = qBound(1, KdenliveSettings::previewprocesses(), chunks.count());
+    QVector<QStringList> processChunks(processCount);
+    for (int i = 0; i < chunks.count(); ++i) {
+        processChunks[i % processCount] << QString::number(chunks.at(i));
+    }
     pCore->currentDoc()->previewProgress(0);
-    m_previewProcess.start(m_renderer, args);
-    if (m_previewProcess.waitForStarted()) {
-        qDebug() << " -  - -STARTING PREVIEW JOBS . . . STARTED";
+    for (const QStringList &list : processChunks) {
+        QStringList args{KdenliveSettings::rendererpath(),
+                         scene,
+                         m_cacheDir.absolutePath(),
+                         QStringLiteral("-split"),
+                         list.join(QLatin1Char(',')),
+                         QString::number(chunkSize - 1),
+                         m_extension,
+                         m_consumerParams.join(QLatin1Char(' '))};
+        qDebug() << " -  - -STARTING PREVIEW JOBS: " << args;
+        m_previewProcesses.push_back(std::unique_ptr<QProcess>(new QProcess));
+        QProcess *process = m_previewProcesses.back().get();
+        connect(this, &PreviewManager::abortPreview, process, &QProcess::kill, Qt::DirectConnection);
+        connect(process, &QProcess::readyReadStandardError, this, [this, process]() { receivedStderr(process); });
+        connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+                [this, process](int, QProcess::ExitStatus status) { processEnded(process, status); });
+        process->start(m_renderer, args);
+        if (process->waitForStarted()) {
+            qDebug() << " -  - -STARTING PREVIEW JOBS . . . STARTED";
+        }
     }
 }
 
-void PreviewManager::processEnded(int, QProcess::ExitStatus status)
+void PreviewManager::processEnded(QProcess *process, QProcess::ExitStatus status)
 {
     qDebug() << "// PROCESS IS FINISHED!!!";
-    const QString sceneList = m_cacheDir.absoluteFilePath(QStringLiteral("preview.mlt"));
-    QFile::remove(sceneList);
+    int chunk = m_workingChunks.value(process, -1);
+    m_workingChunks.remove(process);
     if (status == QProcess::QProcess::CrashExit) {
         qDebug() << "// PROCESS CRASHED!!!!!!";
-        pCore->currentDoc()->previewProgress(-1);
-        if (workingPreview >= 0) {
-            const QString fileName = QStringLiteral("%1.%2").arg(workingPreview).arg(m_extension);
+        m_previewFailed = true;
+        if (chunk >= 0) {
+            const QString fileName = QStringLiteral("%1.%2").arg(chunk).arg(m_extension);
             if (m_cacheDir.exists(fileName)) {
                 m_cacheDir.remove(fileName);
             }
         }
-    } else {
-        pCore->currentDoc()->previewProgress(1000);
     }
+    if (isRendering()) {
+        // Other preview processes are still working
+        workingPreview = m_workingChunks.isEmpty() ? -1 : m_workingChunks.first();
+        m_controller->workingPreviewChanged();
+        return;
+    }
+    const QString sceneList = m_cacheDir.absoluteFilePath(QStringLiteral("preview.mlt"));
+    QFile::remove(sceneList);
+    pCore->currentDoc()->previewProgress(m_previewFailed ? -1 : 1000);
     workingPreview = -1;
     m_controller->workingPreviewChanged();
 }
@@ -709,7 +757,7 @@ void PreviewManager::gotPreviewRender(int frame, const QString &file, int progre
 void PreviewManager::corruptedChunk(int frame, const QString &fileName)
 {
     emit abortPreview();
-    m_previewProcess.waitForFinished();
+    waitForProcesses();
     if (workingPreview >= 0) {
         workingPreview = -1;
         m_controller->workingPreviewChanged();
@@ -24,10 +24,14 @@
 
 #include <QDir>
 #include <QFuture>
+#include <QMap>
 #include <QMutex>
 #include <QProcess>
 #include <QTimer>
 
+#include <memory>
+#include <vector>
+
 class TimelineController;
 
 namespace Mlt {
@@ -101,8 +105,12 @@ private:
     int m_previewTrackIndex;
     /** @brief: The kdenlive renderer app. */
     QString m_renderer;
-    /** @brief: The kdenlive timeline preview process. */
-    QProcess m_previewProcess;
+    /** @brief: The kdenlive timeline preview processes, each one rendering a share of the dirty chunks. */
+    std::vector<std::unique_ptr<QProcess>> m_previewProcesses;
+    /** @brief: The chunk currently processed by each running preview process. */
+    QMap<QProcess *, int> m_workingChunks;
+    /** @brief: True if one of the preview processes crashed during the current rendering. */
+    bool m_previewFailed;
     /** @brief: The directory used to store the preview files. */
     QDir m_cacheDir;
     /** @brief: The directory used to store undo history of preview files (child of m_cacheDir). */
@@ -127,6 +135,14 @@ private:
     void reloadChunks(const QVariantList chunks);
     /** @brief: A chunk failed to render, abort. */
     void corruptedChunk(int workingPreview, const QString &fileName);
+    /** @brief: Returns true if one of the preview processes is still running. */
+    bool isRendering() const;
+    /** @brief: Wait until all preview processes are stopped. */
+    void waitForProcesses();
+    /** @brief: Process preview rendering output of one of the preview processes. */
+    void receivedStderr(QProcess *process);
+    /** @brief: One of the preview processes ended. */
+    void processEnded(QProcess *process, QProcess::ExitStatus status);
 
 private slots:
     /** @brief: To avoid filling the hard drive, remove preview undo history after 5 steps. */
@@ -137,9 +153,6 @@ private slots:
     void slotRemoveInvalidUndo(int ix);
     /** @brief: When the timer collecting invalid zones is done, process. */
     void slotProcessDirtyChunks();
-    /** @brief: Process preview rendering output. */
-    void receivedStderr();
-    void processEnded(int, QProcess::ExitStatus status);
 
 public slots:
     /** @brief: Prepare and start rendering. */
@@ -45,6 +45,11 @@ Rectangle {
         scrollView.flickableItem.contentX = pos
     }
 
+    function updateVisibleRange() {
+        var start = scrollView.flickableItem.contentX / timeline.scaleFactor
+        timeline.setVisibleRange(start, start + scrollView.viewport.width / timeline.scaleFactor)
+    }
+
     function updatePalette() {
         root.color = activePalette.window
         root.textColor = activePalette.text
@@ -1480,6 +1485,7 @@ Rectangle {
         target: timeline
         onPositionChanged: if (!stopScrolling) Logic.scrollIfNeeded()
         onFrameFormatChanged: ruler.adjustFormat()
+        onScaleFactorChanged: updateVisibleRange()
         onSelectionChanged: {
             if (dragProxy.draggedItem > -1 && !timeline.exists(dragProxy.draggedItem)) {
                 endDrag()
@@ -1487,6 +1493,13 @@ Rectangle {
         }
     }
 
+    Connections {
+        // The thumbnails around the visible area are prefetched
+        target: scrollView.flickableItem
+        onContentXChanged: updateVisibleRange()
+        onWidthChanged: updateVisibleRange()
+    }
+
     // This provides continuous scrolling at the left/right edges.
     Timer {
         id: scrollTimer
@@ -23,10 +23,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "kdenlivesettings.h"
 #include "core.h"
 #include "bin/projectitemmodel.h"
+#include "lib/audio/audioPeaks.h"
 #include <QPainter>
 #include <QPainterPath>
 #include <QPalette>
 #include <QQuickPaintedItem>
+#include <algorithm>
 #include <cmath>
 
 const QStringList chanelNames{"L", "R", "C", "LFE", "BL", "BR"};
@@ -97,8 +99,13 @@ public:
         setMipmap(true);
         setTextureSize(QSize(width(), height()));
         connect(this, &TimelineWaveform::levelsChanged, [&]() {
-            if (!m_binId.isEmpty() && m_audioLevels.isEmpty()) {
-                m_audioLevels = pCore->projectItemModel()->getAudioLevelsByBinID(m_binId);
+            m_audioPeaks = m_binId.isEmpty() ? nullptr : pCore->projectItemModel()->getAudioPeaksByBinID(m_binId);
+            update();
+        });
+        // The peaks are replaced when the audio thumb job publishes progress or finishes
+        connect(pCore->projectItemModel().get(), &ProjectItemModel::refreshAudioThumbs, this, [&](const QString &id) {
+            if (id == m_binId) {
+                m_audioPeaks = pCore->projectItemModel()->getAudioPeaksByBinID(m_binId);
                 update();
             }
         });
@@ -109,16 +116,22 @@ public:
 
     void paint(QPainter *painter) override
     {
-        if (!m_showItem || m_binId.isEmpty()) {
+        if (!m_showItem || m_binId.isEmpty() || m_channels <= 0) {
             return;
         }
-        if (m_audioLevels.isEmpty()) {
-            m_audioLevels = pCore->projectItemModel()->getAudioLevelsByBinID(m_binId);
-            if (m_audioLevels.isEmpty()) {
+        if (!m_audioPeaks) {
+            m_audioPeaks = pCore->projectItemModel()->getAudioPeaksByBinID(m_binId);
+            if (!m_audioPeaks) {
                 return;
             }
         }
-        qreal indicesPrPixel = qreal(m_outPoint - m_inPoint) / width();
+        int channels = qMin(m_channels, m_audioPeaks->channels());
+        // In and out points are expressed in audio level indexes (frame * channels)
+        double startFrame = double(m_inPoint) / m_channels;
+        double framesPrPixel = double(m_outPoint - m_inPoint) / m_channels / width();
+        // Pick the peak level matching our zoom, so that each pixel only merges a few buckets
+        int level = m_audioPeaks->levelForFramesPerPixel(qAbs(framesPrPixel));
+        int frames = m_audioPeaks->frames();
         QPen pen = painter->pen();
         pen.setColor(m_color);
         pen.setWidthF(0);
@@ -126,42 +139,41 @@ public:
         if (!KdenliveSettings::displayallchannels()) {
             // Draw merged channels
             QPainterPath path;
+            QPainterPath rmsPath;
             path.moveTo(-1, height());
-            double i = 0;
-            double increment = qMax(1., 1 / qAbs(indicesPrPixel));
-            double level;
-            int lastIdx = -1;
-            for (; i <= width(); i += increment) {
-                int idx = m_inPoint + int(i * indicesPrPixel);
-                if (idx + m_channels >= m_audioLevels.length() || idx < 0) {
+            rmsPath.moveTo(-1, height());
+            int i = 0;
+            for (; i <= width(); ++i) {
+                double pos = startFrame + i * framesPrPixel;
+                double next = pos + framesPrPixel;
+                if (qMin(pos, next) >= frames || qMax(pos, next) < 0) {
                     break;
                 }
-                if (lastIdx == idx) {
-                    continue;
-                }
-                lastIdx = idx;
-                level = m_audioLevels.at(idx) / 256;
-                for (int j = 1; j < m_channels; j++) {
-                    level = qMax(level, m_audioLevels.at(idx + j) / 256);
+                double value = 0;
+                double rms = 0;
+                for (int j = 0; j < channels; j++) {
+                    AudioPeaks::Peak peak = m_audioPeaks->range(level, qMin(pos, next), qMax(pos, next), j);
+                    value = qMax(value, qMax(-double(peak.min), double(peak.max)) / 32768.);
+                    rms = qMax(rms, peak.rms / 32768.);
                 }
-                path.lineTo(i, height() - level * height());
+                path.lineTo(i, height() - value * height());
+                rmsPath.lineTo(i, height() - rms * height());
             }
             path.lineTo(i, height());
+            rmsPath.lineTo(i, height());
             painter->drawPath(path);
+            painter->setPen(Qt::NoPen);
+            painter->setBrush(m_color.darker(150));
+            painter->drawPath(rmsPath);
         } else {
             double channelHeight = height() / (2 * m_channels);
             QFont font = painter->font();
             font.setPixelSize(channelHeight - 1);
             painter->setFont(font);
             // Draw separate channels
-            double i = 0;
-            double increment = qMax(1., 1 / indicesPrPixel);
-            double level;
             QRectF bgRect(0, 0, width(), 2 * channelHeight);
-            QVector<QPainterPath> channelPaths(m_channels);
-            for (int channel = 0; channel < m_channels; channel++) {
+            for (int channel = 0; channel < channels; channel++) {
                 double y = height() - (2 * channel * channelHeight) - channelHeight;
-                channelPaths[channel].moveTo(-1, y);
                 painter->setOpacity(0.2);
                 if (channel % 2 == 0) {
                     // Add dark background on odd channels
@@ -172,26 +184,25 @@ public:
                 painter->setPen(pen);
                 painter->drawLine(QLineF(0., y, width(), y));
                 painter->setOpacity(1);
-                int lastIdx = -1;
-                for (i = 0; i <= width(); i += increment) {
-                    int idx = m_inPoint + ceil(i * indicesPrPixel);
-                    if (lastIdx == idx) {
-                        continue;
+                // Upper part of the polygon follows the max values, lower part the min values
+                QPolygonF maxPoints;
+                QPolygonF minPoints;
+                for (int i = 0; i <= width(); ++i) {
+                    double pos = startFrame + i * framesPrPixel;
+                    double next = pos + framesPrPixel;
+                    if (qMin(pos, next) >= frames || qMax(pos, next) < 0) {
+                        break;
                     }
-                    lastIdx = idx;
-                    idx += channel;
-                    if (idx >= m_audioLevels.length() || idx < 0) break;
-                    level = m_audioLevels.at(idx) * channelHeight / 256;
-                    channelPaths[channel].lineTo(i, y - level);
+                    AudioPeaks::Peak peak = m_audioPeaks->range(level, qMin(pos, next), qMax(pos, next), channel);
+                    maxPoints << QPointF(i, y - peak.max * channelHeight / 32768.);
+                    minPoints << QPointF(i, y - peak.min * channelHeight / 32768.);
                 }
                 if (m_firstChunk && m_channels > 1 && m_channels < 7) {
                     painter->drawText(2, y + channelHeight, chanelNames[channel]);
                 }
-                channelPaths[channel].lineTo(i, y);
+                std::reverse(minPoints.begin(), minPoints.end());
                 painter->setPen(Qt::NoPen);
-                painter->drawPath(channelPaths.value(channel));
-                QTransform tr(1, 0, 0, -1, 0, 2 * y);
-                painter->drawPath(tr.map(channelPaths.value(channel)));
+                painter->drawPolygon(QPolygonF(maxPoints + minPoints));
             }
         }
     }
@@ -205,7 +216,7 @@ signals:
     void audioChannelsChanged();
 
 private:
-    QList<double> m_audioLevels;
+    std::shared_ptr<AudioPeaks> m_audioPeaks;
     int m_inPoint;
     int m_outPoint;
     QString m_binId;
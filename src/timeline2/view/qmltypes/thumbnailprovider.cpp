@@ -21,6 +21,7 @@
 #include "bin/projectitemmodel.h"
 #include "core.h"
 #include "utils/thumbnailcache.hpp"
+#include "utils/thumbnailprefetcher.hpp"
 
 #include <QCryptographicHash>
 #include <QDebug>
@@ -38,30 +39,20 @@ ThumbnailProvider::~ThumbnailProvider() = default;
 
 void ThumbnailProvider::resetProject()
 {
-    // m_producers.clear();
+    ThumbnailPrefetcher::get()->reset();
 }
 
 QImage ThumbnailProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize)
 {
+    Q_UNUSED(requestedSize)
     QImage result;
     // id is binID/#frameNumber
     QString binId = id.section('/', 0, 0);
     bool ok;
     int frameNumber = id.section('#', -1).toInt(&ok);
     if (ok) {
-        if (ThumbnailCache::get()->hasThumbnail(binId, frameNumber, false)) {
-            result = ThumbnailCache::get()->getThumbnail(binId, frameNumber);
-            *size = result.size();
-            return result;
-        }
-        std::shared_ptr<ProjectClip> binClip = pCore->projectItemModel()->getClipByBinID(binId);
-        if (binClip) {
-            std::shared_ptr<Mlt::Producer> prod = binClip->thumbProducer();
-            if (prod && prod->is_valid()) {
-                result = makeThumbnail(prod, frameNumber, requestedSize);
-                ThumbnailCache::get()->storeThumbnail(binId, frameNumber, result, false);
-            }
-        }
+        // The thumbnail producers are shared with the prefetch, which serializes their use
+        result = ThumbnailPrefetcher::get()->getThumbnail(binId, frameNumber);
 
         /*if (m_producers.contains(binId.toInt())) {
             producer = m_producers.object(binId.toInt());
@@ -118,28 +109,3 @@ QString ThumbnailProvider::cacheKey(Mlt::Properties &properties, const QString &
     }
     return key;
 }
-
-QImage ThumbnailProvider::makeThumbnail(const std::shared_ptr<Mlt::Producer> &producer, int frameNumber, const QSize &requestedSize)
-{
-    Q_UNUSED(requestedSize)
-    producer->seek(frameNumber);
-    QScopedPointer<Mlt::Frame> frame(producer->get_frame());
-    if (frame == nullptr || !frame->is_valid()) {
-        return QImage();
-    }
-    int ow = 0; // requestedSize.width();
-    int oh = 0; // requestedSize.height();
-    /*if (ow > 0 && oh > 0) {
-        frame->set("rescale.interp", "fastest");
-        frame->set("deinterlace_method", "onefield");
-        frame->set("top_field_first", -1);
-    }*/
-    mlt_image_format format = mlt_image_rgb24a;
-    const uchar *image = frame->get_image(format, ow, oh);
-    if (image) {
-        QImage temp(ow, oh, QImage::Format_ARGB32);
-        memcpy(temp.scanLine(0), image, (unsigned)(ow * oh * 4));
-        return temp.rgbSwapped();
-    }
-    return QImage();
-}
@@ -48,6 +48,7 @@
 #include "timeline2/view/dialogs/clipdurationdialog.h"
 #include "timeline2/view/dialogs/trackdialog.h"
 #include "transitions/transitionsrepository.hpp"
+#include "utils/thumbnailprefetcher.hpp"
 
 #include <KActionCollection>
 #include <KColorScheme>
@@ -56,6 +57,7 @@
 #include <QClipboard>
 #include <QInputDialog>
 #include <QQuickItem>
+#include <cmath>
 #include <memory>
 #include <unistd.h>
 
@@ -72,7 +74,13 @@ TimelineController::TimelineController(QObject *parent)
     , m_zone(-1, -1)
     , m_scale(QFontMetrics(QApplication::font()).maxWidth() / 250)
     , m_timelinePreview(nullptr)
+    , m_visibleStart(0)
+    , m_visibleEnd(0)
+    , m_scrollDirection(0)
 {
+    m_prefetchTimer.setSingleShot(true);
+    m_prefetchTimer.setInterval(100);
+    connect(&m_prefetchTimer, &QTimer::timeout, this, &TimelineController::prefetchThumbnails);
     m_disablePreview = pCore->currentDoc()->getAction(QStringLiteral("disable_preview"));
     connect(m_disablePreview, &QAction::triggered, this, &TimelineController::disablePreview);
     connect(this, &TimelineController::selectionChanged, this, &TimelineController::updateClipActions);
@@ -1312,6 +1320,17 @@ QVariantList TimelineController::renderedChunks() const
     return m_timelinePreview ? m_timelinePreview->m_renderedChunks : QVariantList();
 }
 
+bool TimelineController::previewEncoding(QDir &folder, QString &extension, QStringList &params) const
+{
+    if (!m_timelinePreview) {
+        return false;
+    }
+    folder = m_timelinePreview->m_cacheDir;
+    extension = m_timelinePreview->m_extension;
+    params = m_timelinePreview->m_consumerParams;
+    return !extension.isEmpty() && !params.isEmpty();
+}
+
 int TimelineController::workingPreview() const
 {
     return m_timelinePreview ? m_timelinePreview->workingPreview : -1;
@@ -1741,29 +1760,42 @@ void TimelineController::alignAudio(int clipId)
         pCore->displayMessage(i18n("Set audio reference before attempting to align"), InformationMessage, 500);
         return;
     }
-    const QString masterBinClipId = getClipBinId(m_audioRef);
-    if (m_model->m_groups->isInGroup(clipId)) {
-        std::unordered_set<int> groupIds = m_model->getGroupElements(clipId);
+    // When the clip is part of the selection, all the selected clips are aligned at once
+    std::vector<int> clips;
+    std::unordered_set<int> selection = m_model->getCurrentSelection();
+    if (selection.count(clipId) > 0) {
+        for (int id : selection) {
+            if (id != m_audioRef && m_model->isClip(id)) {
+                clips.push_back(id);
+            }
+        }
+    } else {
+        clips.push_back(clipId);
+    }
+    if (!selection.empty() || m_model->m_groups->isInGroup(clipId)) {
         // Check that no item is grouped with our audioRef item
         // TODO
         m_model->requestClearSelection();
     }
-    const QString otherBinId = getClipBinId(clipId);
-    if (otherBinId == masterBinClipId) {
-        // easy, same clip.
-        int newPos = m_model->getClipPosition(m_audioRef) - m_model->getClipIn(m_audioRef) + m_model->getClipIn(clipId);
-        if (newPos) {
-            bool result = m_model->requestClipMove(clipId, m_model->getClipTrackId(clipId), newPos, true, true);
-            if (!result) {
-                pCore->displayMessage(i18n("Cannot move clip to frame %1.", newPos), InformationMessage, 500);
+    const QString masterBinClipId = getClipBinId(m_audioRef);
+    for (int cid : clips) {
+        const QString otherBinId = getClipBinId(cid);
+        if (otherBinId == masterBinClipId) {
+            // easy, same clip.
+            int newPos = m_model->getClipPosition(m_audioRef) - m_model->getClipIn(m_audioRef) + m_model->getClipIn(cid);
+            if (newPos) {
+                bool result = m_model->requestClipMove(cid, m_model->getClipTrackId(cid), newPos, true, true);
+                if (!result) {
+                    pCore->displayMessage(i18n("Cannot move clip to frame %1.", newPos), InformationMessage, 500);
+                }
+                continue;
             }
-            return;
         }
+        // Perform audio calculation, the children are correlated concurrently
+        AudioEnvelope *envelope = new AudioEnvelope(otherBinId, cid, (size_t)m_model->getClipIn(cid), (size_t)m_model->getClipPlaytime(cid),
+                                                    (size_t)m_model->getClipPosition(cid));
+        m_audioCorrelator->addChild(envelope);
     }
-    // Perform audio calculation
-    AudioEnvelope *envelope = new AudioEnvelope(otherBinId, clipId, (size_t)m_model->getClipIn(clipId), (size_t)m_model->getClipPlaytime(clipId),
-                                                (size_t)m_model->getClipPosition(clipId));
-    m_audioCorrelator->addChild(envelope);
 }
 
 void TimelineController::switchTrackActive(int trackId)
@@ -2290,6 +2322,105 @@ bool TimelineController::endFakeGroupMove(int clipId, int groupId, int delta_tra
     return true;
 }
 
+void TimelineController::setVisibleRange(int start, int end)
+{
+    if (start == m_visibleStart && end == m_visibleEnd) {
+        return;
+    }
+    if (start != m_visibleStart) {
+        m_scrollDirection = start > m_visibleStart ? 1 : -1;
+    }
+    m_visibleStart = start;
+    m_visibleEnd = end;
+    // While scrolling, the prefetch is updated at the timer pace
+    if (!m_prefetchTimer.isActive()) {
+        m_prefetchTimer.start();
+    }
+}
+
+void TimelineController::prefetchThumbnails()
+{
+    if (!m_model || !KdenliveSettings::videothumbnails() || m_visibleEnd <= m_visibleStart) {
+        return;
+    }
+    // Prefetch half a screen ahead in the scroll direction
+    int ahead = (m_visibleEnd - m_visibleStart) / 2;
+    int start = m_scrollDirection < 0 ? qMax(0, m_visibleStart - ahead) : m_visibleStart;
+    int end = m_scrollDirection > 0 ? m_visibleEnd + ahead : m_visibleEnd;
+    // The requests are sorted by distance to the visible area
+    std::vector<std::pair<int, ThumbnailPrefetcher::Request>> requests;
+    for (int tid : m_model->getAllTracksIds()) {
+        if (m_model->isAudioTrack(tid)) {
+            continue;
+        }
+        QModelIndex trackIndex = m_model->makeTrackIndexFromID(tid);
+        int format = m_model->data(trackIndex, TimelineModel::ThumbsFormatRole).toInt();
+        int height = m_model->data(trackIndex, TimelineModel::HeightRole).toInt();
+        for (int cid : m_model->getItemsInRange(tid, start, end, false)) {
+            std::vector<int> frames = thumbnailFrames(cid, format, height, start, end);
+            if (frames.empty()) {
+                continue;
+            }
+            int position = m_model->getClipPosition(cid);
+            int clipEnd = position + m_model->getClipPlaytime(cid);
+            int distance = clipEnd < m_visibleStart ? m_visibleStart - clipEnd : qMax(0, position - m_visibleEnd);
+            requests.emplace_back(distance, ThumbnailPrefetcher::Request{getClipBinId(cid), std::move(frames)});
+        }
+    }
+    std::stable_sort(requests.begin(), requests.end(),
+                     [](const std::pair<int, ThumbnailPrefetcher::Request> &a, const std::pair<int, ThumbnailPrefetcher::Request> &b) {
+                         return a.first < b.first;
+                     });
+    std::vector<ThumbnailPrefetcher::Request> sorted;
+    sorted.reserve(requests.size());
+    for (auto &request : requests) {
+        sorted.push_back(std::move(request.second));
+    }
+    ThumbnailPrefetcher::get()->prefetch(std::move(sorted));
+}
+
+std::vector<int> TimelineController::thumbnailFrames(int clipId, int thumbsFormat, int trackHeight, int start, int end) const
+{
+    std::vector<int> frames;
+    std::shared_ptr<ProjectClip> binClip = pCore->bin()->getBinClip(getClipBinId(clipId));
+    // Images only have one thumbnail, audio and color clips have none
+    if (!binClip || binClip->clipType() == ClipType::Audio || binClip->clipType() == ClipType::Color || binClip->clipType() == ClipType::Image ||
+        binClip->clipType() == ClipType::Unknown) {
+        return frames;
+    }
+    std::shared_ptr<ClipModel> clip = m_model->getClipPtr(clipId);
+    double speed = clip->getSpeed();
+    int inFrame = int(std::floor(clip->getIn() * speed));
+    int outFrame = int(std::floor(clip->getOut() * speed));
+    if (thumbsFormat == 0) {
+        frames = {inFrame, outFrame};
+    } else if (thumbsFormat == 2) {
+        frames = {inFrame};
+    } else if (thumbsFormat == 1) {
+        // The clip is split in thumbnails with a 16/9 ratio, inside a 1.5 pixel border
+        double width = clip->getPlaytime() * m_scale - 3;
+        int thumbWidth = int((trackHeight - 3) * 16.0 / 9.0);
+        int count = thumbWidth > 0 ? int(width / thumbWidth) : 0;
+        if (count < 3) {
+            frames = {inFrame, outFrame};
+            frames.resize((size_t)qMax(0, count));
+        } else {
+            double imageWidth = qMax((double)thumbWidth, width / count);
+            int position = m_model->getClipPosition(clipId);
+            for (int i = 0; i < count; ++i) {
+                double offset = i * imageWidth / m_scale;
+                if (position + offset + imageWidth / m_scale < start || position + offset > end) {
+                    continue;
+                }
+                frames.push_back(int(std::floor(clip->getIn() + qRound(offset) * speed)));
+            }
+        }
+    }
+    std::sort(frames.begin(), frames.end());
+    frames.erase(std::unique(frames.begin(), frames.end()), frames.end());
+    return frames;
+}
+
 QStringList TimelineController::getThumbKeys()
 {
     QStringList result;
@@ -28,6 +28,7 @@
 
 #include <KActionCollection>
 #include <QDir>
+#include <QTimer>
 
 class PreviewManager;
 class QAction;
@@ -406,6 +407,10 @@ public:
     void stopPreviewRender();
     QVariantList dirtyChunks() const;
     QVariantList renderedChunks() const;
+    /* @brief Gets the folder, file extension and encoding parameters of the timeline preview chunks.
+       Returns false if timeline preview is not enabled
+     */
+    bool previewEncoding(QDir &folder, QString &extension, QStringList &params) const;
     /* @brief returns the frame currently processed by timeline preview, -1 if none
      */
     int workingPreview() const;
@@ -474,9 +479,13 @@ public slots:
     void saveTimelineSelection(const QDir &targetDir);
     /** @brief Restore timeline scroll pos on open. */
     void setScrollPos(int pos);
+    /** @brief The view scrolled or zoomed, start and end are the visible frames. The thumbnails around them are prefetched. */
+    Q_INVOKABLE void setVisibleRange(int start, int end);
 
 private slots:
     void updateClipActions();
+    /** @brief Sends the thumbnails of the visible area, and ahead of it in the scroll direction, to the prefetcher */
+    void prefetchThumbnails();
 
 public:
     /** @brief a list of actions that have to be enabled/disabled depending on the timeline selection */
@@ -502,8 +511,14 @@ private:
     QAction *m_disablePreview;
     std::shared_ptr<AudioCorrelation> m_audioCorrelator;
     QMutex m_metaMutex;
+    int m_visibleStart;
+    int m_visibleEnd;
+    int m_scrollDirection;
+    QTimer m_prefetchTimer;
 
     int getCurrentItem();
+    /** @brief Returns the frames of the thumbnails of a clip that the view displays between start and end, see ClipThumbs.qml */
+    std::vector<int> thumbnailFrames(int clipId, int thumbsFormat, int trackHeight, int start, int end) const;
     void initializePreview();
     bool darkBackground() const;
 
@@ -24,6 +24,7 @@
 #include "kdenlivesettings.h"
 #include "xml/xml.hpp"
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QStandardPaths>
 #include <QTextStream>
@@ -37,7 +38,10 @@ std::once_flag TransitionsRepository::m_onceFlag;
 TransitionsRepository::TransitionsRepository()
     : AbstractAssetsRepository<TransitionType>()
 {
+    QElapsedTimer timer;
+    timer.start();
     init();
+    pCore->addTiming(QStringLiteral("Transitions"), timer.elapsed());
     QStringList invalidTransition;
     for (const QString &effect : KdenliveSettings::favorite_transitions()) {
         if (!exists(effect)) {
@@ -153,6 +157,11 @@ QString TransitionsRepository::assetPreferredListPath() const
     return QStringLiteral("");
 }
 
+QString TransitionsRepository::cacheName() const
+{
+    return QStringLiteral("transitions.cache");
+}
+
 std::unique_ptr<Mlt::Transition> TransitionsRepository::getTransition(const QString &transitionId) const
 {
     Q_ASSERT(exists(transitionId));
@@ -74,6 +74,9 @@ protected:
     /* @brief Returns the path to the effects' preferred list*/
     QString assetPreferredListPath() const override;
 
+    /* @brief Returns the name of the file caching the parsed assets */
+    QString cacheName() const override;
+
     void parseType(QScopedPointer<Mlt::Properties> &metadata, Info &res) override;
 
     /* @brief Returns the metadata associated with the given asset*/
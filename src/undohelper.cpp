@@ -22,7 +22,70 @@
 #include "undohelper.hpp"
 #include "logger.hpp"
 #include <QDebug>
+#include <memory>
 #include <utility>
+
+void UndoTransaction::push(Fun operation, Fun reverse)
+{
+    m_operations.push_back(std::move(operation));
+    m_reverses.push_back(std::move(reverse));
+}
+
+bool UndoTransaction::undo() const
+{
+    bool result = true;
+    for (auto it = m_reverses.rbegin(); it != m_reverses.rend(); ++it) {
+        result = (*it)() && result;
+    }
+    return result;
+}
+
+bool UndoTransaction::redo() const
+{
+    bool result = true;
+    for (const Fun &operation : m_operations) {
+        result = operation() && result;
+    }
+    return result;
+}
+
+bool UndoTransaction::isEmpty() const
+{
+    return m_operations.empty();
+}
+
+size_t UndoTransaction::size() const
+{
+    return m_operations.size();
+}
+
+Fun UndoTransaction::takeUndo()
+{
+    // The list is shared, so that copying the resulting function (as UPDATE_UNDO_REDO does) is cheap
+    auto reverses = std::make_shared<const std::vector<Fun>>(std::move(m_reverses));
+    m_reverses.clear();
+    return [reverses]() {
+        bool result = true;
+        for (auto it = reverses->rbegin(); it != reverses->rend(); ++it) {
+            result = (*it)() && result;
+        }
+        return result;
+    };
+}
+
+Fun UndoTransaction::takeRedo()
+{
+    auto operations = std::make_shared<const std::vector<Fun>>(std::move(m_operations));
+    m_operations.clear();
+    return [operations]() {
+        bool result = true;
+        for (const Fun &operation : *operations) {
+            result = operation() && result;
+        }
+        return result;
+    };
+}
+
 FunctionalUndoCommand::FunctionalUndoCommand(Fun undo, Fun redo, const QString &text, QUndoCommand *parent)
     : QUndoCommand(parent)
     , m_undo(std::move(undo))
@@ -32,6 +95,15 @@ FunctionalUndoCommand::FunctionalUndoCommand(Fun undo, Fun redo, const QString &
     setText(text);
 }
 
+FunctionalUndoCommand::FunctionalUndoCommand(UndoTransaction &&transaction, const QString &text, QUndoCommand *parent)
+    : QUndoCommand(parent)
+    , m_undo(transaction.takeUndo())
+    , m_redo(transaction.takeRedo())
+    , m_undone(false)
+{
+    setText(text);
+}
+
 void FunctionalUndoCommand::undo()
 {
     // qDebug() << "UNDOING " <<text();
@@ -42,6 +42,49 @@ using Fun = std::function<bool(void)>;
     };
 
 #include <QUndoCommand>
+#include <utility>
+#include <vector>
+
+/*@brief This class records a sequence of operations that were applied, with their reverses, in a flat list.
+  It is meant to replace the chains of lambdas built by UPDATE_UNDO_REDO in operations applied to many items: each new operation wraps the previous
+  chain in a new closure, so that the resulting functions are as deep as the number of items.
+  Here, redo runs the operations in order and undo runs the reverses in reverse order, iteratively. As with UPDATE_UNDO_REDO, all of them are run even if one
+  of them fails.
+ */
+class UndoTransaction
+{
+public:
+    /* @brief Records an operation that was already applied, and its reverse */
+    void push(Fun operation, Fun reverse);
+
+    /* @brief Calls a function using the usual (Fun &undo, Fun &redo) convention with empty undo and redo, and records the result as a single step.
+       Returns the value returned by the function.
+     */
+    template <typename F> bool record(F &&function)
+    {
+        Fun local_undo = []() { return true; };
+        Fun local_redo = []() { return true; };
+        bool result = function(local_undo, local_redo);
+        push(std::move(local_redo), std::move(local_undo));
+        return result;
+    }
+
+    /* @brief Runs the reverses, from the last recorded to the first one */
+    bool undo() const;
+    /* @brief Runs the operations, in the recorded order */
+    bool redo() const;
+
+    bool isEmpty() const;
+    size_t size() const;
+
+    /* @brief Moves the reverses (resp. the operations) into a single function that runs them. The transaction doesn't hold them anymore afterwards */
+    Fun takeUndo();
+    Fun takeRedo();
+
+private:
+    std::vector<Fun> m_operations;
+    std::vector<Fun> m_reverses;
+};
 
 /*@brief this is a generic class that takes fonctors as undo and redo actions. It just executes them when required by Qt
   Note that QUndoStack actually executes redo() when we push the undoCommand to the stack
@@ -52,6 +95,7 @@ class FunctionalUndoCommand : public QUndoCommand
 {
 public:
     FunctionalUndoCommand(Fun undo, Fun redo, const QString &text, QUndoCommand *parent = nullptr);
+    FunctionalUndoCommand(UndoTransaction &&transaction, const QString &text, QUndoCommand *parent = nullptr);
     void undo() override;
     void redo() override;
 
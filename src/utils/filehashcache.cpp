@@ -0,0 +1,209 @@
+/***************************************************************************
+ *   Copyright (C) 2019 by Kdenlive contributors                           *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "filehashcache.hpp"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <algorithm>
+#include <vector>
+
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
+
+namespace {
+const quint32 cacheMagic = 0x4b484348; // KHCH
+const quint32 cacheVersion = 1;
+// Hashes of files that were not used for a long time are dropped when there are more than this
+const size_t maxEntries = 50000;
+// Size of the blocks read at the start and end of the file
+const qint64 blockSize = 1000000;
+} // namespace
+
+std::unique_ptr<FileHashCache> FileHashCache::instance;
+std::once_flag FileHashCache::m_onceFlag;
+
+std::unique_ptr<FileHashCache> &FileHashCache::get()
+{
+    std::call_once(m_onceFlag, [] {
+        QDir folder(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+        folder.mkpath(QStringLiteral("."));
+        instance.reset(new FileHashCache(folder.absoluteFilePath(QStringLiteral("filehashes"))));
+    });
+    return instance;
+}
+
+FileHashCache::FileHashCache(const QString &cacheFile)
+    : m_cacheFile(cacheFile)
+{
+}
+
+FileHashCache::~FileHashCache()
+{
+    save();
+}
+
+// static
+FileHashCache::Identity FileHashCache::identify(const QString &path)
+{
+    Identity identity;
+    QFileInfo info(path);
+    if (!info.isFile()) {
+        return identity;
+    }
+    identity.size = info.size();
+    identity.modified = info.lastModified().toMSecsSinceEpoch();
+#ifdef Q_OS_UNIX
+    // The inode tells apart a file replaced by another one with the same size and date
+    struct stat st;
+    if (::stat(QFile::encodeName(path).constData(), &st) == 0) {
+        identity.inode = (quint64)st.st_ino;
+    }
+#endif
+    return identity;
+}
+
+// static
+QString FileHashCache::computeHash(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+    /*
+     * 1 MB = 1 second per 450 files (or faster)
+     * 10 MB = 9 seconds per 450 files (or faster)
+     */
+    QByteArray fileData;
+    if (file.size() > 2 * blockSize) {
+        fileData = file.read(blockSize);
+        if (file.seek(file.size() - blockSize)) {
+            fileData.append(file.readAll());
+        }
+    } else {
+        fileData = file.readAll();
+    }
+    return QString::fromLatin1(QCryptographicHash::hash(fileData, QCryptographicHash::Md5).toHex());
+}
+
+void FileHashCache::load()
+{
+    if (m_loaded) {
+        return;
+    }
+    m_loaded = true;
+    QFile file(m_cacheFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    QDataStream stream(&file);
+    quint32 magic = 0;
+    quint32 version = 0;
+    quint32 count = 0;
+    stream >> magic >> version >> count;
+    if (magic != cacheMagic || version != cacheVersion) {
+        qDebug() << "// Ignoring invalid file hash cache" << m_cacheFile;
+        return;
+    }
+    m_entries.reserve(count);
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QString path;
+        Entry entry;
+        stream >> path >> entry.identity.size >> entry.identity.modified >> entry.identity.inode >> entry.hash >> entry.lastUse;
+        if (stream.status() == QDataStream::Ok) {
+            m_entries[path] = entry;
+        }
+    }
+}
+
+void FileHashCache::save()
+{
+    QMutexLocker lock(&m_mutex);
+    if (!m_dirty) {
+        return;
+    }
+    std::vector<std::pair<QString, Entry>> entries(m_entries.begin(), m_entries.end());
+    if (entries.size() > maxEntries) {
+        // Keep the most recently used hashes
+        std::nth_element(entries.begin(), entries.begin() + maxEntries, entries.end(),
+                         [](const std::pair<QString, Entry> &a, const std::pair<QString, Entry> &b) { return a.second.lastUse > b.second.lastUse; });
+        entries.resize(maxEntries);
+    }
+    QSaveFile file(m_cacheFile);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "// Cannot write file hash cache" << m_cacheFile;
+        return;
+    }
+    QDataStream stream(&file);
+    stream << cacheMagic << cacheVersion << (quint32)entries.size();
+    for (const auto &entry : entries) {
+        stream << entry.first << entry.second.identity.size << entry.second.identity.modified << entry.second.identity.inode << entry.second.hash
+               << entry.second.lastUse;
+    }
+    if (file.commit()) {
+        m_dirty = false;
+    }
+}
+
+bool FileHashCache::contains(const QString &path)
+{
+    const Identity identity = identify(path);
+    QMutexLocker lock(&m_mutex);
+    load();
+    auto it = m_entries.find(path);
+    return identity.size >= 0 && it != m_entries.end() && it->second.identity == identity;
+}
+
+QString FileHashCache::hash(const QString &path, qint64 *size)
+{
+    const Identity identity = identify(path);
+    if (size != nullptr) {
+        *size = identity.size;
+    }
+    if (identity.size < 0) {
+        return QString();
+    }
+    const qint64 now = QDateTime::currentMSecsSinceEpoch() / 1000;
+    {
+        QMutexLocker lock(&m_mutex);
+        load();
+        auto it = m_entries.find(path);
+        if (it != m_entries.end() && it->second.identity == identity) {
+            it->second.lastUse = now;
+            return it->second.hash;
+        }
+    }
+    // Files are read without holding the lock, so that several files can be hashed at once
+    const QString result = computeHash(path);
+    if (!result.isEmpty()) {
+        QMutexLocker lock(&m_mutex);
+        m_entries[path] = Entry{identity, result, now};
+        m_dirty = true;
+    }
+    return result;
+}
@@ -0,0 +1,90 @@
+/***************************************************************************
+ *   Copyright (C) 2019 by Kdenlive contributors                           *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#pragma once
+
+#include "definitions.h"
+#include <QMutex>
+#include <QString>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+/** @brief This class caches the hashes identifying the source files of the clips.
+    The hash of a file is the MD5 of its first and last megabytes (or of the whole file if it is small), as stored in the kdenlive:file_hash
+    property of the clips. Reading these blocks is slow on network storage, so the hashes are kept in a file of the user cache folder,
+    with the size, modification time and inode of the hashed file: a hash is only computed again once the file changed.
+    The cache is used when loading clips and when searching missing clips. It is thread safe.
+ * Note that this class is a Singleton
+ */
+class FileHashCache
+{
+
+public:
+    // Returns the instance of the Singleton
+    static std::unique_ptr<FileHashCache> &get();
+
+    /* @brief Opens the cache stored in the given file. The file is only read on first use */
+    explicit FileHashCache(const QString &cacheFile);
+    ~FileHashCache();
+
+    /* @brief Returns the hexadecimal hash of a file, or an empty string if it cannot be read
+       @param size if not null, receives the size of the file
+     */
+    QString hash(const QString &path, qint64 *size = nullptr);
+
+    /* @brief Returns true if the hash of the file, in its current state, is cached */
+    bool contains(const QString &path);
+
+    /* @brief Computes the hash of a file without using the cache */
+    static QString computeHash(const QString &path);
+
+    /* @brief Writes the cache file if some hashes were computed since it was read */
+    void save();
+
+protected:
+    struct Identity
+    {
+        qint64 size{-1};
+        qint64 modified{0};
+        quint64 inode{0};
+        bool operator==(const Identity &other) const { return size == other.size && modified == other.modified && inode == other.inode; }
+    };
+    struct Entry
+    {
+        Identity identity;
+        QString hash;
+        qint64 lastUse{0};
+    };
+
+    /* @brief Returns the size, modification time and inode of a file, size is -1 if it does not exist */
+    static Identity identify(const QString &path);
+    /* @brief Reads the cache file if it was not read yet, the mutex must be locked */
+    void load();
+
+    QString m_cacheFile;
+    QMutex m_mutex;
+    std::unordered_map<QString, Entry> m_entries;
+    bool m_loaded{false};
+    bool m_dirty{false};
+    static std::unique_ptr<FileHashCache> instance;
+    static std::once_flag m_onceFlag; // flag to create the instance only once
+};
@@ -0,0 +1,129 @@
+/***************************************************************************
+ *   Copyright (C) 2019 by Kdenlive contributors                           *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "folderindex.hpp"
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QVector>
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace {
+struct IndexedFile
+{
+    QString path;
+    QString name;
+    qint64 size;
+};
+using IndexedFiles = QVector<IndexedFile>;
+
+QStringList sorted(QStringList paths)
+{
+    std::sort(paths.begin(), paths.end(), [](const QString &a, const QString &b) {
+        const int depthA = a.count(QLatin1Char('/'));
+        const int depthB = b.count(QLatin1Char('/'));
+        return depthA != depthB ? depthA < depthB : a < b;
+    });
+    return paths;
+}
+} // namespace
+
+FolderIndex::FolderIndex(const QString &root)
+    : m_root(QDir(root).absolutePath())
+{
+}
+
+bool FolderIndex::build(const std::atomic<bool> &cancel, const std::function<void(int, int)> &progress)
+{
+    m_names.clear();
+    m_sizes.clear();
+    const QDir dir(m_root);
+    IndexedFiles topFiles;
+    for (const QFileInfo &info : dir.entryInfoList(QDir::Files | QDir::Readable)) {
+        topFiles.append({info.absoluteFilePath(), info.fileName(), info.size()});
+    }
+    QStringList roots;
+    for (const QString &sub : dir.entryList(QDir::Dirs | QDir::Readable | QDir::Executable | QDir::NoDotAndDotDot | QDir::NoSymLinks)) {
+        roots << dir.absoluteFilePath(sub);
+    }
+    const int total = roots.size();
+    std::atomic<int> done(0);
+    if (progress) {
+        progress(0, total);
+    }
+    // Each subfolder is walked by its own thread, which mostly helps on network storage where each listing waits for the server
+    QList<IndexedFiles> lists = QtConcurrent::blockingMapped<QList<IndexedFiles>>(roots, [&cancel, &progress, &done, total](const QString &root) {
+        IndexedFiles files;
+        QDirIterator it(root, QDir::Files | QDir::Readable, QDirIterator::Subdirectories);
+        while (it.hasNext() && !cancel) {
+            it.next();
+            const QFileInfo info = it.fileInfo();
+            files.append({info.absoluteFilePath(), info.fileName(), info.size()});
+        }
+        if (progress) {
+            progress(++done, total);
+        }
+        return files;
+    });
+    if (cancel) {
+        return false;
+    }
+    lists.prepend(topFiles);
+    for (const IndexedFiles &files : lists) {
+        for (const IndexedFile &file : files) {
+            m_names.insert(file.name, file.path);
+            m_sizes.insert(file.size, file.path);
+        }
+    }
+    return true;
+}
+
+QStringList FolderIndex::byName(const QString &fileName) const
+{
+    return sorted(m_names.values(fileName));
+}
+
+QStringList FolderIndex::bySize(qint64 size) const
+{
+    return sorted(m_sizes.values(size));
+}
+
+QStringList FolderIndex::byPrefix(const QString &prefix) const
+{
+    QStringList paths;
+    for (auto it = m_names.constBegin(); it != m_names.constEnd(); ++it) {
+        if (it.key().startsWith(prefix)) {
+            paths << it.value();
+        }
+    }
+    return sorted(paths);
+}
+
+int FolderIndex::count() const
+{
+    return m_sizes.size();
+}
+
+const QString &FolderIndex::root() const
+{
+    return m_root;
+}
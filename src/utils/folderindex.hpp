@@ -0,0 +1,64 @@
+/***************************************************************************
+ *   Copyright (C) 2019 by Kdenlive contributors                           *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#pragma once
+
+#include "definitions.h"
+#include <QMultiHash>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <functional>
+
+/** @brief This class lists all the files found below a folder, by name and by size.
+    It is used to relocate many missing clips at once: the folder is walked a single time, in parallel over its subfolders,
+    and each clip is then looked for in the index instead of walking the folder again.
+    The results of the queries are sorted with the files closest to the root first, then alphabetically.
+ */
+class FolderIndex
+{
+
+public:
+    explicit FolderIndex(const QString &root);
+
+    /* @brief Lists the files below the root folder, symbolic links to folders are not followed.
+       This is meant to run in a worker thread. Returns false if the walk was cancelled, in which case the index is left empty.
+       @param cancel is checked for each file, the walk stops as soon as it is set
+       @param progress if set, is called with the number of subfolders walked and their total count, from the worker threads
+     */
+    bool build(const std::atomic<bool> &cancel, const std::function<void(int, int)> &progress = nullptr);
+
+    /* @brief Returns the paths of the files having the given name */
+    QStringList byName(const QString &fileName) const;
+    /* @brief Returns the paths of the files having the given size, in bytes */
+    QStringList bySize(qint64 size) const;
+    /* @brief Returns the paths of the files whose name starts with the given prefix */
+    QStringList byPrefix(const QString &prefix) const;
+
+    /* @brief Returns the number of files in the index */
+    int count() const;
+    const QString &root() const;
+
+protected:
+    QString m_root;
+    QMultiHash<QString, QString> m_names;
+    QMultiHash<qint64, QString> m_sizes;
+};
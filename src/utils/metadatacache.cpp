@@ -0,0 +1,122 @@
+/***************************************************************************
+ *   Copyright (C) 2019 by Kdenlive contributors                           *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "metadatacache.hpp"
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <framework/mlt_version.h>
+
+namespace {
+const quint32 cacheMagic = 0x4b4d4443; // KMDC
+// Increase when the layout of the file or of any payload changes
+const quint32 cacheVersion = 1;
+
+void addFileIdentity(QCryptographicHash &hash, const QFileInfo &info)
+{
+    hash.addData(info.absoluteFilePath().toUtf8());
+    hash.addData(QByteArray::number(info.size()));
+    hash.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+}
+} // namespace
+
+MetadataCache::MetadataCache(const QString &cacheFile)
+    : m_cacheFile(cacheFile)
+{
+}
+
+// static
+QString MetadataCache::location(const QString &name)
+{
+    QDir folder(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+    return folder.absoluteFilePath(name);
+}
+
+// static
+QByteArray MetadataCache::signature(const QStringList &folders, const QStringList &keys)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray::number(cacheVersion));
+    hash.addData(mlt_version_get_string());
+    hash.addData(QCoreApplication::applicationVersion().toUtf8());
+    // The parsing code and the bundled lists may change between two builds of the same version
+    addFileIdentity(hash, QFileInfo(QCoreApplication::applicationFilePath()));
+    for (const QString &key : keys) {
+        hash.addData(key.toUtf8());
+        hash.addData("\n", 1);
+    }
+    for (const QString &folder : folders) {
+        QFileInfo info(folder);
+        addFileIdentity(hash, info);
+        if (!info.isDir()) {
+            continue;
+        }
+        // The folder date only changes when files are added or removed, so the files are listed too
+        const QFileInfoList files = QDir(folder).entryInfoList(QDir::Files, QDir::Name);
+        for (const QFileInfo &file : files) {
+            addFileIdentity(hash, file);
+        }
+    }
+    return hash.result();
+}
+
+bool MetadataCache::read(const QByteArray &signature, QByteArray &payload) const
+{
+    QFile file(m_cacheFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    quint32 magic = 0;
+    quint32 version = 0;
+    QByteArray fileSignature;
+    stream >> magic >> version;
+    if (magic != cacheMagic || version != cacheVersion) {
+        qDebug() << "// Ignoring invalid metadata cache" << m_cacheFile;
+        return false;
+    }
+    stream >> fileSignature;
+    if (fileSignature != signature) {
+        return false;
+    }
+    stream >> payload;
+    return stream.status() == QDataStream::Ok;
+}
+
+bool MetadataCache::write(const QByteArray &signature, const QByteArray &payload) const
+{
+    QDir().mkpath(QFileInfo(m_cacheFile).absolutePath());
+    QSaveFile file(m_cacheFile);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "// Cannot write metadata cache" << m_cacheFile;
+        return false;
+    }
+    QDataStream stream(&file);
+    stream << cacheMagic << cacheVersion << signature << payload;
+    return stream.status() == QDataStream::Ok && file.commit();
+}
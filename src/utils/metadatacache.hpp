@@ -0,0 +1,57 @@
+/***************************************************************************
+ *   Copyright (C) 2019 by Kdenlive contributors                           *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+/** @brief This class stores the data that is slow to build at startup, like the parsed descriptions of the effects and profiles, in a file.
+    The file starts with a signature of everything the data was built from: the cache format, the MLT and Kdenlive versions, and the
+    content listing (names, sizes and modification times) of the source folders. The data is only used while the signature matches,
+    otherwise the caller parses its sources again and writes a new cache.
+ */
+class MetadataCache
+{
+
+public:
+    /* @brief Uses the given cache file, which is only accessed on read() and write() */
+    explicit MetadataCache(const QString &cacheFile);
+
+    /* @brief Returns the path of the cache file with the given name in the user cache folder */
+    static QString location(const QString &name);
+
+    /* @brief Computes the signature of data built from the given folders
+       @param folders the folders whose files were parsed, a change in their content invalidates the cache
+       @param keys additional values the data depends on
+     */
+    static QByteArray signature(const QStringList &folders, const QStringList &keys = QStringList());
+
+    /* @brief Reads the cached data. Returns false if the file is missing, invalid or has another signature */
+    bool read(const QByteArray &signature, QByteArray &payload) const;
+
+    /* @brief Replaces the cache file. Returns false if it could not be written */
+    bool write(const QByteArray &signature, const QByteArray &payload) const;
+
+protected:
+    QString m_cacheFile;
+};
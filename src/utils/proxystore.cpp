@@ -0,0 +1,274 @@
+/***************************************************************************
+ *   Copyright (C) 2019 by Kdenlive contributors                           *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "proxystore.hpp"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLockFile>
+#include <QSaveFile>
+#include <QtConcurrent>
+#include <memory>
+
+namespace {
+const int indexVersion = 1;
+// Creating a proxy takes a while, but updating the index is quick: a stale lock is one left by a crashed instance
+const int staleLockTime = 30000;
+const int lockTimeout = 5000;
+} // namespace
+
+ProxyStore::ProxyStore(const QDir &folder, qint64 maxSize, LockMode lockMode)
+    : m_folder(folder)
+    , m_maxSize(maxSize)
+    , m_lockMode(lockMode)
+{
+}
+
+std::unique_ptr<QLockFile> ProxyStore::lockIndex() const
+{
+    std::unique_ptr<QLockFile> lock(new QLockFile(m_folder.absoluteFilePath(QStringLiteral("proxies.lock"))));
+    lock->setStaleLockTime(staleLockTime);
+    if (!lock->tryLock(m_lockMode == LockMode::Wait ? lockTimeout : 0)) {
+        qDebug() << "// Cannot lock proxy index in" << m_folder.absolutePath();
+        return nullptr;
+    }
+    return lock;
+}
+
+bool ProxyStore::defer(const std::function<void(ProxyStore &)> &operation) const
+{
+    if (m_lockMode != LockMode::NoWait) {
+        return false;
+    }
+    const QDir folder = m_folder;
+    const qint64 maxSize = m_maxSize;
+    QtConcurrent::run([folder, maxSize, operation]() {
+        ProxyStore store(folder, maxSize, LockMode::Wait);
+        operation(store);
+    });
+    return true;
+}
+
+// static
+QString ProxyStore::proxyName(const QString &clipHash, const QString &parameters, const QString &extension)
+{
+    const QByteArray paramHash = QCryptographicHash::hash(parameters.simplified().toUtf8(), QCryptographicHash::Md5).toHex().left(8);
+    return clipHash + QLatin1Char('-') + QString::fromLatin1(paramHash) + extension;
+}
+
+bool ProxyStore::contains(const QString &path) const
+{
+    return QFileInfo(path).absolutePath() == m_folder.absolutePath();
+}
+
+ProxyStore::Index ProxyStore::load() const
+{
+    Index index;
+    QFile file(m_folder.absoluteFilePath(QStringLiteral("proxies.index")));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return index;
+    }
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root.value(QStringLiteral("version")).toInt() != indexVersion) {
+        return index;
+    }
+    const QJsonObject proxies = root.value(QStringLiteral("proxies")).toObject();
+    for (auto it = proxies.constBegin(); it != proxies.constEnd(); ++it) {
+        QFileInfo info(m_folder.absoluteFilePath(it.key()));
+        if (!info.exists()) {
+            continue;
+        }
+        const QJsonObject values = it.value().toObject();
+        Entry &entry = index[it.key()];
+        entry.size = info.size();
+        entry.lastUse = (qint64)values.value(QStringLiteral("lastuse")).toDouble();
+        for (const QJsonValue &document : values.value(QStringLiteral("documents")).toArray()) {
+            entry.documents << document.toString();
+        }
+    }
+    return index;
+}
+
+bool ProxyStore::save(const Index &index) const
+{
+    QJsonObject proxies;
+    for (const auto &proxy : index) {
+        QJsonObject values;
+        values.insert(QStringLiteral("lastuse"), (double)proxy.second.lastUse);
+        values.insert(QStringLiteral("documents"), QJsonArray::fromStringList(proxy.second.documents));
+        proxies.insert(proxy.first, values);
+    }
+    QJsonObject root;
+    root.insert(QStringLiteral("version"), indexVersion);
+    root.insert(QStringLiteral("proxies"), proxies);
+    QSaveFile file(m_folder.absoluteFilePath(QStringLiteral("proxies.index")));
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
+
+void ProxyStore::evict(Index &index) const
+{
+    // The proxies used by a document are never evicted, so they don't count in the limit
+    qint64 total = 0;
+    for (const auto &proxy : index) {
+        if (proxy.second.documents.isEmpty()) {
+            total += proxy.second.size;
+        }
+    }
+    while (total > m_maxSize) {
+        auto oldest = index.end();
+        for (auto it = index.begin(); it != index.end(); ++it) {
+            if (it->second.documents.isEmpty() && (oldest == index.end() || it->second.lastUse < oldest->second.lastUse)) {
+                oldest = it;
+            }
+        }
+        if (oldest == index.end()) {
+            // All the proxies are still used
+            break;
+        }
+        qDebug() << "// Dropping unused proxy" << oldest->first;
+        m_folder.remove(oldest->first);
+        total -= oldest->second.size;
+        index.erase(oldest);
+    }
+}
+
+bool ProxyStore::addReference(const QString &path, const QString &documentId)
+{
+    if (!contains(path)) {
+        return false;
+    }
+    auto lock = lockIndex();
+    if (!lock) {
+        return defer([path, documentId](ProxyStore &store) { store.addReference(path, documentId); });
+    }
+    Index index = load();
+    const QString name = QFileInfo(path).fileName();
+    QFileInfo info(m_folder.absoluteFilePath(name));
+    if (!info.exists()) {
+        return false;
+    }
+    Entry &entry = index[name];
+    entry.size = info.size();
+    entry.lastUse = QDateTime::currentMSecsSinceEpoch();
+    if (!entry.documents.contains(documentId)) {
+        entry.documents << documentId;
+    }
+    evict(index);
+    return save(index);
+}
+
+int ProxyStore::removeReference(const QString &path, const QString &documentId)
+{
+    if (!contains(path)) {
+        return 0;
+    }
+    auto lock = lockIndex();
+    if (!lock) {
+        // The number of documents using the proxy is unknown, so that it is not deleted
+        defer([path, documentId](ProxyStore &store) { store.removeReference(path, documentId); });
+        return -1;
+    }
+    Index index = load();
+    auto it = index.find(QFileInfo(path).fileName());
+    if (it == index.end()) {
+        // Another instance may use it without having indexed it
+        return -1;
+    }
+    it->second.documents.removeAll(documentId);
+    it->second.lastUse = QDateTime::currentMSecsSinceEpoch();
+    const int remaining = it->second.documents.size();
+    evict(index);
+    save(index);
+    return remaining;
+}
+
+bool ProxyStore::setReferences(const QString &documentId, const QStringList &paths)
+{
+    auto lock = lockIndex();
+    if (!lock) {
+        return defer([documentId, paths](ProxyStore &store) { store.setReferences(documentId, paths); });
+    }
+    Index index = load();
+    QStringList names;
+    for (const QString &path : paths) {
+        if (contains(path)) {
+            names << QFileInfo(path).fileName();
+        }
+    }
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (auto &proxy : index) {
+        if (proxy.second.documents.removeAll(documentId) > 0) {
+            proxy.second.lastUse = now;
+        }
+    }
+    for (const QString &name : names) {
+        QFileInfo info(m_folder.absoluteFilePath(name));
+        if (!info.exists()) {
+            continue;
+        }
+        Entry &entry = index[name];
+        entry.size = info.size();
+        entry.lastUse = now;
+        entry.documents << documentId;
+    }
+    evict(index);
+    return save(index);
+}
+
+QStringList ProxyStore::references(const QString &path) const
+{
+    if (!contains(path)) {
+        return QStringList();
+    }
+    const Index index = load();
+    auto it = index.find(QFileInfo(path).fileName());
+    return it == index.end() ? QStringList() : it->second.documents;
+}
+
+QStringList ProxyStore::sharedProxies(const QString &documentId) const
+{
+    QStringList shared;
+    const Index index = load();
+    for (const auto &proxy : index) {
+        if (proxy.second.documents.size() > 1 && proxy.second.documents.contains(documentId)) {
+            shared << proxy.first;
+        }
+    }
+    return shared;
+}
+
+qint64 ProxyStore::size() const
+{
+    qint64 total = 0;
+    const Index index = load();
+    for (const auto &proxy : index) {
+        total += proxy.second.size;
+    }
+    return total;
+}
@@ -0,0 +1,100 @@
+/***************************************************************************
+ *   Copyright (C) 2019 by Kdenlive contributors                           *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#pragma once
+
+#include "definitions.h"
+#include <QDir>
+#include <QStringList>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
+class QLockFile;
+
+/** @brief This class keeps track of the proxy clips stored in a cache folder shared by several projects.
+    A proxy file is named after the hash of its source clip and of the parameters used to create it, so that all the projects using
+    the same clip with the same proxy settings share a single file.
+    The index (proxies.index) records for each proxy its size, last use and the ids of the documents referencing it.
+    When the size of the proxies that no document references anymore exceeds the limit, the least recently used of them are deleted.
+    Several Kdenlive instances can use the same folder: each operation locks the index, reads it, and writes it back.
+ */
+class ProxyStore
+{
+
+public:
+    /* @brief How the operations get the index lock when another instance holds it.
+       With NoWait, meant for the GUI thread, an operation that cannot lock the index at once is run again in a worker thread, waiting for the lock.
+     */
+    enum class LockMode { Wait, NoWait };
+
+    /* @brief Opens the store living in the given folder
+       @param maxSize is the maximum size of the unreferenced proxies, in bytes
+     */
+    ProxyStore(const QDir &folder, qint64 maxSize, LockMode lockMode = LockMode::Wait);
+
+    /* @brief Returns the file name of the proxy of a clip, built from the clip hash and the proxy parameters */
+    static QString proxyName(const QString &clipHash, const QString &parameters, const QString &extension);
+
+    /* @brief Returns true if the given proxy path is a file of this store */
+    bool contains(const QString &path) const;
+
+    /* @brief Registers a proxy as used by a document, then deletes unreferenced proxies if the store is too big. Returns false on error.
+       Returns true if the operation was moved to a worker thread */
+    bool addReference(const QString &path, const QString &documentId);
+    /* @brief Unregisters a proxy used by a document, then deletes unreferenced proxies if the store is too big.
+       Returns the number of documents still using it, 0 if the proxy is not in this store,
+       or -1 if it is unknown: the proxy is not indexed, or the operation failed or was moved to a worker thread */
+    int removeReference(const QString &path, const QString &documentId);
+    /* @brief Replaces the list of proxies used by a document. Returns false on error, true if the operation was moved to a worker thread */
+    bool setReferences(const QString &documentId, const QStringList &paths);
+
+    /* @brief Returns the ids of the documents using a proxy */
+    QStringList references(const QString &path) const;
+    /* @brief Returns the file names of the proxies used by a document that other documents also use */
+    QStringList sharedProxies(const QString &documentId) const;
+    /* @brief Returns the total size of the indexed proxies, in bytes */
+    qint64 size() const;
+
+protected:
+    struct Entry
+    {
+        qint64 size{0};
+        qint64 lastUse{0};
+        QStringList documents;
+    };
+    using Index = std::unordered_map<QString, Entry>;
+
+    /* @brief Reads the index, dropping the proxies whose file was deleted */
+    Index load() const;
+    /* @brief Writes the index */
+    bool save(const Index &index) const;
+    /* @brief Deletes the least recently used unreferenced proxies until their size fits */
+    void evict(Index &index) const;
+    /* @brief Locks the index, waiting for another instance according to the lock mode. Returns nullptr on failure */
+    std::unique_ptr<QLockFile> lockIndex() const;
+    /* @brief With LockMode::NoWait, runs the operation in a worker thread on a store waiting for the lock and returns true. Returns false otherwise */
+    bool defer(const std::function<void(ProxyStore &)> &operation) const;
+
+    QDir m_folder;
+    qint64 m_maxSize;
+    LockMode m_lockMode;
+};
@@ -0,0 +1,176 @@
+/***************************************************************************
+ *   Copyright (C) 2019 by Kdenlive contributors                           *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "renderscheduler.hpp"
+#include <QDomDocument>
+#include <QFile>
+#include <QThread>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+// Encoders using their automatic thread count rarely keep more cores busy
+const int maxAutomaticThreads = 8;
+
+// Parameters that do not change the encoded video stream
+bool isVideoParam(const QString &key)
+{
+    static const QStringList ignored{QStringLiteral("mlt_service"), QStringLiteral("target"), QStringLiteral("in"), QStringLiteral("out"),
+                                     QStringLiteral("f"), QStringLiteral("threads"), QStringLiteral("real_time"), QStringLiteral("an"),
+                                     QStringLiteral("acodec"), QStringLiteral("ab"), QStringLiteral("aq"), QStringLiteral("ar"),
+                                     QStringLiteral("ac"), QStringLiteral("channels"), QStringLiteral("frequency")};
+    // glsl. only marks a render using Movit, meta. are the container metadata
+    return !ignored.contains(key) && !key.startsWith(QLatin1String("glsl.")) && !key.startsWith(QLatin1String("meta."));
+}
+} // namespace
+
+RenderScheduler::RenderScheduler(int cores)
+    : m_cores(cores > 0 ? cores : qMax(1, QThread::idealThreadCount()))
+{
+}
+
+int RenderScheduler::cores() const
+{
+    return m_cores;
+}
+
+int RenderScheduler::cost(int encoderThreads, int renderThreads) const
+{
+    int encoder = encoderThreads > 0 ? encoderThreads : qMin(m_cores, maxAutomaticThreads);
+    // The MLT workers produce frames while the encoder compresses the previous ones
+    return qBound(1, encoder + qMax(1, qAbs(renderThreads)), m_cores);
+}
+
+int RenderScheduler::playlistCost(const QString &playlist) const
+{
+    QFile file(playlist);
+    QDomDocument doc;
+    if (!file.open(QIODevice::ReadOnly) || !doc.setContent(&file)) {
+        return cost(0, 1);
+    }
+    const QDomElement consumer = doc.elementsByTagName(QStringLiteral("consumer")).item(0).toElement();
+    return cost(consumer.attribute(QStringLiteral("threads")).toInt(), consumer.attribute(QStringLiteral("real_time"), QStringLiteral("1")).toInt());
+}
+
+std::vector<int> RenderScheduler::jobsToStart(const std::vector<Job> &jobs) const
+{
+    int used = 0;
+    int running = 0;
+    for (const Job &job : jobs) {
+        if (job.state == Running) {
+            used += job.cost;
+            running++;
+        }
+    }
+    std::vector<int> start;
+    for (int i = 0; i < (int)jobs.size(); ++i) {
+        const Job &job = jobs[(size_t)i];
+        if (job.state != Waiting) {
+            continue;
+        }
+        if (job.after >= 0 && job.after < (int)jobs.size() && jobs[(size_t)job.after].state != Done) {
+            // The first pass is not over, later jobs can still be started
+            continue;
+        }
+        // Jobs are started in order: if this one does not fit, the next ones wait as well
+        if (running > 0 && used + job.cost > m_cores) {
+            break;
+        }
+        start.push_back(i);
+        used += job.cost;
+        running++;
+    }
+    return start;
+}
+
+int RenderScheduler::segmentWorkers(int jobCost) const
+{
+    return qMax(1, m_cores / qMax(1, jobCost));
+}
+
+std::vector<int> RenderScheduler::segmentBoundaries(int in, int out, const std::vector<int> &guides, int gop, int count, int minLength)
+{
+    std::vector<int> starts{in};
+    const int length = out - in + 1;
+    count = qBound(1, count, qMax(1, length / qMax(1, minLength)));
+    const int tolerance = length / count / 4;
+    for (int k = 1; k < count; ++k) {
+        const int ideal = in + (int)((qint64)length * k / count);
+        int cut = ideal;
+        auto closest = std::min_element(guides.begin(), guides.end(), [ideal](int a, int b) { return std::abs(a - ideal) < std::abs(b - ideal); });
+        if (closest != guides.end() && std::abs(*closest - ideal) <= tolerance) {
+            cut = *closest;
+        } else if (gop > 1) {
+            cut = in + (int)std::lround((double)(ideal - in) / gop) * gop;
+        }
+        if (cut - starts.back() >= minLength && out + 1 - cut >= minLength) {
+            starts.push_back(cut);
+        }
+    }
+    return starts;
+}
+
+std::vector<RenderScheduler::Segment> RenderScheduler::smartSegments(int in, int out, std::vector<int> chunks, int chunkSize, int maxLength)
+{
+    std::vector<Segment> segments;
+    auto addFresh = [&segments, chunkSize, maxLength](int first, int last) {
+        const int length = last - first + 1;
+        if (length <= 0) {
+            return;
+        }
+        const int count = (length + qMax(1, maxLength) - 1) / qMax(1, maxLength);
+        for (int start : segmentBoundaries(first, last, {}, 0, count, qMax(1, chunkSize))) {
+            segments.push_back(Segment{start, false});
+        }
+    };
+    std::sort(chunks.begin(), chunks.end());
+    int pos = in;
+    for (int chunk : chunks) {
+        if (chunk < pos || chunk + chunkSize - 1 > out) {
+            // Outside of the range, or overlapping the previous chunk
+            continue;
+        }
+        addFresh(pos, chunk - 1);
+        segments.push_back(Segment{chunk, true});
+        pos = chunk + chunkSize;
+    }
+    addFresh(pos, out);
+    return segments;
+}
+
+bool RenderScheduler::sameVideoEncoding(const QStringList &previewParams, const QMap<QString, QString> &renderParams)
+{
+    QMap<QString, QString> preview;
+    for (const QString &param : previewParams) {
+        const QString key = param.section(QLatin1Char('='), 0, 0);
+        if (param.contains(QLatin1Char('=')) && isVideoParam(key)) {
+            preview.insert(key, param.section(QLatin1Char('='), 1));
+        }
+    }
+    QMap<QString, QString> render;
+    for (auto it = renderParams.constBegin(); it != renderParams.constEnd(); ++it) {
+        if (isVideoParam(it.key())) {
+            render.insert(it.key(), it.value());
+        }
+    }
+    return !preview.isEmpty() && preview == render;
+}
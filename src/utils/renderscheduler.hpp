@@ -0,0 +1,97 @@
+/***************************************************************************
+ *   Copyright (C) 2019 by Kdenlive contributors                           *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#pragma once
+
+#include <QMap>
+#include <QStringList>
+#include <vector>
+
+/** @brief This class decides which render jobs of the queue can run at the same time.
+    Each job is given a cost, the number of cores it keeps busy, derived from its encoder threads and parallel processing workers.
+    Waiting jobs are started in queue order as long as the total cost of the running jobs fits in the available cores,
+    one job always being allowed to run. The second pass of a 2-pass encoding only starts once its first pass is over.
+    It also plans the segments of segmented and smart renders.
+ */
+class RenderScheduler
+{
+
+public:
+    enum JobState { Waiting, Running, Done };
+    struct Job
+    {
+        JobState state;
+        /* Number of cores used by the job, see cost() */
+        int cost;
+        /* Index of the job that must be done before this one may start (the first pass of a 2-pass encoding), -1 if none */
+        int after;
+    };
+    struct Segment
+    {
+        int start;
+        /* The segment is a timeline preview chunk */
+        bool cached;
+    };
+
+    /* @param cores is the number of cores available to the render jobs, the ideal thread count if not set */
+    explicit RenderScheduler(int cores = 0);
+
+    /* @brief Returns the number of cores a job keeps busy.
+       @param encoderThreads is the threads parameter of the job, 0 for automatic which is taken as at most 8 threads, since encoders scale poorly past this
+       @param renderThreads is the number of MLT parallel processing workers (absolute value of real_time)
+     */
+    int cost(int encoderThreads, int renderThreads) const;
+
+    /* @brief Reads the threads and real_time parameters of the consumer of a render playlist and returns the job cost */
+    int playlistCost(const QString &playlist) const;
+
+    /* @brief Returns the indexes of the waiting jobs to start now, in queue order */
+    std::vector<int> jobsToStart(const std::vector<Job> &jobs) const;
+
+    /* @brief Returns the number of segments of a segmented render that can be rendered at the same time, each one by a job of the given cost */
+    int segmentWorkers(int jobCost) const;
+
+    /* @brief Splits the frames from in to out (included) in about count segments, and returns the first frame of each segment.
+       A cut is moved to the closest guide if one lies within a quarter of the segment length, else it is aligned on a multiple of gop frames
+       from in, so that the keyframe interval is kept. Segments are at least minLength frames long (except when the range is shorter).
+     */
+    static std::vector<int> segmentBoundaries(int in, int out, const std::vector<int> &guides, int gop, int count, int minLength = 250);
+
+    /* @brief Splits the frames from in to out (included) for a smart render, and returns the segments in order.
+       Each timeline preview chunk lying entirely in the range is a cached segment, the frames between them are split
+       in fresh segments of at most maxLength frames (and at least chunkSize frames when possible).
+       @param chunks is the first frame of the rendered chunks, in any order
+       @param chunkSize is the length of a chunk, in frames
+     */
+    static std::vector<Segment> smartSegments(int in, int out, std::vector<int> chunks, int chunkSize, int maxLength);
+
+    /* @brief Returns true if the timeline preview chunks can be joined with the rendered video without re-encoding, ie.
+       if the preview and render parameters only differ by their audio, container and threading settings.
+       @param previewParams is the list of key=value parameters of the preview
+       @param renderParams is the attributes of the render consumer
+     */
+    static bool sameVideoEncoding(const QStringList &previewParams, const QMap<QString, QString> &renderParams);
+
+    int cores() const;
+
+protected:
+    int m_cores;
+};
@@ -24,6 +24,8 @@
 #include "bin/projectitemmodel.h"
 #include "core.h"
 #include "doc/kdenlivedoc.h"
+#include "kdenlivesettings.h"
+#include "thumbnailstore.hpp"
 #include <QDir>
 #include <QMutexLocker>
 #include <list>
@@ -90,10 +92,16 @@ protected:
 };
 
 ThumbnailCache::ThumbnailCache()
-    : m_volatileCache(new Cache_t(10000000))
+    : m_volatileCache(new Cache_t(volatileCacheSize()))
 {
 }
 
+// static
+int ThumbnailCache::volatileCacheSize()
+{
+    return 10000000;
+}
+
 std::unique_ptr<ThumbnailCache> &ThumbnailCache::get()
 {
     std::call_once(m_onceFlag, [] { instance.reset(new ThumbnailCache()); });
@@ -104,51 +112,54 @@ bool ThumbnailCache::hasThumbnail(const QString &binId, int pos, bool volatileOn
 {
     QMutexLocker locker(&m_mutex);
     bool ok = false;
-    auto key = getKey(binId, pos, &ok);
-    if (ok && m_volatileCache->contains(key)) {
+    const QString hash = getHash(binId, &ok);
+    if (!ok) {
+        return false;
+    }
+    if (m_volatileCache->contains(getKey(hash, pos))) {
         return true;
     }
-    if (!ok || volatileOnly) {
+    if (volatileOnly) {
         return false;
     }
-    QDir thumbFolder = getDir(&ok);
-    return ok && thumbFolder.exists(key);
+    ThumbnailStore *store = getStore();
+    return store != nullptr && store->contains(hash, pos);
 }
 
 QImage ThumbnailCache::getThumbnail(const QString &binId, int pos, bool volatileOnly) const
 {
     QMutexLocker locker(&m_mutex);
     bool ok = false;
-    auto key = getKey(binId, pos, &ok);
-    if (ok && m_volatileCache->contains(key)) {
+    const QString hash = getHash(binId, &ok);
+    if (!ok) {
+        return QImage();
+    }
+    const QString key = getKey(hash, pos);
+    if (m_volatileCache->contains(key)) {
         return m_volatileCache->get(key);
     }
-    if (!ok || volatileOnly) {
+    if (volatileOnly) {
         return QImage();
     }
-    QDir thumbFolder = getDir(&ok);
-    if (ok && thumbFolder.exists(key)) {
-        m_storedOnDisk[binId].push_back(pos);
-        return QImage(thumbFolder.absoluteFilePath(key));
-    }
-    return QImage();
+    ThumbnailStore *store = getStore();
+    return store != nullptr ? store->get(hash, pos) : QImage();
 }
 
 void ThumbnailCache::storeThumbnail(const QString &binId, int pos, const QImage &img, bool persistent)
 {
     QMutexLocker locker(&m_mutex);
     bool ok = false;
-    const QString key = getKey(binId, pos, &ok);
+    const QString hash = getHash(binId, &ok);
     if (!ok) {
         return;
     }
+    const QString key = getKey(hash, pos);
     if (persistent) {
-        QDir thumbFolder = getDir(&ok);
-        if (ok) {
-            if (!img.save(thumbFolder.absoluteFilePath(key))) {
-                qDebug() << ".............\nAAAAAAAAAAAARGH ERROR SAVING THUMB";
+        ThumbnailStore *store = getStore();
+        if (store != nullptr) {
+            if (!store->store(hash, pos, img)) {
+                qDebug() << "// Error writing thumbnail to " << store->folder().absolutePath();
             }
-            m_storedOnDisk[binId].push_back(pos);
             // if volatile cache also contains this entry, update it
             if (m_volatileCache->contains(key)) {
                 m_volatileCache->remove(key);
@@ -165,16 +176,20 @@ void ThumbnailCache::storeThumbnail(const QString &binId, int pos, const QImage
 
 void ThumbnailCache::saveCachedThumbs(QStringList keys)
 {
-    bool ok;
-    QDir thumbFolder = getDir(&ok);
-    if (!ok) {
+    QMutexLocker locker(&m_mutex);
+    ThumbnailStore *store = getStore();
+    if (store == nullptr) {
         return;
     }
     for (const QString &key : keys) {
-        if (!thumbFolder.exists(key) && m_volatileCache->contains(key)) {
+        // keys are built by getKey: hash#pos.png
+        const QString hash = key.section(QLatin1Char('#'), 0, 0);
+        bool ok = false;
+        int pos = key.section(QLatin1Char('#'), 1).section(QLatin1Char('.'), 0, 0).toInt(&ok);
+        if (ok && !store->contains(hash, pos) && m_volatileCache->contains(key)) {
             QImage img = m_volatileCache->get(key);
-            if (!img.save(thumbFolder.absoluteFilePath(key))) {
-                qDebug() << "// Error writing thumbnails to " << thumbFolder.absolutePath();
+            if (!store->store(hash, pos, img)) {
+                qDebug() << "// Error writing thumbnails to " << store->folder().absolutePath();
                 break;
             }
         }
@@ -184,36 +199,55 @@ void ThumbnailCache::saveCachedThumbs(QStringList keys)
 void ThumbnailCache::invalidateThumbsForClip(const QString &binId)
 {
     QMutexLocker locker(&m_mutex);
+    bool ok = false;
+    const QString hash = getHash(binId, &ok);
+    if (!ok) {
+        return;
+    }
     if (m_storedVolatile.find(binId) != m_storedVolatile.end()) {
-        bool ok = false;
         for (int pos : m_storedVolatile.at(binId)) {
-            auto key = getKey(binId, pos, &ok);
-            if (ok) {
-                m_volatileCache->remove(key);
-            }
+            m_volatileCache->remove(getKey(hash, pos));
         }
         m_storedVolatile.erase(binId);
     }
-    bool ok = false;
-    QDir thumbFolder = getDir(&ok);
-    if (ok && m_storedOnDisk.find(binId) != m_storedOnDisk.end()) {
-        // Remove persistent cache
-        for (int pos : m_storedOnDisk.at(binId)) {
-            auto key = getKey(binId, pos, &ok);
-            if (ok) {
-                QFile::remove(thumbFolder.absoluteFilePath(key));
-            }
+    // Remove persistent cache
+    ThumbnailStore *store = getStore();
+    if (store != nullptr) {
+        store->remove(hash);
+    }
+}
+
+void ThumbnailCache::resetPersistentStore()
+{
+    QMutexLocker locker(&m_mutex);
+    m_store.reset();
+}
+
+ThumbnailStore *ThumbnailCache::getStore() const
+{
+    if (!m_store) {
+        bool ok = false;
+        QDir thumbFolder = getDir(&ok);
+        if (!ok) {
+            return nullptr;
         }
-        m_storedOnDisk.erase(binId);
+        m_store.reset(new ThumbnailStore(thumbFolder, qint64(KdenliveSettings::thumbnailcachesize()) * 1024 * 1024));
     }
+    return m_store.get();
 }
 
 // static
-QString ThumbnailCache::getKey(const QString &binId, int pos, bool *ok)
+QString ThumbnailCache::getHash(const QString &binId, bool *ok)
 {
     auto binClip = pCore->projectItemModel()->getClipByBinID(binId);
     *ok = binClip != nullptr;
-    return *ok ? binClip->hash() + QLatin1Char('#') + QString::number(pos) + QStringLiteral(".png") : QString();
+    return *ok ? binClip->hash() : QString();
+}
+
+// static
+QString ThumbnailCache::getKey(const QString &hash, int pos)
+{
+    return hash + QLatin1Char('#') + QString::number(pos) + QStringLiteral(".png");
 }
 
 // static
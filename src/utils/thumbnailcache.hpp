@@ -30,8 +30,11 @@
 #include <unordered_map>
 #include <vector>
 
+class ThumbnailStore;
+
 /** @brief This class class is an interface to the caches that store thumbnails.
     In Kdenlive, we use two such caches, a persistent that is stored on disk to allow thumbnails to be reused when reopening.
+    The persistent cache packs the thumbnails of each clip in a single file, see ThumbnailStore.
     The other one is a volatile LRU cache that lives in memory.
     Note that for the volatile cache uses a custom implementation.
     QCache is not suitable since it operates on pointers and since the object is removed from the cache when accessed.
@@ -73,25 +76,37 @@ public:
     /* @brief Save all cached thumbs to disk */
     void saveCachedThumbs(QStringList keys);
 
+    /* @brief Close the persistent cache, it is reopened on next use. This must be called when the cache folder changes */
+    void resetPersistentStore();
+
+    /* @brief Returns the maximum size of the volatile cache, in bytes */
+    static int volatileCacheSize();
+
 protected:
     // Constructor is protected because class is a Singleton
     ThumbnailCache();
 
+    // Return the hash of a clip, used to identify its thumbnails
+    static QString getHash(const QString &binId, bool *ok);
+
     // Return the key associated to a thumbnail
-    static QString getKey(const QString &binId, int pos, bool *ok);
+    static QString getKey(const QString &hash, int pos);
 
     // Return the dir where the persistent cache lives
     static QDir getDir(bool *ok);
 
+    // Return the persistent cache, opening it if needed. Returns nullptr if the document has no cache folder
+    ThumbnailStore *getStore() const;
+
     static std::unique_ptr<ThumbnailCache> instance;
     static std::once_flag m_onceFlag; // flag to create the repository only once;
 
     class Cache_t;
     std::unique_ptr<Cache_t> m_volatileCache;
+    mutable std::unique_ptr<ThumbnailStore> m_store;
     mutable QMutex m_mutex;
 
-    // the following maps keeps track of the positions that we store for each clip in volatile caches.
+    // the following map keeps track of the positions that we store for each clip in the volatile cache.
     // Note that we don't track deletions due to items dropped from the cache. So the maps can contain more items that are currently stored.
     std::unordered_map<QString, std::vector<int>> m_storedVolatile;
-    mutable std::unordered_map<QString, std::vector<int>> m_storedOnDisk;
 };
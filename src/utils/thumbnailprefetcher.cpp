@@ -0,0 +1,208 @@
+/***************************************************************************
+ *   Copyright (C) 2019 by Kdenlive contributors                           *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "thumbnailprefetcher.hpp"
+#include "bin/projectclip.h"
+#include "bin/projectitemmodel.h"
+#include "core.h"
+#include "thumbnailcache.hpp"
+#include <QMutexLocker>
+#include <QScopedPointer>
+#include <cstring>
+#include <mlt++/MltFrame.h>
+#include <mlt++/MltProducer.h>
+#include <mlt++/MltProfile.h>
+
+std::unique_ptr<ThumbnailPrefetcher> ThumbnailPrefetcher::instance;
+std::once_flag ThumbnailPrefetcher::m_onceFlag;
+
+namespace {
+// Each producer keeps its decoder, so only a few of them are kept
+const size_t maxProducers = 8;
+// Prefetching is still worth it for a few frames when the thumbnails are large
+const int minPrefetchedFrames = 8;
+} // namespace
+
+ThumbnailPrefetcher::ThumbnailPrefetcher()
+{
+    // Leave most threads to the playback and to the thumbnails requested by the view
+    m_scheduler.setLimit(JobScheduler::Resource::CpuBound, 2);
+}
+
+ThumbnailPrefetcher::~ThumbnailPrefetcher()
+{
+    // Running tasks stop at the next frame
+    ++m_generation;
+}
+
+std::unique_ptr<ThumbnailPrefetcher> &ThumbnailPrefetcher::get()
+{
+    std::call_once(m_onceFlag, [] { instance.reset(new ThumbnailPrefetcher()); });
+    return instance;
+}
+
+QImage ThumbnailPrefetcher::getThumbnail(const QString &binId, int frame)
+{
+    QImage result = ThumbnailCache::get()->getThumbnail(binId, frame);
+    if (!result.isNull()) {
+        return result;
+    }
+    return decode(binId, frame);
+}
+
+void ThumbnailPrefetcher::prefetch(std::vector<Request> requests)
+{
+    int generation = ++m_generation;
+    m_scheduler.cancel(generation - 1);
+    int budget = maxPrefetchedFrames();
+    int priority = (int)requests.size();
+    for (Request &request : requests) {
+        if (budget <= 0) {
+            break;
+        }
+        if ((int)request.frames.size() > budget) {
+            request.frames.resize((size_t)budget);
+        }
+        budget -= (int)request.frames.size();
+        m_scheduler.submit(generation, JobScheduler::Resource::CpuBound, priority--, [this, generation, request]() {
+            for (int frame : request.frames) {
+                if (m_generation != generation) {
+                    // The view moved, a new prefetch replaces this one
+                    return;
+                }
+                if (!ThumbnailCache::get()->hasThumbnail(request.binId, frame)) {
+                    decode(request.binId, frame);
+                }
+            }
+        });
+    }
+}
+
+void ThumbnailPrefetcher::reset()
+{
+    int generation = ++m_generation;
+    m_scheduler.cancel(generation - 1);
+    QMutexLocker locker(&m_poolMutex);
+    for (const auto &slot : m_pool) {
+        QMutexLocker slotLocker(&slot.second->mutex);
+        slot.second->released = true;
+    }
+    m_pool.clear();
+}
+
+void ThumbnailPrefetcher::releaseClip(const QString &binId)
+{
+    std::shared_ptr<Slot> slot;
+    {
+        QMutexLocker locker(&m_poolMutex);
+        auto it = m_pool.find(binId);
+        if (it == m_pool.end()) {
+            return;
+        }
+        slot = it->second;
+        m_pool.erase(it);
+    }
+    // Wait for the running decoding, so that no outdated thumbnail is stored after this
+    QMutexLocker slotLocker(&slot->mutex);
+    slot->released = true;
+}
+
+int ThumbnailPrefetcher::maxPrefetchedFrames()
+{
+    Mlt::Profile *profile = pCore->thumbProfile();
+    int frameSize = qMax(1, profile->width() * profile->height() * 4);
+    // Keep half of the cache for the thumbnails already displayed
+    return qMax(minPrefetchedFrames, ThumbnailCache::volatileCacheSize() / 2 / frameSize);
+}
+
+std::shared_ptr<ThumbnailPrefetcher::Slot> ThumbnailPrefetcher::getSlot(const QString &binId)
+{
+    QMutexLocker locker(&m_poolMutex);
+    std::shared_ptr<Slot> &slot = m_pool[binId];
+    if (!slot) {
+        slot = std::make_shared<Slot>();
+    }
+    slot->lastUse = ++m_clock;
+    std::shared_ptr<Slot> result = slot;
+    while (m_pool.size() > maxProducers) {
+        // Drop the least recently used producer that is not decoding
+        auto oldest = m_pool.end();
+        for (auto it = m_pool.begin(); it != m_pool.end(); ++it) {
+            if (it->second.use_count() == 1 && (oldest == m_pool.end() || it->second->lastUse < oldest->second->lastUse)) {
+                oldest = it;
+            }
+        }
+        if (oldest == m_pool.end()) {
+            break;
+        }
+        m_pool.erase(oldest);
+    }
+    return result;
+}
+
+QImage ThumbnailPrefetcher::decode(const QString &binId, int frame)
+{
+    std::shared_ptr<Slot> slot = getSlot(binId);
+    QMutexLocker locker(&slot->mutex);
+    if (slot->released) {
+        return QImage();
+    }
+    // The thumbnail may have been decoded while we were waiting for the producer
+    QImage result = ThumbnailCache::get()->getThumbnail(binId, frame, true);
+    if (!result.isNull()) {
+        return result;
+    }
+    if (!slot->producer) {
+        std::shared_ptr<ProjectClip> binClip = pCore->projectItemModel()->getClipByBinID(binId);
+        if (!binClip) {
+            return QImage();
+        }
+        slot->producer = binClip->createThumbProducer();
+    }
+    if (!slot->producer || !slot->producer->is_valid()) {
+        return QImage();
+    }
+    result = makeThumbnail(slot->producer, frame);
+    if (!result.isNull()) {
+        ThumbnailCache::get()->storeThumbnail(binId, frame, result, false);
+    }
+    return result;
+}
+
+// static
+QImage ThumbnailPrefetcher::makeThumbnail(const std::shared_ptr<Mlt::Producer> &producer, int frame)
+{
+    producer->seek(frame);
+    QScopedPointer<Mlt::Frame> mltFrame(producer->get_frame());
+    if (mltFrame == nullptr || !mltFrame->is_valid()) {
+        return QImage();
+    }
+    int ow = 0;
+    int oh = 0;
+    mlt_image_format format = mlt_image_rgb24a;
+    const uchar *image = mltFrame->get_image(format, ow, oh);
+    if (image) {
+        QImage temp(ow, oh, QImage::Format_ARGB32);
+        memcpy(temp.scanLine(0), image, (unsigned)(ow * oh * 4));
+        return temp.rgbSwapped();
+    }
+    return QImage();
+}
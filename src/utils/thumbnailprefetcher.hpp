@@ -0,0 +1,102 @@
+/***************************************************************************
+ *   Copyright (C) 2019 by Kdenlive contributors                           *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#pragma once
+
+#include "definitions.h"
+#include "jobs/jobscheduler.hpp"
+#include <QImage>
+#include <QMutex>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Mlt {
+class Producer;
+}
+
+/** @brief This class decodes the thumbnails displayed in the timeline, on request of the view and ahead of it.
+    The timeline sends the thumbnails around its visible area, grouped per clip. Each group is decoded in increasing frame order by a single task,
+    so that the decoding is mostly sequential. A new request cancels the previous one, so that the thumbnails that scrolled out of view are dropped.
+    The decoding uses a bounded pool of thumbnail producers, one per clip, which are also used for the thumbnails requested by the view.
+    The decoded thumbnails are stored in the volatile part of the ThumbnailCache.
+ * Note that this class is a Singleton
+ */
+class ThumbnailPrefetcher
+{
+
+public:
+    struct Request
+    {
+        QString binId;
+        std::vector<int> frames; // sorted
+    };
+
+    // Returns the instance of the Singleton
+    static std::unique_ptr<ThumbnailPrefetcher> &get();
+    ~ThumbnailPrefetcher();
+
+    /* @brief Returns a thumbnail from the cache, decoding it if needed. This is called by the threads of the QML image provider */
+    QImage getThumbnail(const QString &binId, int frame);
+
+    /* @brief Replaces the pending prefetch. The requests are started in the given order, and limited to what fits in the volatile cache */
+    void prefetch(std::vector<Request> requests);
+
+    /* @brief Cancels the prefetch and releases the producers, when the project changes */
+    void reset();
+
+    /* @brief Releases the producer of a clip, this must be called when the clip is reloaded */
+    void releaseClip(const QString &binId);
+
+    /* @brief Returns the maximum number of thumbnails decoded by a prefetch */
+    static int maxPrefetchedFrames();
+
+protected:
+    // Constructor is protected because class is a Singleton
+    ThumbnailPrefetcher();
+
+    struct Slot
+    {
+        QMutex mutex;
+        std::shared_ptr<Mlt::Producer> producer;
+        quint64 lastUse{0};
+        bool released{false};
+    };
+
+    /* @brief Returns the pool slot of a clip, creating it if needed and dropping the least recently used ones */
+    std::shared_ptr<Slot> getSlot(const QString &binId);
+    /* @brief Decodes a thumbnail and stores it in the cache */
+    QImage decode(const QString &binId, int frame);
+    /* @brief Decodes the frame of a producer as an image */
+    static QImage makeThumbnail(const std::shared_ptr<Mlt::Producer> &producer, int frame);
+
+    static std::unique_ptr<ThumbnailPrefetcher> instance;
+    static std::once_flag m_onceFlag; // flag to create the prefetcher only once
+
+    QMutex m_poolMutex;
+    std::unordered_map<QString, std::shared_ptr<Slot>> m_pool;
+    quint64 m_clock{0};
+    std::atomic<int> m_generation{0};
+    // Declared last, so that the running tasks are done before the pool is destructed
+    JobScheduler m_scheduler;
+};
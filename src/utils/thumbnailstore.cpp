@@ -0,0 +1,258 @@
+/***************************************************************************
+ *   Copyright (C) 2019 by Kdenlive contributors                           *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "thumbnailstore.hpp"
+#include <QBuffer>
+#include <QDebug>
+#include <QFile>
+#include <cstring>
+
+namespace {
+// The packs are a local cache, so they are written with the native byte order
+const char indexMagic[4] = {'K', 'T', 'H', 'I'};
+const quint32 indexVersion = 1;
+
+struct IndexHeader
+{
+    char magic[4];
+    quint32 version;
+};
+
+struct IndexRecord
+{
+    qint32 pos;
+    quint32 length;
+    qint64 offset;
+};
+} // namespace
+
+ThumbnailStore::ThumbnailStore(const QDir &folder, qint64 maxSize)
+    : m_folder(folder)
+    , m_maxSize(maxSize)
+{
+    // Packs are sorted from the oldest to the most recently written, so that the least recently used ones are dropped first
+    const QFileInfoList packs = m_folder.entryInfoList({QStringLiteral("*.thumbs")}, QDir::Files, QDir::Time | QDir::Reversed);
+    for (const QFileInfo &info : packs) {
+        const QString hash = info.completeBaseName();
+        Pack &pack = m_packs[hash];
+        pack.size = info.size() + QFileInfo(indexPath(hash)).size();
+        pack.lastUse = ++m_clock;
+        m_size += pack.size;
+    }
+    evict(QString());
+}
+
+ThumbnailStore::~ThumbnailStore() = default;
+
+const QDir &ThumbnailStore::folder() const
+{
+    return m_folder;
+}
+
+QString ThumbnailStore::dataPath(const QString &hash) const
+{
+    return m_folder.absoluteFilePath(hash + QStringLiteral(".thumbs"));
+}
+
+QString ThumbnailStore::indexPath(const QString &hash) const
+{
+    return m_folder.absoluteFilePath(hash + QStringLiteral(".thumbindex"));
+}
+
+ThumbnailStore::Pack *ThumbnailStore::getPack(const QString &hash)
+{
+    auto it = m_packs.find(hash);
+    if (it == m_packs.end()) {
+        return nullptr;
+    }
+    Pack &pack = it->second;
+    if (!pack.loaded && !loadPack(hash, pack)) {
+        qDebug() << "// Dropping invalid thumbnail pack" << dataPath(hash);
+        remove(hash);
+        return nullptr;
+    }
+    pack.lastUse = ++m_clock;
+    return &pack;
+}
+
+bool ThumbnailStore::loadPack(const QString &hash, Pack &pack)
+{
+    QFile index(indexPath(hash));
+    if (!index.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QByteArray content = index.readAll();
+    IndexHeader header;
+    if (content.size() < (int)sizeof(IndexHeader)) {
+        return false;
+    }
+    memcpy(&header, content.constData(), sizeof(IndexHeader));
+    if (memcmp(header.magic, indexMagic, 4) != 0 || header.version != indexVersion) {
+        return false;
+    }
+    pack.data.reset(new QFile(dataPath(hash)));
+    if (!pack.data->open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const qint64 dataSize = pack.data->size();
+    const int count = (content.size() - (int)sizeof(IndexHeader)) / (int)sizeof(IndexRecord);
+    const char *records = content.constData() + sizeof(IndexHeader);
+    for (int i = 0; i < count; ++i) {
+        IndexRecord record;
+        memcpy(&record, records + i * sizeof(IndexRecord), sizeof(IndexRecord));
+        // Records are appended after the image data, a thumbnail stored again at the same position replaces the previous one
+        if (record.offset >= 0 && record.offset + record.length <= dataSize) {
+            pack.index[record.pos] = Entry{record.offset, record.length};
+        }
+    }
+    pack.loaded = true;
+    return mapPack(pack);
+}
+
+bool ThumbnailStore::mapPack(Pack &pack)
+{
+    if (pack.map != nullptr) {
+        pack.data->unmap(pack.map);
+        pack.map = nullptr;
+        pack.mapped = 0;
+    }
+    const qint64 size = pack.data->size();
+    if (size == 0) {
+        return true;
+    }
+    pack.map = pack.data->map(0, size);
+    if (pack.map == nullptr) {
+        return false;
+    }
+    pack.mapped = size;
+    return true;
+}
+
+bool ThumbnailStore::contains(const QString &hash, int pos)
+{
+    Pack *pack = getPack(hash);
+    return pack != nullptr && pack->index.count(pos) > 0;
+}
+
+QImage ThumbnailStore::get(const QString &hash, int pos)
+{
+    Pack *pack = getPack(hash);
+    if (pack == nullptr) {
+        return QImage();
+    }
+    auto it = pack->index.find(pos);
+    if (it == pack->index.end()) {
+        return QImage();
+    }
+    const Entry &entry = it->second;
+    // If the image was appended during this session, the mapping has to be extended
+    if (entry.offset + entry.length > pack->mapped && !mapPack(*pack)) {
+        return QImage();
+    }
+    return QImage::fromData(pack->map + entry.offset, (int)entry.length, "PNG");
+}
+
+bool ThumbnailStore::store(const QString &hash, int pos, const QImage &img)
+{
+    QByteArray bytes;
+    QBuffer buffer(&bytes);
+    buffer.open(QIODevice::WriteOnly);
+    if (!img.save(&buffer, "PNG")) {
+        return false;
+    }
+    Pack *pack = getPack(hash);
+    if (pack == nullptr) {
+        pack = &m_packs[hash];
+        pack->loaded = true;
+        pack->lastUse = ++m_clock;
+    }
+    QFile data(dataPath(hash));
+    QFile index(indexPath(hash));
+    if (!data.open(QIODevice::Append) || !index.open(QIODevice::Append)) {
+        return false;
+    }
+    qint64 written = 0;
+    if (index.size() == 0) {
+        IndexHeader header;
+        memcpy(header.magic, indexMagic, 4);
+        header.version = indexVersion;
+        written += index.write(reinterpret_cast<const char *>(&header), sizeof(IndexHeader));
+    }
+    IndexRecord record{pos, (quint32)bytes.size(), data.size()};
+    if (data.write(bytes) != bytes.size()) {
+        return false;
+    }
+    written += bytes.size();
+    if (index.write(reinterpret_cast<const char *>(&record), sizeof(IndexRecord)) != sizeof(IndexRecord)) {
+        return false;
+    }
+    written += sizeof(IndexRecord);
+    pack->index[pos] = Entry{record.offset, record.length};
+    pack->size += written;
+    m_size += written;
+    if (!pack->data) {
+        pack->data.reset(new QFile(dataPath(hash)));
+        pack->data->open(QIODevice::ReadOnly);
+    }
+    evict(hash);
+    return true;
+}
+
+void ThumbnailStore::remove(const QString &hash)
+{
+    auto it = m_packs.find(hash);
+    if (it == m_packs.end()) {
+        return;
+    }
+    Pack &pack = it->second;
+    if (pack.data) {
+        if (pack.map != nullptr) {
+            pack.data->unmap(pack.map);
+        }
+        pack.data->close();
+    }
+    QFile::remove(dataPath(hash));
+    QFile::remove(indexPath(hash));
+    m_size -= pack.size;
+    m_packs.erase(it);
+}
+
+qint64 ThumbnailStore::size() const
+{
+    return m_size;
+}
+
+void ThumbnailStore::evict(const QString &keep)
+{
+    while (m_size > m_maxSize) {
+        auto oldest = m_packs.end();
+        for (auto it = m_packs.begin(); it != m_packs.end(); ++it) {
+            if (it->first != keep && (oldest == m_packs.end() || it->second.lastUse < oldest->second.lastUse)) {
+                oldest = it;
+            }
+        }
+        if (oldest == m_packs.end()) {
+            break;
+        }
+        const QString hash = oldest->first;
+        remove(hash);
+    }
+}
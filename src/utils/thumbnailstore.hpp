@@ -0,0 +1,100 @@
+/***************************************************************************
+ *   Copyright (C) 2019 by Kdenlive contributors                           *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#pragma once
+
+#include "definitions.h"
+#include <QDir>
+#include <QImage>
+#include <memory>
+#include <unordered_map>
+
+class QFile;
+
+/** @brief This class is the persistent part of the thumbnail cache.
+    The thumbnails of a clip are packed in two append-only files named after the clip hash:
+    a data file (.thumbs) with the encoded images, and an index (.thumbindex) giving the position, offset and size of each image.
+    The index of a clip is read on first use and the data file is memory mapped, so that further queries don't touch the filesystem.
+    The total size of the packs is bounded: when it is exceeded, the least recently used clips are dropped.
+    Note that this class is not thread safe, accesses are serialized by ThumbnailCache.
+ */
+class ThumbnailStore
+{
+
+public:
+    /* @brief Opens the store living in the given folder
+       @param maxSize is the maximum size of the packs, in bytes
+     */
+    ThumbnailStore(const QDir &folder, qint64 maxSize);
+    ~ThumbnailStore();
+
+    const QDir &folder() const;
+
+    /* @brief Check whether the thumbnail of the given clip hash and position is stored */
+    bool contains(const QString &hash, int pos);
+
+    /* @brief Returns a stored thumbnail, or a null image if it is not stored */
+    QImage get(const QString &hash, int pos);
+
+    /* @brief Appends a thumbnail to the pack of a clip. Returns false if it could not be written */
+    bool store(const QString &hash, int pos, const QImage &img);
+
+    /* @brief Deletes all the thumbnails of a clip */
+    void remove(const QString &hash);
+
+    /* @brief Returns the total size of the packs, in bytes */
+    qint64 size() const;
+
+protected:
+    struct Entry
+    {
+        qint64 offset;
+        quint32 length;
+    };
+    struct Pack
+    {
+        std::unordered_map<int, Entry> index;
+        std::unique_ptr<QFile> data;
+        uchar *map{nullptr};
+        qint64 mapped{0};
+        qint64 size{0};
+        quint64 lastUse{0};
+        bool loaded{false};
+    };
+
+    /* @brief Returns the pack of a clip, loading its index if needed, or nullptr if the clip has no pack */
+    Pack *getPack(const QString &hash);
+    /* @brief Reads the index of a pack and maps its data file */
+    bool loadPack(const QString &hash, Pack &pack);
+    /* @brief Maps the whole data file of a pack, after it grew */
+    bool mapPack(Pack &pack);
+    /* @brief Drops the least recently used packs until the size fits, except the one of the given hash */
+    void evict(const QString &keep);
+
+    QString dataPath(const QString &hash) const;
+    QString indexPath(const QString &hash) const;
+
+    QDir m_folder;
+    qint64 m_maxSize;
+    qint64 m_size{0};
+    quint64 m_clock{0};
+    std::unordered_map<QString, Pack> m_packs;
+};
@@ -2,6 +2,7 @@
 #include "catch.hpp"
 
 #include <QApplication>
+#include <QStandardPaths>
 #include <mlt++/MltFactory.h>
 #include <mlt++/MltRepository.h>
 #define private public
@@ -17,6 +18,8 @@ int main(int argc, char *argv[])
 {
     QApplication app(argc, argv);
     app.setApplicationName(QStringLiteral("kdenlive"));
+    // Don't read or overwrite the user's cached assets and profiles
+    QStandardPaths::setTestModeEnabled(true);
     std::unique_ptr<Mlt::Repository> repo(Mlt::Factory::init(nullptr));
     qputenv("MLT_TESTS", QByteArray("1"));
     Core::build(false);
@@ -0,0 +1,155 @@
+#include "catch.hpp"
+#include "lib/audio/audioCorrelation.h"
+#include "lib/audio/audioCorrelationInfo.h"
+#include "lib/audio/fftCorrelation.h"
+#include <QtConcurrent>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+// A centered random envelope, like the normalized ones of AudioEnvelope
+std::vector<qint64> randomEnvelope(size_t size, unsigned seed)
+{
+    std::default_random_engine g(seed);
+    std::uniform_int_distribution<qint64> amplitude(-1000, 1000);
+    std::vector<qint64> envelope(size);
+    for (auto &value : envelope) {
+        value = amplitude(g);
+    }
+    return envelope;
+}
+
+// Extracts a noisy excerpt of the envelope starting at the given frame
+std::vector<qint64> excerpt(const std::vector<qint64> &envelope, size_t start, size_t size, unsigned seed)
+{
+    std::default_random_engine g(seed);
+    std::uniform_int_distribution<qint64> noise(-100, 100);
+    std::vector<qint64> result(envelope.begin() + (int)start, envelope.begin() + int(start + size));
+    for (auto &value : result) {
+        value += noise(g);
+    }
+    return result;
+}
+
+int shiftOf(const AudioCorrelationInfo &info, size_t sizeSub)
+{
+    return (int)info.maxIndex() - (int)sizeSub;
+}
+} // namespace
+
+TEST_CASE("FFT correlation against a precomputed reference", "[AudioCorrelation]")
+{
+    const std::vector<qint64> main = randomEnvelope(5000, 1);
+    const std::vector<qint64> sub = excerpt(main, 1200, 1000, 2);
+
+    AudioCorrelationInfo direct(main.size(), sub.size());
+    AudioCorrelation::correlate(main.data(), main.size(), sub.data(), sub.size(), direct.correlationVector());
+    REQUIRE(shiftOf(direct, sub.size()) == 1200);
+
+    AudioCorrelationInfo fft(main.size(), sub.size());
+    FFTCorrelation::correlate(main.data(), main.size(), sub.data(), sub.size(), fft.correlationVector());
+    REQUIRE(shiftOf(fft, sub.size()) == 1200);
+
+    // The same reference is used for several vectors, of different sizes
+    FFTCorrelation::Reference reference(main.data(), main.size());
+    for (size_t start : {0, 700, 2900}) {
+        for (size_t size : {150, 2000}) {
+            const std::vector<qint64> other = excerpt(main, start, size, (unsigned)(start + size));
+            AudioCorrelationInfo info(main.size(), other.size());
+            FFTCorrelation::correlate(reference, other.data(), other.size(), info.correlationVector());
+            REQUIRE(shiftOf(info, other.size()) == (int)start);
+        }
+    }
+}
+
+TEST_CASE("Coarse to fine correlation", "[AudioCorrelation]")
+{
+    REQUIRE(AudioCorrelation::decimationFactor(1000, 500, 1000) == 1);
+    REQUIRE(AudioCorrelation::decimationFactor(1001, 500, 1000) == 2);
+    REQUIRE(AudioCorrelation::decimationFactor(500, 3500, 1000) == 4);
+
+    const std::vector<qint64> main = randomEnvelope(20000, 3);
+    AudioCorrelation::References references(main);
+    for (size_t start : {0, 4321, 12345}) {
+        const std::vector<qint64> sub = excerpt(main, start, 6000, (unsigned)start);
+        AudioCorrelationInfo info(main.size(), sub.size());
+        // With a coarse size of 1000, the envelopes are decimated by 32
+        AudioCorrelation::correlateCoarseToFine(references, sub, info.correlationVector(), 1000);
+        REQUIRE(shiftOf(info, sub.size()) == (int)start);
+    }
+
+    // Sub clips starting before the reference
+    const std::vector<qint64> sub = randomEnvelope(8000, 4);
+    std::vector<qint64> longer(sub.begin() + 3000, sub.end());
+    longer.resize(15000, 0);
+    AudioCorrelation::References subReferences(longer);
+    AudioCorrelationInfo info(longer.size(), sub.size());
+    AudioCorrelation::correlateCoarseToFine(subReferences, sub, info.correlationVector(), 1000);
+    REQUIRE(shiftOf(info, sub.size()) == -3000);
+}
+
+TEST_CASE("Correlation of an anti-correlated clip", "[AudioCorrelation]")
+{
+    // The best correlation must be found even if all of them are negative
+    AudioCorrelationInfo negative(2, 2);
+    qint64 *values = negative.correlationVector();
+    for (size_t i = 0; i < negative.size(); ++i) {
+        values[i] = -10 - (qint64)i;
+    }
+    values[3] = -2;
+    REQUIRE(negative.maxIndex() == 3);
+
+    // A positive main envelope and a negative sub clip: the correlation is negative wherever they overlap
+    std::vector<qint64> main = randomEnvelope(20000, 6);
+    for (auto &value : main) {
+        value = qAbs(value) + 1;
+    }
+    std::vector<qint64> sub = excerpt(main, 4321, 6000, 7);
+    for (auto &value : sub) {
+        value = -qAbs(value) - 1;
+    }
+    AudioCorrelation::References references(main);
+    AudioCorrelationInfo info(main.size(), sub.size());
+    AudioCorrelation::correlateCoarseToFine(references, sub, info.correlationVector(), 1000);
+    const qint64 *correlation = info.correlationVector();
+    const qint64 best = correlation[info.maxIndex()];
+    REQUIRE(best != std::numeric_limits<qint64>::min());
+    size_t computed = 0;
+    for (size_t i = 0; i < info.size(); ++i) {
+        if (correlation[i] != std::numeric_limits<qint64>::min()) {
+            computed++;
+            REQUIRE(correlation[i] <= 0);
+            REQUIRE(correlation[i] <= best);
+        }
+    }
+    // Only the shifts within two blocks of 32 frames around the coarse match are computed
+    REQUIRE(computed > 0);
+    REQUIRE(computed <= 4 * 32 + 1);
+}
+
+TEST_CASE("Multicam audio alignment", "[.][benchmark][AudioCorrelation]")
+{
+    // One hour at 25 fps, with 12 cameras of 20 minutes each
+    const std::vector<qint64> main = randomEnvelope(90000, 5);
+    std::vector<std::vector<qint64>> cameras;
+    for (unsigned i = 0; i < 12; ++i) {
+        cameras.push_back(excerpt(main, i * 5000, 30000, i));
+    }
+
+    BENCHMARK("Pairwise FFT correlation")
+    {
+        for (const auto &camera : cameras) {
+            AudioCorrelationInfo info(main.size(), camera.size());
+            FFTCorrelation::correlate(main.data(), main.size(), camera.data(), camera.size(), info.correlationVector());
+        }
+    }
+    BENCHMARK("Concurrent coarse to fine correlation")
+    {
+        AudioCorrelation::References references(main);
+        QtConcurrent::blockingMap(cameras, [&references, &main](const std::vector<qint64> &camera) {
+            AudioCorrelationInfo info(main.size(), camera.size());
+            AudioCorrelation::correlateCoarseToFine(references, camera, info.correlationVector());
+        });
+    }
+}
@@ -0,0 +1,157 @@
+#include "catch.hpp"
+#include "lib/audio/audioPeaks.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <vector>
+
+namespace {
+// Ten frames of 100 stereo samples: the first channel is at 1000 for five frames then at -2000, the second one is silent
+std::shared_ptr<AudioPeaks> buildPeaks()
+{
+    AudioPeaksBuilder builder(2, 10, 100.);
+    std::vector<qint16> samples(1000 * 2, 0);
+    for (int i = 0; i < 1000; ++i) {
+        samples[(size_t)(2 * i)] = i < 500 ? 1000 : -2000;
+    }
+    builder.addSamples(samples.data(), 1000);
+    REQUIRE(builder.processedFrames() == 10);
+    return builder.finish();
+}
+} // namespace
+
+TEST_CASE("Audio peaks levels", "[AudioPeaks]")
+{
+    std::shared_ptr<AudioPeaks> peaks = buildPeaks();
+    REQUIRE(peaks->channels() == 2);
+    REQUIRE(peaks->frames() == 10);
+    REQUIRE(peaks->bucketCount(0) == 40);
+    REQUIRE(peaks->bucketCount(1) == 10);
+    REQUIRE(peaks->bucketCount(2) == 3);
+
+    AudioPeaks::Peak peak = peaks->range(0, 0, 1, 0);
+    REQUIRE(peak.min == 1000);
+    REQUIRE(peak.max == 1000);
+    REQUIRE(peak.rms == 1000);
+    peak = peaks->range(1, 5, 6, 0);
+    REQUIRE(peak.min == -2000);
+    REQUIRE(peak.max == -2000);
+    peak = peaks->range(2, 0, 10, 0);
+    REQUIRE(peak.min == -2000);
+    REQUIRE(peak.max == 1000);
+    peak = peaks->range(2, 0, 10, 1);
+    REQUIRE(peak.min == 0);
+    REQUIRE(peak.max == 0);
+
+    const QList<double> levels = peaks->frameLevels();
+    REQUIRE(levels.size() == 20);
+    REQUIRE(levels.at(0) == Approx(256. * 1000 / 32768));
+    REQUIRE(levels.at(1) == 0);
+    REQUIRE(levels.at(18) == Approx(256. * 2000 / 32768));
+
+    // Level 0 has 4 buckets per frame, and each level merges 4 buckets of the previous one
+    REQUIRE(peaks->levelForFramesPerPixel(0.1) == 0);
+    REQUIRE(peaks->levelForFramesPerPixel(1) == 1);
+    REQUIRE(peaks->levelForFramesPerPixel(3.9) == 1);
+    REQUIRE(peaks->levelForFramesPerPixel(4) == 2);
+    REQUIRE(peaks->levelForFramesPerPixel(100000) == AudioPeaks::LevelCount - 1);
+}
+
+TEST_CASE("Audio peaks progressive build", "[AudioPeaks]")
+{
+    AudioPeaksBuilder builder(2, 10, 100.);
+    std::vector<qint16> samples(500 * 2, 0);
+    for (int i = 0; i < 500; ++i) {
+        samples[(size_t)(2 * i)] = 1000;
+    }
+    builder.addSamples(samples.data(), 500);
+    std::shared_ptr<AudioPeaks> partial = builder.snapshot();
+    REQUIRE(partial->frames() == 10);
+    REQUIRE(partial->availableFrames() == 5);
+    // The frames that are not computed yet are silent
+    AudioPeaks::Peak peak = partial->range(1, 5, 10, 0);
+    REQUIRE(peak.min == 0);
+    REQUIRE(peak.max == 0);
+    peak = partial->range(2, 0, 10, 0);
+    REQUIRE(peak.min == 1000);
+    REQUIRE(peak.max == 1000);
+    QList<double> levels = partial->frameLevels();
+    REQUIRE(levels.size() == 20);
+    REQUIRE(levels.at(8) == Approx(256. * 1000 / 32768));
+    REQUIRE(levels.at(10) == 0);
+
+    for (int i = 0; i < 500; ++i) {
+        samples[(size_t)(2 * i)] = -2000;
+    }
+    builder.addSamples(samples.data(), 500);
+    // The builder fills the published peaks in place
+    REQUIRE(builder.snapshot() == partial);
+    REQUIRE(partial->availableFrames() == 10);
+    partial->fillFrameLevels(levels, 5, 10);
+    REQUIRE(levels == partial->frameLevels());
+    REQUIRE(builder.finish() == partial);
+
+    std::shared_ptr<AudioPeaks> peaks = buildPeaks();
+    for (int level = 0; level < AudioPeaks::LevelCount; ++level) {
+        for (int frame = 0; frame < 10; ++frame) {
+            AudioPeaks::Peak a = partial->range(level, frame, frame + 1, 0);
+            AudioPeaks::Peak b = peaks->range(level, frame, frame + 1, 0);
+            REQUIRE(a.min == b.min);
+            REQUIRE(a.max == b.max);
+            REQUIRE(a.rms == b.rms);
+        }
+    }
+}
+
+TEST_CASE("Audio peak files", "[AudioPeaks]")
+{
+    QTemporaryDir tmp;
+    REQUIRE(tmp.isValid());
+    QDir folder(tmp.path());
+    const QString path = folder.absoluteFilePath(QStringLiteral("peaks"));
+    std::shared_ptr<AudioPeaks> peaks = buildPeaks();
+    REQUIRE(peaks->save(path));
+
+    SECTION("Saved peaks are loaded back")
+    {
+        std::shared_ptr<AudioPeaks> loaded = AudioPeaks::load(path);
+        REQUIRE(loaded != nullptr);
+        REQUIRE(loaded->channels() == 2);
+        REQUIRE(loaded->frames() == 10);
+        for (int level = 0; level < AudioPeaks::LevelCount; ++level) {
+            REQUIRE(loaded->bucketCount(level) == peaks->bucketCount(level));
+            for (int channel = 0; channel < 2; ++channel) {
+                AudioPeaks::Peak a = loaded->range(level, 0, 10, channel);
+                AudioPeaks::Peak b = peaks->range(level, 0, 10, channel);
+                REQUIRE(a.min == b.min);
+                REQUIRE(a.max == b.max);
+                REQUIRE(a.rms == b.rms);
+            }
+        }
+        REQUIRE(loaded->frameLevels() == peaks->frameLevels());
+    }
+
+    SECTION("Missing, truncated or corrupt files are rejected")
+    {
+        REQUIRE(AudioPeaks::load(folder.absoluteFilePath(QStringLiteral("missing"))) == nullptr);
+
+        const QString truncated = folder.absoluteFilePath(QStringLiteral("truncated"));
+        REQUIRE(QFile::copy(path, truncated));
+        REQUIRE(QFile::resize(truncated, QFileInfo(path).size() - 1));
+        REQUIRE(AudioPeaks::load(truncated) == nullptr);
+        REQUIRE(QFile::resize(truncated, 10));
+        REQUIRE(AudioPeaks::load(truncated) == nullptr);
+
+        // The offset of the second level comes after the magic, five 32 bit fields and the offset of the first level
+        const QString corrupt = folder.absoluteFilePath(QStringLiteral("corrupt"));
+        REQUIRE(QFile::copy(path, corrupt));
+        QFile file(corrupt);
+        REQUIRE(file.open(QIODevice::ReadWrite));
+        REQUIRE(file.seek(32));
+        const qint64 offset = 1000000;
+        REQUIRE(file.write(reinterpret_cast<const char *>(&offset), sizeof(offset)) == (qint64)sizeof(offset));
+        file.close();
+        REQUIRE(AudioPeaks::load(corrupt) == nullptr);
+    }
+}
@@ -0,0 +1,98 @@
+#include "catch.hpp"
+#include "monitor/scopes/audioring.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+std::vector<qint16> makeSamples(int channels, int samples, qint16 value)
+{
+    return std::vector<qint16>((size_t)(channels * samples), value);
+}
+} // namespace
+
+TEST_CASE("Audio ring", "[AudioRing]")
+{
+    AudioRing ring(4, 1024);
+    AudioBlock block;
+    REQUIRE(ring.lastSequence() == 0);
+    REQUIRE_FALSE(ring.readLatest(block));
+
+    SECTION("Blocks are read back")
+    {
+        auto samples = makeSamples(2, 100, 7);
+        ring.write(samples.data(), 2, 100, 48000);
+        REQUIRE(ring.lastSequence() == 1);
+        REQUIRE(ring.readLatest(block));
+        REQUIRE(block.sequence == 1);
+        REQUIRE(block.channels == 2);
+        REQUIRE(block.samples == 100);
+        REQUIRE(block.frequency == 48000);
+        REQUIRE(block.data.size() == 200);
+        REQUIRE(block.data.at(0) == 7);
+        REQUIRE(block.data.at(199) == 7);
+    }
+
+    SECTION("Overwritten blocks cannot be read")
+    {
+        for (qint16 i = 1; i <= 6; ++i) {
+            auto samples = makeSamples(1, 10, i);
+            ring.write(samples.data(), 1, 10, 48000);
+        }
+        REQUIRE(ring.lastSequence() == 6);
+        REQUIRE_FALSE(ring.read(2, block));
+        REQUIRE_FALSE(ring.read(7, block));
+        REQUIRE(ring.read(3, block));
+        REQUIRE(block.data.at(0) == 3);
+        REQUIRE(ring.read(6, block));
+        REQUIRE(block.data.at(9) == 6);
+    }
+
+    SECTION("Long frames are truncated to whole samples")
+    {
+        auto samples = makeSamples(3, 1000, 1);
+        ring.write(samples.data(), 3, 1000, 44100);
+        REQUIRE(ring.readLatest(block));
+        REQUIRE(block.samples == 341);
+        REQUIRE(block.data.size() == 1023);
+    }
+
+    SECTION("Reading does not allocate once the block is reserved")
+    {
+        auto samples = makeSamples(2, 500, 3);
+        ring.write(samples.data(), 2, 500, 48000);
+        REQUIRE(ring.readLatest(block));
+        const qint16 *data = block.data.constData();
+        auto shorter = makeSamples(2, 200, 4);
+        ring.write(shorter.data(), 2, 200, 48000);
+        REQUIRE(ring.readLatest(block));
+        ring.write(samples.data(), 2, 500, 48000);
+        REQUIRE(ring.readLatest(block));
+        REQUIRE(block.data.constData() == data);
+    }
+
+    SECTION("Readers never get a torn block")
+    {
+        std::atomic<bool> done(false);
+        std::thread writer([&ring, &done]() {
+            std::vector<qint16> samples(1024);
+            for (int i = 1; i <= 20000; ++i) {
+                std::fill(samples.begin(), samples.end(), qint16(i));
+                ring.write(samples.data(), 2, 512, i);
+            }
+            done = true;
+        });
+        while (!done) {
+            if (ring.readLatest(block)) {
+                const auto expected = qint16(block.frequency);
+                REQUIRE(block.channels == 2);
+                REQUIRE(block.samples == 512);
+                REQUIRE(block.sequence == (quint64)block.frequency);
+                REQUIRE(block.data.front() == expected);
+                REQUIRE(block.data.back() == expected);
+            }
+        }
+        writer.join();
+        REQUIRE(ring.lastSequence() == 20000);
+    }
+}
@@ -0,0 +1,97 @@
+#include "test_utils.hpp"
+
+Mlt::Profile profile_bin;
+
+TEST_CASE("Bin item lookups", "[ProjectItemModel]")
+{
+    Logger::clear();
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    Fun undo = []() { return true; };
+    Fun redo = []() { return true; };
+
+    SECTION("Lookup by bin id")
+    {
+        QString binId = createProducer(profile_bin, "red", binModel);
+        QString binId2 = createProducer(profile_bin, "blue", binModel);
+        REQUIRE(binModel->getClipByBinID(binId) != nullptr);
+        REQUIRE(binModel->getClipByBinID(binId)->clipId() == binId);
+        REQUIRE(binModel->getClipByBinID(binId2)->clipId() == binId2);
+        // Track clip ids carry a suffix that must be ignored
+        REQUIRE(binModel->getClipByBinID(binId + QStringLiteral("_1"))->clipId() == binId);
+        REQUIRE(binModel->getItemByBinId(binId) == binModel->getClipByBinID(binId));
+        REQUIRE(binModel->getFolderByBinId(binId) == nullptr);
+        REQUIRE_FALSE(binModel->isIdFree(binId));
+
+        REQUIRE(binModel->requestBinClipDeletion(binModel->getClipByBinID(binId), undo, redo));
+        REQUIRE(binModel->getClipByBinID(binId) == nullptr);
+        REQUIRE(binModel->isIdFree(binId));
+        REQUIRE(binModel->getClipByBinID(binId2) != nullptr);
+
+        // Undoing the deletion must restore the index
+        REQUIRE(undo());
+        REQUIRE(binModel->getClipByBinID(binId) != nullptr);
+        REQUIRE(redo());
+        REQUIRE(binModel->getClipByBinID(binId) == nullptr);
+    }
+
+    SECTION("Lookup of folders")
+    {
+        QString folderId;
+        REQUIRE(binModel->requestAddFolder(folderId, QStringLiteral("folder"), binModel->getRootFolder()->clipId(), undo, redo));
+        REQUIRE(binModel->getFolderByBinId(folderId) != nullptr);
+        REQUIRE(binModel->getClipByBinID(folderId) == nullptr);
+        REQUIRE(binModel->getFolderIdByName(QStringLiteral("folder")) == folderId);
+
+        REQUIRE(binModel->requestRenameFolder(binModel->getFolderByBinId(folderId), QStringLiteral("renamed"), undo, redo));
+        REQUIRE(binModel->getFolderIdByName(QStringLiteral("folder")).isEmpty());
+        REQUIRE(binModel->getFolderIdByName(QStringLiteral("renamed")) == folderId);
+
+        REQUIRE(binModel->requestBinClipDeletion(binModel->getFolderByBinId(folderId), undo, redo));
+        REQUIRE(binModel->getFolderByBinId(folderId) == nullptr);
+        REQUIRE(binModel->getFolderIdByName(QStringLiteral("renamed")).isEmpty());
+    }
+    binModel->clean();
+    pCore->m_projectManager = nullptr;
+}
+
+TEST_CASE("Bin lookup cost as the bin grows", "[.][benchmark][ProjectItemModel]")
+{
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    std::vector<QString> ids;
+    for (int size : {100, 1000, 5000}) {
+        while ((int)ids.size() < size) {
+            ids.push_back(createProducer(profile_bin, "red", binModel));
+        }
+        int found = 0;
+        BENCHMARK(QStringLiteral("10000 lookups in a bin of %1 clips").arg(size).toStdString())
+        {
+            for (int i = 0; i < 10000; ++i) {
+                if (binModel->getClipByBinID(ids[(size_t)i % ids.size()])) {
+                    found++;
+                }
+            }
+        }
+        REQUIRE(found > 0);
+        REQUIRE(found % 10000 == 0);
+    }
+    binModel->clean();
+    pCore->m_projectManager = nullptr;
+}
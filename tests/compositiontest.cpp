@@ -414,3 +414,85 @@ TEST_CASE("Composition manipulation", "[CompositionModel]")
     }
     Logger::print_trace();
 }
+
+TEST_CASE("Compositions are planted in order", "[CompositionModel]")
+{
+    Logger::clear();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    std::shared_ptr<MarkerListModel> guideModel(new MarkerListModel(undoStack));
+    std::shared_ptr<TimelineItemModel> timeline = TimelineItemModel::construct(&profile_composition, guideModel, undoStack);
+
+    int tid0 = TrackModel::construct(timeline);
+    Q_UNUSED(tid0);
+    int tid1 = TrackModel::construct(timeline);
+    int tid2 = TrackModel::construct(timeline);
+    int tid3 = TrackModel::construct(timeline);
+    std::vector<int> tracks{tid1, tid2, tid3};
+    std::vector<int> compos;
+    for (int i = 0; i < 9; ++i) {
+        int cid = CompositionModel::construct(timeline, aCompo);
+        // Insert them in an order that is neither increasing nor decreasing in tracks
+        REQUIRE(timeline->requestCompositionMove(cid, tracks[(size_t)(i * 2) % 3], i * 10));
+        REQUIRE(timeline->checkConsistency());
+        compos.push_back(cid);
+    }
+    REQUIRE(timeline->getTrackCompositionsCount(tid1) == 3);
+    REQUIRE(timeline->getTrackCompositionsCount(tid2) == 3);
+    REQUIRE(timeline->getTrackCompositionsCount(tid3) == 3);
+
+    // Change tracks, check that the field stays sorted after each move and its undo
+    REQUIRE(timeline->requestCompositionMove(compos[0], tid3, 100));
+    REQUIRE(timeline->checkConsistency());
+    REQUIRE(timeline->requestCompositionMove(compos[4], tid2, 110));
+    REQUIRE(timeline->checkConsistency());
+    REQUIRE(timeline->requestCompositionMove(compos[8], tid1, 120));
+    REQUIRE(timeline->checkConsistency());
+    REQUIRE(timeline->getTrackCompositionsCount(tid1) == 3);
+    REQUIRE(timeline->getTrackCompositionsCount(tid3) == 3);
+
+    for (int i = 0; i < 3; ++i) {
+        undoStack->undo();
+        REQUIRE(timeline->checkConsistency());
+    }
+    REQUIRE(timeline->getCompositionTrackId(compos[0]) == tid1);
+    REQUIRE(timeline->getCompositionPosition(compos[0]) == 0);
+    for (int i = 0; i < 3; ++i) {
+        undoStack->redo();
+        REQUIRE(timeline->checkConsistency());
+    }
+    REQUIRE(timeline->getCompositionTrackId(compos[0]) == tid3);
+
+    // Deleting a composition does not change the order of the other ones
+    REQUIRE(timeline->requestItemDeletion(compos[3]));
+    REQUIRE(timeline->checkConsistency());
+    Logger::print_trace();
+}
+
+TEST_CASE("Move a composition among many", "[.][benchmark][CompositionModel]")
+{
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    std::shared_ptr<MarkerListModel> guideModel(new MarkerListModel(undoStack));
+    std::shared_ptr<TimelineItemModel> timeline = TimelineItemModel::construct(&profile_composition, guideModel, undoStack);
+
+    std::vector<int> tracks;
+    for (int i = 0; i < 5; ++i) {
+        tracks.push_back(TrackModel::construct(timeline));
+    }
+    for (int count : {100, 500}) {
+        for (int i = timeline->getCompositionsCount(); i < count; ++i) {
+            int cid = CompositionModel::construct(timeline, aCompo);
+            REQUIRE(timeline->requestCompositionMove(cid, tracks[1 + (size_t)i % 4], 10 * i, false, false));
+        }
+        int cid = CompositionModel::construct(timeline, aCompo);
+        REQUIRE(timeline->requestCompositionMove(cid, tracks[1], 10 * count, false, false));
+        REQUIRE(timeline->checkConsistency());
+
+        const std::string name = QStringLiteral("Move one composition between tracks among %1").arg(count).toStdString();
+        BENCHMARK(name)
+        {
+            REQUIRE(timeline->requestCompositionMove(cid, tracks[3], 10 * count, false, false));
+            REQUIRE(timeline->requestCompositionMove(cid, tracks[1], 10 * count, false, false));
+        }
+        REQUIRE(timeline->checkConsistency());
+    }
+}
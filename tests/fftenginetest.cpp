@@ -0,0 +1,147 @@
+#include "catch.hpp"
+#include "lib/audio/fftEngine.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+// Interleaved stereo samples, a sine of the given frequency (in bins of windowSize) on the first channel and noise on the second one
+std::vector<qint16> makeSamples(int samples, int windowSize, double bin)
+{
+    std::vector<qint16> data((size_t)samples * 2);
+    std::default_random_engine g(42);
+    std::uniform_int_distribution<int> noise(-2000, 2000);
+    for (int i = 0; i < samples; ++i) {
+        data[(size_t)i * 2] = (qint16)std::lround(16000. * std::sin(2. * M_PI * bin * i / windowSize));
+        data[(size_t)i * 2 + 1] = (qint16)noise(g);
+    }
+    return data;
+}
+
+// The computation done by FFTTools::fftNormalized before it used the engine
+std::vector<float> referenceSpectrum(const qint16 *samples, int numSamples, int channel, int numChannels, int windowSize,
+                                     FFTTools::WindowType windowType, float param)
+{
+    const QVector<float> window = FFTTools::window(windowType, windowSize, param);
+    std::vector<float> data((size_t)windowSize, 0.f);
+    for (int i = 0; i < numSamples && i < windowSize; ++i) {
+        data[(size_t)i] = (float)samples[i * numChannels + channel] / 32767.0f * window[i];
+    }
+    std::vector<kiss_fft_cpx> freqData((size_t)windowSize / 2 + 1);
+    kiss_fftr_cfg cfg = kiss_fftr_alloc(windowSize, 0, nullptr, nullptr);
+    kiss_fftr(cfg, data.data(), freqData.data());
+    kiss_fftr_free(cfg);
+    const float windowScaleFactor = 1.f / window[windowSize];
+    std::vector<float> spectrum((size_t)windowSize / 2);
+    for (size_t i = 0; i < spectrum.size(); ++i) {
+        spectrum[i] = float(20 * log(pow(pow(fabs(freqData[i].r * windowScaleFactor), 2) + pow(fabs(freqData[i].i * windowScaleFactor), 2), .5) /
+                                     ((float)windowSize / 2.0f)) /
+                            log(10));
+    }
+    return spectrum;
+}
+} // namespace
+
+TEST_CASE("FFT engine", "[FFT]")
+{
+    FFTEngine engine;
+    const int windowSize = 1024;
+    const int numSamples = 4000;
+    const std::vector<qint16> samples = makeSamples(numSamples, windowSize, 64);
+
+    SECTION("Window count")
+    {
+        REQUIRE(FFTEngine::windowCount(100, 1024, 512) == 1);
+        REQUIRE(FFTEngine::windowCount(1024, 1024, 512) == 1);
+        REQUIRE(FFTEngine::windowCount(1025, 1024, 512) == 2);
+        REQUIRE(FFTEngine::windowCount(4000, 1024, 512) == 7);
+    }
+
+    SECTION("Sine peak")
+    {
+        for (auto windowType : {FFTTools::Window_Rect, FFTTools::Window_Triangle, FFTTools::Window_Hamming}) {
+            std::vector<float> spectrum((size_t)windowSize / 2);
+            engine.spectra(samples.data(), numSamples, 0, 2, windowSize, windowSize, 1, windowType, 0, spectrum.data());
+            REQUIRE(std::max_element(spectrum.begin(), spectrum.end()) - spectrum.begin() == 64);
+            // A sine of half the full scale is about 6 dB below the maximum
+            REQUIRE(std::abs(spectrum[64] + 6.2f) < 0.5f);
+        }
+    }
+
+    SECTION("Same values as before")
+    {
+        for (auto windowType : {FFTTools::Window_Rect, FFTTools::Window_Triangle, FFTTools::Window_Hamming}) {
+            for (int channel : {0, 1}) {
+                // Also with less samples than the window size
+                for (int count : {numSamples, 700}) {
+                    std::vector<float> spectrum((size_t)windowSize / 2);
+                    engine.spectra(samples.data(), count, channel, 2, windowSize, windowSize, 1, windowType, 0.2f, spectrum.data());
+                    const std::vector<float> reference = referenceSpectrum(samples.data(), count, channel, 2, windowSize, windowType, 0.2f);
+                    for (size_t i = 0; i < spectrum.size(); ++i) {
+                        REQUIRE(spectrum[i] == Approx(reference[i]).margin(0.01));
+                    }
+                }
+            }
+        }
+    }
+
+    SECTION("Batched windows")
+    {
+        const int hop = windowSize / 2;
+        const int count = FFTEngine::windowCount(numSamples, windowSize, hop);
+        std::vector<float> batch((size_t)(count * windowSize / 2));
+        engine.spectra(samples.data(), numSamples, 1, 2, windowSize, hop, count, FFTTools::Window_Hamming, 0, batch.data());
+        std::vector<float> peak((size_t)windowSize / 2, -1000.f);
+        for (int w = 0; w < count; ++w) {
+            std::vector<float> single((size_t)windowSize / 2);
+            engine.spectra(samples.data() + w * hop * 2, numSamples - w * hop, 1, 2, windowSize, windowSize, 1, FFTTools::Window_Hamming, 0, single.data());
+            for (size_t i = 0; i < single.size(); ++i) {
+                REQUIRE(batch[(size_t)w * single.size() + i] == single[i]);
+                peak[i] = std::max(peak[i], single[i]);
+            }
+        }
+        std::vector<float> peakSpectrum((size_t)windowSize / 2);
+        engine.peakSpectrum(samples.data(), numSamples, 1, 2, windowSize, FFTTools::Window_Hamming, 0, peakSpectrum.data());
+        REQUIRE(peakSpectrum == peak);
+    }
+
+    SECTION("FFTTools")
+    {
+        FFTTools tools;
+        audioShortVector frame(numSamples * 2);
+        std::copy(samples.begin(), samples.end(), frame.begin());
+        std::vector<float> spectrum((size_t)windowSize / 2);
+        std::vector<float> expected((size_t)windowSize / 2);
+        tools.fftNormalized(frame, 0, 2, spectrum.data(), FFTTools::Window_Triangle, windowSize, 0);
+        engine.spectra(samples.data(), numSamples, 0, 2, windowSize, windowSize, 1, FFTTools::Window_Triangle, 0, expected.data());
+        REQUIRE(spectrum == expected);
+    }
+}
+
+TEST_CASE("FFT of audio frames", "[.][benchmark][FFT]")
+{
+    const int numSamples = 16384;
+    const std::vector<qint16> samples = makeSamples(numSamples, 1024, 64.5);
+    FFTEngine engine;
+    FFTTools tools;
+    audioShortVector frame(numSamples * 2);
+    std::copy(samples.begin(), samples.end(), frame.begin());
+    std::vector<float> spectrum(numSamples / 2);
+
+    for (int windowSize : {1024, 2048, 4096, 8192, 16384}) {
+        BENCHMARK("Single window of " + std::to_string(windowSize))
+        {
+            tools.fftNormalized(frame, 0, 2, spectrum.data(), FFTTools::Window_Hamming, (uint)windowSize, 0);
+        }
+        BENCHMARK("Peak spectrum of " + std::to_string(windowSize))
+        {
+            engine.peakSpectrum(samples.data(), numSamples, 0, 2, windowSize, FFTTools::Window_Hamming, 0, spectrum.data());
+        }
+        BENCHMARK("Previous implementation with " + std::to_string(windowSize))
+        {
+            referenceSpectrum(samples.data(), numSamples, 0, 2, windowSize, FFTTools::Window_Hamming, 0);
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#include "test_utils.hpp"
+#include "utils/filehashcache.hpp"
+#include <QCryptographicHash>
+#include <QFile>
+
+TEST_CASE("File hash cache", "[FileHashCache]")
+{
+    TemporaryFolder tmp;
+    const QDir &folder = tmp.folder;
+    const QString cacheFile = folder.absoluteFilePath(QStringLiteral("hashes"));
+
+    SECTION("Small files are hashed entirely")
+    {
+        const QByteArray content(1000, 'a');
+        const QString path = writeFile(folder, QStringLiteral("small"), content);
+        FileHashCache cache(cacheFile);
+        REQUIRE_FALSE(cache.contains(path));
+        qint64 size = 0;
+        const QString hash = cache.hash(path, &size);
+        REQUIRE(size == 1000);
+        REQUIRE(hash == QString::fromLatin1(QCryptographicHash::hash(content, QCryptographicHash::Md5).toHex()));
+        REQUIRE(hash == FileHashCache::computeHash(path));
+        REQUIRE(cache.contains(path));
+    }
+
+    SECTION("Large files are hashed from their first and last blocks")
+    {
+        QByteArray content(3000000, 'b');
+        const QString path = writeFile(folder, QStringLiteral("large"), content);
+        const QString hash = FileHashCache::computeHash(path);
+        content[1500000] = 'c';
+        writeFile(folder, QStringLiteral("large2"), content);
+        REQUIRE(FileHashCache::computeHash(folder.absoluteFilePath(QStringLiteral("large2"))) == hash);
+        content[0] = 'c';
+        writeFile(folder, QStringLiteral("large3"), content);
+        REQUIRE(FileHashCache::computeHash(folder.absoluteFilePath(QStringLiteral("large3"))) != hash);
+    }
+
+    SECTION("Modified files are hashed again")
+    {
+        const QString path = writeFile(folder, QStringLiteral("file"), QByteArray(100, 'a'));
+        FileHashCache cache(cacheFile);
+        const QString hash = cache.hash(path);
+        writeFile(folder, QStringLiteral("file"), QByteArray(200, 'a'));
+        REQUIRE_FALSE(cache.contains(path));
+        const QString newHash = cache.hash(path);
+        REQUIRE(newHash != hash);
+        REQUIRE(newHash == FileHashCache::computeHash(path));
+    }
+
+    SECTION("Missing files have no hash")
+    {
+        FileHashCache cache(cacheFile);
+        REQUIRE(cache.hash(folder.absoluteFilePath(QStringLiteral("missing"))).isEmpty());
+        REQUIRE_FALSE(cache.contains(folder.absoluteFilePath(QStringLiteral("missing"))));
+    }
+
+    SECTION("Hashes are kept in the cache file")
+    {
+        const QString path = writeFile(folder, QStringLiteral("file"), QByteArray(100, 'a'));
+        QString hash;
+        {
+            FileHashCache cache(cacheFile);
+            hash = cache.hash(path);
+            cache.save();
+        }
+        REQUIRE(QFile::exists(cacheFile));
+        FileHashCache cache(cacheFile);
+        REQUIRE(cache.contains(path));
+        REQUIRE(cache.hash(path) == hash);
+    }
+
+    SECTION("An invalid cache file is ignored")
+    {
+        writeFile(folder, QStringLiteral("hashes"), QByteArray("garbage"));
+        const QString path = writeFile(folder, QStringLiteral("file"), QByteArray(100, 'a'));
+        FileHashCache cache(cacheFile);
+        REQUIRE_FALSE(cache.contains(path));
+        REQUIRE(cache.hash(path) == FileHashCache::computeHash(path));
+    }
+}
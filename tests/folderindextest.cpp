@@ -0,0 +1,49 @@
+#include "test_utils.hpp"
+#include "utils/folderindex.hpp"
+
+TEST_CASE("Folder index", "[FolderIndex]")
+{
+    TemporaryFolder tmp;
+    const QDir &folder = tmp.folder;
+    writeFile(folder, QStringLiteral("clip.mp4"), QByteArray(10, 'x'));
+    writeFile(folder, QStringLiteral("b/clip.mp4"), QByteArray(20, 'x'));
+    writeFile(folder, QStringLiteral("a/deep/clip.mp4"), QByteArray(30, 'x'));
+    writeFile(folder, QStringLiteral("a/image-001.png"), QByteArray(20, 'x'));
+    writeFile(folder, QStringLiteral("a/image-002.png"), QByteArray(20, 'x'));
+
+    FolderIndex index(folder.absolutePath());
+    std::atomic<bool> cancel(false);
+    int walked = 0;
+    int total = 0;
+    REQUIRE(index.build(cancel, [&](int done, int count) {
+        walked = done;
+        total = count;
+    }));
+    REQUIRE(total == 2);
+    REQUIRE(walked == 2);
+    REQUIRE(index.count() == 5);
+
+    SECTION("Files are found by name, closest to the root first")
+    {
+        const QStringList clips = index.byName(QStringLiteral("clip.mp4"));
+        REQUIRE(clips == QStringList({folder.absoluteFilePath(QStringLiteral("clip.mp4")), folder.absoluteFilePath(QStringLiteral("b/clip.mp4")),
+                                      folder.absoluteFilePath(QStringLiteral("a/deep/clip.mp4"))}));
+        REQUIRE(index.byName(QStringLiteral("missing.mp4")).isEmpty());
+    }
+
+    SECTION("Files are found by size and prefix")
+    {
+        REQUIRE(index.bySize(30) == QStringList({folder.absoluteFilePath(QStringLiteral("a/deep/clip.mp4"))}));
+        REQUIRE(index.bySize(20).size() == 3);
+        REQUIRE(index.bySize(40).isEmpty());
+        REQUIRE(index.byPrefix(QStringLiteral("image-")) ==
+                QStringList({folder.absoluteFilePath(QStringLiteral("a/image-001.png")), folder.absoluteFilePath(QStringLiteral("a/image-002.png"))}));
+    }
+
+    SECTION("A cancelled walk leaves the index empty")
+    {
+        cancel = true;
+        REQUIRE_FALSE(index.build(cancel));
+        REQUIRE(index.count() == 0);
+    }
+}
@@ -0,0 +1,94 @@
+#include "catch.hpp"
+#include "jobs/jobscheduler.hpp"
+#include <QMutex>
+#include <QSemaphore>
+#include <QThread>
+#include <atomic>
+#include <vector>
+
+TEST_CASE("Job scheduler", "[JobScheduler]")
+{
+    JobScheduler scheduler;
+    scheduler.setLimit(JobScheduler::Resource::CpuBound, 1);
+    QSemaphore release;
+    QSemaphore started;
+    // Occupies the only CPU slot until released, so that the following tasks are queued
+    auto blocker = [&]() {
+        started.release();
+        release.acquire();
+    };
+    QMutex orderMutex;
+    std::vector<int> order;
+    auto record = [&](int value) {
+        return [&, value]() {
+            QMutexLocker locker(&orderMutex);
+            order.push_back(value);
+        };
+    };
+
+    SECTION("Tasks are run by priority, then in submission order")
+    {
+        scheduler.submit(0, JobScheduler::Resource::CpuBound, 0, blocker);
+        started.acquire();
+        scheduler.submit(1, JobScheduler::Resource::CpuBound, 0, record(1));
+        scheduler.submit(2, JobScheduler::Resource::CpuBound, 5, record(2));
+        scheduler.submit(3, JobScheduler::Resource::CpuBound, 0, record(3));
+        scheduler.submit(4, JobScheduler::Resource::CpuBound, 2, record(4));
+        REQUIRE(scheduler.metrics(JobScheduler::Resource::CpuBound).queued == 4);
+        REQUIRE(scheduler.metrics(JobScheduler::Resource::CpuBound).running == 1);
+        release.release();
+        REQUIRE(scheduler.waitForDone(10000));
+        REQUIRE(order == std::vector<int>{2, 4, 1, 3});
+        JobScheduler::Metrics metrics = scheduler.metrics(JobScheduler::Resource::CpuBound);
+        REQUIRE(metrics.queued == 0);
+        REQUIRE(metrics.running == 0);
+        REQUIRE(metrics.started == 5);
+        REQUIRE(metrics.maxWait >= metrics.averageWait());
+    }
+
+    SECTION("Pending tasks can be canceled or reprioritized")
+    {
+        scheduler.submit(0, JobScheduler::Resource::CpuBound, 0, blocker);
+        started.acquire();
+        scheduler.submit(1, JobScheduler::Resource::CpuBound, 1, record(1));
+        scheduler.submit(2, JobScheduler::Resource::CpuBound, 1, record(2));
+        scheduler.submit(2, JobScheduler::Resource::CpuBound, 1, record(3));
+        scheduler.submit(3, JobScheduler::Resource::CpuBound, 0, record(4));
+        scheduler.submit(4, JobScheduler::Resource::CpuBound, 0, record(5));
+        REQUIRE(scheduler.cancel(2) == 2);
+        REQUIRE(scheduler.cancel(2) == 0);
+        scheduler.setPriority(4, 3);
+        release.release();
+        REQUIRE(scheduler.waitForDone(10000));
+        REQUIRE(order == std::vector<int>{5, 1, 4});
+    }
+
+    SECTION("Each resource has its own limit")
+    {
+        // A blocked CPU task does not prevent IO tasks to run
+        scheduler.submit(0, JobScheduler::Resource::CpuBound, 0, blocker);
+        started.acquire();
+        scheduler.setLimit(JobScheduler::Resource::IoBound, 2);
+        std::atomic<int> running{0};
+        std::atomic<int> maxRunning{0};
+        for (int i = 0; i < 20; ++i) {
+            scheduler.submit(i + 1, JobScheduler::Resource::IoBound, 0, [&]() {
+                int current = ++running;
+                int previous = maxRunning;
+                while (current > previous && !maxRunning.compare_exchange_weak(previous, current)) {
+                }
+                QThread::msleep(2);
+                --running;
+            });
+        }
+        while (scheduler.metrics(JobScheduler::Resource::IoBound).started < 20 || scheduler.metrics(JobScheduler::Resource::IoBound).running > 0) {
+            QThread::msleep(1);
+        }
+        REQUIRE(maxRunning <= 2);
+        REQUIRE(maxRunning >= 1);
+        REQUIRE(scheduler.metrics(JobScheduler::Resource::CpuBound).running == 1);
+        release.release();
+        REQUIRE(scheduler.waitForDone(10000));
+        REQUIRE(scheduler.metrics().started == 21);
+    }
+}
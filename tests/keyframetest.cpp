@@ -1,5 +1,6 @@
 #include <memory>
 
+#include "assets/keyframes/model/keyframecurve.hpp"
 #include "test_utils.hpp"
 
 using namespace fakeit;
@@ -251,6 +252,99 @@ TEST_CASE("Keyframe model", "[KeyframeModel]")
         undoStack->undo();
         state1(6.1);
     }
+
+    SECTION("Interpolation matches MLT")
+    {
+        REQUIRE(model->addKeyframe(GenTime(1.), KeyframeType::Curve, 80));
+        REQUIRE(model->addKeyframe(GenTime(2.), KeyframeType::Discrete, 20));
+        REQUIRE(model->addKeyframe(GenTime(3.), KeyframeType::Curve, 60));
+        REQUIRE(model->addKeyframe(GenTime(3.6), KeyframeType::Linear, 10));
+        Mlt::Properties props;
+        props.set("key", model->getAnimProperty().toUtf8().constData());
+        std::vector<double> values;
+        model->getInterpolatedValues(-10, 120, values);
+        REQUIRE(values.size() == 120);
+        for (int frame = -10; frame < 110; ++frame) {
+            double expected = props.anim_get_double("key", qMax(0, frame), 110);
+            REQUIRE(model->getInterpolatedValue(frame).toDouble() == Approx(expected));
+            REQUIRE(values[size_t(frame + 10)] == Approx(expected));
+        }
+
+        // The curve follows the keyframe changes
+        REQUIRE(model->updateKeyframe(GenTime(2.), QVariant(40)));
+        REQUIRE(model->getInterpolatedValue(60).toDouble() == Approx(40));
+        undoStack->undo();
+        REQUIRE(model->getInterpolatedValue(60).toDouble() == Approx(20));
+    }
     pCore->m_projectManager = nullptr;
     Logger::print_trace();
 }
+
+TEST_CASE("Keyframe curve", "[KeyframeModel]")
+{
+    KeyframeCurve curve;
+    REQUIRE(curve.isEmpty());
+    REQUIRE(curve.evaluate(10) == 0.);
+
+    // A rectangle with its opacity, linear then constant
+    curve.build({0, 10, 20}, {mlt_keyframe_linear, mlt_keyframe_discrete, mlt_keyframe_linear}, {0, 0, 100, 100, 1, 50, 50, 200, 200, 0.5, 0, 0, 0, 0, 0}, 5);
+    REQUIRE(curve.dimension() == 5);
+    double rect[5];
+    curve.evaluate(5, rect);
+    REQUIRE(rect[0] == Approx(25));
+    REQUIRE(rect[2] == Approx(150));
+    REQUIRE(rect[4] == Approx(0.75));
+    curve.evaluate(19, rect);
+    REQUIRE(rect[1] == Approx(50));
+    REQUIRE(curve.evaluate(20, 3) == Approx(0));
+    REQUIRE(curve.evaluate(-5, 2) == Approx(100));
+    REQUIRE(curve.evaluate(500, 4) == Approx(0));
+
+    std::vector<double> range(30);
+    curve.evaluateRange(-5, 30, 0, range.data());
+    for (int i = 0; i < 30; ++i) {
+        REQUIRE(range[size_t(i)] == curve.evaluate(i - 5, 0));
+    }
+}
+
+TEST_CASE("Keyframe interpolation", "[.][benchmark][KeyframeModel]")
+{
+    // A long animation, as produced by motion tracking
+    const int count = 2000;
+    std::vector<int> frames;
+    std::vector<mlt_keyframe_type> types;
+    std::vector<double> values;
+    QStringList anim;
+    for (int i = 0; i < count; ++i) {
+        frames.push_back(i * 5);
+        types.push_back(i % 2 ? mlt_keyframe_smooth : mlt_keyframe_linear);
+        values.push_back(i % 7);
+        anim << QStringLiteral("%1%2=%3").arg(i * 5).arg(i % 2 ? QStringLiteral("~") : QString()).arg(i % 7);
+    }
+    KeyframeCurve curve;
+    curve.build(frames, types, values, 1);
+    Mlt::Properties props;
+    props.set("key", anim.join(QLatin1Char(';')).toUtf8().constData());
+    std::vector<double> range((size_t)count * 5);
+
+    BENCHMARK("Curve, frame by frame")
+    {
+        double sum = 0;
+        for (int frame = 0; frame < count * 5; ++frame) {
+            sum += curve.evaluate(frame);
+        }
+        REQUIRE(sum > 0);
+    }
+    BENCHMARK("Curve, whole range")
+    {
+        curve.evaluateRange(0, count * 5, 0, range.data());
+    }
+    BENCHMARK("MLT animation")
+    {
+        double sum = 0;
+        for (int frame = 0; frame < count * 5; ++frame) {
+            sum += props.anim_get_double("key", frame, count * 5);
+        }
+        REQUIRE(sum > 0);
+    }
+}
@@ -0,0 +1,48 @@
+#include "test_utils.hpp"
+#include "utils/metadatacache.hpp"
+
+TEST_CASE("Metadata cache", "[MetadataCache]")
+{
+    TemporaryFolder tmp;
+    const QDir &folder = tmp.folder;
+    REQUIRE(folder.mkdir(QStringLiteral("assets")));
+    QDir assets(folder.absoluteFilePath(QStringLiteral("assets")));
+    writeFile(assets, QStringLiteral("first.xml"), QByteArray(100, 'a'));
+    const QStringList folders{assets.absolutePath()};
+    MetadataCache cache(folder.absoluteFilePath(QStringLiteral("assets.cache")));
+    const QByteArray payload(5000, 'p');
+    QByteArray result;
+
+    SECTION("Missing or invalid files are not read")
+    {
+        REQUIRE_FALSE(cache.read(MetadataCache::signature(folders), result));
+        writeFile(folder, QStringLiteral("assets.cache"), QByteArray(10, 'x'));
+        REQUIRE_FALSE(cache.read(MetadataCache::signature(folders), result));
+    }
+
+    SECTION("Data is read back while the signature matches")
+    {
+        const QByteArray signature = MetadataCache::signature(folders, {QStringLiteral("key")});
+        REQUIRE(signature == MetadataCache::signature(folders, {QStringLiteral("key")}));
+        REQUIRE(cache.write(signature, payload));
+        REQUIRE(cache.read(signature, result));
+        REQUIRE(result == payload);
+        REQUIRE_FALSE(cache.read(MetadataCache::signature(folders, {QStringLiteral("other")}), result));
+        REQUIRE_FALSE(cache.read(MetadataCache::signature(folders), result));
+    }
+
+    SECTION("Changes in the folders invalidate the signature")
+    {
+        const QByteArray signature = MetadataCache::signature(folders);
+        REQUIRE(cache.write(signature, payload));
+        writeFile(assets, QStringLiteral("first.xml"), QByteArray(200, 'a'));
+        const QByteArray modified = MetadataCache::signature(folders);
+        REQUIRE(modified != signature);
+        REQUIRE_FALSE(cache.read(modified, result));
+        writeFile(assets, QStringLiteral("second.xml"), QByteArray(100, 'a'));
+        REQUIRE(MetadataCache::signature(folders) != modified);
+        REQUIRE(cache.write(MetadataCache::signature(folders), payload));
+        REQUIRE(cache.read(MetadataCache::signature(folders), result));
+        REQUIRE(result == payload);
+    }
+}
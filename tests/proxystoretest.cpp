@@ -0,0 +1,119 @@
+#include "test_utils.hpp"
+#include "utils/proxystore.hpp"
+#include <QFile>
+#include <QLockFile>
+#include <QThread>
+#include <QThreadPool>
+
+namespace {
+QString writeProxy(const QDir &folder, const QString &name, int size)
+{
+    return writeFile(folder, name, QByteArray(size, 'x'));
+}
+} // namespace
+
+TEST_CASE("Proxy store", "[ProxyStore]")
+{
+    TemporaryFolder tmp;
+    const QDir &folder = tmp.folder;
+
+    SECTION("Proxy names depend on the clip and the parameters")
+    {
+        const QString name = ProxyStore::proxyName(QStringLiteral("abc"), QStringLiteral("-vf scale=640:-1"), QStringLiteral(".mkv"));
+        REQUIRE(name.startsWith(QStringLiteral("abc-")));
+        REQUIRE(name.endsWith(QStringLiteral(".mkv")));
+        REQUIRE(name == ProxyStore::proxyName(QStringLiteral("abc"), QStringLiteral(" -vf  scale=640:-1 "), QStringLiteral(".mkv")));
+        REQUIRE(name != ProxyStore::proxyName(QStringLiteral("abc"), QStringLiteral("-vf scale=960:-1"), QStringLiteral(".mkv")));
+        REQUIRE(name != ProxyStore::proxyName(QStringLiteral("abd"), QStringLiteral("-vf scale=640:-1"), QStringLiteral(".mkv")));
+    }
+
+    SECTION("References are shared between documents and persist")
+    {
+        const QString proxy = writeProxy(folder, QStringLiteral("abc-1.mkv"), 1000);
+        {
+            ProxyStore store(folder, 1024 * 1024);
+            REQUIRE(store.contains(proxy));
+            REQUIRE_FALSE(store.contains(QStringLiteral("/elsewhere/abc-1.mkv")));
+            REQUIRE(store.addReference(proxy, QStringLiteral("1")));
+            REQUIRE(store.addReference(proxy, QStringLiteral("2")));
+            // Adding a reference twice has no effect
+            REQUIRE(store.addReference(proxy, QStringLiteral("2")));
+            REQUIRE(store.size() == 1000);
+        }
+        ProxyStore store(folder, 1024 * 1024);
+        REQUIRE(store.references(proxy).size() == 2);
+        REQUIRE(store.sharedProxies(QStringLiteral("1")) == QStringList{QStringLiteral("abc-1.mkv")});
+        REQUIRE(store.sharedProxies(QStringLiteral("3")).isEmpty());
+        REQUIRE(store.removeReference(proxy, QStringLiteral("1")) == 1);
+        REQUIRE(store.sharedProxies(QStringLiteral("2")).isEmpty());
+        REQUIRE(store.removeReference(proxy, QStringLiteral("2")) == 0);
+        // Unreferenced proxies are kept while the store is not full
+        REQUIRE(QFile::exists(proxy));
+    }
+
+    SECTION("A document replaces its references")
+    {
+        const QString first = writeProxy(folder, QStringLiteral("abc-1.mkv"), 10);
+        const QString second = writeProxy(folder, QStringLiteral("def-1.mkv"), 10);
+        ProxyStore store(folder, 1024 * 1024);
+        REQUIRE(store.setReferences(QStringLiteral("1"), {first, second}));
+        REQUIRE(store.references(first) == QStringList{QStringLiteral("1")});
+        REQUIRE(store.setReferences(QStringLiteral("1"), {second}));
+        REQUIRE(store.references(first).isEmpty());
+        REQUIRE(store.references(second) == QStringList{QStringLiteral("1")});
+    }
+
+    SECTION("Only unreferenced proxies are evicted, oldest first")
+    {
+        const QString used = writeProxy(folder, QStringLiteral("used-1.mkv"), 400);
+        const QString oldest = writeProxy(folder, QStringLiteral("old-1.mkv"), 400);
+        const QString recent = writeProxy(folder, QStringLiteral("recent-1.mkv"), 400);
+        ProxyStore store(folder, 1000);
+        REQUIRE(store.addReference(used, QStringLiteral("1")));
+        REQUIRE(store.addReference(oldest, QStringLiteral("2")));
+        REQUIRE(store.removeReference(oldest, QStringLiteral("2")) == 0);
+        REQUIRE(store.addReference(recent, QStringLiteral("3")));
+        // Only the unreferenced proxies count in the limit
+        REQUIRE(QFile::exists(oldest));
+        REQUIRE(store.size() == 1200);
+        const QString other = writeProxy(folder, QStringLiteral("other-1.mkv"), 700);
+        REQUIRE(store.addReference(other, QStringLiteral("4")));
+        // Make sure that the last use times differ
+        QThread::msleep(10);
+        REQUIRE(store.removeReference(other, QStringLiteral("4")) == 0);
+        // The unreferenced proxies are now too big, the oldest one is dropped
+        REQUIRE_FALSE(QFile::exists(oldest));
+        REQUIRE(QFile::exists(other));
+        REQUIRE(QFile::exists(used));
+        REQUIRE(QFile::exists(recent));
+        REQUIRE(store.size() == 1500);
+
+        // A proxy deleted from the disk is dropped from the index
+        QFile::remove(recent);
+        REQUIRE(store.references(recent).isEmpty());
+        REQUIRE(store.size() == 1100);
+    }
+
+    SECTION("The documents using a proxy missing from the index are unknown")
+    {
+        const QString proxy = writeProxy(folder, QStringLiteral("abc-1.mkv"), 10);
+        ProxyStore store(folder, 1024 * 1024);
+        REQUIRE(store.removeReference(proxy, QStringLiteral("1")) == -1);
+        // Files outside of the store are not shared
+        REQUIRE(store.removeReference(QStringLiteral("/elsewhere/abc-1.mkv"), QStringLiteral("1")) == 0);
+    }
+
+    SECTION("The index locked by another instance")
+    {
+        const QString proxy = writeProxy(folder, QStringLiteral("abc-1.mkv"), 10);
+        QLockFile lock(folder.absoluteFilePath(QStringLiteral("proxies.lock")));
+        REQUIRE(lock.tryLock());
+        // Without waiting, the update is done in a thread once the lock is released
+        ProxyStore store(folder, 1024 * 1024, ProxyStore::LockMode::NoWait);
+        REQUIRE(store.addReference(proxy, QStringLiteral("1")));
+        REQUIRE(store.removeReference(proxy, QStringLiteral("2")) == -1);
+        lock.unlock();
+        QThreadPool::globalInstance()->waitForDone();
+        REQUIRE(store.references(proxy) == QStringList{QStringLiteral("1")});
+    }
+}
@@ -0,0 +1,121 @@
+#include "catch.hpp"
+#include "utils/renderscheduler.hpp"
+#include <QTemporaryFile>
+
+using Job = RenderScheduler::Job;
+
+TEST_CASE("Render scheduler", "[RenderScheduler]")
+{
+    RenderScheduler scheduler(32);
+    REQUIRE(scheduler.cores() == 32);
+
+    SECTION("Job cost")
+    {
+        REQUIRE(scheduler.cost(1, 1) == 2);
+        REQUIRE(scheduler.cost(4, -4) == 8);
+        // Automatic encoder threads are capped
+        REQUIRE(scheduler.cost(0, 1) == 9);
+        REQUIRE(scheduler.cost(64, 1) == 32);
+        REQUIRE(RenderScheduler(4).cost(0, 1) == 4);
+    }
+
+    SECTION("Jobs started while they fit")
+    {
+        std::vector<Job> jobs(10, Job{RenderScheduler::Waiting, 8, -1});
+        REQUIRE(scheduler.jobsToStart(jobs) == std::vector<int>({0, 1, 2, 3}));
+        jobs[0].state = RenderScheduler::Running;
+        jobs[1].state = RenderScheduler::Running;
+        jobs[2].state = RenderScheduler::Done;
+        REQUIRE(scheduler.jobsToStart(jobs) == std::vector<int>({3, 4}));
+        // Jobs are started in order, a smaller job does not overtake a waiting one
+        jobs[3].state = RenderScheduler::Running;
+        jobs[4].cost = 20;
+        jobs[5].cost = 1;
+        REQUIRE(scheduler.jobsToStart(jobs).empty());
+    }
+
+    SECTION("A job larger than the machine still runs alone")
+    {
+        std::vector<Job> jobs{{RenderScheduler::Waiting, 64, -1}, {RenderScheduler::Waiting, 1, -1}};
+        REQUIRE(scheduler.jobsToStart(jobs) == std::vector<int>({0}));
+        jobs[0].state = RenderScheduler::Running;
+        REQUIRE(scheduler.jobsToStart(jobs).empty());
+    }
+
+    SECTION("Second pass waits for the first one")
+    {
+        std::vector<Job> jobs{{RenderScheduler::Waiting, 4, -1}, {RenderScheduler::Waiting, 4, 0}, {RenderScheduler::Waiting, 4, -1}};
+        REQUIRE(scheduler.jobsToStart(jobs) == std::vector<int>({0, 2}));
+        jobs[0].state = RenderScheduler::Running;
+        jobs[2].state = RenderScheduler::Running;
+        REQUIRE(scheduler.jobsToStart(jobs).empty());
+        jobs[0].state = RenderScheduler::Done;
+        REQUIRE(scheduler.jobsToStart(jobs) == std::vector<int>({1}));
+    }
+
+    SECTION("Segments")
+    {
+        REQUIRE(scheduler.segmentWorkers(9) == 3);
+        REQUIRE(scheduler.segmentWorkers(40) == 1);
+        REQUIRE(RenderScheduler::segmentBoundaries(0, 9999, {}, 0, 4) == std::vector<int>({0, 2500, 5000, 7500}));
+        // Cuts aligned on the keyframe interval
+        REQUIRE(RenderScheduler::segmentBoundaries(0, 9999, {}, 240, 4) == std::vector<int>({0, 2400, 5040, 7440}));
+        REQUIRE(RenderScheduler::segmentBoundaries(100, 10099, {}, 240, 4) == std::vector<int>({100, 2500, 5140, 7540}));
+        // Cuts moved to the close guides
+        REQUIRE(RenderScheduler::segmentBoundaries(0, 9999, {2450, 5600}, 0, 4) == std::vector<int>({0, 2450, 5600, 7500}));
+        // Short ranges are not split in too small segments
+        REQUIRE(RenderScheduler::segmentBoundaries(100, 399, {}, 0, 8) == std::vector<int>({100}));
+        REQUIRE(RenderScheduler::segmentBoundaries(0, 999, {}, 0, 8) == std::vector<int>({0, 250, 500, 750}));
+    }
+
+    SECTION("Smart render segments")
+    {
+        auto plan = [](int in, int out, const std::vector<int> &chunks, int maxLength) {
+            QStringList segments;
+            for (const RenderScheduler::Segment &segment : RenderScheduler::smartSegments(in, out, chunks, 25, maxLength)) {
+                segments << QString::number(segment.start) + (segment.cached ? QStringLiteral("c") : QString());
+            }
+            return segments.join(QLatin1Char(','));
+        };
+        // Chunks outside of the range or overlapping its end are rendered again, long gaps are split
+        REQUIRE(plan(0, 299, {100, 25, 50, 275, -25, 290}, 100) == QStringLiteral("0,25c,50c,75,100c,125,200,275c"));
+        REQUIRE(plan(0, 999, {}, 250) == QStringLiteral("0,250,500,750"));
+        REQUIRE(plan(10, 59, {0, 25}, 250) == QStringLiteral("10,25c,50"));
+        REQUIRE(plan(0, 49, {0, 25}, 250) == QStringLiteral("0c,25c"));
+    }
+
+    SECTION("Preview encoding compatibility")
+    {
+        const QStringList preview{QStringLiteral("f=matroska"), QStringLiteral("vcodec=libx264"), QStringLiteral("crf=20"), QStringLiteral("an=1"),
+                                  QStringLiteral("glsl.=1")};
+        QMap<QString, QString> render{{QStringLiteral("mlt_service"), QStringLiteral("avformat")},
+                                      {QStringLiteral("target"), QStringLiteral("/tmp/render.mp4")},
+                                      {QStringLiteral("in"), QStringLiteral("0")},
+                                      {QStringLiteral("out"), QStringLiteral("99")},
+                                      {QStringLiteral("f"), QStringLiteral("mp4")},
+                                      {QStringLiteral("vcodec"), QStringLiteral("libx264")},
+                                      {QStringLiteral("crf"), QStringLiteral("20")},
+                                      {QStringLiteral("acodec"), QStringLiteral("aac")},
+                                      {QStringLiteral("ab"), QStringLiteral("160k")},
+                                      {QStringLiteral("threads"), QStringLiteral("0")},
+                                      {QStringLiteral("real_time"), QStringLiteral("-4")},
+                                      {QStringLiteral("meta.attr.title.markup"), QStringLiteral("Title")}};
+        REQUIRE(RenderScheduler::sameVideoEncoding(preview, render));
+        REQUIRE_FALSE(RenderScheduler::sameVideoEncoding({QStringLiteral("an=1")}, render));
+        render.insert(QStringLiteral("crf"), QStringLiteral("23"));
+        REQUIRE_FALSE(RenderScheduler::sameVideoEncoding(preview, render));
+        render.insert(QStringLiteral("crf"), QStringLiteral("20"));
+        render.insert(QStringLiteral("s"), QStringLiteral("1280x720"));
+        REQUIRE_FALSE(RenderScheduler::sameVideoEncoding(preview, render));
+    }
+
+    SECTION("Cost read from a render playlist")
+    {
+        QTemporaryFile playlist;
+        REQUIRE(playlist.open());
+        playlist.write("<mlt><profile/><consumer mlt_service=\"avformat\" threads=\"2\" real_time=\"-3\"/></mlt>");
+        playlist.close();
+        REQUIRE(scheduler.playlistCost(playlist.fileName()) == 5);
+        REQUIRE(scheduler.playlistCost(QStringLiteral("/nonexistent/playlist.mlt")) == scheduler.cost(0, 1));
+    }
+}
@@ -0,0 +1,147 @@
+#include "catch.hpp"
+#include "monitor/scopes/scopeframe.h"
+#include "scopes/colorscopes/histogramgenerator.h"
+#include "scopes/colorscopes/rgbparadegenerator.h"
+#include "scopes/colorscopes/scopekernels.h"
+#include "scopes/colorscopes/vectorscopegenerator.h"
+#include "scopes/colorscopes/waveformgenerator.h"
+#include <QImage>
+#include <mlt++/MltFrame.h>
+#include <mlt++/MltProducer.h>
+#include <mlt++/MltProfile.h>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+QImage syntheticFrame(int width, int height)
+{
+    QImage frame(width, height, QImage::Format_ARGB32);
+    std::default_random_engine g(42);
+    std::uniform_int_distribution<int> noise(0, 15);
+    for (int y = 0; y < height; ++y) {
+        auto *line = reinterpret_cast<QRgb *>(frame.scanLine(y));
+        for (int x = 0; x < width; ++x) {
+            line[x] = qRgb((x * 255 / width + noise(g)) & 0xff, (y * 255 / height) & 0xff, ((x + y) / 8 + noise(g)) & 0xff);
+        }
+    }
+    return frame;
+}
+} // namespace
+
+TEST_CASE("Scope kernels match their generic versions", "[Scopes]")
+{
+    std::default_random_engine g(42);
+    std::uniform_int_distribution<uint> pixel;
+    // Odd size, so that the generic version also handles the end of the line
+    std::vector<QRgb> pixels(1027);
+    for (auto &p : pixels) {
+        p = pixel(g);
+    }
+    pixels[0] = qRgb(255, 255, 255);
+    pixels[1] = qRgb(0, 0, 0);
+
+    for (bool rec709 : {false, true}) {
+        std::vector<uchar> luma(pixels.size());
+        std::vector<uchar> lumaGeneric(pixels.size());
+        ScopeKernels::computeLuma(pixels.data(), (int)pixels.size(), rec709, luma.data());
+        ScopeKernels::computeLumaGeneric(pixels.data(), (int)pixels.size(), rec709, lumaGeneric.data());
+        REQUIRE(luma == lumaGeneric);
+        REQUIRE(luma[0] == 255);
+        REQUIRE(luma[1] == 0);
+    }
+
+    const float coefficients[6] = {-0.0005781f, -0.001135f, 0.001713f, 0.002411f, -0.002019f, -0.0003921f};
+    std::vector<float> u(pixels.size()), v(pixels.size());
+    std::vector<float> uGeneric(pixels.size()), vGeneric(pixels.size());
+    ScopeKernels::computeChroma(pixels.data(), (int)pixels.size(), coefficients, u.data(), v.data());
+    ScopeKernels::computeChromaGeneric(pixels.data(), (int)pixels.size(), coefficients, uGeneric.data(), vGeneric.data());
+    REQUIRE(u == uGeneric);
+    REQUIRE(v == vGeneric);
+}
+
+TEST_CASE("Waveform of a black frame", "[Scopes]")
+{
+    QImage frame(640, 360, QImage::Format_ARGB32);
+    frame.fill(qRgb(0, 0, 0));
+    WaveformGenerator generator;
+    QImage wave = generator.calculateWaveform(QSize(200, 100), ScopeFrame(frame), WaveformGenerator::PaintMode_White, false, WaveformGenerator::Rec_709);
+    REQUIRE(wave.size() == QSize(200, 100));
+    for (int x = 0; x < wave.width(); ++x) {
+        // All the pixels are on the bottom line
+        REQUIRE(qAlpha(wave.pixel(x, 99)) == 255);
+        REQUIRE(qAlpha(wave.pixel(x, 0)) == 0);
+        REQUIRE(qAlpha(wave.pixel(x, 50)) == 0);
+    }
+}
+
+TEST_CASE("Luma read from the Y plane of a frame", "[Scopes]")
+{
+    Mlt::Profile profile;
+    Mlt::Producer producer(profile, "color", "0x808080ff");
+    REQUIRE(producer.is_valid());
+    std::unique_ptr<Mlt::Frame> mltFrame(producer.get_frame());
+    mlt_image_format format = mlt_image_yuv420p;
+    int width = profile.width();
+    int height = profile.height();
+    REQUIRE(mltFrame->get_image(format, width, height) != nullptr);
+    REQUIRE(format == mlt_image_yuv420p);
+
+    const ScopeFrame frame{SharedFrame(*mltFrame)};
+    REQUIRE(frame.isValid());
+    REQUIRE(frame.width() == width);
+    REQUIRE(frame.height() == height);
+    const bool rec709 = height >= 720;
+    REQUIRE(frame.hasLumaPlane(rec709));
+    REQUIRE_FALSE(frame.hasLumaPlane(!rec709));
+    REQUIRE_FALSE(ScopeFrame(QImage(width, height, QImage::Format_ARGB32)).hasLumaPlane(rec709));
+
+    // The luma of the Y plane, scaled to the full range, matches the one of the converted image
+    const QImage image = frame.image();
+    REQUIRE(image.size() == QSize(width, height));
+    std::vector<uchar> planeLuma((size_t)width);
+    std::vector<uchar> imageLuma((size_t)width);
+    for (int row : {0, height / 2, height - 1}) {
+        frame.lumaLine(row, planeLuma.data());
+        ScopeKernels::computeLuma(reinterpret_cast<const QRgb *>(image.constScanLine(row)), width, rec709, imageLuma.data());
+        for (int x = 0; x < width; ++x) {
+            REQUIRE(std::abs(planeLuma[(size_t)x] - 128) <= 2);
+            REQUIRE(std::abs(planeLuma[(size_t)x] - imageLuma[(size_t)x]) <= 1);
+        }
+    }
+
+    HistogramGenerator histogram;
+    const HistogramGenerator::Rec rec = rec709 ? HistogramGenerator::Rec_709 : HistogramGenerator::Rec_601;
+    REQUIRE_FALSE(histogram.calculateHistogram(QSize(256, 100), frame, HistogramGenerator::ComponentY, rec, false).isNull());
+}
+
+TEST_CASE("Colour scopes on UHD frames", "[.][benchmark][Scopes]")
+{
+    const QImage image = syntheticFrame(3840, 2160);
+    const ScopeFrame frame(image);
+    WaveformGenerator waveform;
+    RGBParadeGenerator parade;
+    VectorscopeGenerator vectorscope;
+    HistogramGenerator histogram;
+    const QSize size(720, 400);
+
+    BENCHMARK("Waveform")
+    {
+        REQUIRE_FALSE(waveform.calculateWaveform(size, frame, WaveformGenerator::PaintMode_Green, true, WaveformGenerator::Rec_709).isNull());
+    }
+    BENCHMARK("RGB parade")
+    {
+        REQUIRE_FALSE(parade.calculateRGBParade(size, image, RGBParadeGenerator::PaintMode_RGB, true, true).isNull());
+    }
+    BENCHMARK("Vectorscope")
+    {
+        REQUIRE_FALSE(
+            vectorscope.calculateVectorscope(size, image, 1, VectorscopeGenerator::PaintMode_Green2, VectorscopeGenerator::ColorSpace_YPbPr, true).isNull());
+    }
+    BENCHMARK("Histogram")
+    {
+        int components = HistogramGenerator::ComponentY | HistogramGenerator::ComponentR | HistogramGenerator::ComponentG | HistogramGenerator::ComponentB;
+        REQUIRE_FALSE(histogram.calculateHistogram(size, frame, components, HistogramGenerator::Rec_709, false).isNull());
+    }
+}
@@ -43,3 +43,20 @@ QString createProducerWithSound(Mlt::Profile &prof, std::shared_ptr<ProjectItemM
 
     return binId;
 }
+
+TemporaryFolder::TemporaryFolder()
+    : folder(dir.path())
+{
+    REQUIRE(dir.isValid());
+}
+
+QString writeFile(const QDir &folder, const QString &name, const QByteArray &content)
+{
+    const QString path = folder.absoluteFilePath(name);
+    REQUIRE(folder.mkpath(QFileInfo(path).absolutePath()));
+    QFile file(path);
+    REQUIRE(file.open(QIODevice::WriteOnly));
+    REQUIRE(file.write(content) == content.size());
+    file.close();
+    return path;
+}
@@ -3,6 +3,8 @@
 #include "bin/model/markerlistmodel.hpp"
 #include "catch.hpp"
 #include "doc/docundostack.hpp"
+#include <QDir>
+#include <QTemporaryDir>
 #include <iostream>
 #include <memory>
 #include <random>
@@ -86,3 +88,14 @@ using namespace fakeit;
 QString createProducer(Mlt::Profile &prof, std::string color, std::shared_ptr<ProjectItemModel> binModel, int length = 20, bool limited = true);
 
 QString createProducerWithSound(Mlt::Profile &prof, std::shared_ptr<ProjectItemModel> binModel);
+
+/* @brief An empty folder, removed at the end of the test */
+struct TemporaryFolder
+{
+    TemporaryFolder();
+    QTemporaryDir dir;
+    QDir folder;
+};
+
+/* @brief Writes a file, creating its parent folders, and returns its path. The test fails if the file cannot be written */
+QString writeFile(const QDir &folder, const QString &name, const QByteArray &content);
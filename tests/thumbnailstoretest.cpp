@@ -0,0 +1,104 @@
+#include "catch.hpp"
+#include "utils/thumbnailstore.hpp"
+#include <QTemporaryDir>
+
+namespace {
+QImage makeThumb(int seed)
+{
+    QImage img(64, 36, QImage::Format_RGB32);
+    for (int y = 0; y < img.height(); ++y) {
+        for (int x = 0; x < img.width(); ++x) {
+            img.setPixel(x, y, qRgb((x * seed) & 0xff, (y * 7 + seed) & 0xff, (x + y + seed) & 0xff));
+        }
+    }
+    return img;
+}
+} // namespace
+
+TEST_CASE("Thumbnail store", "[ThumbnailStore]")
+{
+    QTemporaryDir tmp;
+    REQUIRE(tmp.isValid());
+    QDir folder(tmp.path());
+
+    SECTION("Store and read back thumbnails")
+    {
+        ThumbnailStore store(folder, 1024 * 1024);
+        REQUIRE_FALSE(store.contains(QStringLiteral("abc"), 0));
+        REQUIRE(store.get(QStringLiteral("abc"), 0).isNull());
+        for (int pos = 0; pos < 10; ++pos) {
+            REQUIRE(store.store(QStringLiteral("abc"), pos * 25, makeThumb(pos)));
+        }
+        for (int pos = 0; pos < 10; ++pos) {
+            REQUIRE(store.contains(QStringLiteral("abc"), pos * 25));
+            REQUIRE(store.get(QStringLiteral("abc"), pos * 25) == makeThumb(pos));
+        }
+        REQUIRE_FALSE(store.contains(QStringLiteral("abc"), 1));
+        REQUIRE(store.size() > 0);
+
+        // A thumbnail stored again replaces the previous one
+        REQUIRE(store.store(QStringLiteral("abc"), 0, makeThumb(42)));
+        REQUIRE(store.get(QStringLiteral("abc"), 0) == makeThumb(42));
+    }
+
+    SECTION("Thumbnails persist across instances")
+    {
+        qint64 size = 0;
+        {
+            ThumbnailStore store(folder, 1024 * 1024);
+            REQUIRE(store.store(QStringLiteral("abc"), 5, makeThumb(1)));
+            REQUIRE(store.store(QStringLiteral("def"), 5, makeThumb(2)));
+            REQUIRE(store.store(QStringLiteral("abc"), 5, makeThumb(3)));
+            size = store.size();
+        }
+        REQUIRE(folder.entryList({QStringLiteral("*.thumbs")}, QDir::Files).size() == 2);
+        ThumbnailStore store(folder, 1024 * 1024);
+        REQUIRE(store.size() == size);
+        REQUIRE(store.get(QStringLiteral("abc"), 5) == makeThumb(3));
+        REQUIRE(store.get(QStringLiteral("def"), 5) == makeThumb(2));
+        // Appending after a reload keeps the existing entries readable
+        REQUIRE(store.store(QStringLiteral("abc"), 6, makeThumb(4)));
+        REQUIRE(store.get(QStringLiteral("abc"), 5) == makeThumb(3));
+        REQUIRE(store.get(QStringLiteral("abc"), 6) == makeThumb(4));
+    }
+
+    SECTION("Least recently used clips are evicted")
+    {
+        qint64 packSize = 0;
+        {
+            ThumbnailStore store(folder, 1024 * 1024);
+            REQUIRE(store.store(QStringLiteral("a"), 0, makeThumb(1)));
+            packSize = store.size();
+        }
+        folder.removeRecursively();
+        folder.mkpath(QStringLiteral("."));
+        // Room for two packs of a single thumbnail, with some slack since the encoded size varies
+        ThumbnailStore store(folder, packSize * 5 / 2);
+        REQUIRE(store.store(QStringLiteral("a"), 0, makeThumb(1)));
+        REQUIRE(store.store(QStringLiteral("b"), 0, makeThumb(1)));
+        // Use a, so that b becomes the oldest
+        REQUIRE(store.contains(QStringLiteral("a"), 0));
+        REQUIRE(store.store(QStringLiteral("c"), 0, makeThumb(1)));
+        REQUIRE(store.contains(QStringLiteral("a"), 0));
+        REQUIRE_FALSE(store.contains(QStringLiteral("b"), 0));
+        REQUIRE(store.contains(QStringLiteral("c"), 0));
+        REQUIRE(store.size() <= packSize * 5 / 2);
+        REQUIRE_FALSE(folder.exists(QStringLiteral("b.thumbs")));
+    }
+
+    SECTION("Remove the thumbnails of a clip")
+    {
+        ThumbnailStore store(folder, 1024 * 1024);
+        REQUIRE(store.store(QStringLiteral("abc"), 0, makeThumb(1)));
+        REQUIRE(store.store(QStringLiteral("def"), 0, makeThumb(2)));
+        store.remove(QStringLiteral("abc"));
+        REQUIRE_FALSE(store.contains(QStringLiteral("abc"), 0));
+        REQUIRE(store.contains(QStringLiteral("def"), 0));
+        REQUIRE_FALSE(folder.exists(QStringLiteral("abc.thumbs")));
+        REQUIRE_FALSE(folder.exists(QStringLiteral("abc.thumbindex")));
+        // Removing an unknown clip is harmless
+        store.remove(QStringLiteral("xyz"));
+        REQUIRE(store.store(QStringLiteral("abc"), 0, makeThumb(3)));
+        REQUIRE(store.get(QStringLiteral("abc"), 0) == makeThumb(3));
+    }
+}
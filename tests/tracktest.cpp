@@ -0,0 +1,203 @@
+#include "test_utils.hpp"
+
+using namespace fakeit;
+Mlt::Profile profile_track;
+
+TEST_CASE("Track range and row queries", "[TrackModel]")
+{
+    Logger::clear();
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    std::shared_ptr<MarkerListModel> guideModel = std::make_shared<MarkerListModel>(undoStack);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    TimelineItemModel tim(&profile_track, undoStack);
+    Mock<TimelineItemModel> timMock(tim);
+    auto timeline = std::shared_ptr<TimelineItemModel>(&timMock.get(), [](...) {});
+    TimelineItemModel::finishConstruct(timeline, guideModel);
+
+    RESET(timMock);
+
+    QString binId = createProducer(profile_track, "red", binModel);
+    int tid = TrackModel::construct(timeline);
+    int cid1 = ClipModel::construct(timeline, binId, -1, PlaylistState::VideoOnly);
+    int cid2 = ClipModel::construct(timeline, binId, -1, PlaylistState::VideoOnly);
+    int cid3 = ClipModel::construct(timeline, binId, -1, PlaylistState::VideoOnly);
+    auto track = timeline->getTrackById(tid);
+
+    // Insert in reverse order, rows must still follow the ids
+    REQUIRE(timeline->requestClipMove(cid3, tid, 60));
+    REQUIRE(timeline->requestClipMove(cid2, tid, 30));
+    REQUIRE(timeline->requestClipMove(cid1, tid, 0));
+    REQUIRE(timeline->checkConsistency());
+
+    REQUIRE(track->getRowfromClip(cid1) == 0);
+    REQUIRE(track->getRowfromClip(cid2) == 1);
+    REQUIRE(track->getRowfromClip(cid3) == 2);
+    REQUIRE(track->getClipByRow(0) == cid1);
+    REQUIRE(track->getClipByRow(2) == cid3);
+    REQUIRE(track->getClipByRow(3) == -1);
+
+    REQUIRE(track->getClipsInRange(0) == std::unordered_set<int>({cid1, cid2, cid3}));
+    REQUIRE(track->getClipsInRange(25, 35) == std::unordered_set<int>({cid2}));
+    REQUIRE(track->getClipsInRange(19, 30) == std::unordered_set<int>({cid1}));
+    REQUIRE(track->getClipsInRange(20, 30).empty());
+    REQUIRE(track->getClipsInRange(50) == std::unordered_set<int>({cid3}));
+    REQUIRE(track->getClipsInRange(80).empty());
+
+    SECTION("Resize from the left moves the clip in the index")
+    {
+        REQUIRE(timeline->requestItemResize(cid2, 10, false) == 10);
+        REQUIRE(timeline->checkConsistency());
+        REQUIRE(timeline->getClipPosition(cid2) == 40);
+        REQUIRE(track->getClipsInRange(30, 40).empty());
+        REQUIRE(track->getClipsInRange(45, 46) == std::unordered_set<int>({cid2}));
+
+        undoStack->undo();
+        REQUIRE(timeline->checkConsistency());
+        REQUIRE(track->getClipsInRange(30, 40) == std::unordered_set<int>({cid2}));
+    }
+
+    SECTION("Move and delete clips")
+    {
+        REQUIRE(timeline->requestClipMove(cid1, tid, 100));
+        REQUIRE(timeline->checkConsistency());
+        REQUIRE(track->getRowfromClip(cid1) == 0);
+        REQUIRE(track->getClipsInRange(0, 30).empty());
+        REQUIRE(track->getClipsInRange(110, 111) == std::unordered_set<int>({cid1}));
+
+        REQUIRE(timeline->requestItemDeletion(cid2));
+        REQUIRE(timeline->checkConsistency());
+        REQUIRE(track->getClipByRow(1) == cid3);
+        REQUIRE(track->getRowfromClip(cid3) == 1);
+
+        undoStack->undo();
+        REQUIRE(timeline->checkConsistency());
+        REQUIRE(track->getClipByRow(1) == cid2);
+        REQUIRE(track->getRowfromClip(cid3) == 2);
+    }
+    binModel->clean();
+    pCore->m_projectManager = nullptr;
+}
+
+TEST_CASE("Bulk insertion of clips", "[TrackModel]")
+{
+    Logger::clear();
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    std::shared_ptr<MarkerListModel> guideModel = std::make_shared<MarkerListModel>(undoStack);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    TimelineItemModel tim(&profile_track, undoStack);
+    Mock<TimelineItemModel> timMock(tim);
+    auto timeline = std::shared_ptr<TimelineItemModel>(&timMock.get(), [](...) {});
+    TimelineItemModel::finishConstruct(timeline, guideModel);
+
+    RESET(timMock);
+
+    QString binId = createProducer(profile_track, "red", binModel);
+    int tid = TrackModel::construct(timeline);
+    int audioTrack = TrackModel::construct(timeline, -1, -1, QString(), true);
+    std::vector<int> cids;
+    for (int i = 0; i < 6; ++i) {
+        cids.push_back(ClipModel::construct(timeline, binId, -1, PlaylistState::VideoOnly));
+    }
+    auto track = timeline->getTrackById(tid);
+
+    // The clip at 50 goes in the blank left before the clip at 100, the one at 10 overlaps the first two clips
+    std::vector<int> rejected =
+        timeline->bulkInsertClips(tid, {{cids[0], 0}, {cids[1], 20}, {cids[2], 100}, {cids[3], 50}, {cids[4], 10}, {cids[5], 130}});
+    REQUIRE(rejected == std::vector<int>({cids[4]}));
+    REQUIRE(timeline->getClipTrackId(cids[4]) == -1);
+    REQUIRE(timeline->checkConsistency());
+    REQUIRE(undoStack->count() == 0);
+    REQUIRE(timeline->getClipPosition(cids[0]) == 0);
+    REQUIRE(timeline->getClipPosition(cids[1]) == 20);
+    REQUIRE(timeline->getClipPosition(cids[2]) == 100);
+    REQUIRE(timeline->getClipPosition(cids[3]) == 50);
+    REQUIRE(timeline->getClipPosition(cids[5]) == 130);
+    REQUIRE(track->getClipByRow(3) == cids[3]);
+    REQUIRE(track->getClipsInRange(60, 110) == std::unordered_set<int>({cids[3], cids[2]}));
+    REQUIRE(timeline->getNextSnapPos(60) == 70);
+
+    // Video clips are refused by audio tracks
+    rejected = timeline->bulkInsertClips(audioTrack, {{cids[4], 0}});
+    REQUIRE(rejected == std::vector<int>({cids[4]}));
+    REQUIRE(timeline->getTrackClipsCount(audioTrack) == 0);
+
+    // The clips are then handled as usual
+    REQUIRE(timeline->requestClipMove(cids[4], tid, 200));
+    REQUIRE(timeline->requestItemDeletion(cids[3]));
+    REQUIRE(timeline->checkConsistency());
+    undoStack->undo();
+    REQUIRE(timeline->checkConsistency());
+    REQUIRE(timeline->getClipPosition(cids[3]) == 50);
+    binModel->clean();
+    pCore->m_projectManager = nullptr;
+}
+
+TEST_CASE("Track query cost as the track grows", "[.][benchmark][TrackModel]")
+{
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    std::shared_ptr<MarkerListModel> guideModel = std::make_shared<MarkerListModel>(undoStack);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    TimelineItemModel tim(&profile_track, undoStack);
+    Mock<TimelineItemModel> timMock(tim);
+    auto timeline = std::shared_ptr<TimelineItemModel>(&timMock.get(), [](...) {});
+    TimelineItemModel::finishConstruct(timeline, guideModel);
+
+    RESET(timMock);
+
+    QString binId = createProducer(profile_track, "red", binModel);
+    int tid = TrackModel::construct(timeline);
+    auto track = timeline->getTrackById(tid);
+    std::vector<int> clips;
+    for (int size : {500, 2000, 4000}) {
+        while ((int)clips.size() < size) {
+            int cid = ClipModel::construct(timeline, binId, -1, PlaylistState::VideoOnly);
+            REQUIRE(timeline->requestClipMove(cid, tid, (int)clips.size() * 20, false, false));
+            clips.push_back(cid);
+        }
+        int found = 0;
+        BENCHMARK(QStringLiteral("10000 row lookups on a track of %1 clips").arg(size).toStdString())
+        {
+            for (int i = 0; i < 10000; ++i) {
+                if (timeline->makeClipIndexFromID(clips[(size_t)i % clips.size()]).isValid()) {
+                    found++;
+                }
+            }
+        }
+        REQUIRE(found > 0);
+        size_t inRange = 0;
+        BENCHMARK(QStringLiteral("10000 range queries on a track of %1 clips").arg(size).toStdString())
+        {
+            for (int i = 0; i < 10000; ++i) {
+                int start = (i * 37) % (size * 20);
+                inRange += track->getClipsInRange(start, start + 100).size();
+            }
+        }
+        REQUIRE(inRange > 0);
+    }
+    binModel->clean();
+    pCore->m_projectManager = nullptr;
+}
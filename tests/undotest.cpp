@@ -0,0 +1,145 @@
+#include "test_utils.hpp"
+#include "macros.hpp"
+
+using namespace fakeit;
+Mlt::Profile profile_undo;
+
+TEST_CASE("Undo transaction", "[Undo]")
+{
+    std::vector<int> log;
+    UndoTransaction transaction;
+    REQUIRE(transaction.isEmpty());
+    for (int i = 1; i <= 3; ++i) {
+        transaction.push(
+            [&log, i]() {
+                log.push_back(i);
+                return true;
+            },
+            [&log, i]() {
+                log.push_back(-i);
+                return true;
+            });
+    }
+    bool recorded = transaction.record([&log](Fun &undo, Fun &redo) {
+        Fun operation = [&log]() {
+            log.push_back(4);
+            return true;
+        };
+        Fun reverse = [&log]() {
+            log.push_back(-4);
+            return false;
+        };
+        UPDATE_UNDO_REDO_NOLOCK(operation, reverse, undo, redo);
+        return true;
+    });
+    REQUIRE(recorded);
+    REQUIRE(transaction.size() == 4);
+
+    REQUIRE(transaction.redo());
+    REQUIRE(log == std::vector<int>{1, 2, 3, 4});
+    log.clear();
+    // All the reverses are run even if one fails
+    REQUIRE_FALSE(transaction.undo());
+    REQUIRE(log == std::vector<int>{-4, -3, -2, -1});
+    log.clear();
+
+    Fun undo = transaction.takeUndo();
+    Fun redo = transaction.takeRedo();
+    REQUIRE(transaction.isEmpty());
+    // The functions can be chained like any other
+    Fun copy = undo;
+    REQUIRE(redo());
+    REQUIRE_FALSE(copy());
+    REQUIRE(log == std::vector<int>{1, 2, 3, 4, -4, -3, -2, -1});
+}
+
+TEST_CASE("Undo of large group moves", "[.][benchmark][Undo]")
+{
+    const int count = 1000;
+    SECTION("Chained lambdas against a transaction")
+    {
+        int value = 0;
+        Fun operation = [&value]() {
+            value++;
+            return true;
+        };
+        Fun reverse = [&value]() {
+            value--;
+            return true;
+        };
+        BENCHMARK("Build and run 1000 chained lambdas")
+        {
+            Fun undo = []() { return true; };
+            Fun redo = []() { return true; };
+            for (int i = 0; i < count; ++i) {
+                UPDATE_UNDO_REDO_NOLOCK(operation, reverse, undo, redo);
+            }
+            REQUIRE(redo());
+            REQUIRE(undo());
+        }
+        BENCHMARK("Build and run a transaction of 1000 operations")
+        {
+            UndoTransaction transaction;
+            for (int i = 0; i < count; ++i) {
+                transaction.push(operation, reverse);
+            }
+            Fun undo = transaction.takeUndo();
+            Fun redo = transaction.takeRedo();
+            REQUIRE(redo());
+            REQUIRE(undo());
+        }
+        REQUIRE(value == 0);
+    }
+
+    SECTION("Move a group of 1000 clips")
+    {
+        auto binModel = pCore->projectItemModel();
+        binModel->clean();
+        std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+        std::shared_ptr<MarkerListModel> guideModel = std::make_shared<MarkerListModel>(undoStack);
+
+        Mock<ProjectManager> pmMock;
+        When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+
+        ProjectManager &mocked = pmMock.get();
+        pCore->m_projectManager = &mocked;
+
+        TimelineItemModel tim(&profile_undo, undoStack);
+        Mock<TimelineItemModel> timMock(tim);
+        auto timeline = std::shared_ptr<TimelineItemModel>(&timMock.get(), [](...) {});
+        TimelineItemModel::finishConstruct(timeline, guideModel);
+
+        RESET(timMock);
+
+        QString binId = createProducer(profile_undo, "red", binModel);
+        int tid = TrackModel::construct(timeline);
+        std::unordered_set<int> clips;
+        int first = -1;
+        for (int i = 0; i < count; ++i) {
+            int cid = ClipModel::construct(timeline, binId, -1, PlaylistState::VideoOnly);
+            REQUIRE(timeline->requestClipMove(cid, tid, i * 20, false, false));
+            clips.insert(cid);
+            first = first == -1 ? cid : first;
+        }
+        int gid = timeline->requestClipsGroup(clips, false);
+        REQUIRE(gid > 0);
+
+        BENCHMARK("Move a group of 1000 clips")
+        {
+            REQUIRE(timeline->requestGroupMove(first, gid, 0, 100, true, true));
+        }
+        REQUIRE(timeline->getClipPosition(first) == 100);
+        BENCHMARK("Undo the move of a group of 1000 clips")
+        {
+            undoStack->undo();
+        }
+        REQUIRE(timeline->getClipPosition(first) == 0);
+        BENCHMARK("Redo the move of a group of 1000 clips")
+        {
+            undoStack->redo();
+        }
+        REQUIRE(timeline->getClipPosition(first) == 100);
+        REQUIRE(timeline->checkConsistency());
+        pCore->m_projectManager = nullptr;
+    }
+}